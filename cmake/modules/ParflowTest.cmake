@@ -35,6 +35,32 @@ function (pf_add_parallel_test inputfile topology)
 
 endfunction()
 
+#
+# Add parflow test to ctest framework, run with OMP_NUM_THREADS set.
+#
+# inputfile is the TCL script that defines the test.
+# topology is the processor topology, number of processor along each axis NX NY NZ
+# threads is the number of OpenMP threads per process
+#
+# The test compares against the same correct output as the unthreaded run.
+#
+function (pf_add_threaded_test inputfile topology threads)
+  if (NOT PARFLOW_HAVE_TCL)
+    return()
+  endif()
+
+  string(REGEX REPLACE "/\.tcl" "" testname ${inputfile})
+  string(REGEX REPLACE " " "_" postfix ${topology})
+
+  list(APPEND args ${inputfile})
+  separate_arguments(targs UNIX_COMMAND ${topology})
+  list(APPEND args ${targs})
+
+  add_test (NAME ${testname}_${postfix}_omp${threads} COMMAND ${CMAKE_COMMAND} "-DPARFLOW_TEST=${args}" -DMPIEXEC=${MPIEXEC} -DMPIEXEC_NUMPROC_FLAG=${MPIEXEC_NUMPROC_FLAG} "-DMPIEXEC_PREFLAGS=${MPIEXEC_PREFLAGS}" "-DMPIEXEC_POSTFLAGS=${MPIEXEC_POSTFLAGS}" -DPARFLOW_HAVE_OAS3=${PARFLOW_HAVE_OAS3} -DPARFLOW_HAVE_SILO=${PARFLOW_HAVE_SILO} -DTCL_TCLSH=${TCL_TCLSH} -P ${CMAKE_SOURCE_DIR}/cmake/modules/RunParallelTest.cmake WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR})
+  set_tests_properties(${testname}_${postfix}_omp${threads} PROPERTIES TIMEOUT 3600 ENVIRONMENT "OMP_NUM_THREADS=${threads}")
+
+endfunction()
+
 #
 # Add parflow test to ctest framework.
 #
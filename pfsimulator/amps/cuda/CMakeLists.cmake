@@ -1,6 +1,7 @@
 
 set(AMPS_SRC_FILES
   amps_allreduce.c
+  amps_iallreduce.c
   amps_bcast.c
   amps_clear.c
   amps_createinvoice.c
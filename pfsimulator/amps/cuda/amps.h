@@ -371,6 +371,23 @@ typedef struct _amps_HandleObject {
 
 typedef amps_HandleObject *amps_Handle;
 
+/*===========================================================================*/
+/* Handle for a reduction started by amps_IAllReduce.  Holds one request     */
+/* and one pair of contiguous buffers per invoice entry until the matching   */
+/* amps_WaitAllReduce copies the results back into the invoice.              */
+/*===========================================================================*/
+
+typedef struct _amps_ReduceHandleObject {
+  amps_Invoice invoice;
+
+  int num;
+  MPI_Request   *requests;
+  char         **in_buffers;
+  char         **out_buffers;
+} amps_ReduceHandleObject;
+
+typedef amps_ReduceHandleObject *amps_ReduceHandle;
+
 extern amps_Buffer *amps_BufferList;
 extern amps_Buffer *amps_BufferListEnd;
 extern amps_Buffer *amps_BufferFreeList;
@@ -1,5 +1,6 @@
 set(AMPS_SRC_FILES
   amps_allreduce.c
+  amps_iallreduce.c
   amps_bcast.c
   amps_clear.c
   amps_createinvoice.c
@@ -331,6 +331,34 @@ typedef struct amps_buffer {
   char *buffer;
 } amps_Buffer;
 
+/**
+ * @brief GPU staging buffers for amps_exchange
+ *
+ * Each package owns a recv and a send instance with one buffer per
+ * invoice.  The buffers are allocated when the package is committed and
+ * kept until the package is freed, so the persistent requests of the
+ * package can be bound to them.
+ */
+typedef struct _amps_GpuBuffer {
+  /**
+   * A list of GPU pointers for the packed data for each recv/send invoice.
+   */
+  char **buf;
+  /**
+   * A list of CPU pointers for the packed data for each recv/send invoice.
+   * Only allocated if host staging is used.
+   */
+  char **buf_host;
+  /**
+   * A list of buf sizes for each invoice (applies to *buf and *host_buf).
+   */
+  int *buf_size;
+  /**
+   * The number of buffers allocated (applies to *buf and *host_buf).
+   */
+  int num_bufs;
+} amps_GpuBuffer;
+
 /*===========================================================================*/
 /* Package structure is used by the Exchange functions.  Contains several    */
 /* Invoices plus the src or dest rank.                                       */
@@ -350,6 +378,20 @@ typedef struct {
   MPI_Status    *status;
 
   int commited;
+
+#if defined(PARFLOW_HAVE_CUDA) || defined(PARFLOW_HAVE_KOKKOS)
+  /* Staging buffers bound to the persistent requests */
+  amps_GpuBuffer gpu_recvbuf;
+  amps_GpuBuffer gpu_sendbuf;
+#endif
+
+  /* Neighborhood collective plan, used when method is AMPS_EXCHANGE_NEIGHBOR */
+  int method;
+  MPI_Comm neighbor_comm;
+  MPI_Request neighbor_request;
+  int           *neighbor_counts;
+  MPI_Aint      *neighbor_displs;
+  MPI_Datatype  *neighbor_types;
 } amps_PackageStruct;
 
 typedef amps_PackageStruct *amps_Package;
@@ -364,6 +406,23 @@ typedef struct _amps_HandleObject {
 
 typedef amps_HandleObject *amps_Handle;
 
+/*===========================================================================*/
+/* Handle for a reduction started by amps_IAllReduce.  Holds one request     */
+/* and one pair of contiguous buffers per invoice entry until the matching   */
+/* amps_WaitAllReduce copies the results back into the invoice.              */
+/*===========================================================================*/
+
+typedef struct _amps_ReduceHandleObject {
+  amps_Invoice invoice;
+
+  int num;
+  MPI_Request   *requests;
+  char         **in_buffers;
+  char         **out_buffers;
+} amps_ReduceHandleObject;
+
+typedef amps_ReduceHandleObject *amps_ReduceHandle;
+
 extern amps_Buffer *amps_BufferList;
 extern amps_Buffer *amps_BufferListEnd;
 extern amps_Buffer *amps_BufferFreeList;
@@ -1210,6 +1269,18 @@ static inline void _amps_tfree_device(void *ptr)
 
 #endif // PARFLOW_HAVE_CUDA || PARFLOW_HAVE_KOKKOS
 
+/*---------------------------------------------------------------------------*/
+/* Package exchange methods, see amps_SetExchangeMethod                      */
+/*---------------------------------------------------------------------------*/
+
+#define AMPS_EXCHANGE_PERSISTENT 0
+#define AMPS_EXCHANGE_NEIGHBOR   1
+
+/* The neighborhood collective exchange needs persistent packages and MPI-3 */
+#if !defined(AMPS_MPI_NOT_USE_PERSISTENT) && (MPI_VERSION >= 3)
+#define AMPS_HAVE_NEIGHBOR_EXCHANGE
+#endif
+
 #include "amps_proto.h"
 
 #define AMPS_EXCHANGE_SPECIALIZED 1
@@ -28,90 +28,108 @@
 
 #include "amps.h"
 
-/* This CUDA stuff could be combined with AMPS_MPI_NOT_USE_PERSISTENT case */
 #if defined(PARFLOW_HAVE_CUDA) || defined(PARFLOW_HAVE_KOKKOS)
 
-void _amps_wait_exchange(amps_Handle handle)
+/*
+ * The staging buffers of a package are allocated when it is first
+ * exchanged and the persistent requests are bound to them, so later
+ * exchanges only pack, start, wait and unpack.  Invoices that can not be
+ * packed on the GPU fall back to a derived datatype, also kept until the
+ * package is freed.
+ */
+static void amps_gpu_commit(amps_Package package)
 {
   char *combuf;
-  int i;
   int size;
+  int i;
 
-  if (handle->package->num_recv + handle->package->num_send)
+  for (i = 0; i < package->num_recv; i++)
   {
-    MPI_Waitall(handle->package->num_recv + handle->package->num_send,
-                handle->package->recv_requests, handle->package->status);
-    for (i = 0; i < handle->package->num_recv; i++)
+    if (amps_gpupacking(AMPS_GETRBUF, package->recv_invoices[i], i,
+                        &package->gpu_recvbuf, &combuf, &size) == 0)
     {
-      amps_gpupacking(AMPS_UNPACK,
-                      handle->package->recv_invoices[i],
-                      i, &combuf, &size);
+      package->recv_invoices[i]->mpi_type = MPI_BYTE;
     }
-    for (i = 0; i < handle->package->num_recv; i++)
+    else
     {
-      amps_gpu_sync_streams(i);
-      AMPS_CLEAR_INVOICE(handle->package->recv_invoices[i]);
+      combuf = (char*)MPI_BOTTOM;
+      size = 1;
+      amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
+      MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
     }
+
+    MPI_Recv_init(combuf, size, package->recv_invoices[i]->mpi_type,
+                  package->src[i], 0, amps_CommWorld,
+                  &(package->recv_requests[i]));
   }
 
-  for (i = 0; i < handle->package->num_recv; i++)
+  for (i = 0; i < package->num_send; i++)
   {
-    MPI_Datatype type = handle->package->recv_invoices[i]->mpi_type;
-    if (type != MPI_DATATYPE_NULL && type != MPI_BYTE)
-      MPI_Type_free(&(handle->package->recv_invoices[i]->mpi_type));
-    if (handle->package->recv_requests[i] != MPI_REQUEST_NULL)
-      MPI_Request_free(&(handle->package->recv_requests[i]));
+    if (amps_gpupacking(AMPS_GETSBUF, package->send_invoices[i], i,
+                        &package->gpu_sendbuf, &combuf, &size) == 0)
+    {
+      package->send_invoices[i]->mpi_type = MPI_BYTE;
+    }
+    else
+    {
+      combuf = (char*)MPI_BOTTOM;
+      size = 1;
+      amps_create_mpi_type(amps_CommWorld, package->send_invoices[i]);
+      MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
+    }
+
+    MPI_Send_init(combuf, size, package->send_invoices[i]->mpi_type,
+                  package->dest[i], 0, amps_CommWorld,
+                  &(package->send_requests[i]));
   }
-  for (i = 0; i < handle->package->num_send; i++)
+
+  package->commited = TRUE;
+}
+
+void _amps_wait_exchange(amps_Handle handle)
+{
+  amps_Package package = handle->package;
+  char *combuf;
+  int i;
+  int size;
+
+  if (package->num_recv + package->num_send)
   {
-    MPI_Datatype type = handle->package->send_invoices[i]->mpi_type;
-    if (type != MPI_DATATYPE_NULL && type != MPI_BYTE)
-      MPI_Type_free(&handle->package->send_invoices[i]->mpi_type);
-    if (handle->package->send_requests[i] != MPI_REQUEST_NULL)
-      MPI_Request_free(&(handle->package->send_requests[i]));
+    MPI_Waitall(package->num_recv + package->num_send,
+                package->recv_requests, package->status);
+    for (i = 0; i < package->num_recv; i++)
+    {
+      if (package->recv_invoices[i]->mpi_type == MPI_BYTE)
+      {
+        amps_gpupacking(AMPS_UNPACK, package->recv_invoices[i], i,
+                        &package->gpu_recvbuf, &combuf, &size);
+      }
+    }
+    for (i = 0; i < package->num_recv; i++)
+    {
+      amps_gpu_sync_streams(i);
+      AMPS_CLEAR_INVOICE(package->recv_invoices[i]);
+    }
   }
 }
 
 amps_Handle amps_IExchangePackage(amps_Package package)
 {
-  char **combuf;
-  int *size;
-  int errchk;
+  char *combuf;
+  int size;
   int i;
 
-  if (package->num_send > 0)
-  {
-    combuf = (char**)malloc(package->num_send * sizeof(char*));
-    size = (int*)malloc(package->num_send * sizeof(int));
-  }
-  else
+  if (!package->commited)
   {
-    combuf = (char**)malloc(sizeof(char*));
-    size = (int*)malloc(sizeof(int));
+    amps_gpu_commit(package);
   }
 
   /*--------------------------------------------------------------------
    * post receives for data to get
    *--------------------------------------------------------------------*/
-  for (i = 0; i < package->num_recv; i++)
+  if (package->num_recv)
   {
-    errchk = amps_gpupacking(AMPS_GETRBUF, package->recv_invoices[i],
-                             i, &combuf[0], &size[0]);
-    if (errchk == 0)
-    {
-      package->recv_invoices[i]->mpi_type = MPI_BYTE;
-    }
-    else
-    {
-      combuf[0] = NULL;
-      size[0] = 1;
-      amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
-      MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
-    }
-
-    MPI_Irecv(combuf[0], size[0], package->recv_invoices[i]->mpi_type,
-              package->src[i], 0, amps_CommWorld,
-              &(package->recv_requests[i]));
+    MPI_Startall(package->num_recv, package->recv_requests);
   }
 
   /*--------------------------------------------------------------------
@@ -119,29 +137,17 @@ amps_Handle amps_IExchangePackage(amps_Package package)
    *--------------------------------------------------------------------*/
   for (i = 0; i < package->num_send; i++)
   {
-    errchk = amps_gpupacking(AMPS_PACK, package->send_invoices[i],
-                             i, &combuf[i], &size[i]);
-    if (errchk == 0)
-    {
-      package->send_invoices[i]->mpi_type = MPI_BYTE;
-    }
-    else
+    if (package->send_invoices[i]->mpi_type == MPI_BYTE)
     {
-      combuf[i] = NULL;
-      size[i] = 1;
-      amps_create_mpi_type(amps_CommWorld, package->send_invoices[i]);
-      MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
+      amps_gpupacking(AMPS_PACK, package->send_invoices[i], i,
+                      &package->gpu_sendbuf, &combuf, &size);
     }
   }
   for (i = 0; i < package->num_send; i++)
   {
     amps_gpu_sync_streams(i);
-    MPI_Isend(combuf[i], size[i], package->send_invoices[i]->mpi_type,
-              package->dest[i], 0, amps_CommWorld,
-              &(package->send_requests[i]));
+    MPI_Start(&(package->send_requests[i]));
   }
-  free(combuf);
-  free(size);
 
   return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
 }
@@ -212,67 +218,284 @@ amps_Handle amps_IExchangePackage(amps_Package package)
 
 #else
 
-void _amps_wait_exchange(amps_Handle handle)
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+
+/*---------------------------------------------------------------------------*/
+/* Graph communicators of the neighborhood collective exchange.  Packages    */
+/* with the same neighbors share one; creating them is collective, so the    */
+/* list has the same entries in the same order on every rank.                */
+/*---------------------------------------------------------------------------*/
+
+typedef struct {
+  int num_src;
+  int      *src;
+  int num_dest;
+  int      *dest;
+  MPI_Comm comm;
+} amps_NeighborComm;
+
+static amps_NeighborComm *amps_neighbor_comms = NULL;
+static int amps_num_neighbor_comms = 0;
+
+static int amps_exchange_method = AMPS_EXCHANGE_PERSISTENT;
+
+static int amps_same_ranks(int num_a, int *a, int num_b, int *b)
 {
   int i;
-  int num;
 
-  num = handle->package->num_send + handle->package->num_recv;
+  if (num_a != num_b)
+  {
+    return 0;
+  }
 
-  if (num)
+  for (i = 0; i < num_a; i++)
   {
-    if (handle->package->num_recv)
+    if (a[i] != b[i])
     {
-      for (i = 0; i < handle->package->num_recv; i++)
-      {
-        AMPS_CLEAR_INVOICE(handle->package->recv_invoices[i]);
-      }
+      return 0;
     }
-
-    MPI_Waitall(num, handle->package->recv_requests,
-                handle->package->status);
   }
 
-#ifdef AMPS_MPI_PACKAGE_LOWSTORAGE
-  /* Needed by the DEC's; need better memory allocation strategy */
-  /* Need to uncommit packages when not in use */
-  /* amps_Commit followed by amps_UnCommit ????? */
-  if (handle->package->commited)
+  return 1;
+}
+
+/*
+ * Find or create the graph communicator for the package neighbors.  Every
+ * rank must commit its packages in the same order, as for the exchanges.
+ */
+static MPI_Comm amps_neighbor_comm(amps_Package package)
+{
+  amps_NeighborComm *entry;
+  int *match = NULL;
+  int *weights;
+  int found = -1;
+  int num;
+  int i;
+
+  if (amps_num_neighbor_comms)
   {
-    for (i = 0; i < handle->package->num_recv; i++)
-    {
-      if (handle->package->recv_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
-      {
-        MPI_Type_free(&(handle->package->recv_invoices[i]->mpi_type));
-      }
+    match = (int*)malloc(amps_num_neighbor_comms * sizeof(int));
 
-      MPI_Request_free(&(handle->package->recv_requests[i]));
+    for (i = 0; i < amps_num_neighbor_comms; i++)
+    {
+      entry = &amps_neighbor_comms[i];
+      match[i] = amps_same_ranks(entry->num_src, entry->src,
+                                 package->num_recv, package->src)
+                 && amps_same_ranks(entry->num_dest, entry->dest,
+                                    package->num_send, package->dest);
     }
 
-    for (i = 0; i < handle->package->num_send; i++)
+    /* A communicator can only be reused if it matches on every rank */
+    MPI_Allreduce(MPI_IN_PLACE, match, amps_num_neighbor_comms, MPI_INT,
+                  MPI_LAND, amps_CommWorld);
+
+    for (i = 0; i < amps_num_neighbor_comms; i++)
     {
-      if (handle->package->send_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
+      if (match[i])
       {
-        MPI_Type_free(&handle->package->send_invoices[i]->mpi_type);
+        found = i;
+        break;
       }
+    }
+
+    free(match);
+  }
+
+  if (found >= 0)
+  {
+    return amps_neighbor_comms[found].comm;
+  }
+
+  amps_neighbor_comms = (amps_NeighborComm*)realloc(
+                                                    amps_neighbor_comms,
+                                                    (amps_num_neighbor_comms + 1) * sizeof(amps_NeighborComm));
+  entry = &amps_neighbor_comms[amps_num_neighbor_comms++];
+
+  entry->num_src = package->num_recv;
+  entry->src = (int*)malloc((package->num_recv + 1) * sizeof(int));
+  for (i = 0; i < package->num_recv; i++)
+  {
+    entry->src[i] = package->src[i];
+  }
 
-      MPI_Request_free(&(handle->package->send_requests[i]));
+  entry->num_dest = package->num_send;
+  entry->dest = (int*)malloc((package->num_send + 1) * sizeof(int));
+  for (i = 0; i < package->num_send; i++)
+  {
+    entry->dest[i] = package->dest[i];
+  }
+
+  /* Unit weights on every rank; MPI_UNWEIGHTED is a sentinel address that
+   * compilers flag as an out of bounds read */
+  num = (entry->num_src > entry->num_dest) ? entry->num_src : entry->num_dest;
+  weights = (int*)malloc((num + 1) * sizeof(int));
+  for (i = 0; i < num; i++)
+  {
+    weights[i] = 1;
+  }
+
+  MPI_Dist_graph_create_adjacent(amps_CommWorld,
+                                 entry->num_src, entry->src, weights,
+                                 entry->num_dest, entry->dest, weights,
+                                 MPI_INFO_NULL, 0, &entry->comm);
+
+  free(weights);
+
+  return entry->comm;
+}
+
+/*
+ * Commit the package for the neighborhood collective exchange.  Each
+ * invoice is one derived datatype at absolute addresses, so all counts
+ * are 1 and all displacements 0.
+ */
+static void amps_neighbor_commit(amps_Package package)
+{
+  int num = package->num_send + package->num_recv;
+  int max = (package->num_send > package->num_recv) ?
+            package->num_send : package->num_recv;
+  int i;
+
+  package->neighbor_comm = amps_neighbor_comm(package);
+
+  package->neighbor_counts = (int*)malloc((max + 1) * sizeof(int));
+  package->neighbor_displs = (MPI_Aint*)malloc((max + 1) * sizeof(MPI_Aint));
+  package->neighbor_types =
+    (MPI_Datatype*)malloc((num + 1) * sizeof(MPI_Datatype));
+
+  for (i = 0; i < max; i++)
+  {
+    package->neighbor_counts[i] = 1;
+    package->neighbor_displs[i] = 0;
+  }
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    amps_create_mpi_type(amps_CommWorld, package->send_invoices[i]);
+    MPI_Type_commit(&(package->send_invoices[i]->mpi_type));
+    package->neighbor_types[i] = package->send_invoices[i]->mpi_type;
+  }
+
+  for (i = 0; i < package->num_recv; i++)
+  {
+    amps_create_mpi_type(amps_CommWorld, package->recv_invoices[i]);
+    MPI_Type_commit(&(package->recv_invoices[i]->mpi_type));
+    package->neighbor_types[package->num_send + i] =
+      package->recv_invoices[i]->mpi_type;
+  }
+
+  package->neighbor_request = MPI_REQUEST_NULL;
+
+#if MPI_VERSION >= 4
+  MPI_Neighbor_alltoallw_init(MPI_BOTTOM, package->neighbor_counts,
+                              package->neighbor_displs,
+                              package->neighbor_types,
+                              MPI_BOTTOM, package->neighbor_counts,
+                              package->neighbor_displs,
+                              package->neighbor_types + package->num_send,
+                              package->neighbor_comm, MPI_INFO_NULL,
+                              &package->neighbor_request);
+#endif
+}
+
+static void amps_neighbor_start(amps_Package package)
+{
+#if MPI_VERSION >= 4
+  MPI_Start(&package->neighbor_request);
+#else
+  MPI_Ineighbor_alltoallw(MPI_BOTTOM, package->neighbor_counts,
+                          package->neighbor_displs,
+                          package->neighbor_types,
+                          MPI_BOTTOM, package->neighbor_counts,
+                          package->neighbor_displs,
+                          package->neighbor_types + package->num_send,
+                          package->neighbor_comm,
+                          &package->neighbor_request);
+#endif
+}
+
+void _amps_free_neighbor_package(amps_Package package)
+{
+  int i;
+
+  for (i = 0; i < package->num_send; i++)
+  {
+    if (package->send_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
+    {
+      MPI_Type_free(&package->send_invoices[i]->mpi_type);
     }
+  }
 
-    if (handle->package->recv_requests)
+  for (i = 0; i < package->num_recv; i++)
+  {
+    if (package->recv_invoices[i]->mpi_type != MPI_DATATYPE_NULL)
     {
-      free(handle->package->recv_requests);
-      handle->package->recv_requests = NULL;
+      MPI_Type_free(&package->recv_invoices[i]->mpi_type);
     }
-    if (handle->package->status)
+  }
+
+  if (package->neighbor_request != MPI_REQUEST_NULL)
+  {
+    MPI_Request_free(&package->neighbor_request);
+  }
+
+  free(package->neighbor_counts);
+  free(package->neighbor_displs);
+  free(package->neighbor_types);
+}
+
+void _amps_free_neighbor_comms(void)
+{
+  int i;
+
+  for (i = 0; i < amps_num_neighbor_comms; i++)
+  {
+    MPI_Comm_free(&amps_neighbor_comms[i].comm);
+    free(amps_neighbor_comms[i].src);
+    free(amps_neighbor_comms[i].dest);
+  }
+
+  free(amps_neighbor_comms);
+  amps_neighbor_comms = NULL;
+  amps_num_neighbor_comms = 0;
+}
+
+#endif
+
+void _amps_wait_exchange(amps_Handle handle)
+{
+  int i;
+  int num;
+
+  num = handle->package->num_send + handle->package->num_recv;
+
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+  if (handle->package->method == AMPS_EXCHANGE_NEIGHBOR)
+  {
+    for (i = 0; i < handle->package->num_recv; i++)
     {
-      free(handle->package->status);
-      handle->package->status = NULL;
+      AMPS_CLEAR_INVOICE(handle->package->recv_invoices[i]);
     }
 
-    handle->package->commited = FALSE;
+    MPI_Wait(&handle->package->neighbor_request, MPI_STATUS_IGNORE);
+
+    return;
   }
 #endif
+
+  if (num)
+  {
+    if (handle->package->num_recv)
+    {
+      for (i = 0; i < handle->package->num_recv; i++)
+      {
+        AMPS_CLEAR_INVOICE(handle->package->recv_invoices[i]);
+      }
+    }
+
+    MPI_Waitall(num, handle->package->recv_requests,
+                handle->package->status);
+  }
 }
 
 /*===========================================================================*/
@@ -316,6 +539,23 @@ amps_Handle amps_IExchangePackage(amps_Package package)
   /*-------------------------------------------------------------------
   * Check if we need to allocate the MPI types and requests
   *------------------------------------------------------------------*/
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+  if (!package->commited && amps_exchange_method == AMPS_EXCHANGE_NEIGHBOR)
+  {
+    package->commited = TRUE;
+    package->method = AMPS_EXCHANGE_NEIGHBOR;
+
+    amps_neighbor_commit(package);
+  }
+
+  if (package->method == AMPS_EXCHANGE_NEIGHBOR)
+  {
+    amps_neighbor_start(package);
+
+    return(amps_NewHandle(amps_CommWorld, 0, NULL, package));
+  }
+#endif
+
   if (!package->commited)
   {
     package->commited = TRUE;
@@ -392,3 +632,37 @@ amps_Handle amps_IExchangePackage(amps_Package package)
 
 #endif
 
+/*===========================================================================*/
+/**
+ *
+ * \Ref{amps_SetExchangeMethod} selects how packages committed after the
+ * call are exchanged.  With {\bf AMPS_EXCHANGE_PERSISTENT} (the default)
+ * each package keeps persistent point to point requests for all its
+ * neighbors.  With {\bf AMPS_EXCHANGE_NEIGHBOR} each package is exchanged
+ * with one neighborhood collective on a graph communicator of its
+ * neighbors.  All nodes must select the same method.
+ *
+ * @memo Select the package exchange method
+ * @param method AMPS_EXCHANGE_PERSISTENT or AMPS_EXCHANGE_NEIGHBOR
+ * @return 0 on success, 1 if the method is not available in this build
+ */
+int amps_SetExchangeMethod(int method)
+{
+  if (method == AMPS_EXCHANGE_PERSISTENT)
+  {
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+    amps_exchange_method = method;
+#endif
+    return 0;
+  }
+
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+  if (method == AMPS_EXCHANGE_NEIGHBOR)
+  {
+    amps_exchange_method = method;
+    return 0;
+  }
+#endif
+
+  return 1;
+}
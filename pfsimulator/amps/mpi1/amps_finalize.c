@@ -65,6 +65,9 @@ int amps_Finalize()
 {
   if (amps_mpi_initialized)
   {
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+    _amps_free_neighbor_comms();
+#endif
     MPI_Comm_free(&amps_CommNode);
     MPI_Comm_free(&amps_CommWrite);
     MPI_Comm_free(&amps_CommWorld);
@@ -28,33 +28,6 @@ extern "C"{
 /* Disable GPU packing (useful for debugging) */
 // #define DISABLE_GPU_PACKING
 
-/**
- * @brief A global GPU staging buffer for amps_exchange
- * 
- * A separate instance is allocated for recv and send operations
- * which are shared between all amps packages. The space is allocated
- * according to the largest invoice size.
- */
- typedef struct _amps_GpuBuffer {
-  /** 
-  * A list of GPU pointers for the packed data for each recv/send invoice. 
-  */
-  char **buf;
-  /** 
-  * A list of CPU pointers for the packed data for each recv/send invoice. 
-  * Only allocated if host staging is used.
-  */
-  char **buf_host;
-  /** 
-  * A list of buf sizes for each invoice (applies to *buf and *host_buf).
-  */
-  int *buf_size;
-  /** 
-  * The number of buffers allocated (applies to *buf and *host_buf).
-  */
-  int num_bufs;
-} amps_GpuBuffer;
-
 #ifdef DISABLE_GPU_PACKING
 /* Dummy definitions if no GPU packing */
 void amps_gpu_finalize(){}
@@ -63,32 +36,21 @@ void amps_gpu_sync_streams(int id){
   (void)id;
 }
 
-int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out, int *size_out){
+void amps_gpu_free_bufs(amps_GpuBuffer *gpubuf){
+  (void)gpubuf;
+}
+
+int amps_gpupacking(int action, amps_Invoice inv, int inv_num, amps_GpuBuffer *gpubuf, char **buffer_out, int *size_out){
   (void)action;
   (void)inv;
   (void)inv_num;
+  (void)gpubuf;
   (void)buffer_out;
   (void)size_out;
   return 1;
 }    
 #else
 
-amps_GpuBuffer amps_gpu_recvbuf = 
-{
-  .buf = NULL, 
-  .buf_host = NULL,
-  .buf_size = NULL,
-  .num_bufs = 0
-};
-
-amps_GpuBuffer amps_gpu_sendbuf = 
-{
-  .buf = NULL, 
-  .buf_host = NULL,
-  .buf_size = NULL,
-  .num_bufs = 0
-};
-
 /**
  * @brief Defines whether host staging is used
  *
@@ -309,9 +271,11 @@ void kokkosMemSetAmps(char* ptr, size_t size) {
 /**
  * @brief Free the staging buffers associated with gpubuf
  *
- * @param gpubuf A pointer to the amps_GpuBuffer [IN]
+ * Called when the package owning the buffers is freed.
+ *
+ * @param gpubuf A pointer to the amps_GpuBuffer [IN/OUT]
  */
-static void _amps_gpubuf_free(amps_GpuBuffer *gpubuf){
+void amps_gpu_free_bufs(amps_GpuBuffer *gpubuf){
   if(gpubuf->num_bufs > 0){
     for(int i = 0; i < gpubuf->num_bufs; i++){
       if(gpubuf->buf_size[i] > 0){
@@ -325,21 +289,16 @@ static void _amps_gpubuf_free(amps_GpuBuffer *gpubuf){
     if(ENFORCE_HOST_STAGING)
       free(gpubuf->buf_host);
   }
-}
-
-/**
- * @brief Free the global recv and send staging buffers
- */
-void amps_gpu_free_bufs(){
-  _amps_gpubuf_free(&amps_gpu_recvbuf);
-  _amps_gpubuf_free(&amps_gpu_sendbuf);
+  gpubuf->buf = NULL;
+  gpubuf->buf_host = NULL;
+  gpubuf->buf_size = NULL;
+  gpubuf->num_bufs = 0;
 }
 
 /**
  * @brief Finalize GPU resource usage
  */
 void amps_gpu_finalize(){
-  amps_gpu_free_bufs();
   amps_gpu_destroy_streams();
   if(Kokkos::is_initialized() && !Kokkos::is_finalized()) Kokkos::finalize();
 }
@@ -430,61 +389,21 @@ static char* _amps_gpubuf_realloc(amps_GpuBuffer *gpubuf, int id, int pos, int s
 }
 
 /**
- * @brief Get recv buffer associated with id to be passed for MPI
- *
- * @param id The id of the recv buffer [IN]
- * @return A pointer to the recv staging buffer
- */
-static char* _amps_gpu_recvbuf(int id){
-  if(id >= amps_gpu_recvbuf.num_bufs){
-    printf("ERROR at %s:%d: Not enough space is allocated for recvbufs\n", __FILE__, __LINE__);
-    exit(1);
-  }
-  if(ENFORCE_HOST_STAGING)
-    return amps_gpu_recvbuf.buf_host[id];
-  else
-    return amps_gpu_recvbuf.buf[id];
-}
-
-/**
- * @brief Allocate/reallocate recv GPU/CPU staging buffers
+ * @brief Get the staging buffer associated with id to be passed for MPI
  *
- * @param id The id associated with the buffer (typically amps invoice index) [IN]
- * @param pos The position in bytes up to which the buffer is already filled [IN]
- * @param size The total required buffer size subtracted by pos [IN]
- * @return A pointer to the allocated/reallocated GPU recv buffer
- */
-static char* _amps_gpu_recvbuf_realloc(int id, int pos, int size){
-  return _amps_gpubuf_realloc(&amps_gpu_recvbuf, id, pos, size);
-}
-
-/**
- * @brief Get send buffer associated with id to be passed for MPI
- *
- * @param id The id of the send buffer [IN]
- * @return A pointer to the send staging buffer
+ * @param gpubuf A pointer to the amps_GpuBuffer [IN]
+ * @param id The id of the buffer [IN]
+ * @return A pointer to the staging buffer
  */
-static char* _amps_gpu_sendbuf(int id){
-  if(id >= amps_gpu_sendbuf.num_bufs){
-    printf("ERROR at %s:%d: Not enough space is allocated for sendbufs\n", __FILE__, __LINE__);
+static char* _amps_gpubuf_get(amps_GpuBuffer *gpubuf, int id){
+  if(id >= gpubuf->num_bufs){
+    printf("ERROR at %s:%d: Not enough space is allocated for the staging buffers\n", __FILE__, __LINE__);
     exit(1);
   }
   if(ENFORCE_HOST_STAGING)
-    return amps_gpu_sendbuf.buf_host[id];
+    return gpubuf->buf_host[id];
   else
-    return amps_gpu_sendbuf.buf[id];
-}
-
-/**
- * @brief Allocate/reallocate send GPU/CPU staging buffers
- *
- * @param id The id associated with the buffer (typically amps invoice index) [IN]
- * @param pos The position in bytes up to which the buffer is already filled [IN]
- * @param size The total required buffer size subtracted by pos [IN]
- * @return A pointer to the allocated/reallocated GPU send buffer
- */
-static char* _amps_gpu_sendbuf_realloc(int id, int pos, int size){
-  return _amps_gpubuf_realloc(&amps_gpu_sendbuf, id, pos, size);
+    return gpubuf->buf[id];
 }
 
 /**
@@ -515,11 +434,12 @@ static char* _amps_gpu_sendbuf_realloc(int id, int pos, int size){
 * @param action either AMPS_GETRBUF, AMPS_GETSBUF, AMPS_PACK or AMPS_UNPACK [IN]
 * @param inv amps invoice [IN]
 * @param inv_num amps invoice order number [IN]
+* @param gpubuf the recv or send staging buffers of the package [IN/OUT]
 * @param buffer_out pointer to the pointer of the staging buffer [OUT]
 * @param size_out pointer to the invoice message size in bytes [OUT]
 * @return error code (line number), 0 if successful
 */
-int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out, int *size_out){
+int amps_gpupacking(int action, amps_Invoice inv, int inv_num, amps_GpuBuffer *gpubuf, char **buffer_out, int *size_out){
   
   char *buffer;
   int pos = 0;
@@ -591,11 +511,9 @@ int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out
 #endif
 
     int size = len_x * len_y * len_z * sizeof(double);
-    if((action == AMPS_GETSBUF) || (action == AMPS_PACK)){
-      buffer = _amps_gpu_sendbuf_realloc(inv_num, pos, size);
-    }
-    else if((action == AMPS_GETRBUF) || (action == AMPS_UNPACK)){
-      buffer = _amps_gpu_recvbuf_realloc(inv_num, pos, size);
+    if((action == AMPS_GETSBUF) || (action == AMPS_PACK) ||
+       (action == AMPS_GETRBUF) || (action == AMPS_UNPACK)){
+      buffer = _amps_gpubuf_realloc(gpubuf, inv_num, pos, size);
     }
     else{
       printf("ERROR at %s:%d: Unknown action argument (val = %d)\n", __FILE__, __LINE__, action);
@@ -627,16 +545,16 @@ int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out
       });
       if(ENFORCE_HOST_STAGING){
         /* Copy device buffer to host after packing */
-        kokkosMemCpyDeviceToHost(amps_gpu_sendbuf.buf_host[inv_num] + pos,
-                                    amps_gpu_sendbuf.buf[inv_num] + pos, size);
+        kokkosMemCpyDeviceToHost(gpubuf->buf_host[inv_num] + pos,
+                                    gpubuf->buf[inv_num] + pos, size);
       }
       inv->flags |= AMPS_PACKED;
     }
     else if(action == AMPS_UNPACK){
       if(ENFORCE_HOST_STAGING){
         /* Copy host buffer to device before unpacking */
-        kokkosMemCpyHostToDevice(amps_gpu_recvbuf.buf[inv_num] + pos,
-                                    amps_gpu_recvbuf.buf_host[inv_num] + pos, size);
+        kokkosMemCpyHostToDevice(gpubuf->buf[inv_num] + pos,
+                                    gpubuf->buf_host[inv_num] + pos, size);
       }
       Kokkos::parallel_for(mdpolicy_3d, KOKKOS_LAMBDA(int i, int j, int k)
       {
@@ -659,16 +577,7 @@ int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out
   // }
 
   /* Set the out values here if everything went fine */
-  if((action == AMPS_GETSBUF) || (action == AMPS_PACK)){
-    *buffer_out = _amps_gpu_sendbuf(inv_num);
-  }
-  else if((action == AMPS_GETRBUF) || (action == AMPS_UNPACK)){
-    *buffer_out = _amps_gpu_recvbuf(inv_num);
-  }
-  else{
-    printf("ERROR at %s:%d: Unknown action argument (val = %d)\n", __FILE__, __LINE__, action);
-    return __LINE__;
-  }
+  *buffer_out = _amps_gpubuf_get(gpubuf, inv_num);
 
   *size_out = pos;
 
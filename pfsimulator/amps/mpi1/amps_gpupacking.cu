@@ -53,33 +53,6 @@ extern "C"{
 /* Disable GPU packing (useful for debugging) */
 // #define DISABLE_GPU_PACKING
 
-/**
- * @brief A global GPU staging buffer for amps_exchange
- * 
- * A separate instance is allocated for recv and send operations
- * which are shared between all amps packages. The space is allocated
- * according to the largest invoice size.
- */
- typedef struct _amps_GpuBuffer {
-  /** 
-  * A list of GPU pointers for the packed data for each recv/send invoice. 
-  */
-  char **buf;
-  /** 
-  * A list of CPU pointers for the packed data for each recv/send invoice. 
-  * Only allocated if host staging is used.
-  */
-  char **buf_host;
-  /** 
-  * A list of buf sizes for each invoice (applies to *buf and *host_buf).
-  */
-  int *buf_size;
-  /** 
-  * The number of buffers allocated (applies to *buf and *host_buf).
-  */
-  int num_bufs;
-} amps_GpuBuffer;
-
 /**
  * @brief Information about the global GPU packing/unpacking streams
  */
@@ -112,32 +85,21 @@ void amps_gpu_sync_streams(int id){
   (void)id;
 }
 
-int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out, int *size_out){
+void amps_gpu_free_bufs(amps_GpuBuffer *gpubuf){
+  (void)gpubuf;
+}
+
+int amps_gpupacking(int action, amps_Invoice inv, int inv_num, amps_GpuBuffer *gpubuf, char **buffer_out, int *size_out){
   (void)action;
   (void)inv;
   (void)inv_num;
+  (void)gpubuf;
   (void)buffer_out;
   (void)size_out;
   return 1;
 }    
 #else
 
-amps_GpuBuffer amps_gpu_recvbuf = 
-{
-  .buf = NULL, 
-  .buf_host = NULL,
-  .buf_size = NULL,
-  .num_bufs = 0
-};
-
-amps_GpuBuffer amps_gpu_sendbuf = 
-{
-  .buf = NULL, 
-  .buf_host = NULL,
-  .buf_size = NULL,
-  .num_bufs = 0
-};
-
 amps_GpuStreams amps_gpu_streams = 
 {
   .stream = NULL,
@@ -258,9 +220,11 @@ void amps_gpu_sync_streams(int id){
 /**
  * @brief Free the staging buffers associated with gpubuf
  *
- * @param gpubuf A pointer to the amps_GpuBuffer [IN]
+ * Called when the package owning the buffers is freed.
+ *
+ * @param gpubuf A pointer to the amps_GpuBuffer [IN/OUT]
  */
-static void _amps_gpubuf_free(amps_GpuBuffer *gpubuf){
+void amps_gpu_free_bufs(amps_GpuBuffer *gpubuf){
   if(gpubuf->num_bufs > 0){
     for(int i = 0; i < gpubuf->num_bufs; i++){
       if(gpubuf->buf_size[i] > 0){
@@ -274,21 +238,16 @@ static void _amps_gpubuf_free(amps_GpuBuffer *gpubuf){
     if(ENFORCE_HOST_STAGING)
       free(gpubuf->buf_host);
   }
-}
-
-/**
- * @brief Free the global recv and send staging buffers
- */
-void amps_gpu_free_bufs(){
-  _amps_gpubuf_free(&amps_gpu_recvbuf);
-  _amps_gpubuf_free(&amps_gpu_sendbuf);
+  gpubuf->buf = NULL;
+  gpubuf->buf_host = NULL;
+  gpubuf->buf_size = NULL;
+  gpubuf->num_bufs = 0;
 }
 
 /**
  * @brief Finalize GPU resource usage
  */
  void amps_gpu_finalize(){
-  amps_gpu_free_bufs();
   amps_gpu_destroy_streams();
 }
 
@@ -375,61 +334,21 @@ static char* _amps_gpubuf_realloc(amps_GpuBuffer *gpubuf, int id, int pos, int s
 }
 
 /**
- * @brief Get recv buffer associated with id to be passed for MPI
+ * @brief Get the staging buffer associated with id to be passed for MPI
  *
- * @param id The id of the recv buffer [IN]
- * @return A pointer to the recv staging buffer
- */
-static char* _amps_gpu_recvbuf(int id){
-  if(id >= amps_gpu_recvbuf.num_bufs){
-    printf("ERROR at %s:%d: Not enough space is allocated for recvbufs\n", __FILE__, __LINE__);
-    exit(1);
-  }
-  if(ENFORCE_HOST_STAGING)
-    return amps_gpu_recvbuf.buf_host[id];
-  else
-    return amps_gpu_recvbuf.buf[id];
-}
-
-/**
- * @brief Allocate/reallocate recv GPU/CPU staging buffers
- *
- * @param id The id associated with the buffer (typically amps invoice index) [IN]
- * @param pos The position in bytes up to which the buffer is already filled [IN]
- * @param size The total required buffer size subtracted by pos [IN]
- * @return A pointer to the allocated/reallocated GPU recv buffer
- */
-static char* _amps_gpu_recvbuf_realloc(int id, int pos, int size){
-  return _amps_gpubuf_realloc(&amps_gpu_recvbuf, id, pos, size);
-}
-
-/**
- * @brief Get send buffer associated with id to be passed for MPI
- *
- * @param id The id of the send buffer [IN]
- * @return A pointer to the send staging buffer
+ * @param gpubuf A pointer to the amps_GpuBuffer [IN]
+ * @param id The id of the buffer [IN]
+ * @return A pointer to the staging buffer
  */
-static char* _amps_gpu_sendbuf(int id){
-  if(id >= amps_gpu_sendbuf.num_bufs){
-    printf("ERROR at %s:%d: Not enough space is allocated for sendbufs\n", __FILE__, __LINE__);
+static char* _amps_gpubuf_get(amps_GpuBuffer *gpubuf, int id){
+  if(id >= gpubuf->num_bufs){
+    printf("ERROR at %s:%d: Not enough space is allocated for the staging buffers\n", __FILE__, __LINE__);
     exit(1);
   }
   if(ENFORCE_HOST_STAGING)
-    return amps_gpu_sendbuf.buf_host[id];
+    return gpubuf->buf_host[id];
   else
-    return amps_gpu_sendbuf.buf[id];
-}
-
-/**
- * @brief Allocate/reallocate send GPU/CPU staging buffers
- *
- * @param id The id associated with the buffer (typically amps invoice index) [IN]
- * @param pos The position in bytes up to which the buffer is already filled [IN]
- * @param size The total required buffer size subtracted by pos [IN]
- * @return A pointer to the allocated/reallocated GPU send buffer
- */
-static char* _amps_gpu_sendbuf_realloc(int id, int pos, int size){
-  return _amps_gpubuf_realloc(&amps_gpu_sendbuf, id, pos, size);
+    return gpubuf->buf[id];
 }
 
  extern "C++"{
@@ -532,11 +451,12 @@ static char* _amps_gpu_sendbuf_realloc(int id, int pos, int size){
 * @param action either AMPS_GETRBUF, AMPS_GETSBUF, AMPS_PACK or AMPS_UNPACK [IN]
 * @param inv amps invoice [IN]
 * @param inv_num amps invoice order number [IN]
+* @param gpubuf the recv or send staging buffers of the package [IN/OUT]
 * @param buffer_out pointer to the pointer of the staging buffer [OUT]
 * @param size_out pointer to the invoice message size in bytes [OUT]
 * @return error code (line number), 0 if successful
 */
-int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out, int *size_out){
+int amps_gpupacking(int action, amps_Invoice inv, int inv_num, amps_GpuBuffer *gpubuf, char **buffer_out, int *size_out){
   
   char *buffer;
   int pos = 0;
@@ -609,11 +529,9 @@ int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out
     }
 
     int size = len_x * len_y * len_z * sizeof(double);
-    if((action == AMPS_GETSBUF) || (action == AMPS_PACK)){
-      buffer = _amps_gpu_sendbuf_realloc(inv_num, pos, size);
-    }
-    else if((action == AMPS_GETRBUF) || (action == AMPS_UNPACK)){
-      buffer = _amps_gpu_recvbuf_realloc(inv_num, pos, size);
+    if((action == AMPS_GETSBUF) || (action == AMPS_PACK) ||
+       (action == AMPS_GETRBUF) || (action == AMPS_UNPACK)){
+      buffer = _amps_gpubuf_realloc(gpubuf, inv_num, pos, size);
     }
     else{
       printf("ERROR at %s:%d: Unknown action argument (val = %d)\n", __FILE__, __LINE__, action);
@@ -641,8 +559,8 @@ int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out
         (double*)buffer, (double*)data, len_x, len_y, len_z, stride_x, stride_y, stride_z);
       if(ENFORCE_HOST_STAGING){
         /* Copy device buffer to host after packing */
-        CUDA_ERRCHK(cudaMemcpyAsync(amps_gpu_sendbuf.buf_host[inv_num] + pos,
-                                      amps_gpu_sendbuf.buf[inv_num] + pos,
+        CUDA_ERRCHK(cudaMemcpyAsync(gpubuf->buf_host[inv_num] + pos,
+                                      gpubuf->buf[inv_num] + pos,
                                         size, cudaMemcpyDeviceToHost, new_stream));
       }
       inv->flags |= AMPS_PACKED;
@@ -651,8 +569,8 @@ int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out
       cudaStream_t new_stream = amps_gpu_get_stream(inv_num);
       if(ENFORCE_HOST_STAGING){
         /* Copy host buffer to device before unpacking */
-        CUDA_ERRCHK(cudaMemcpyAsync(amps_gpu_recvbuf.buf[inv_num] + pos,
-                                      amps_gpu_recvbuf.buf_host[inv_num] + pos,
+        CUDA_ERRCHK(cudaMemcpyAsync(gpubuf->buf[inv_num] + pos,
+                                      gpubuf->buf_host[inv_num] + pos,
                                         size, cudaMemcpyHostToDevice, new_stream));
       }
       _amps_unpacking_kernel<<<grid, block, 0, new_stream>>>(
@@ -673,16 +591,7 @@ int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out
   // }
 
   /* Set the out values here if everything went fine */
-  if((action == AMPS_GETSBUF) || (action == AMPS_PACK)){
-    *buffer_out = _amps_gpu_sendbuf(inv_num);
-  }
-  else if((action == AMPS_GETRBUF) || (action == AMPS_UNPACK)){
-    *buffer_out = _amps_gpu_recvbuf(inv_num);
-  }
-  else{
-    printf("ERROR at %s:%d: Unknown action argument (val = %d)\n", __FILE__, __LINE__, action);
-    return __LINE__;
-  }
+  *buffer_out = _amps_gpubuf_get(gpubuf, inv_num);
 
   *size_out = pos;
 
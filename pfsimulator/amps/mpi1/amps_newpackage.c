@@ -67,6 +67,42 @@ amps_Package amps_NewPackage(amps_Comm     comm,
 
 void amps_FreePackage(amps_Package package)
 {
+#if defined(PARFLOW_HAVE_CUDA) || defined(PARFLOW_HAVE_KOKKOS)
+  int i;
+  MPI_Datatype type;
+
+  /* Release the persistent requests and their staging buffers */
+  if (package->commited)
+  {
+    for (i = 0; i < package->num_recv; i++)
+    {
+      type = package->recv_invoices[i]->mpi_type;
+      if (type != MPI_DATATYPE_NULL && type != MPI_BYTE)
+      {
+        MPI_Type_free(&(package->recv_invoices[i]->mpi_type));
+      }
+
+      MPI_Request_free(&package->recv_requests[i]);
+    }
+
+    for (i = 0; i < package->num_send; i++)
+    {
+      type = package->send_invoices[i]->mpi_type;
+      if (type != MPI_DATATYPE_NULL && type != MPI_BYTE)
+      {
+        MPI_Type_free(&package->send_invoices[i]->mpi_type);
+      }
+
+      MPI_Request_free(&package->send_requests[i]);
+    }
+
+    amps_gpu_free_bufs(&package->gpu_recvbuf);
+    amps_gpu_free_bufs(&package->gpu_sendbuf);
+
+    package->commited = FALSE;
+  }
+#endif
+
   if (package->num_recv + package->num_send)
   {
     free(package->recv_requests);
@@ -110,6 +146,14 @@ void amps_FreePackage(amps_Package package)
 
   if (package)
   {
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+    if (package->commited && package->method == AMPS_EXCHANGE_NEIGHBOR)
+    {
+      _amps_free_neighbor_package(package);
+      package->commited = FALSE;
+    }
+#endif
+
     if (package->commited)
     {
       for (i = 0; i < package->num_recv; i++)
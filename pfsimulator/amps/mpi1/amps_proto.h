@@ -1,6 +1,10 @@
 /* amps_allreduce.c */
 int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation);
 
+/* amps_iallreduce.c */
+amps_ReduceHandle amps_IAllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation);
+int amps_WaitAllReduce(amps_ReduceHandle handle);
+
 /* amps_bcast.c */
 int amps_BCast(amps_Comm comm, int source, amps_Invoice invoice);
 
@@ -20,6 +24,9 @@ void _amps_wait_exchange(amps_Handle handle);
 amps_Handle amps_IExchangePackage(amps_Package package);
 void _amps_wait_exchange(amps_Handle handle);
 amps_Handle amps_IExchangePackage(amps_Package package);
+int amps_SetExchangeMethod(int method);
+void _amps_free_neighbor_package(amps_Package package);
+void _amps_free_neighbor_comms(void);
 
 /* amps_ffopen.c */
 amps_File amps_FFopen(amps_Comm comm, char *filename, char *type, long size);
@@ -36,7 +43,8 @@ amps_File amps_Fopen(char *filename, char *type);
 /* amps_gpupacking.cu */
 void amps_gpu_finalize();
 void amps_gpu_sync_streams(int id);
-int amps_gpupacking(int action, amps_Invoice inv, int inv_num, char **buffer_out, int *size_out);
+void amps_gpu_free_bufs(amps_GpuBuffer *gpubuf);
+int amps_gpupacking(int action, amps_Invoice inv, int inv_num, amps_GpuBuffer *gpubuf, char **buffer_out, int *size_out);
 
 /* amps_init.c */
 int amps_Init(int *argc, char **argv []);
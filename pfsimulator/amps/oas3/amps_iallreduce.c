@@ -0,0 +1,238 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+
+#include "amps.h"
+
+#include <strings.h>
+
+static MPI_Datatype amps_ReduceType(int type, int *element_size)
+{
+  switch (type)
+  {
+    case AMPS_INVOICE_BYTE_CTYPE:
+      *element_size = sizeof(char);
+      return MPI_BYTE;
+
+    case AMPS_INVOICE_CHAR_CTYPE:
+      *element_size = sizeof(char);
+      return MPI_CHAR;
+
+    case AMPS_INVOICE_SHORT_CTYPE:
+      *element_size = sizeof(short);
+      return MPI_SHORT;
+
+    case AMPS_INVOICE_INT_CTYPE:
+      *element_size = sizeof(int);
+      return MPI_INT;
+
+    case AMPS_INVOICE_LONG_CTYPE:
+      *element_size = sizeof(long);
+      return MPI_LONG;
+
+    case AMPS_INVOICE_FLOAT_CTYPE:
+      *element_size = sizeof(float);
+      return MPI_FLOAT;
+
+    case AMPS_INVOICE_DOUBLE_CTYPE:
+      *element_size = sizeof(double);
+      return MPI_DOUBLE;
+
+    default:
+      printf("AMPS Operation not supported\n");
+  }
+
+  *element_size = 0;
+  return MPI_CHAR;
+}
+
+/*===========================================================================*/
+/**
+ * The collective operation \Ref{amps_IAllReduce} starts the same reduction
+ * as \Ref{amps_AllReduce} but returns without waiting for it to complete.
+ * The data described by the invoice is copied out when the reduction is
+ * started; the combined result is only written back to the invoice
+ * variables by \Ref{amps_WaitAllReduce}.  Work that does not depend on the
+ * result can be done between the two calls to hide the latency of the
+ * reduction.  The invoice must not be freed before the wait.
+ *
+ * {\large Example:}
+ * \begin{verbatim}
+ * amps_Invoice      invoice;
+ * amps_ReduceHandle handle;
+ * double            d[2];
+ *
+ * invoice = amps_NewInvoice("%*d", 2, d);
+ *
+ * handle = amps_IAllReduce(amps_CommWorld, invoice, amps_Add);
+ *
+ * // do some work not involving d
+ *
+ * amps_WaitAllReduce(handle);
+ *
+ * amps_FreeInvoice(invoice);
+ * \end{verbatim}
+ *
+ * @memo Start a nonblocking reduction
+ * @param comm communication context for the reduction [IN]
+ * @param invoice invoice to reduce [IN]
+ * @param operation reduction operation to perform [IN]
+ * @return Handle to pass to \Ref{amps_WaitAllReduce}
+ */
+amps_ReduceHandle amps_IAllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation)
+{
+  amps_ReduceHandle handle;
+  amps_InvoiceEntry *ptr;
+
+  int len;
+  int stride;
+  int num;
+
+  char *data;
+
+  char *ptr_src;
+  char *ptr_dest;
+
+  MPI_Datatype mpi_type;
+  int element_size;
+
+  num = 0;
+  for (ptr = invoice->list; ptr != NULL; ptr = ptr->next)
+    num++;
+
+  handle = (amps_ReduceHandle)malloc(sizeof(amps_ReduceHandleObject));
+  handle->invoice = invoice;
+  handle->num = num;
+  handle->requests = (MPI_Request*)malloc(sizeof(MPI_Request) * (size_t)num);
+  handle->in_buffers = (char**)malloc(sizeof(char*) * (size_t)num);
+  handle->out_buffers = (char**)malloc(sizeof(char*) * (size_t)num);
+
+  for (ptr = invoice->list, num = 0; ptr != NULL; ptr = ptr->next, num++)
+  {
+    if (ptr->len_type == AMPS_INVOICE_POINTER)
+      len = *(ptr->ptr_len);
+    else
+      len = ptr->len;
+
+    if (ptr->stride_type == AMPS_INVOICE_POINTER)
+      stride = *(ptr->ptr_stride);
+    else
+      stride = ptr->stride;
+
+    if (ptr->data_type == AMPS_INVOICE_POINTER)
+      data = *((char**)(ptr->data));
+    else
+      data = (char*)ptr->data;
+
+    mpi_type = amps_ReduceType(ptr->type, &element_size);
+
+    handle->in_buffers[num] = (char*)malloc((size_t)(element_size * len));
+    handle->out_buffers[num] = (char*)malloc((size_t)(element_size * len));
+
+    /* Copy into a contiguous buffer */
+    if (stride == 1)
+      bcopy(data, handle->in_buffers[num], (size_t)(len * element_size));
+    else
+      for (ptr_src = data, ptr_dest = handle->in_buffers[num];
+           ptr_src < data + len * stride * element_size;
+           ptr_src += stride * element_size, ptr_dest += element_size)
+        bcopy(ptr_src, ptr_dest, (size_t)(element_size));
+
+    MPI_Iallreduce(handle->in_buffers[num], handle->out_buffers[num], len,
+                   mpi_type, operation, comm, &(handle->requests[num]));
+  }
+
+  return handle;
+}
+
+/*===========================================================================*/
+/**
+ * \Ref{amps_WaitAllReduce} completes a reduction started by
+ * \Ref{amps_IAllReduce}, copies the combined result back into the
+ * invoice variables and frees the handle.  The invoice itself is not
+ * freed.
+ *
+ * @memo Wait for a nonblocking reduction
+ * @param handle handle returned by \Ref{amps_IAllReduce} [IN]
+ * @return Error code
+ */
+int amps_WaitAllReduce(amps_ReduceHandle handle)
+{
+  amps_InvoiceEntry *ptr;
+
+  int len;
+  int stride;
+  int num;
+
+  char *data;
+
+  char *ptr_src;
+  char *ptr_dest;
+
+  int element_size;
+
+  MPI_Waitall(handle->num, handle->requests, MPI_STATUSES_IGNORE);
+
+  for (ptr = handle->invoice->list, num = 0; ptr != NULL; ptr = ptr->next, num++)
+  {
+    if (ptr->len_type == AMPS_INVOICE_POINTER)
+      len = *(ptr->ptr_len);
+    else
+      len = ptr->len;
+
+    if (ptr->stride_type == AMPS_INVOICE_POINTER)
+      stride = *(ptr->ptr_stride);
+    else
+      stride = ptr->stride;
+
+    if (ptr->data_type == AMPS_INVOICE_POINTER)
+      data = *((char**)(ptr->data));
+    else
+      data = (char*)ptr->data;
+
+    amps_ReduceType(ptr->type, &element_size);
+
+    /* Copy back into user variables */
+    if (stride == 1)
+      bcopy(handle->out_buffers[num], data, (size_t)(len * element_size));
+    else
+      for (ptr_src = handle->out_buffers[num], ptr_dest = data;
+           ptr_src < handle->out_buffers[num] + len * element_size;
+           ptr_src += element_size, ptr_dest += stride * element_size)
+        bcopy(ptr_src, ptr_dest, (size_t)(element_size));
+
+    free(handle->in_buffers[num]);
+    free(handle->out_buffers[num]);
+  }
+
+  free(handle->requests);
+  free(handle->in_buffers);
+  free(handle->out_buffers);
+  free(handle);
+
+  return 0;
+}
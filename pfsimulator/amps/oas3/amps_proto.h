@@ -1,6 +1,10 @@
 /* amps_allreduce.c */
 int amps_AllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation);
 
+/* amps_iallreduce.c */
+amps_ReduceHandle amps_IAllReduce(amps_Comm comm, amps_Invoice invoice, MPI_Op operation);
+int amps_WaitAllReduce(amps_ReduceHandle handle);
+
 /* amps_bcast.c */
 int amps_BCast(amps_Comm comm, int source, amps_Invoice invoice);
 
@@ -103,6 +103,11 @@ extern int amps_write_size;
 
 #define amps_AllReduce(comm, invoice, operation)
 
+/* There is nothing to overlap with a reduction on a single process */
+typedef void *amps_ReduceHandle;
+#define amps_IAllReduce(comm, invoice, operation) NULL
+#define amps_WaitAllReduce(handle) 0
+
 #define amps_BCast(comm, source, invoice) 0
 
 #define amps_NewHandle(comm, id, invoice)
@@ -379,6 +379,13 @@ typedef struct _amps_HandleObject {
 
 typedef amps_HandleObject *amps_Handle;
 
+/* No nonblocking reduction in this layer; amps_IAllReduce completes the
+ * reduction before returning and amps_WaitAllReduce does nothing. */
+typedef void *amps_ReduceHandle;
+#define amps_IAllReduce(comm, invoice, operation) \
+  (amps_AllReduce((comm), (invoice), (operation)), (amps_ReduceHandle)NULL)
+#define amps_WaitAllReduce(handle) 0
+
 extern amps_Buffer *amps_BufferList;
 extern amps_Buffer *amps_BufferListEnd;
 extern amps_Buffer *amps_BufferFreeList;
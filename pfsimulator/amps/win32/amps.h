@@ -233,6 +233,13 @@ typedef struct {
 
 typedef amps_HandleObject *amps_Handle;
 
+/* No nonblocking reduction in this layer; amps_IAllReduce completes the
+ * reduction before returning and amps_WaitAllReduce does nothing. */
+typedef void *amps_ReduceHandle;
+#define amps_IAllReduce(comm, invoice, operation) \
+  (amps_AllReduce((comm), (invoice), (operation)), (amps_ReduceHandle)NULL)
+#define amps_WaitAllReduce(handle) 0
+
 #if 0
 extern amps_Buffer **amps_PtrBufferList;
 extern amps_Buffer **amps_PtrBufferListEnd;
@@ -20,6 +20,7 @@
 #define FACTOR RCONST(1000.0)
 #define ZERO   RCONST(0.0)
 #define ONE    RCONST(1.0)
+#define HALF   RCONST(0.5)
 
 
 /************************* ModifiedGS ***********************************
@@ -93,14 +94,16 @@ int ClassicalGS(N_Vector *v, real **h, int k, int p, real *new_vk_norm,
 
   k_minus_1 = k - 1;
 
-  /* Perform Classical Gram-Schmidt */
-
-  vk_norm = RSqrt(N_VDotProd(v[k], v[k]));
+  /* Perform Classical Gram-Schmidt; the projections and the norm of
+   * v[k] (v[k] dot v[k] is the last entry) share one reduction */
 
   i0 = MAX(k - p, 0);
+  N_VDotProdMulti(k - i0 + 1, v[k], v + i0, s + i0);
+  vk_norm = RSqrt(s[k]);
+
   for (i = i0; i < k; i++)
   {
-    h[i][k_minus_1] = N_VDotProd(v[i], v[k]);
+    h[i][k_minus_1] = s[i];
   }
 
   for (i = i0; i < k; i++)
@@ -116,10 +119,7 @@ int ClassicalGS(N_Vector *v, real **h, int k, int p, real *new_vk_norm,
 
   if ((FACTOR * (*new_vk_norm)) < vk_norm)
   {
-    for (i = i0; i < k; i++)
-    {
-      s[i] = N_VDotProd(v[i], v[k]);
-    }
+    N_VDotProdMulti(k - i0, v[k], v + i0, s + i0);
 
     if (i0 < k)
     {
@@ -139,6 +139,59 @@ int ClassicalGS(N_Vector *v, real **h, int k, int p, real *new_vk_norm,
   return(0);
 }
 
+/************************ ClassicalGS2 *******************************
+ * Classical Gram-Schmidt with one unconditional reorthogonalization
+ * pass (CGS2).  The second pass fuses the norm of v[k] into its
+ * reduction and recovers the final norm from the Pythagorean
+ * identity; the norm is only recomputed when that subtraction
+ * cancels.
+ **********************************************************************/
+
+int ClassicalGS2(N_Vector *v, real **h, int k, int p, real *new_vk_norm,
+                 real *s)
+{
+  int i, k_minus_1, i0;
+  real vk_norm_2, new_norm_2;
+
+  k_minus_1 = k - 1;
+  i0 = MAX(k - p, 0);
+
+  /* First pass */
+
+  N_VDotProdMulti(k - i0, v[k], v + i0, s + i0);
+
+  for (i = i0; i < k; i++)
+  {
+    h[i][k_minus_1] = s[i];
+    N_VLinearSum(ONE, v[k], -s[i], v[i], v[k]);
+  }
+
+  /* Second pass, together with v[k] dot v[k] in s[k] */
+
+  N_VDotProdMulti(k - i0 + 1, v[k], v + i0, s + i0);
+  vk_norm_2 = s[k];
+
+  new_norm_2 = ZERO;
+  for (i = i0; i < k; i++)
+  {
+    h[i][k_minus_1] += s[i];
+    N_VLinearSum(ONE, v[k], -s[i], v[i], v[k]);
+    new_norm_2 += SQR(s[i]);
+  }
+
+  new_norm_2 = vk_norm_2 - new_norm_2;
+  if (new_norm_2 > HALF * vk_norm_2)
+  {
+    *new_vk_norm = RSqrt(new_norm_2);
+  }
+  else
+  {
+    *new_vk_norm = RSqrt(N_VDotProd(v[k], v[k]));
+  }
+
+  return(0);
+}
+
 /*************** QRfact **********************************************
  * This implementation of QRfact is a slight modification of a previous
  * routine (called qrfact) written by Milo Dorr.
@@ -19,6 +19,7 @@
 #include "llnlmath.h"
 #include "iterativ.h"
 #include "spgmr.h"
+#include "spbcgp.h"
 
 
 /* Error Messages */
@@ -46,6 +47,7 @@ typedef struct {
   int g_maxl;         /* maxl = maximum dimension of the Krylov space   */
   int g_pretype;      /* preconditioning type--for Spgmr call           */
   int g_gstype;       /* gram schmidt type --  for Spgmr call           */
+  int g_krylov;       /* Krylov method, SPGMR_KRYLOV or SPBCGP_KRYLOV   */
   boole g_new_uu;       /* flag that a new uu has been created--
                          * indicating that a call to generate a new user-supplied
                          * Jacobian routine (internal to user's code) is req'd */
@@ -73,6 +75,10 @@ typedef struct {
   SpgmrMem g_spgmr_mem;
   /* spgmr_mem is memory used by the
    * generic Spgmr solver                           */
+
+  SpbcgpMem g_spbcgp_mem;
+  /* spbcgp_mem is memory used by the pipelined
+   * BiCGStab solver, NULL unless it is selected    */
 } KINSpgmrMemRec, *KINSpgmrMem;
 
 
@@ -120,6 +126,7 @@ static int KINSpgmrPSolve(void *kinsol_mem, N_Vector r, N_Vector z, int lr);
 #define precondflag (kin_mem->kin_precondflag)
 
 #define spgmr_mem (kinspgmr_mem->g_spgmr_mem)
+#define spbcgp_mem (kinspgmr_mem->g_spbcgp_mem)
 #define nli     (kinspgmr_mem->g_nli)
 #define npe     (kinspgmr_mem->g_npe)
 #define nps     (kinspgmr_mem->g_nps)
@@ -203,6 +210,8 @@ int KINSpgmr(void *kinsol_mem, int maxl, int maxlrst, int msbpre,
   }
 
   kinspgmr_mem->g_gstype = MODIFIED_GS;
+  kinspgmr_mem->g_krylov = SPGMR_KRYLOV;
+  kinspgmr_mem->g_spbcgp_mem = NULL;
 
   /* Set Spgmr parameters that have been passed in call sequence */
   kinspgmr_mem->g_maxl = (maxl <= 0) ? MIN(KINSPGMR_MAXL, Neq) : MIN(maxl, Neq);
@@ -237,6 +246,81 @@ int KINSpgmr(void *kinsol_mem, int maxl, int maxlrst, int msbpre,
 }
 
 
+/*************** KINSpgmrSetGSType ************************************
+*
+*  This routine selects the Gram-Schmidt routine used by Spgmr. It must
+*  be called after KINSpgmr.
+*
+**********************************************************************/
+
+int KINSpgmrSetGSType(void *kinsol_mem, int type)
+{
+  KINMem kin_mem;
+  KINSpgmrMem kinspgmr_mem;
+
+  kin_mem = (KINMem)kinsol_mem;
+
+  if (kin_mem == NULL)
+  {
+    return(KIN_MEM_NULL);
+  }
+
+  kinspgmr_mem = (KINSpgmrMem)lmem;
+  if (kinspgmr_mem == NULL)
+  {
+    fprintf(msgfp, MSG_MEM_FAIL);
+    return(KINSPGMR_MEM_FAIL);
+  }
+
+  kinspgmr_mem->g_gstype = type;
+
+  return(0);
+}
+
+
+/*************** KINSpgmrSetKrylovType ********************************
+*
+*  This routine selects the Krylov method used by KINSpgmrSolve and
+*  allocates the pipelined BiCGStab workspace when that method is
+*  chosen. It must be called after KINSpgmr.
+*
+**********************************************************************/
+
+int KINSpgmrSetKrylovType(void *kinsol_mem, int type)
+{
+  KINMem kin_mem;
+  KINSpgmrMem kinspgmr_mem;
+
+  kin_mem = (KINMem)kinsol_mem;
+
+  if (kin_mem == NULL)
+  {
+    return(KIN_MEM_NULL);
+  }
+
+  kinspgmr_mem = (KINSpgmrMem)lmem;
+  if (kinspgmr_mem == NULL)
+  {
+    fprintf(msgfp, MSG_MEM_FAIL);
+    return(KINSPGMR_MEM_FAIL);
+  }
+
+  if (type == SPBCGP_KRYLOV && spbcgp_mem == NULL)
+  {
+    spbcgp_mem = SpbcgpMalloc(Neq, machenv);
+    if (spbcgp_mem == NULL)
+    {
+      fprintf(msgfp, MSG_MEM_FAIL);
+      return(SPGMR_MEM_FAIL);
+    }
+  }
+
+  kinspgmr_mem->g_krylov = type;
+
+  return(0);
+}
+
+
 /* Additional readability Replacements */
 #define pretype (kinspgmr_mem->g_pretype)
 #define gstype  (kinspgmr_mem->g_gstype)
@@ -356,11 +440,33 @@ static int KINSpgmrSolve(KINMem kin_mem, N_Vector xx, N_Vector bb,
 
   kinspgmr_mem->g_new_uu = TRUE;  /* set flag required for user Jacobian rtn */
 
-  /* Call SpgmrSolve  */
-  ret = SpgmrSolve(spgmr_mem, kin_mem, xx, bb, pretype, gstype, eps,
-                   maxlinrestarts, kin_mem, fscale, fscale,
-                   KINSpgmrAtimes, KINSpgmrPSolve,
-                   res_norm, &nli_inc, &nps_inc);
+  if (kinspgmr_mem->g_krylov == SPBCGP_KRYLOV)
+  {
+    /* Call SpbcgpSolve with the iteration budget of SPGMR with restarts
+     * and map its return values onto the SPGMR ones. */
+    ret = SpbcgpSolve(spbcgp_mem, kin_mem, xx, bb, pretype, eps,
+                      maxl * (maxlinrestarts + 1), kin_mem, fscale, fscale,
+                      KINSpgmrAtimes, KINSpgmrPSolve,
+                      res_norm, &nli_inc, &nps_inc);
+    if (ret == SPBCGP_SUCCESS)
+      ret = SPGMR_SUCCESS;
+    else if (ret == SPBCGP_RES_REDUCED)
+      ret = SPGMR_RES_REDUCED;
+    else if (ret == SPBCGP_PSOLVE_FAIL_REC)
+      ret = SPGMR_PSOLVE_FAIL_REC;
+    else if (ret == SPBCGP_PSOLVE_FAIL_UNREC)
+      ret = SPGMR_PSOLVE_FAIL_UNREC;
+    else
+      ret = SPGMR_CONV_FAIL;
+  }
+  else
+  {
+    /* Call SpgmrSolve  */
+    ret = SpgmrSolve(spgmr_mem, kin_mem, xx, bb, pretype, gstype, eps,
+                     maxlinrestarts, kin_mem, fscale, fscale,
+                     KINSpgmrAtimes, KINSpgmrPSolve,
+                     res_norm, &nli_inc, &nps_inc);
+  }
   /* Increment counters nli, nps, and ncfl
    * (nni is updated in the KINSol main iteration loop) */
   nli += nli_inc;
@@ -428,6 +534,7 @@ static int KINSpgmrFree(KINMem kin_mem)
   kinspgmr_mem = (KINSpgmrMem)lmem;
 
   SpgmrFree(spgmr_mem);
+  SpbcgpFree(spbcgp_mem);
   free(lmem);
   return(0);
 }
@@ -18,6 +18,7 @@
 #include "vector.h"
 #include "kinsol.h"   /*  for KINSOL_IOPT_SIZE, etc.  */
 #include "spgmr.h"
+#include "spbcgp.h"
 #include "llnltyps.h"
 
 #include <stdio.h>
@@ -65,6 +66,10 @@ enum { SPGMR_NLI=KINSOL_IOPT_SIZE, SPGMR_NPE, SPGMR_NPS, SPGMR_NCFL };
 
 #define KINSPGMR_MSBPRE  10
 
+/* Krylov methods selectable with KINSpgmrSetKrylovType */
+
+enum krylov_type { SPGMR_KRYLOV, SPBCGP_KRYLOV };
+
 /* Constants for error returns from KINSpgmr. */
 
 #define KIN_MEM_NULL      -1
@@ -328,6 +333,55 @@ int KINSpgmr(void *kin_mem, int maxl, int maxlrst, int msbpre,
              KINSpgmruserAtimesFn userAtimes,
              void *P_data);
 
+
+/******************************************************************
+*                                                                *
+* Function : KINSpgmrSetGSType                                   *
+*----------------------------------------------------------------*
+* KINSpgmrSetGSType selects the Gram-Schmidt routine used by     *
+* Spgmr (see enum gs_type in iterativ.h). KINSpgmr sets it to    *
+* MODIFIED_GS; call this after KINSpgmr to change it.            *
+*                                                                *
+* kin_mem is the pointer to KINSol memory returned by            *
+*             KINSolMalloc.                                      *
+*                                                                *
+* gstype    is MODIFIED_GS, CLASSICAL_GS or CLASSICAL_GS2.       *
+*                                                                *
+*       KINSpgmrSetGSType returns SUCCESS, KIN_MEM_NULL or       *
+*       KINSPGMR_MEM_FAIL if KINSpgmr has not been called.       *
+*                                                                *
+******************************************************************/
+
+int KINSpgmrSetGSType(void *kin_mem, int gstype);
+
+
+/******************************************************************
+*                                                                *
+* Function : KINSpgmrSetKrylovType                               *
+*----------------------------------------------------------------*
+* KINSpgmrSetKrylovType selects the Krylov method used for the   *
+* Newton correction. KINSpgmr sets it to SPGMR_KRYLOV; call this *
+* after KINSpgmr to change it.                                   *
+*                                                                *
+* kin_mem is the pointer to KINSol memory returned by            *
+*             KINSolMalloc.                                      *
+*                                                                *
+* type      is SPGMR_KRYLOV for restarted GMRES (see spgmr.h),   *
+*             or SPBCGP_KRYLOV for pipelined BiCGStab (see       *
+*             spbcgp.h), which uses the same preconditioner and  *
+*             is allowed maxl * (maxlrst + 1) iterations.        *
+*             Linear iterations of either method are counted in  *
+*             iopt[SPGMR_NLI].                                   *
+*                                                                *
+*       KINSpgmrSetKrylovType returns SUCCESS, KIN_MEM_NULL,     *
+*       KINSPGMR_MEM_FAIL if KINSpgmr has not been called, or    *
+*       SPGMR_MEM_FAIL if the BiCGStab workspace cannot be       *
+*       allocated.                                               *
+*                                                                *
+******************************************************************/
+
+int KINSpgmrSetKrylovType(void *kin_mem, int type);
+
 END_EXTERN_C
 
 #endif
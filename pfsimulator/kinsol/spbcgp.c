@@ -0,0 +1,358 @@
+/******************************************************************
+* File          : spbcgp.c                                       *
+*----------------------------------------------------------------*
+* This is the implementation file for the scaled, right          *
+* preconditioned, pipelined BiCGStab (SPBCGP) iterative linear   *
+* solver.                                                        *
+*                                                                *
+******************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "iterativ.h"
+#include "spbcgp.h"
+#include "llnltyps.h"
+#include "vector.h"
+#include "llnlmath.h"
+
+
+#define ZERO RCONST(0.0)
+#define ONE  RCONST(1.0)
+
+
+/*************** Private Helper Function Prototypes ******************/
+
+static int SpbcgpPSolve(SpbcgpMem mem, boole preOnRight, N_Vector s2,
+                        void *P_data, PSolveFn psolve, N_Vector y,
+                        N_Vector yhat, int *nps);
+static int SpbcgpATimes(void *A_data, N_Vector s1, ATimesFn atimes,
+                        N_Vector yhat, N_Vector y);
+
+
+/* Implementation of the pipelined BiCGStab algorithm */
+
+
+/*************** SpbcgpMalloc ****************************************/
+
+SpbcgpMem SpbcgpMalloc(integer N, void *machEnv)
+{
+  SpbcgpMem mem;
+  N_Vector *vecs[13];
+  int k, i;
+
+  /* Check the input parameter. */
+
+  if (N <= 0)
+    return(NULL);
+
+  /* Get memory for an SpbcgpMemRec and its work vectors. */
+
+  mem = (SpbcgpMem)malloc(sizeof(SpbcgpMemRec));
+  if (mem == NULL)
+    return(NULL);
+
+  vecs[0] = &(mem->rstar);
+  vecs[1] = &(mem->r);
+  vecs[2] = &(mem->rhat);
+  vecs[3] = &(mem->w);
+  vecs[4] = &(mem->what);
+  vecs[5] = &(mem->t);
+  vecs[6] = &(mem->phat);
+  vecs[7] = &(mem->s);
+  vecs[8] = &(mem->shat);
+  vecs[9] = &(mem->z);
+  vecs[10] = &(mem->zhat);
+  vecs[11] = &(mem->v);
+  vecs[12] = &(mem->vtemp);
+
+  for (k = 0; k < 13; k++)
+  {
+    *vecs[k] = N_VNew(N, machEnv);
+    if (*vecs[k] == NULL)
+    {
+      for (i = 0; i < k; i++)
+        N_VFree(*vecs[i]);
+      free(mem);
+      return(NULL);
+    }
+  }
+
+  mem->N = N;
+
+  /* Return the pointer to SPBCGP memory. */
+
+  return(mem);
+}
+
+
+/*************** SpbcgpSolve *****************************************/
+
+int SpbcgpSolve(SpbcgpMem mem, void *A_data, N_Vector x, N_Vector b,
+                int pretype, real delta, int max_iters, void *P_data,
+                N_Vector s1, N_Vector s2, ATimesFn atimes, PSolveFn psolve,
+                real *res_norm, int *nli, int *nps)
+{
+  N_Vector rstar, r, rhat, w, what, t, phat, s, shat, z, zhat, v, vtemp;
+  N_Vector dot_x[5], dot_y[5];
+  real dots[5];
+  real alpha, beta, omega, rsr, denom, r_norm, r0_norm;
+  boole preOnRight;
+  VectorReduceHandle *handle;
+  int iter, ier;
+
+  if (mem == NULL)
+    return(SPBCGP_MEM_NULL);
+
+  /* Make local copies of mem variables. */
+  rstar = mem->rstar;
+  r = mem->r;
+  rhat = mem->rhat;
+  w = mem->w;
+  what = mem->what;
+  t = mem->t;
+  phat = mem->phat;
+  s = mem->s;
+  shat = mem->shat;
+  z = mem->z;
+  zhat = mem->zhat;
+  v = mem->v;
+  vtemp = mem->vtemp;
+
+  *nli = *nps = 0;     /* Initialize counters */
+
+  preOnRight = (pretype == LEFT) || (pretype == RIGHT) || (pretype == BOTH);
+
+  /* Set r to the scaled initial residual r_0 = s1 (b - A*x_0). */
+
+  if (N_VDotProd(x, x) == ZERO)
+  {
+    N_VScale(ONE, b, r);
+  }
+  else
+  {
+    if (atimes(A_data, x, vtemp) != 0)
+      return(SPBCGP_ATIMES_FAIL);
+    N_VLinearSum(ONE, b, -ONE, vtemp, r);
+  }
+  if (s1 != NULL)
+    N_VProd(s1, r, r);
+
+  rsr = N_VDotProd(r, r);
+  *res_norm = r_norm = r0_norm = RSqrt(rsr);
+  if (r_norm <= delta)
+    return(SPBCGP_SUCCESS);
+
+  /* Shadow residual rstar = r_0, then rhat, w = Abar rhat, what and
+   * t = Abar what, which the pipelined recurrences start from.      */
+
+  N_VScale(ONE, r, rstar);
+
+  ier = SpbcgpPSolve(mem, preOnRight, s2, P_data, psolve, r, rhat, nps);
+  if (ier != 0)
+    return((ier < 0) ? SPBCGP_PSOLVE_FAIL_UNREC : SPBCGP_PSOLVE_FAIL_REC);
+  if (SpbcgpATimes(A_data, s1, atimes, rhat, w) != 0)
+    return(SPBCGP_ATIMES_FAIL);
+
+  ier = SpbcgpPSolve(mem, preOnRight, s2, P_data, psolve, w, what, nps);
+  if (ier != 0)
+    return((ier < 0) ? SPBCGP_PSOLVE_FAIL_UNREC : SPBCGP_PSOLVE_FAIL_REC);
+  if (SpbcgpATimes(A_data, s1, atimes, what, t) != 0)
+    return(SPBCGP_ATIMES_FAIL);
+
+  denom = N_VDotProd(rstar, w);
+  if (denom == ZERO)
+    return(SPBCGP_CONV_FAIL);
+  alpha = rsr / denom;
+  beta = omega = ZERO;
+
+  for (iter = 0; iter < max_iters; iter++)
+  {
+    (*nli)++;
+
+    /* Update the search directions and their images. */
+
+    if (iter == 0)
+    {
+      N_VScale(ONE, rhat, phat);
+      N_VScale(ONE, w, s);
+      N_VScale(ONE, what, shat);
+      N_VScale(ONE, t, z);
+    }
+    else
+    {
+      N_VLinearSum(ONE, phat, -omega, shat, phat);
+      N_VLinearSum(ONE, rhat, beta, phat, phat);
+      N_VLinearSum(ONE, s, -omega, z, s);
+      N_VLinearSum(ONE, w, beta, s, s);
+      N_VLinearSum(ONE, shat, -omega, zhat, shat);
+      N_VLinearSum(ONE, what, beta, shat, shat);
+      N_VLinearSum(ONE, z, -omega, v, z);
+      N_VLinearSum(ONE, t, beta, z, z);
+    }
+
+    /* q = r - alpha s, qhat = rhat - alpha shat and y = w - alpha z
+     * overwrite r, rhat and w. */
+
+    N_VLinearSum(ONE, r, -alpha, s, r);
+    N_VLinearSum(ONE, rhat, -alpha, shat, rhat);
+    N_VLinearSum(ONE, w, -alpha, z, w);
+
+    /* Start (q,y) and (y,y); zhat and v = Abar zhat hide the latency. */
+
+    dot_x[0] = r;
+    dot_y[0] = w;
+    dot_x[1] = w;
+    dot_y[1] = w;
+    handle = N_VDotProdPairsBegin(2, dot_x, dot_y, dots);
+
+    ier = SpbcgpPSolve(mem, preOnRight, s2, P_data, psolve, z, zhat, nps);
+    if (ier == 0 && SpbcgpATimes(A_data, s1, atimes, zhat, v) != 0)
+    {
+      N_VDotProdPairsEnd(handle);
+      return(SPBCGP_ATIMES_FAIL);
+    }
+
+    N_VDotProdPairsEnd(handle);
+    if (ier != 0)
+      return((ier < 0) ? SPBCGP_PSOLVE_FAIL_UNREC : SPBCGP_PSOLVE_FAIL_REC);
+
+    if (dots[1] == ZERO)
+      break;
+    omega = dots[0] / dots[1];
+
+    /* x = x + alpha phat + omega qhat, then r = q - omega y,
+     * rhat = qhat - omega (what - alpha zhat) and
+     * w = y - omega (t - alpha v). */
+
+    N_VLinearSum(alpha, phat, ONE, x, x);
+    N_VLinearSum(omega, rhat, ONE, x, x);
+
+    N_VLinearSum(ONE, r, -omega, w, r);
+    N_VLinearSum(ONE, rhat, -omega, what, rhat);
+    N_VLinearSum(ONE, rhat, omega * alpha, zhat, rhat);
+    N_VLinearSum(ONE, w, -omega, t, w);
+    N_VLinearSum(ONE, w, omega * alpha, v, w);
+
+    /* Start the five products needed for the residual norm, beta
+     * and alpha; what and t = Abar what hide the latency.         */
+
+    dot_x[0] = rstar;
+    dot_y[0] = r;
+    dot_x[1] = rstar;
+    dot_y[1] = w;
+    dot_x[2] = rstar;
+    dot_y[2] = s;
+    dot_x[3] = rstar;
+    dot_y[3] = z;
+    dot_x[4] = r;
+    dot_y[4] = r;
+    handle = N_VDotProdPairsBegin(5, dot_x, dot_y, dots);
+
+    ier = SpbcgpPSolve(mem, preOnRight, s2, P_data, psolve, w, what, nps);
+    if (ier == 0 && SpbcgpATimes(A_data, s1, atimes, what, t) != 0)
+    {
+      N_VDotProdPairsEnd(handle);
+      return(SPBCGP_ATIMES_FAIL);
+    }
+
+    N_VDotProdPairsEnd(handle);
+    if (ier != 0)
+      return((ier < 0) ? SPBCGP_PSOLVE_FAIL_UNREC : SPBCGP_PSOLVE_FAIL_REC);
+
+    *res_norm = r_norm = RSqrt(dots[4]);
+    if (r_norm <= delta)
+      return(SPBCGP_SUCCESS);
+
+    /* Stop on a breakdown of the recurrences. */
+
+    if ((dots[0] == ZERO) || (omega == ZERO))
+      break;
+
+    beta = (alpha / omega) * (dots[0] / rsr);
+    rsr = dots[0];
+
+    denom = dots[1] + beta * dots[2] - beta * omega * dots[3];
+    if (denom == ZERO)
+      break;
+    alpha = rsr / denom;
+  }
+
+  /* Failed to converge within max_iters iterations.  x holds the
+   * latest iterate; report whether it reduced the residual norm.  */
+
+  if (r_norm < r0_norm)
+    return(SPBCGP_RES_REDUCED);
+
+  return(SPBCGP_CONV_FAIL);
+}
+
+/*************** SpbcgpFree ******************************************/
+
+void SpbcgpFree(SpbcgpMem mem)
+{
+  if (mem == NULL)
+    return;
+
+  N_VFree(mem->rstar);
+  N_VFree(mem->r);
+  N_VFree(mem->rhat);
+  N_VFree(mem->w);
+  N_VFree(mem->what);
+  N_VFree(mem->t);
+  N_VFree(mem->phat);
+  N_VFree(mem->s);
+  N_VFree(mem->shat);
+  N_VFree(mem->z);
+  N_VFree(mem->zhat);
+  N_VFree(mem->v);
+  N_VFree(mem->vtemp);
+
+  free(mem);
+}
+
+
+/*************** Private Helper Function: SpbcgpPSolve ***************/
+
+/* yhat = P2_inv s2_inv y */
+
+static int SpbcgpPSolve(SpbcgpMem mem, boole preOnRight, N_Vector s2,
+                        void *P_data, PSolveFn psolve, N_Vector y,
+                        N_Vector yhat, int *nps)
+{
+  N_Vector vtemp = mem->vtemp;
+  int ier;
+
+  if (s2 != NULL)
+    N_VDiv(y, s2, vtemp);
+  else
+    N_VScale(ONE, y, vtemp);
+
+  if (!preOnRight)
+  {
+    N_VScale(ONE, vtemp, yhat);
+    return(0);
+  }
+
+  ier = psolve(P_data, vtemp, yhat, RIGHT);
+  (*nps)++;
+
+  return(ier);
+}
+
+
+/*************** Private Helper Function: SpbcgpATimes ***************/
+
+/* y = s1 A yhat */
+
+static int SpbcgpATimes(void *A_data, N_Vector s1, ATimesFn atimes,
+                        N_Vector yhat, N_Vector y)
+{
+  if (atimes(A_data, yhat, y) != 0)
+    return(1);
+
+  if (s1 != NULL)
+    N_VProd(s1, y, y);
+
+  return(0);
+}
@@ -0,0 +1,152 @@
+/****************************************************************************
+ * File          : spbcgp.h                                                  *
+ *---------------------------------------------------------------------------*
+ * This is the header file for the implementation of the SPBCGP Krylov       *
+ * iterative linear solver, a scaled, right preconditioned, pipelined        *
+ * BiCGStab method (Cools and Vanroose, "The communication-hiding pipelined  *
+ * BiCGStab method for the parallel solution of large unsymmetric linear     *
+ * systems", Parallel Computing 65, 2017).                                   *
+ *                                                                           *
+ * The SPBCGP algorithm solves a N by N linear system A x = b.  Only right   *
+ * preconditioning is supported.  With the notation of spgmr.h, SPBCGP       *
+ * applies the pipelined BiCGStab method to the transformed system           *
+ *   Abar xbar = bbar ,   where                                              *
+ *   Abar = S1 A (P2-inverse) (S2-inverse) ,                                 *
+ *   bbar = S1 b , and   xbar = S2 P2 x .                                    *
+ *                                                                           *
+ * Each iteration needs two global reductions, as plain BiCGStab does, but   *
+ * they are started without waiting for the result: the first overlaps      *
+ * one preconditioner solve and one atimes call, and so does the second.     *
+ * On a large number of processes this hides most of the reduction latency  *
+ * at the price of extra vector updates and memory (thirteen work vectors).  *
+ *                                                                           *
+ * The stopping test for the SPBCGP iterations is on the L2 norm of the      *
+ * scaled residual, computed by recurrence:                                  *
+ *      || bbar - Abar xbar ||_2  <  delta                                   *
+ * with an input test constant delta.                                        *
+ *                                                                           *
+ * The usage of the SPBCGP solver follows SPGMR:                             *
+ *    mem  = SpbcgpMalloc(N, machEnv);                                       *
+ *    flag = SpbcgpSolve(mem,A_data,x,b,...,P_data,s1,s2,atimes,psolve,...); *
+ *    SpbcgpFree(mem);                                                       *
+ * atimes and psolve are described in iterativ.h.                            *
+ *                                                                           *
+ *****************************************************************************/
+
+#ifndef _spbcgp_h
+#define _spbcgp_h
+
+BEGIN_EXTERN_C
+
+#include "llnltyps.h"
+#include "iterativ.h"
+#include "vector.h"
+
+
+/******************************************************************
+*                                                                *
+* Types: SpbcgpMemRec, SpbcgpMem                                 *
+*----------------------------------------------------------------*
+* SpbcgpMem is a pointer to an SpbcgpMemRec which contains       *
+* the work vectors needed by SpbcgpSolve. A hat denotes a vector *
+* to which the scaled right preconditioner has been applied,     *
+* e.g. rhat = P2_inv s2_inv r.                                   *
+*                                                                *
+* N is the linear system size.                                   *
+*                                                                *
+* rstar is the fixed shadow residual r_0.                        *
+*                                                                *
+* r, rhat, w, what, t, p_hat, s, shat, z, zhat and v hold the    *
+* recurrence vectors of the method.                              *
+*                                                                *
+* vtemp is a length N vector used as temporary storage.          *
+*                                                                *
+******************************************************************/
+
+typedef struct {
+  integer N;
+  N_Vector rstar;
+  N_Vector r;
+  N_Vector rhat;
+  N_Vector w;
+  N_Vector what;
+  N_Vector t;
+  N_Vector phat;
+  N_Vector s;
+  N_Vector shat;
+  N_Vector z;
+  N_Vector zhat;
+  N_Vector v;
+  N_Vector vtemp;
+} SpbcgpMemRec, *SpbcgpMem;
+
+
+/******************************************************************
+*                                                                *
+* Function : SpbcgpMalloc                                        *
+*----------------------------------------------------------------*
+* SpbcgpMalloc allocates the memory used by SpbcgpSolve. It      *
+* returns a pointer of type SpbcgpMem which should be passed to  *
+* SpbcgpSolve. N is the size of the system and machEnv is a      *
+* pointer to machine environment-specific information, as for    *
+* SpgmrMalloc. This routine returns NULL if there is a memory    *
+* request failure.                                               *
+*                                                                *
+******************************************************************/
+
+SpbcgpMem SpbcgpMalloc(integer N, void *machEnv);
+
+
+/******************************************************************
+*                                                                *
+* Function : SpbcgpSolve                                         *
+*----------------------------------------------------------------*
+* SpbcgpSolve solves the linear system Ax = b using the SPBCGP   *
+* method. The arguments have the same meaning as for SpgmrSolve  *
+* except for:                                                    *
+*                                                                *
+* pretype is NONE or RIGHT. LEFT and BOTH are treated as RIGHT.  *
+*                                                                *
+* max_iters is the maximum number of iterations. Each iteration  *
+* makes two calls to atimes and two calls to psolve.             *
+*                                                                *
+* On return with SPBCGP_SUCCESS or SPBCGP_RES_REDUCED, x holds   *
+* the solution and (*res_norm) the recurrence estimate of        *
+* || s1 (b - Ax) ||_2. For all other return values x and         *
+* (*res_norm) are undefined.                                     *
+*                                                                *
+******************************************************************/
+
+int SpbcgpSolve(SpbcgpMem mem, void *A_data, N_Vector x, N_Vector b,
+                int pretype, real delta, int max_iters, void *P_data,
+                N_Vector s1, N_Vector s2, ATimesFn atimes, PSolveFn psolve,
+                real *res_norm, int *nli, int *nps);
+
+
+/* Return values for SpbcgpSolve */
+
+#define SPBCGP_SUCCESS             0  /* Converged                    */
+#define SPBCGP_RES_REDUCED         1  /* Did not converge, but reduced
+                                       * norm of residual             */
+#define SPBCGP_CONV_FAIL           2  /* Failed to converge           */
+#define SPBCGP_PSOLVE_FAIL_REC     4  /* psolve failed recoverably    */
+
+#define SPBCGP_MEM_NULL           -1  /* mem argument is NULL         */
+#define SPBCGP_ATIMES_FAIL        -2  /* atimes returned failure flag */
+#define SPBCGP_PSOLVE_FAIL_UNREC  -3  /* psolve failed unrecoverably  */
+
+
+/******************************************************************
+*                                                                *
+* Function : SpbcgpFree                                          *
+*----------------------------------------------------------------*
+* SpbcgpFree frees the memory allocated by SpbcgpMalloc. It is   *
+* illegal to use the pointer mem after a call to SpbcgpFree.     *
+*                                                                *
+******************************************************************/
+
+void SpbcgpFree(SpbcgpMem mem);
+
+END_EXTERN_C
+
+#endif
@@ -327,6 +327,12 @@ int SpgmrSolve(SpgmrMem mem, void *A_data, N_Vector x, N_Vector b,
                         vtemp, yg) != 0)
           return(SPGMR_GS_FAIL);
       }
+      else if (gstype == CLASSICAL_GS2)
+      {
+        if (ClassicalGS2(V, Hes, l_plus_1, l_max, &(Hes[l_plus_1][l]),
+                         yg) != 0)
+          return(SPGMR_GS_FAIL);
+      }
       else
       {
         if (ModifiedGS(V, Hes, l_plus_1, l_max, &(Hes[l_plus_1][l])) != 0)
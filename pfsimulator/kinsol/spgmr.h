@@ -178,7 +178,7 @@ SpgmrMem SpgmrMalloc(integer N, int l_max, void *machEnv);
 *                                                                *
 * gstype is the type of Gram-Schmidt orthogonalization to be     *
 * used. Its legal values are enumerated in iterativ.h. These     *
-* values are MODIFIED_GS=0 and CLASSICAL_GS=1.                   *
+* values are MODIFIED_GS=0, CLASSICAL_GS=1 and CLASSICAL_GS2=2.  *
 *                                                                *
 * delta is the tolerance on the L2 norm of the scaled,           *
 * preconditioned residual. On return with value SPGMR_SUCCESS,   *
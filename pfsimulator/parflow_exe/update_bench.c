@@ -0,0 +1,186 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+
+/*****************************************************************************
+*
+* Halo exchange micro-benchmark.
+*
+* Reads the computational grid and process topology of a run from its
+* pfidb file and times InitVectorUpdate/FinalizeVectorUpdate on a cell
+* centered vector for every VectorUpdate mode and every package exchange
+* method available in this build.  The time reported is the per exchange
+* average of the slowest rank.
+*
+*   mpirun -np <P*Q*R> pfupdatebench <run name> [exchanges per mode]
+*
+*****************************************************************************/
+#include "parflow.h"
+#include "amps.h"
+
+#include <stdlib.h>
+
+#define BENCH_WARMUP 10
+
+static const char *update_mode_names[NumUpdateModes] = {
+  "All", "All2", "RPoint", "BPoint", "Godunov",
+  "VelZ", "PGS1", "PGS2", "PGS3", "PGS4"
+};
+
+static double TimeUpdates(Vector *vector, int update_mode, int num_exchanges)
+{
+  VectorUpdateCommHandle *handle;
+  amps_Invoice result_invoice;
+  amps_Clock_t start;
+  double seconds;
+  int n;
+
+  /* The first exchanges commit the package */
+  for (n = 0; n < BENCH_WARMUP; n++)
+  {
+    handle = InitVectorUpdate(vector, update_mode);
+    FinalizeVectorUpdate(handle);
+  }
+
+  amps_Sync(amps_CommWorld);
+
+  start = amps_Clock();
+  for (n = 0; n < num_exchanges; n++)
+  {
+    handle = InitVectorUpdate(vector, update_mode);
+    FinalizeVectorUpdate(handle);
+  }
+  seconds = (double)(amps_Clock() - start) / AMPS_TICKS_PER_SEC;
+
+  result_invoice = amps_NewInvoice("%d", &seconds);
+  amps_AllReduce(amps_CommWorld, result_invoice, amps_Max);
+  amps_FreeInvoice(result_invoice);
+
+  return seconds / num_exchanges;
+}
+
+static void RunMethod(Grid *grid, const char *method_name, int num_exchanges)
+{
+  Vector *vector;
+  int mode;
+
+  /* A new vector, so its packages are committed with the current method */
+  vector = NewVectorType(grid, 1, 3, vector_cell_centered);
+  InitVectorAll(vector, 1.0);
+
+  for (mode = 0; mode < NumUpdateModes; mode++)
+  {
+    CommPkg *comm_pkg = VectorCommPkg(vector, mode);
+    double seconds = TimeUpdates(vector, mode, num_exchanges);
+    int num_messages = comm_pkg->num_send_invoices + comm_pkg->num_recv_invoices;
+    amps_Invoice result_invoice = amps_NewInvoice("%i", &num_messages);
+
+    amps_AllReduce(amps_CommWorld, result_invoice, amps_Max);
+    amps_FreeInvoice(result_invoice);
+
+    if (!amps_Rank(amps_CommWorld))
+    {
+      amps_Printf("%-12s %-8s %10d %14.3f\n", method_name,
+                  update_mode_names[mode], num_messages, seconds * 1.0e6);
+    }
+  }
+
+  FreeVector(vector);
+}
+
+int main(int argc, char *argv [])
+{
+  Grid *grid;
+  int num_exchanges;
+
+  if (amps_Init(&argc, &argv))
+  {
+    amps_Printf("Error: amps_Init initialization failed\n");
+    exit(1);
+  }
+
+  amps_SetConsole(stdout);
+
+  if (argc < 2)
+  {
+    amps_Printf("USAGE: %s <input pfidb run name> [exchanges per mode]\n",
+                argv[0]);
+    amps_Finalize();
+    return 1;
+  }
+
+  num_exchanges = (argc > 2) ? atoi(argv[2]) : 1000;
+  if (num_exchanges < 1)
+  {
+    num_exchanges = 1;
+  }
+
+  NewGlobals(argv[1]);
+  amps_ThreadLocal(input_database) = IDB_NewDB(GlobalsInFileName);
+  NewLogging();
+  NewTiming();
+
+  GlobalsNumProcsX = GetIntDefault("Process.Topology.P", 1);
+  GlobalsNumProcsY = GetIntDefault("Process.Topology.Q", 1);
+  GlobalsNumProcsZ = GetIntDefault("Process.Topology.R", 1);
+  GlobalsNumProcs = amps_Size(amps_CommWorld);
+
+  GlobalsBackground = ReadBackground();
+  GlobalsUserGrid = ReadUserGrid();
+  SetBackgroundBounds(GlobalsBackground, GlobalsUserGrid);
+
+  grid = CreateGrid(GlobalsUserGrid);
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    amps_Printf("Halo exchange on %d ranks, %d exchanges per mode\n",
+                GlobalsNumProcs, num_exchanges);
+    amps_Printf("%-12s %-8s %10s %14s\n", "method", "mode",
+                "messages", "usec/exchange");
+  }
+
+  RunMethod(grid, "Persistent", num_exchanges);
+
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+  amps_SetExchangeMethod(AMPS_EXCHANGE_NEIGHBOR);
+  RunMethod(grid, "Neighbor", num_exchanges);
+  amps_SetExchangeMethod(AMPS_EXCHANGE_PERSISTENT);
+#endif
+
+  FreeGrid(grid);
+  FreeUserGrid(GlobalsUserGrid);
+  FreeBackground(GlobalsBackground);
+
+  FreeTiming();
+  FreeLogging();
+  IDB_FreeDB(amps_ThreadLocal(input_database));
+  FreeGlobals();
+
+  amps_Finalize();
+
+  return 0;
+}
@@ -291,6 +291,9 @@ typedef struct {
   TimeCycleData      *time_cycle_data;
 } BCPressureData;
 
+/* Cached patch values of the file based types, see bc_pressure_file_cache.c */
+typedef struct _BCPressureFileCache BCPressureFileCache;
+
 /*--------------------------------------------------------------------------
  * Accessor macros: BCPressureValues
  * @MCB: With the new macro system these don't make as much sense, replace/deprecate?
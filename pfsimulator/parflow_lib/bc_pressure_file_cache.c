@@ -0,0 +1,603 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+/*****************************************************************************
+*
+* Cached reads of the PFB files used by the file based pressure boundary
+* conditions (PressureFile, FluxFile and OverlandFlowPFB).
+*
+* Only the values on the patch cells are needed, so for each subgrid the
+* bounding box of its patch cells is read straight from the file and the
+* patch values are picked out of it.  For a top or bottom patch this is a
+* single 2D slab.  The PFB subgrid headers are used to locate the data (see
+* PFBLayoutLoad), so the file may have been distributed for any process
+* topology and no .dist file is needed.  Reads are local to each process.
+*
+* The patch values of an interval are kept in a small LRU cache so time
+* cycles that repeat do not read the files again.  While an interval is in
+* use the file of the next interval is read in the background by an I/O
+* thread.  The thread only uses POSIX calls.  All reads go through the
+* thread, so the cached file layout is never accessed concurrently.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef PARFLOW_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+#define BC_FILE_EMPTY     0
+#define BC_FILE_PENDING   1
+#define BC_FILE_READY     2
+
+typedef struct {
+  int ix, iy, iz;             /* bounding box of the patch cells */
+  int nx, ny, nz;
+  int num_cells;
+  int *cells;                 /* cell offsets in the bounding box */
+} BCFileCells;
+
+typedef struct _BCFileEntry {
+  int state;
+  int required;               /* a failed read is an error */
+  char     *filename;
+  double  **values;           /* patch values for each subgrid */
+  long last_use;
+  struct _BCFileEntry *next;  /* read queue */
+  struct _BCFilePatch *patch;
+} BCFileEntry;
+
+typedef struct _BCFilePatch {
+  int num_subgrids;
+  BCFileCells *cells;         /* NULL until the patch cells are set */
+  int num_intervals;
+  BCFileEntry *entries;       /* one entry for each interval */
+  int num_cached;
+} BCFilePatch;
+
+struct _BCPressureFileCache {
+  int num_patches;
+  BCFilePatch *patches;
+  int max_cached;             /* cached intervals per patch */
+  long use_count;
+
+  PFBLayout *layout;          /* only used by the reading thread */
+
+  BCFileEntry *queue_head;
+  BCFileEntry *queue_tail;
+
+#ifdef PARFLOW_HAVE_PTHREADS
+  int thread_started;
+  int shutdown;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t not_empty;
+  pthread_cond_t done;
+#endif
+};
+
+/*--------------------------------------------------------------------------
+ * BCFileCacheReadEntry: read the patch values of an entry from its file.
+ *--------------------------------------------------------------------------*/
+
+static int BCFileCacheReadEntry(BCPressureFileCache *cache, BCFileEntry *entry)
+{
+  BCFilePatch *patch = entry->patch;
+  char        *filename = entry->filename;
+  int num_chars = strlen(filename);
+  int fd, is, c, status;
+  int loaded;
+
+  if ((num_chars < 4) || (strcmp(".pfb", &filename[num_chars - 4])))
+  {
+    if (entry->required)
+    {
+      amps_Printf("Error: %s is not in pfb format\n", filename);
+      exit(1);
+    }
+    return 0;
+  }
+
+  if ((fd = open(filename, O_RDONLY)) < 0)
+  {
+    if (entry->required)
+    {
+      amps_Printf("Error: can't open input file %s\n", filename);
+      exit(1);
+    }
+    return 0;
+  }
+
+  loaded = PFBLayoutLoad(cache->layout, fd, 0);
+
+  for (is = 0; is < patch->num_subgrids; is++)
+  {
+    BCFileCells *cells = &(patch->cells[is]);
+    double      *box_data;
+
+    if (cells->num_cells == 0)
+    {
+      continue;
+    }
+
+    box_data = talloc(double, cells->nx * cells->ny * cells->nz);
+
+    status = loaded ? PFBReadBox(cache->layout, fd, cells->ix, cells->iy,
+                                 cells->iz, cells->nx, cells->ny, cells->nz,
+                                 box_data) : 0;
+
+    /* Distributed differently from the previous file */
+    if (status == 0 && (loaded = PFBLayoutLoad(cache->layout, fd, 1)))
+    {
+      status = PFBReadBox(cache->layout, fd, cells->ix, cells->iy, cells->iz,
+                          cells->nx, cells->ny, cells->nz, box_data);
+    }
+
+    if (status != 1)
+    {
+      tfree(box_data);
+      close(fd);
+
+      if (entry->required)
+      {
+        if (status < 0)
+        {
+          amps_Printf("Error: %s does not cover the boundary patch\n",
+                      filename);
+        }
+        else
+        {
+          amps_Printf("Error: %s is not a valid pfb file\n", filename);
+        }
+        exit(1);
+      }
+      return 0;
+    }
+
+    for (c = 0; c < cells->num_cells; c++)
+    {
+      entry->values[is][c] = box_data[cells->cells[c]];
+    }
+
+    tfree(box_data);
+  }
+
+  close(fd);
+
+  return 1;
+}
+
+#ifdef PARFLOW_HAVE_PTHREADS
+/*--------------------------------------------------------------------------
+ * BCFileCacheThread: I/O thread reading the queued entries.
+ *--------------------------------------------------------------------------*/
+
+static void *BCFileCacheThread(void *arg)
+{
+  BCPressureFileCache *cache = (BCPressureFileCache*)arg;
+
+  pthread_mutex_lock(&cache->mutex);
+  while (1)
+  {
+    while (cache->queue_head == NULL && !cache->shutdown)
+    {
+      pthread_cond_wait(&cache->not_empty, &cache->mutex);
+    }
+
+    if (cache->queue_head == NULL)
+    {
+      break;
+    }
+
+    BCFileEntry *entry = cache->queue_head;
+    cache->queue_head = entry->next;
+    if (cache->queue_head == NULL)
+    {
+      cache->queue_tail = NULL;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    int success = BCFileCacheReadEntry(cache, entry);
+
+    pthread_mutex_lock(&cache->mutex);
+    entry->state = success ? BC_FILE_READY : BC_FILE_EMPTY;
+    pthread_cond_broadcast(&cache->done);
+  }
+  pthread_mutex_unlock(&cache->mutex);
+
+  return NULL;
+}
+#endif
+
+/*--------------------------------------------------------------------------
+ * BCFileCacheFreeEntry
+ *--------------------------------------------------------------------------*/
+
+static void BCFileCacheFreeEntry(BCFilePatch *patch, BCFileEntry *entry)
+{
+  int is;
+
+  if (entry->values)
+  {
+    for (is = 0; is < patch->num_subgrids; is++)
+    {
+      tfree(entry->values[is]);
+    }
+    tfree(entry->values);
+    patch->num_cached--;
+  }
+
+  entry->values = NULL;
+  entry->filename = NULL;
+  entry->state = BC_FILE_EMPTY;
+}
+
+/*--------------------------------------------------------------------------
+ * BCFileCacheQueue: queue an entry to be read from filename.
+ *
+ * The least recently used interval is dropped when the patch already
+ * holds max_cached intervals.
+ *--------------------------------------------------------------------------*/
+
+static void BCFileCacheQueue(BCPressureFileCache *cache, BCFilePatch *patch,
+                             BCFileEntry *entry, char *filename, int required)
+{
+  int is, n;
+
+  if (entry->values == NULL)
+  {
+    if (patch->num_cached >= cache->max_cached)
+    {
+      BCFileEntry *oldest = NULL;
+
+      for (n = 0; n < patch->num_intervals; n++)
+      {
+        BCFileEntry *other = &(patch->entries[n]);
+
+        if (other->values && other->state != BC_FILE_PENDING &&
+            other != entry &&
+            (oldest == NULL || other->last_use < oldest->last_use))
+        {
+          oldest = other;
+        }
+      }
+
+      if (oldest)
+      {
+        BCFileCacheFreeEntry(patch, oldest);
+      }
+    }
+
+    entry->values = ctalloc(double *, patch->num_subgrids);
+    for (is = 0; is < patch->num_subgrids; is++)
+    {
+      entry->values[is] = talloc(double, patch->cells[is].num_cells);
+    }
+    patch->num_cached++;
+  }
+
+  entry->filename = filename;
+  entry->required = required;
+  entry->state = BC_FILE_PENDING;
+  entry->last_use = ++(cache->use_count);
+
+#ifdef PARFLOW_HAVE_PTHREADS
+  if (!cache->thread_started)
+  {
+    if (pthread_create(&cache->thread, NULL, BCFileCacheThread, cache) != 0)
+    {
+      amps_Printf("Error: can't create boundary condition input thread\n");
+      exit(1);
+    }
+    cache->thread_started = 1;
+  }
+
+  pthread_mutex_lock(&cache->mutex);
+  entry->next = NULL;
+  if (cache->queue_tail)
+  {
+    cache->queue_tail->next = entry;
+  }
+  else
+  {
+    cache->queue_head = entry;
+  }
+  cache->queue_tail = entry;
+  pthread_cond_signal(&cache->not_empty);
+  pthread_mutex_unlock(&cache->mutex);
+#else
+  entry->state = BCFileCacheReadEntry(cache, entry) ?
+                 BC_FILE_READY : BC_FILE_EMPTY;
+#endif
+}
+
+/*--------------------------------------------------------------------------
+ * BCFileCacheWait: wait until an entry is no longer being read.
+ *--------------------------------------------------------------------------*/
+
+static void BCFileCacheWait(BCPressureFileCache *cache, BCFileEntry *entry)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  pthread_mutex_lock(&cache->mutex);
+  while (entry->state == BC_FILE_PENDING)
+  {
+    pthread_cond_wait(&cache->done, &cache->mutex);
+  }
+  pthread_mutex_unlock(&cache->mutex);
+#else
+  (void)cache;
+  (void)entry;
+#endif
+}
+
+/*--------------------------------------------------------------------------
+ * NewBCPressureFileCache
+ *--------------------------------------------------------------------------*/
+
+BCPressureFileCache *NewBCPressureFileCache(
+                                            int num_patches,
+                                            int max_cached)
+{
+  BCPressureFileCache *cache = ctalloc(BCPressureFileCache, 1);
+
+  cache->num_patches = num_patches;
+  cache->patches = ctalloc(BCFilePatch, num_patches);
+
+  /* Room for the interval in use and the one being read ahead */
+  cache->max_cached = pfmax(max_cached, 2);
+
+  cache->layout = NewPFBLayout();
+
+#ifdef PARFLOW_HAVE_PTHREADS
+  pthread_mutex_init(&cache->mutex, NULL);
+  pthread_cond_init(&cache->not_empty, NULL);
+  pthread_cond_init(&cache->done, NULL);
+#endif
+
+  return cache;
+}
+
+/*--------------------------------------------------------------------------
+ * FreeBCPressureFileCache
+ *--------------------------------------------------------------------------*/
+
+void FreeBCPressureFileCache(BCPressureFileCache *cache)
+{
+  int ipatch;
+
+  if (cache == NULL)
+  {
+    return;
+  }
+
+#ifdef PARFLOW_HAVE_PTHREADS
+  if (cache->thread_started)
+  {
+    pthread_mutex_lock(&cache->mutex);
+    cache->shutdown = 1;
+    pthread_cond_signal(&cache->not_empty);
+    pthread_mutex_unlock(&cache->mutex);
+
+    pthread_join(cache->thread, NULL);
+  }
+
+  pthread_mutex_destroy(&cache->mutex);
+  pthread_cond_destroy(&cache->not_empty);
+  pthread_cond_destroy(&cache->done);
+#endif
+
+  for (ipatch = 0; ipatch < cache->num_patches; ipatch++)
+  {
+    BCPressureFileCacheSetCells(cache, ipatch, 0, 0, NULL, NULL);
+  }
+
+  FreePFBLayout(cache->layout);
+  tfree(cache->patches);
+  tfree(cache);
+}
+
+/*--------------------------------------------------------------------------
+ * BCPressureFileCacheNumCells
+ *
+ * Number of patch cells set for subgrid is, -1 if none are set.
+ *--------------------------------------------------------------------------*/
+
+int BCPressureFileCacheNumCells(
+                                BCPressureFileCache *cache,
+                                int                  ipatch,
+                                int                  is)
+{
+  BCFilePatch *patch = &(cache->patches[ipatch]);
+
+  if (patch->cells == NULL || is >= patch->num_subgrids)
+  {
+    return -1;
+  }
+
+  return patch->cells[is].num_cells;
+}
+
+/*--------------------------------------------------------------------------
+ * BCPressureFileCacheSetCells
+ *
+ * Set the patch cells of each subgrid, as (i, j, k) triples in the order
+ * of the patch values, and drop any cached values of the patch.  Called
+ * with num_subgrids 0 it only frees the patch.  Must not be called while
+ * a read of the patch is pending.
+ *--------------------------------------------------------------------------*/
+
+void BCPressureFileCacheSetCells(
+                                 BCPressureFileCache *cache,
+                                 int                  ipatch,
+                                 int                  num_intervals,
+                                 int                  num_subgrids,
+                                 int *                num_cells,
+                                 int **               cell_indexes)
+{
+  BCFilePatch *patch = &(cache->patches[ipatch]);
+  int is, c, n;
+
+  for (n = 0; n < patch->num_intervals; n++)
+  {
+    BCFileCacheWait(cache, &(patch->entries[n]));
+    BCFileCacheFreeEntry(patch, &(patch->entries[n]));
+  }
+  tfree(patch->entries);
+
+  for (is = 0; is < patch->num_subgrids; is++)
+  {
+    tfree(patch->cells[is].cells);
+  }
+  tfree(patch->cells);
+
+  patch->num_subgrids = num_subgrids;
+  patch->num_intervals = num_intervals;
+  patch->num_cached = 0;
+
+  if (num_subgrids == 0)
+  {
+    return;
+  }
+
+  patch->entries = ctalloc(BCFileEntry, num_intervals);
+  for (n = 0; n < num_intervals; n++)
+  {
+    patch->entries[n].patch = patch;
+  }
+
+  patch->cells = ctalloc(BCFileCells, num_subgrids);
+  for (is = 0; is < num_subgrids; is++)
+  {
+    BCFileCells *cells = &(patch->cells[is]);
+    int         *ijk = cell_indexes[is];
+    int lo[3], hi[3], d;
+
+    cells->num_cells = num_cells[is];
+    if (cells->num_cells == 0)
+    {
+      continue;
+    }
+
+    for (d = 0; d < 3; d++)
+    {
+      lo[d] = hi[d] = ijk[d];
+    }
+    for (c = 1; c < cells->num_cells; c++)
+    {
+      for (d = 0; d < 3; d++)
+      {
+        lo[d] = pfmin(lo[d], ijk[3 * c + d]);
+        hi[d] = pfmax(hi[d], ijk[3 * c + d]);
+      }
+    }
+
+    cells->ix = lo[0];
+    cells->iy = lo[1];
+    cells->iz = lo[2];
+    cells->nx = hi[0] - lo[0] + 1;
+    cells->ny = hi[1] - lo[1] + 1;
+    cells->nz = hi[2] - lo[2] + 1;
+
+    cells->cells = talloc(int, cells->num_cells);
+    for (c = 0; c < cells->num_cells; c++)
+    {
+      cells->cells[c] = ((ijk[3 * c + 2] - cells->iz) * cells->ny
+                         + (ijk[3 * c + 1] - cells->iy)) * cells->nx
+                        + (ijk[3 * c] - cells->ix);
+    }
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * BCPressureFileCacheRead
+ *
+ * Patch values of interval_number read from filename, one array for each
+ * subgrid in the order of the patch cells.  The arrays are owned by the
+ * cache and stay valid until the next call for this patch.
+ *--------------------------------------------------------------------------*/
+
+double **BCPressureFileCacheRead(
+                                 BCPressureFileCache *cache,
+                                 int                  ipatch,
+                                 int                  interval_number,
+                                 char *               filename)
+{
+  BCFilePatch *patch = &(cache->patches[ipatch]);
+  BCFileEntry *entry = &(patch->entries[interval_number]);
+
+  BCFileCacheWait(cache, entry);
+
+  /* A failed read ahead is retried; the error is reported now */
+  if (entry->state != BC_FILE_READY)
+  {
+    BCFileCacheQueue(cache, patch, entry, filename, 1);
+    BCFileCacheWait(cache, entry);
+  }
+
+  entry->last_use = ++(cache->use_count);
+
+  return entry->values;
+}
+
+/*--------------------------------------------------------------------------
+ * BCPressureFileCachePrefetch
+ *
+ * Start reading the patch values of interval_number in the background.
+ * Errors are ignored until the values are read.
+ *--------------------------------------------------------------------------*/
+
+void BCPressureFileCachePrefetch(
+                                 BCPressureFileCache *cache,
+                                 int                  ipatch,
+                                 int                  interval_number,
+                                 char *               filename)
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  BCFilePatch *patch = &(cache->patches[ipatch]);
+  BCFileEntry *entry = &(patch->entries[interval_number]);
+  int state;
+
+  pthread_mutex_lock(&cache->mutex);
+  state = entry->state;
+  pthread_mutex_unlock(&cache->mutex);
+
+  if (state == BC_FILE_EMPTY)
+  {
+    BCFileCacheQueue(cache, patch, entry, filename, 0);
+  }
+#else
+  (void)cache;
+  (void)ipatch;
+  (void)interval_number;
+  (void)filename;
+#endif
+}
@@ -0,0 +1,678 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+/*****************************************************************************
+*
+* Routines to write and read full-state checkpoint files.
+*
+* A checkpoint holds a set of named scalars and named Vectors in a single
+* file.  Rank 0 writes the header:
+*
+*   char   magic[8]                        "PFCHKPT"
+*   int    version, num_scalars, num_vectors
+*   num_scalars x { char name[32]; double value; }
+*   num_vectors x { char name[32]; int ix, iy, iz, nx, ny, nz; }
+*
+* The data of each Vector follows in header order.  A Vector is stored as
+* the global array over the bounding box (ix, iy, iz, nx, ny, nz) of its
+* grid with x varying fastest, so the file does not depend on the process
+* topology that wrote it and can be read back on any other one.  Values
+* are big-endian (XDR), as in PFB files.
+*
+* With MPI each subgrid is moved with one collective MPI-IO call through a
+* subarray file view.  The file is written under a temporary name and
+* renamed when complete, so an interrupted write never replaces a good
+* checkpoint.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#include <string.h>
+
+#define CHECKPOINT_MAGIC         "PFCHKPT"
+#define CHECKPOINT_VERSION       1
+#define CHECKPOINT_NAME_LEN      32
+
+#define CHECKPOINT_PREAMBLE_SIZE (8 + 3 * 4)
+#define CHECKPOINT_SCALAR_SIZE   (CHECKPOINT_NAME_LEN + 8)
+#define CHECKPOINT_VECTOR_SIZE   (CHECKPOINT_NAME_LEN + 6 * 4)
+
+#ifdef PARFLOW_HAVE_MPI
+typedef MPI_File CheckpointFile;
+#else
+typedef FILE *CheckpointFile;
+#endif
+
+/*--------------------------------------------------------------------------
+ * CheckpointVectorBox
+ *
+ * Bounding box of all subgrids of the grid of v as ix, iy, iz, nx, ny, nz.
+ *--------------------------------------------------------------------------*/
+
+static void CheckpointVectorBox(Vector *v, int *box)
+{
+  SubgridArray   *all_subgrids = GridAllSubgrids(VectorGrid(v));
+  Subgrid        *subgrid;
+
+  int lo[3] = { 0, 0, 0 };
+  int hi[3] = { 0, 0, 0 };
+  int g;
+
+  ForSubgridI(g, all_subgrids)
+  {
+    subgrid = SubgridArraySubgrid(all_subgrids, g);
+
+    if (g == 0)
+    {
+      lo[0] = SubgridIX(subgrid);
+      lo[1] = SubgridIY(subgrid);
+      lo[2] = SubgridIZ(subgrid);
+      hi[0] = lo[0] + SubgridNX(subgrid);
+      hi[1] = lo[1] + SubgridNY(subgrid);
+      hi[2] = lo[2] + SubgridNZ(subgrid);
+    }
+    else
+    {
+      lo[0] = pfmin(lo[0], SubgridIX(subgrid));
+      lo[1] = pfmin(lo[1], SubgridIY(subgrid));
+      lo[2] = pfmin(lo[2], SubgridIZ(subgrid));
+      hi[0] = pfmax(hi[0], SubgridIX(subgrid) + SubgridNX(subgrid));
+      hi[1] = pfmax(hi[1], SubgridIY(subgrid) + SubgridNY(subgrid));
+      hi[2] = pfmax(hi[2], SubgridIZ(subgrid) + SubgridNZ(subgrid));
+    }
+  }
+
+  box[0] = lo[0];
+  box[1] = lo[1];
+  box[2] = lo[2];
+  box[3] = hi[0] - lo[0];
+  box[4] = hi[1] - lo[1];
+  box[5] = hi[2] - lo[2];
+}
+
+/*--------------------------------------------------------------------------
+ * CheckpointMaxSubgrids
+ *
+ * Largest number of local subgrids of any of the vectors on any rank; the
+ * collective I/O calls are made this many times per vector.  Collective.
+ *--------------------------------------------------------------------------*/
+
+static int CheckpointMaxSubgrids(int num_vectors, Vector **vectors)
+{
+  amps_Invoice result_invoice;
+  int max_subgrids = 0;
+  int m;
+
+  for (m = 0; m < num_vectors; m++)
+  {
+    max_subgrids = pfmax(max_subgrids, GridNumSubgrids(VectorGrid(vectors[m])));
+  }
+
+  result_invoice = amps_NewInvoice("%i", &max_subgrids);
+  amps_AllReduce(amps_CommWorld, result_invoice, amps_Max);
+  amps_FreeInvoice(result_invoice);
+
+  return max_subgrids;
+}
+
+/*--------------------------------------------------------------------------
+ * CheckpointVectorIO
+ *
+ * Write (write != 0) or read the local subgrids of v to/from the global
+ * array of box starting at byte disp.  Side centered vectors share the
+ * faces between neighbouring subgrids; on write only the subgrid at the
+ * upper end of the box stores its upper face so no value is written twice.
+ * Collective.
+ *--------------------------------------------------------------------------*/
+
+static void CheckpointVectorIO(
+                               CheckpointFile fh,
+                               long long      disp,
+                               int *          box,
+                               Vector *       v,
+                               int            max_subgrids,
+                               int            write)
+{
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  Subgrid        *subgrid;
+  Subvector      *subvector;
+
+  int g;
+
+  for (g = 0; g < max_subgrids; g++)
+  {
+    int ix = 0, iy = 0, iz = 0;
+    int nx = 0, ny = 0, nz = 0;
+    int count = 0;
+
+    char           *buffer;
+
+    if (g < SubgridArraySize(subgrids))
+    {
+      subgrid = SubgridArraySubgrid(subgrids, g);
+
+      ix = SubgridIX(subgrid);
+      iy = SubgridIY(subgrid);
+      iz = SubgridIZ(subgrid);
+
+      nx = SubgridNX(subgrid);
+      ny = SubgridNY(subgrid);
+      nz = SubgridNZ(subgrid);
+
+      if (write)
+      {
+        if (VectorType(v) == vector_side_centered_x && ix + nx < box[0] + box[3])
+          nx--;
+        if (VectorType(v) == vector_side_centered_y && iy + ny < box[1] + box[4])
+          ny--;
+        if (VectorType(v) == vector_side_centered_z && iz + nz < box[2] + box[5])
+          nz--;
+      }
+
+      count = nx * ny * nz;
+    }
+
+    buffer = talloc(char, count > 0 ? 8 * (size_t)count : 1);
+
+    if (write && count > 0)
+    {
+      int nx_v, ny_v, nz_v;
+      int i, j, k, ai;
+      double *data;
+      char *pos = buffer;
+
+      subvector = VectorSubvector(v, g);
+
+      nx_v = SubvectorNX(subvector);
+      ny_v = SubvectorNY(subvector);
+      nz_v = SubvectorNZ(subvector);
+
+      data = SubvectorElt(subvector, ix, iy, iz);
+
+      ai = 0;
+      BoxLoopI1(i, j, k,
+                ix, iy, iz, nx, ny, nz,
+                ai, nx_v, ny_v, nz_v, 1, 1, 1,
+      {
+        pos = PFBPackDouble(pos, data[ai]);
+      });
+    }
+
+#ifdef PARFLOW_HAVE_MPI
+    {
+      MPI_Datatype element;
+      MPI_Datatype filetype;
+      MPI_Status status;
+
+      MPI_Type_contiguous(8, MPI_BYTE, &element);
+      MPI_Type_commit(&element);
+
+      if (count > 0)
+      {
+        int sizes[3] = { box[5], box[4], box[3] };
+        int subsizes[3] = { nz, ny, nx };
+        int starts[3] = { iz - box[2], iy - box[1], ix - box[0] };
+
+        MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C,
+                                 element, &filetype);
+        MPI_Type_commit(&filetype);
+      }
+      else
+      {
+        filetype = element;
+      }
+
+      MPI_File_set_view(fh, (MPI_Offset)disp, element, filetype, "native",
+                        MPI_INFO_NULL);
+
+      if (write)
+      {
+        MPI_File_write_all(fh, buffer, count, element, &status);
+      }
+      else
+      {
+        MPI_File_read_all(fh, buffer, count, element, &status);
+      }
+
+      if (count > 0)
+      {
+        MPI_Type_free(&filetype);
+      }
+      MPI_Type_free(&element);
+    }
+#else
+    {
+      int j, k;
+      char *pos = buffer;
+
+      for (k = 0; k < nz; k++)
+      {
+        for (j = 0; j < ny; j++)
+        {
+          long long row = ((long long)(iz + k - box[2]) * box[4]
+                           + (iy + j - box[1])) * box[3] + (ix - box[0]);
+
+          fseek(fh, (long)(disp + 8 * row), SEEK_SET);
+          if (write)
+          {
+            fwrite(pos, 8, nx, fh);
+          }
+          else if (fread(pos, 8, nx, fh) != (size_t)nx)
+          {
+            amps_Printf("Error: checkpoint file is truncated\n");
+            exit(1);
+          }
+          pos += 8 * nx;
+        }
+      }
+    }
+#endif
+
+    if (!write && count > 0)
+    {
+      int nx_v, ny_v, nz_v;
+      int i, j, k, ai;
+      double *data;
+      char *pos = buffer;
+
+      subvector = VectorSubvector(v, g);
+
+      nx_v = SubvectorNX(subvector);
+      ny_v = SubvectorNY(subvector);
+      nz_v = SubvectorNZ(subvector);
+
+      data = SubvectorElt(subvector, ix, iy, iz);
+
+      ai = 0;
+      BoxLoopI1(i, j, k,
+                ix, iy, iz, nx, ny, nz,
+                ai, nx_v, ny_v, nz_v, 1, 1, 1,
+      {
+        pos = PFBUnpackDouble(pos, &data[ai]);
+      });
+    }
+
+    tfree(buffer);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * Open, close and header access for either I/O backend.
+ *--------------------------------------------------------------------------*/
+
+static CheckpointFile CheckpointOpen(char *filename, int write)
+{
+  CheckpointFile fh;
+
+#ifdef PARFLOW_HAVE_MPI
+  int mode = write ? (MPI_MODE_WRONLY | MPI_MODE_CREATE) : MPI_MODE_RDONLY;
+
+  if (MPI_File_open(amps_CommWorld, filename, mode, MPI_INFO_NULL, &fh)
+      != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't open checkpoint file %s\n", filename);
+    exit(1);
+  }
+
+  if (write)
+  {
+    MPI_File_set_size(fh, 0);
+  }
+#else
+  if ((fh = fopen(filename, write ? "wb" : "rb")) == NULL)
+  {
+    amps_Printf("Error: can't open checkpoint file %s\n", filename);
+    exit(1);
+  }
+#endif
+
+  return fh;
+}
+
+static void CheckpointClose(CheckpointFile fh)
+{
+#ifdef PARFLOW_HAVE_MPI
+  MPI_File_close(&fh);
+#else
+  fclose(fh);
+#endif
+}
+
+/* Only rank 0 writes the header */
+static void CheckpointWriteHeader(CheckpointFile fh, char *buffer, int size)
+{
+  if (amps_Rank(amps_CommWorld) == 0)
+  {
+#ifdef PARFLOW_HAVE_MPI
+    MPI_Status status;
+    MPI_File_write_at(fh, 0, buffer, size, MPI_BYTE, &status);
+#else
+    fseek(fh, 0, SEEK_SET);
+    fwrite(buffer, 1, size, fh);
+#endif
+  }
+}
+
+/* All ranks read the header */
+static void CheckpointReadHeader(CheckpointFile fh, long long offset,
+                                 char *buffer, int size, char *filename)
+{
+  int count;
+
+#ifdef PARFLOW_HAVE_MPI
+  MPI_Status status;
+
+  MPI_File_read_at_all(fh, (MPI_Offset)offset, buffer, size, MPI_BYTE,
+                       &status);
+  MPI_Get_count(&status, MPI_BYTE, &count);
+#else
+  fseek(fh, (long)offset, SEEK_SET);
+  count = (int)fread(buffer, 1, size, fh);
+#endif
+
+  if (count != size)
+  {
+    amps_Printf("Error: checkpoint file %s is truncated\n", filename);
+    exit(1);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * WriteCheckpoint
+ *
+ * Write the named scalars and vectors to filename.  Names longer than 31
+ * characters are truncated.  Collective.
+ *--------------------------------------------------------------------------*/
+
+void WriteCheckpoint(
+                     char *   filename,
+                     int      num_scalars,
+                     const char **scalar_names,
+                     double * scalars,
+                     int      num_vectors,
+                     const char **vector_names,
+                     Vector **vectors)
+{
+  char tmp_filename[2048];
+
+  int header_size = CHECKPOINT_PREAMBLE_SIZE
+                    + num_scalars * CHECKPOINT_SCALAR_SIZE
+                    + num_vectors * CHECKPOINT_VECTOR_SIZE;
+  char           *header;
+  char           *pos;
+  char name[CHECKPOINT_NAME_LEN];
+
+  int            *boxes;
+  int max_subgrids;
+  long long disp;
+  int m, d;
+
+  CheckpointFile fh;
+
+  /* Outputs up to this point should be on disk with the checkpoint */
+  PFBAsyncFlush();
+
+  boxes = talloc(int, 6 * pfmax(num_vectors, 1));
+  for (m = 0; m < num_vectors; m++)
+  {
+    CheckpointVectorBox(vectors[m], boxes + 6 * m);
+  }
+
+  max_subgrids = CheckpointMaxSubgrids(num_vectors, vectors);
+
+  sprintf(tmp_filename, "%s.tmp", filename);
+
+  fh = CheckpointOpen(tmp_filename, 1);
+
+  header = talloc(char, header_size);
+  memset(header, 0, header_size);
+
+  pos = header;
+  memcpy(pos, CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC));
+  pos += 8;
+  pos = PFBPackInt(pos, CHECKPOINT_VERSION);
+  pos = PFBPackInt(pos, num_scalars);
+  pos = PFBPackInt(pos, num_vectors);
+
+  for (m = 0; m < num_scalars; m++)
+  {
+    memset(name, 0, CHECKPOINT_NAME_LEN);
+    strncpy(name, scalar_names[m], CHECKPOINT_NAME_LEN - 1);
+    memcpy(pos, name, CHECKPOINT_NAME_LEN);
+    pos += CHECKPOINT_NAME_LEN;
+    pos = PFBPackDouble(pos, scalars[m]);
+  }
+
+  for (m = 0; m < num_vectors; m++)
+  {
+    memset(name, 0, CHECKPOINT_NAME_LEN);
+    strncpy(name, vector_names[m], CHECKPOINT_NAME_LEN - 1);
+    memcpy(pos, name, CHECKPOINT_NAME_LEN);
+    pos += CHECKPOINT_NAME_LEN;
+    for (d = 0; d < 6; d++)
+    {
+      pos = PFBPackInt(pos, boxes[6 * m + d]);
+    }
+  }
+
+  CheckpointWriteHeader(fh, header, header_size);
+  tfree(header);
+
+  disp = header_size;
+  for (m = 0; m < num_vectors; m++)
+  {
+    int *box = boxes + 6 * m;
+
+    CheckpointVectorIO(fh, disp, box, vectors[m], max_subgrids, 1);
+    disp += 8LL * box[3] * box[4] * box[5];
+  }
+
+  CheckpointClose(fh);
+
+  if (amps_Rank(amps_CommWorld) == 0)
+  {
+    if (rename(tmp_filename, filename) != 0)
+    {
+      amps_Printf("Error: can't rename %s to %s\n", tmp_filename, filename);
+      exit(1);
+    }
+  }
+
+  tfree(boxes);
+}
+
+/*--------------------------------------------------------------------------
+ * ReadCheckpoint
+ *
+ * Read the named scalars and vectors from filename, which may have been
+ * written with a different process topology.  Entries of the file that
+ * are not asked for are skipped; it is an error if an entry asked for is
+ * missing or a vector was written for a grid of a different size.  Ghost
+ * values are not updated.  Collective.
+ *--------------------------------------------------------------------------*/
+
+void ReadCheckpoint(
+                    char *   filename,
+                    int      num_scalars,
+                    const char **scalar_names,
+                    double * scalars,
+                    int      num_vectors,
+                    const char **vector_names,
+                    Vector **vectors)
+{
+  char preamble[CHECKPOINT_PREAMBLE_SIZE];
+  char           *header;
+  char           *pos;
+
+  int version;
+  int file_num_scalars;
+  int file_num_vectors;
+  int header_size;
+
+  char          (*file_names)[CHECKPOINT_NAME_LEN];
+  int            *file_boxes;
+  long long      *file_disps;
+  double         *file_scalars;
+
+  int box[6];
+  int max_subgrids;
+  int m, n, d;
+
+  CheckpointFile fh;
+
+  fh = CheckpointOpen(filename, 0);
+
+  CheckpointReadHeader(fh, 0, preamble, CHECKPOINT_PREAMBLE_SIZE, filename);
+
+  if (strncmp(preamble, CHECKPOINT_MAGIC, 8) != 0)
+  {
+    amps_Printf("Error: %s is not a ParFlow checkpoint file\n", filename);
+    exit(1);
+  }
+
+  pos = preamble + 8;
+  pos = PFBUnpackInt(pos, &version);
+  pos = PFBUnpackInt(pos, &file_num_scalars);
+  pos = PFBUnpackInt(pos, &file_num_vectors);
+
+  if (version != CHECKPOINT_VERSION)
+  {
+    amps_Printf("Error: checkpoint file %s has version %d, expected %d\n",
+                filename, version, CHECKPOINT_VERSION);
+    exit(1);
+  }
+
+  header_size = file_num_scalars * CHECKPOINT_SCALAR_SIZE
+                + file_num_vectors * CHECKPOINT_VECTOR_SIZE;
+
+  header = talloc(char, pfmax(header_size, 1));
+  CheckpointReadHeader(fh, CHECKPOINT_PREAMBLE_SIZE, header, header_size,
+                       filename);
+
+  n = pfmax(file_num_scalars + file_num_vectors, 1);
+  file_names = (char (*)[CHECKPOINT_NAME_LEN])talloc(char, n * CHECKPOINT_NAME_LEN);
+  file_scalars = talloc(double, n);
+  file_boxes = talloc(int, 6 * n);
+  file_disps = talloc(long long, n);
+
+  pos = header;
+  for (n = 0; n < file_num_scalars; n++)
+  {
+    memcpy(file_names[n], pos, CHECKPOINT_NAME_LEN);
+    file_names[n][CHECKPOINT_NAME_LEN - 1] = '\0';
+    pos += CHECKPOINT_NAME_LEN;
+    pos = PFBUnpackDouble(pos, &file_scalars[n]);
+  }
+
+  for (n = file_num_scalars; n < file_num_scalars + file_num_vectors; n++)
+  {
+    int *file_box = file_boxes + 6 * n;
+
+    memcpy(file_names[n], pos, CHECKPOINT_NAME_LEN);
+    file_names[n][CHECKPOINT_NAME_LEN - 1] = '\0';
+    pos += CHECKPOINT_NAME_LEN;
+    for (d = 0; d < 6; d++)
+    {
+      pos = PFBUnpackInt(pos, &file_box[d]);
+    }
+
+    if (n == file_num_scalars)
+    {
+      file_disps[n] = CHECKPOINT_PREAMBLE_SIZE + header_size;
+    }
+    else
+    {
+      int *prev_box = file_boxes + 6 * (n - 1);
+      file_disps[n] = file_disps[n - 1]
+                      + 8LL * prev_box[3] * prev_box[4] * prev_box[5];
+    }
+  }
+
+  tfree(header);
+
+  for (m = 0; m < num_scalars; m++)
+  {
+    for (n = 0; n < file_num_scalars; n++)
+    {
+      if (strncmp(file_names[n], scalar_names[m], CHECKPOINT_NAME_LEN - 1) == 0)
+        break;
+    }
+
+    if (n == file_num_scalars)
+    {
+      amps_Printf("Error: checkpoint file %s has no value <%s>\n",
+                  filename, scalar_names[m]);
+      exit(1);
+    }
+
+    scalars[m] = file_scalars[n];
+  }
+
+  max_subgrids = CheckpointMaxSubgrids(num_vectors, vectors);
+
+  for (m = 0; m < num_vectors; m++)
+  {
+    int *file_box;
+
+    for (n = file_num_scalars; n < file_num_scalars + file_num_vectors; n++)
+    {
+      if (strncmp(file_names[n], vector_names[m], CHECKPOINT_NAME_LEN - 1) == 0)
+        break;
+    }
+
+    if (n == file_num_scalars + file_num_vectors)
+    {
+      amps_Printf("Error: checkpoint file %s has no vector <%s>\n",
+                  filename, vector_names[m]);
+      exit(1);
+    }
+
+    file_box = file_boxes + 6 * n;
+    CheckpointVectorBox(vectors[m], box);
+
+    for (d = 0; d < 6; d++)
+    {
+      if (box[d] != file_box[d])
+      {
+        amps_Printf("Error: vector <%s> in checkpoint file %s was written for a different grid\n",
+                    vector_names[m], filename);
+        exit(1);
+      }
+    }
+
+    CheckpointVectorIO(fh, file_disps[n], box, vectors[m], max_subgrids, 0);
+  }
+
+  CheckpointClose(fh);
+
+  tfree(file_names);
+  tfree(file_scalars);
+  tfree(file_boxes);
+  tfree(file_disps);
+}
@@ -49,11 +49,6 @@
  * Sys, Man, and Cyber (21)5:1278-1286.
  */
 
-/**
- * Tag count.
- */
-static int tag_count;
-
 /**
  * Maximum number of ghost layers.
  *
@@ -85,6 +80,90 @@ typedef struct {
   int *histogram[DIM];
 } HistogramBox;
 
+/**
+ * Tags of the cells in the ghosted subgrid of this rank.
+ *
+ * The indicator vectors are only needed to exchange the tags in the
+ * ghost layers.  The clustering reads the tags many times so they are
+ * copied once into a dense byte array in i, j, k order.
+ */
+typedef struct {
+  Box box;
+  int nx;
+  int ny;
+  unsigned char *tags;
+} TagArray;
+
+/**
+ * Copy the tags in the ghosted subgrid of this rank out of the indicator vector.
+ */
+TagArray* NewTagArray(Vector *indicator)
+{
+  TagArray* tag_array = ctalloc(TagArray, 1);
+
+  Grid* grid = VectorGrid(indicator);
+  Subgrid* subgrid;
+  Subvector* v_sub = NULL;
+
+  int i_s;
+  int i, j, k;
+
+  BoxClear(&(tag_array->box));
+  tag_array->box.up[0] = -1;
+
+  ForSubgridI(i_s, GridSubgrids(grid))
+  {
+    subgrid = GridSubgrid(grid, i_s);
+
+    v_sub = VectorSubvector(indicator, i_s);
+
+    tag_array->box.lo[0] = SubgridIX(subgrid) - num_ghost;
+    tag_array->box.lo[1] = SubgridIY(subgrid) - num_ghost;
+    tag_array->box.lo[2] = SubgridIZ(subgrid) - num_ghost;
+
+    tag_array->box.up[0] = SubgridIX(subgrid) + SubgridNX(subgrid) - 1 + num_ghost;
+    tag_array->box.up[1] = SubgridIY(subgrid) + SubgridNY(subgrid) - 1 + num_ghost;
+    tag_array->box.up[2] = SubgridIZ(subgrid) + SubgridNZ(subgrid) - 1 + num_ghost;
+  }
+
+  tag_array->nx = tag_array->box.up[0] - tag_array->box.lo[0] + 1;
+  tag_array->ny = tag_array->box.up[1] - tag_array->box.lo[1] + 1;
+
+  if (v_sub && BoxSize(&(tag_array->box)) > 0)
+  {
+    unsigned char *tp;
+    double        *vp;
+
+    tag_array->tags = talloc(unsigned char, BoxSize(&(tag_array->box)));
+
+    tp = tag_array->tags;
+    for (k = tag_array->box.lo[2]; k <= tag_array->box.up[2]; k++)
+    {
+      for (j = tag_array->box.lo[1]; j <= tag_array->box.up[1]; j++)
+      {
+        vp = SubvectorElt(v_sub, tag_array->box.lo[0], j, k);
+        for (i = 0; i < tag_array->nx; i++)
+        {
+          DoubleTags v;
+          v.as_double = vp[i];
+          *tp++ = (unsigned char)v.as_tags;
+        }
+      }
+    }
+  }
+
+  return tag_array;
+}
+
+/**
+ * Free the tag array.
+ */
+void FreeTagArray(TagArray* tag_array)
+{
+  tfree(tag_array->tags);
+  tfree(tag_array);
+}
+
 /**
  * Get tags along the provided dimension for the global index along that dimension.
  */
@@ -112,12 +191,12 @@ HistogramBox* NewHistogramBox(Box *box)
 
   BoxCopy(&(histogram_box->box), box);
 
-  int size = BoxSize(&(histogram_box->box));
+  Point num_cells;
+  BoxNumberCells(&(histogram_box->box), &num_cells);
 
   for (int dim = 0; dim < DIM; dim++)
   {
-    histogram_box->histogram[dim] = talloc(int, size);
-    memset(histogram_box->histogram[dim], 0, size * sizeof(int));
+    histogram_box->histogram[dim] = ctalloc(int, num_cells[dim]);
   }
 
   return histogram_box;
@@ -143,13 +222,13 @@ void FreeHistogramBox(HistogramBox* histogram_box)
  */
 void ResetHistogram(HistogramBox *histogram_box)
 {
+  Point num_cells;
+
+  BoxNumberCells(&(histogram_box->box), &num_cells);
+
   for (int dim = 0; dim < DIM; dim++)
   {
-    int size = BoxSize(&(histogram_box->box));
-    for (int index = 0; index < size; index++)
-    {
-      histogram_box->histogram[dim][index] = 0;
-    }
+    memset(histogram_box->histogram[dim], 0, num_cells[dim] * sizeof(int));
   }
 }
 
@@ -229,125 +308,51 @@ void FindBoundBoxForTags(HistogramBox* histogram_box, Box* bound_box, Point min_
 }
 
 /**
- * Reduces tag counts along an axis.
+ * Compute Tag Histogram along all dimensions.
  *
- * Reduce (count) the number of cells that have the specified tag
- * along the provided dimension and store into the provided histogram
- * box.
+ * Counts the cells with the specified tag in each plane of the
+ * histogram box along each dimension in one pass over the box.
  */
-void ReduceTags(HistogramBox *histogram_box, Vector *vector, int dim, DoubleTags tag)
+int ComputeTagHistogram(HistogramBox *histogram_box, TagArray* tag_array, unsigned int tag)
 {
-  Box intersection;
-
-  BoxClear(&intersection);
-
-  BoxCopy(&intersection, &(histogram_box->box));
-
-  int ilo = intersection.lo[dim];
-  int ihi = intersection.up[dim];
+  Box *box = &(histogram_box->box);
+  int num_tags = 0;
+  Point lo, up;
 
+  ResetHistogram(histogram_box);
 
-  for (int ic_sb = ilo; ic_sb <= ihi; ic_sb++)
+  for (int dim = 0; dim < DIM; dim++)
   {
-    tag_count = 0;
-
-    Box src_box;
-    BoxClear(&src_box);
-
-    BoxCopy(&src_box, &intersection);
+    lo[dim] = pfmax(box->lo[dim], tag_array->box.lo[dim]);
+    up[dim] = pfmin(box->up[dim], tag_array->box.up[dim]);
+  }
 
-    src_box.lo[dim] = ic_sb;
-    src_box.up[dim] = ic_sb;
+  int *histogram_i = histogram_box->histogram[0];
+  int *histogram_j = histogram_box->histogram[1];
+  int *histogram_k = histogram_box->histogram[2];
 
+  for (int k = lo[2]; k <= up[2]; k++)
+  {
+    for (int j = lo[1]; j <= up[1]; j++)
     {
-      Grid* grid = VectorGrid(vector);
-      Subvector* v_sub;
-      double     *vp;
-
-      Subgrid* subgrid;
-
-      int ix, iy, iz;
-      int nx, ny, nz;
-      int nx_v, ny_v, nz_v;
-
-      int i_s;
-      int i, j, k, iv;
-
-      Box bounding_box;
-      BoxClear(&bounding_box);
-      //      Point lo, up;
+      unsigned char *tp = tag_array->tags
+                          + ((k - tag_array->box.lo[2]) * tag_array->ny
+                             + (j - tag_array->box.lo[1])) * tag_array->nx;
+      int row_tags = 0;
 
-      ForSubgridI(i_s, GridSubgrids(grid))
+      for (int i = lo[0]; i <= up[0]; i++)
       {
-        subgrid = GridSubgrid(grid, i_s);
-
-        v_sub = VectorSubvector(vector, i_s);
-
-        ix = SubgridIX(subgrid) - num_ghost;
-        iy = SubgridIY(subgrid) - num_ghost;
-        iz = SubgridIZ(subgrid) - num_ghost;
-
-        nx = SubgridNX(subgrid) + 2 * num_ghost;
-        ny = SubgridNY(subgrid) + 2 * num_ghost;
-        nz = SubgridNZ(subgrid) + 2 * num_ghost;
-
-        nx_v = SubvectorNX(v_sub);
-        ny_v = SubvectorNY(v_sub);
-        nz_v = SubvectorNZ(v_sub);
-
-        ix = pfmax(ix, src_box.lo[0]);
-        iy = pfmax(iy, src_box.lo[1]);
-        iz = pfmax(iz, src_box.lo[2]);
-
-        nx = pfmin(nx, src_box.up[0] - src_box.lo[0] + 1);
-        ny = pfmin(ny, src_box.up[1] - src_box.lo[1] + 1);
-        nz = pfmin(nz, src_box.up[2] - src_box.lo[2] + 1);
-        vp = SubvectorElt(v_sub, ix, iy, iz);
-
-        iv = 0;
-        BoxLoopI1(i, j, k, ix, iy, iz, nx, ny, nz,
-                  iv, nx_v, ny_v, nz_v, 1, 1, 1,
+        if (tp[i - tag_array->box.lo[0]] & tag)
         {
-          DoubleTags v;
-          v.as_double = vp[iv];
-
-          if (v.as_tags & tag.as_tags)
-          {
-            if (((src_box.lo[0] <= i) && (i <= src_box.up[0])) &&
-                ((src_box.lo[1] <= j) && (j <= src_box.up[1])) &&
-                ((src_box.lo[2] <= k) && (k <= src_box.up[2])))
-            {
-              PlusEquals(tag_count, 1);
-            }
-          }
-        });
+          histogram_i[i - box->lo[0]]++;
+          row_tags++;
+        }
       }
-      HistogramBoxAddTags(histogram_box, dim, ic_sb, tag_count);
-    }
-  }
-}
-
-/**
- * Compute Tag Histogram along all dimensions.
- */
-int ComputeTagHistogram(HistogramBox *histogram_box, Vector* vector, DoubleTags tag)
-{
-  int num_tags = 0;
-  Point num_cells;
-
-  ResetHistogram(histogram_box);
-
-  for (int dim = 0; dim < DIM; dim++)
-  {
-    ReduceTags(histogram_box, vector, dim, tag);
-  }
 
-  BoxNumberCells(&(histogram_box->box), &num_cells);
-
-  int dim = 0;
-  for (int index = 0; index < num_cells[dim]; index++)
-  {
-    num_tags += (histogram_box->histogram)[dim][index];
+      histogram_j[j - box->lo[1]] += row_tags;
+      histogram_k[k - box->lo[2]] += row_tags;
+      num_tags += row_tags;
+    }
   }
 
   return(num_tags);
@@ -579,15 +584,15 @@ int SplitTagBoundBox(Box*          box_lft,
  * specified tag value.
  *
  */
-void FindBoxesContainingTags(BoxList*   boxes,
-                             Vector*    vector,
-                             Box*       bound_box,
-                             Point      min_box,
-                             DoubleTags tag)
+void FindBoxesContainingTags(BoxList*     boxes,
+                             TagArray*    tag_array,
+                             Box*         bound_box,
+                             Point        min_box,
+                             unsigned int tag)
 {
   HistogramBox* hist_box = NewHistogramBox(bound_box);
 
-  int num_tags = ComputeTagHistogram(hist_box, vector, tag);
+  int num_tags = ComputeTagHistogram(hist_box, tag_array, tag);
 
   if (num_tags == 0)
   {
@@ -623,11 +628,11 @@ void FindBoxesContainingTags(BoxList*   boxes,
         BoxList* box_list_rgt = NewBoxList();
 
         FindBoxesContainingTags(box_list_lft,
-                                vector,
+                                tag_array,
                                 &box_lft, min_box,
                                 tag);
         FindBoxesContainingTags(box_list_rgt,
-                                vector,
+                                tag_array,
                                 &box_rgt, min_box,
                                 tag);
 
@@ -658,6 +663,7 @@ void FindBoxesContainingTags(BoxList*   boxes,
   FreeHistogramBox(hist_box);
 }
 
+
 /**
  * Compute boxes that cover cells with the provided tag.
  *
@@ -665,142 +671,203 @@ void FindBoxesContainingTags(BoxList*   boxes,
  * specified tag value.
  *
  */
-void BergerRigoutsos(Vector*    vector,
-                     Point      min_box,
-                     DoubleTags tag,
-                     BoxList*   boxes)
+void BergerRigoutsos(TagArray*    tag_array,
+                     Point        min_box,
+                     unsigned int tag,
+                     BoxList*     boxes)
 {
-  Grid* grid = VectorGrid(vector);
-  Subgrid* subgrid;
+  if (BoxSize(&(tag_array->box)) > 0)
+  {
+    FindBoxesContainingTags(boxes, tag_array, &(tag_array->box), min_box, tag);
+  }
+}
 
-  int ix, iy, iz;
-  int nx, ny, nz;
+/**
+ * Compare boxes by their extent in the dimensions other than dim and
+ * then by their lower index along dim.
+ */
+int CompareBoxesAlong(const Box* box_a, const Box* box_b, int dim)
+{
+  for (int offset = 1; offset <= DIM; offset++)
+  {
+    int other = (dim + offset) % DIM;
 
-  int i_s;
+    if (box_a->lo[other] != box_b->lo[other])
+    {
+      return (box_a->lo[other] < box_b->lo[other]) ? -1 : 1;
+    }
 
-  Box bounding_box;
+    if (other != dim && box_a->up[other] != box_b->up[other])
+    {
+      return (box_a->up[other] < box_b->up[other]) ? -1 : 1;
+    }
+  }
 
-  BoxClear(&bounding_box);
+  return 0;
+}
 
-  Point lo, up;
+int CompareBoxesAlongX(const void* box_a, const void* box_b)
+{
+  return CompareBoxesAlong((const Box*)box_a, (const Box*)box_b, 0);
+}
 
-  ForSubgridI(i_s, GridSubgrids(grid))
+int CompareBoxesAlongY(const void* box_a, const void* box_b)
+{
+  return CompareBoxesAlong((const Box*)box_a, (const Box*)box_b, 1);
+}
+
+int CompareBoxesAlongZ(const void* box_a, const void* box_b)
+{
+  return CompareBoxesAlong((const Box*)box_a, (const Box*)box_b, 2);
+}
+
+/**
+ * Merge boxes that together form a larger box.
+ *
+ * Cuts at an inflection point of the histogram often separate cells
+ * that a single box could cover.  Boxes with the same extent in two
+ * dimensions that touch in the third are joined until no more can be.
+ * The covering stays exact; only the number of boxes to loop over
+ * drops.
+ */
+void MergeBoxes(BoxList* boxes)
+{
+  int (*const compare[DIM])(const void*, const void*) =
   {
-    subgrid = GridSubgrid(grid, i_s);
+    CompareBoxesAlongX, CompareBoxesAlongY, CompareBoxesAlongZ
+  };
 
-    ix = SubgridIX(subgrid) - num_ghost;
-    iy = SubgridIY(subgrid) - num_ghost;
-    iz = SubgridIZ(subgrid) - num_ghost;
+  int num_boxes = BoxListSize(boxes);
 
-    nx = SubgridNX(subgrid) + 2 * num_ghost;
-    ny = SubgridNY(subgrid) + 2 * num_ghost;
-    nz = SubgridNZ(subgrid) + 2 * num_ghost;
+  if (num_boxes < 2)
+  {
+    return;
+  }
 
-    lo[0] = ix;
-    lo[1] = iy;
-    lo[2] = iz;
+  Box* box_array = talloc(Box, num_boxes);
 
-    up[0] = ix + nx - 1;
-    up[1] = iy + ny - 1;
-    up[2] = iz + nz - 1;
+  int index = 0;
+  for (BoxListElement* element = boxes->head; element; element = element->next)
+  {
+    BoxCopy(&(box_array[index++]), &(element->box));
   }
 
-  BoxSet(&bounding_box, lo, up);
+  /*
+   * Sorting along a dimension puts boxes that can be merged along it
+   * next to each other.  Cycle through the dimensions until a full
+   * round merges nothing.
+   */
+  int dim = 0;
+  int unchanged = 0;
+  while (unchanged < DIM)
+  {
+    qsort(box_array, num_boxes, sizeof(Box), compare[dim]);
 
-  HistogramBox* histogram_box = NewHistogramBox(&bounding_box);
+    int num_merged = 0;
+    for (index = 1; index < num_boxes; index++)
+    {
+      Box* last = &(box_array[num_merged]);
+      Box* next = &(box_array[index]);
+      int other_a = (dim + 1) % DIM;
+      int other_b = (dim + 2) % DIM;
+
+      if ((last->up[dim] + 1 == next->lo[dim]) &&
+          (last->lo[other_a] == next->lo[other_a]) &&
+          (last->up[other_a] == next->up[other_a]) &&
+          (last->lo[other_b] == next->lo[other_b]) &&
+          (last->up[other_b] == next->up[other_b]))
+      {
+        last->up[dim] = next->up[dim];
+      }
+      else
+      {
+        num_merged++;
+        BoxCopy(&(box_array[num_merged]), next);
+      }
+    }
+    num_merged++;
 
-  int num_tags = ComputeTagHistogram(histogram_box, vector, tag);
+    unchanged = (num_merged < num_boxes) ? 0 : unchanged + 1;
+    num_boxes = num_merged;
+    dim = (dim + 1) % DIM;
+  }
 
-  if (num_tags == 0)
+  BoxListClearItems(boxes);
+  for (index = 0; index < num_boxes; index++)
   {
-    BoxListClearItems(boxes);
+    BoxListAppend(boxes, &(box_array[index]));
   }
-  else
-  {
-    Box tag_bound_box;
-    BoxClear(&tag_bound_box);
 
-    FindBoundBoxForTags(histogram_box, &tag_bound_box, min_box);
+  tfree(box_array);
+}
 
-    int num_cells = BoxSize(&tag_bound_box);
+/**
+ * Compute the box array that exactly covers the cells with the provided tag.
+ */
+BoxArray* ComputeTagBoxes(TagArray* tag_array, unsigned int tag)
+{
+  Point min_box;
 
-    if (num_tags < num_cells)
-    {
-      Box box_lft;
-      Box box_rgt;
+  min_box[0] = 1;
+  min_box[1] = 1;
+  min_box[2] = 1;
 
-      BoxClear(&box_lft);
-      BoxClear(&box_rgt);
+  BoxList* boxes = NewBoxList();
 
-      int is_split = SplitTagBoundBox(&box_lft, &box_rgt, &tag_bound_box,
-                                      histogram_box, min_box);
+  BergerRigoutsos(tag_array,
+                  min_box,
+                  tag,
+                  boxes);
 
-      if (is_split)
-      {
-        /*
-         * The bounding box "tag_bound_box" has been split into two
-         * boxes, "box_lft" and "box_rgt".  Now, attempt to recursively
-         * split these boxes further.
-         */
-        BoxList* box_list_lft = NewBoxList();
-        BoxList* box_list_rgt = NewBoxList();
+  MergeBoxes(boxes);
 
-        FindBoxesContainingTags(box_list_lft,
-                                vector,
-                                &box_lft, min_box,
-                                tag);
-        FindBoxesContainingTags(box_list_rgt,
-                                vector,
-                                &box_rgt, min_box,
-                                tag);
+  BoxArray* box_array = NewBoxArray(boxes);
 
-        if (((BoxListSize(box_list_lft) > 1) ||
-             (BoxListSize(box_list_rgt) > 1)) ||
-            ((double)(BoxSize(BoxListFront(box_list_lft))
-                      + BoxSize(BoxListFront(box_list_rgt)))
-             < ((double)BoxSize(&tag_bound_box))))
-        {
-          BoxListConcatenate(boxes, box_list_lft);
-          BoxListConcatenate(boxes, box_list_rgt);
-        }
+  FreeBoxList(boxes);
 
-        FreeBoxList(box_list_lft);
-        FreeBoxList(box_list_rgt);
-      }
-    }
+  return box_array;
+}
 
-    /*
-     * If no good splitting is found, add bounding box to list.
-     */
-    if (BoxListIsEmpty(boxes))
+/**
+ * Apply the Clustering.MaxBoxes limit to the box arrays of one loop.
+ *
+ * A loop uses the boxes of all of its face directions or none of them,
+ * so if any of the arrays has more boxes than the limit all of them are
+ * dropped and the loop traverses the octree instead.
+ */
+void LimitBoxes(BoxArray** box_arrays, int num_box_arrays)
+{
+  int max_boxes = GlobalsClusteringMaxBoxes;
+  int exceeded = FALSE;
+
+  for (int n = 0; n < num_box_arrays; n++)
+  {
+    if (max_boxes > 0 && (int)BoxArraySize(box_arrays[n]) > max_boxes)
     {
-      BoxListAppend(boxes, &tag_bound_box);
+      exceeded = TRUE;
     }
   }
 
-  FreeHistogramBox(histogram_box);
+  if (exceeded)
+  {
+    for (int n = 0; n < num_box_arrays; n++)
+    {
+      FreeBoxArray(box_arrays[n]);
+      box_arrays[n] = NULL;
+    }
+  }
 }
 
-
 /**
- * Compute the patch loop iteration boxes.
+ * Tag the patch loop cells.
  *
- * Compute the patch loop iteration boxes for the specified patch.  Patches
- * are looped over in each face direction so a box array is generated for
- * each face direction.
- *
- * The computed box arrays are stored in the geom_solid.
+ * Patches are looped over in each face direction so each cell is
+ * tagged with one bit per face direction it is visited for.
  */
-void ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
+TagArray* ComputePatchTags(GrGeomSolid *geom_solid, int patch, Vector *indicator)
 {
-  Grid *grid = CreateGrid(GlobalsUserGrid);
-
-  Vector* indicator = NewVectorType(grid, 1, num_ghost, vector_cell_centered);
-
   InitVectorAll(indicator, 0.0);
 
-  DoubleTags tag;
-
   {
     Grid        *grid = VectorGrid(indicator);
     Subgrid     *subgrid;
@@ -813,8 +880,6 @@ void ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
 
     double *dp;
 
-    tag_count = 0;
-
     ForSubgridI(is, GridSubgrids(grid))
     {
       subgrid = GridSubgrid(grid, is);
@@ -845,8 +910,6 @@ void ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
         v.as_double = dp[ip];
         v.as_tags = v.as_tags | this_face_tag;
         dp[ip] = v.as_double;
-
-        PlusEquals(tag_count, 1);
       });
     }
   }
@@ -857,50 +920,19 @@ void ComputePatchBoxes(GrGeomSolid *geom_solid, int patch)
     FinalizeVectorUpdate(handle);
   }
 
-  Point min_box;
-  min_box[0] = 1;
-  min_box[1] = 1;
-  min_box[2] = 1;
-
-  for (int face = 0; face < GrGeomOctreeNumFaces; face++)
-  {
-    BoxList* boxes = NewBoxList();
-
-    tag.as_tags = 1 << face;
-
-    BergerRigoutsos(indicator,
-                    min_box,
-                    tag,
-                    boxes);
-
-    GrGeomSolidPatchBoxes(geom_solid, patch, face) = NewBoxArray(boxes);
-
-    FreeBoxList(boxes);
-  }
-
-  FreeVector(indicator);
-  FreeGrid(grid);
+  return NewTagArray(indicator);
 }
 
 /**
- * Compute the surface loop iteration boxes.
+ * Tag the surface loop cells.
  *
- * Compute the surface loop iteration boxes.  Surface loops are looped
- * over in each face direction so a box array is generated for each
- * face direction.
- *
- * The computed box arrays are stored in the geom_solid.
+ * Surface loops are looped over in each face direction so each cell
+ * is tagged with one bit per face direction it is visited for.
  */
-void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
+TagArray* ComputeSurfaceTags(GrGeomSolid *geom_solid, Vector *indicator)
 {
-  Grid *grid = CreateGrid(GlobalsUserGrid);
-
-  Vector* indicator = NewVectorType(grid, 1, num_ghost, vector_cell_centered);
-
   InitVectorAll(indicator, 0.0);
 
-  DoubleTags tag;
-
   {
     Grid        *grid = VectorGrid(indicator);
     Subgrid     *subgrid;
@@ -913,8 +945,6 @@ void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
 
     double *dp;
 
-    tag_count = 0;
-
     ForSubgridI(is, GridSubgrids(grid))
     {
       subgrid = GridSubgrid(grid, is);
@@ -944,8 +974,6 @@ void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
         v.as_double = dp[ip];
         v.as_tags = v.as_tags | this_face_tag;
         dp[ip] = v.as_double;
-
-        PlusEquals(tag_count, 1);
       });
     }
   }
@@ -956,48 +984,18 @@ void ComputeSurfaceBoxes(GrGeomSolid *geom_solid)
     FinalizeVectorUpdate(handle);
   }
 
-  Point min_box;
-  min_box[0] = 1;
-  min_box[1] = 1;
-  min_box[2] = 1;
-
-  for (int face = 0; face < GrGeomOctreeNumFaces; face++)
-  {
-    BoxList* boxes = NewBoxList();
-
-    tag.as_tags = 1 << face;
-
-    BergerRigoutsos(indicator,
-                    min_box,
-                    tag,
-                    boxes);
-
-    GrGeomSolidSurfaceBoxes(geom_solid, face) = NewBoxArray(boxes);
-
-    FreeBoxList(boxes);
-  }
-
-  FreeVector(indicator);
-  FreeGrid(grid);
+  return NewTagArray(indicator);
 }
 
 /**
- * Compute the interior loop iteration boxes.
- *
- * Compute the interior loop iteration boxes.  Boxes will exactly cover
- * all of interior of geom_solid in index space.
- *
- * The computed box array is stored in the geom_solid.
+ * Tag the interior loop cells.
  */
-void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
+TagArray* ComputeInteriorTags(GrGeomSolid *geom_solid, Vector *indicator)
 {
   DoubleTags tag;
 
   tag.as_tags = 1;
 
-  Grid *grid = CreateGrid(GlobalsUserGrid);
-
-  Vector* indicator = NewVectorType(grid, 1, num_ghost, vector_cell_centered);
   InitVectorAll(indicator, 0.0);
 
   {
@@ -1012,8 +1010,6 @@ void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
 
     double *dp;
 
-    tag_count = 0;
-
     ForSubgridI(is, GridSubgrids(grid))
     {
       subgrid = GridSubgrid(grid, is);
@@ -1038,7 +1034,6 @@ void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
         int ip = SubvectorEltIndex(d_sub, i, j, k);
 
         dp[ip] = tag.as_double;
-        PlusEquals(tag_count, 1);
       });
     }
   }
@@ -1049,37 +1044,87 @@ void ComputeInteriorBoxes(GrGeomSolid *geom_solid)
     FinalizeVectorUpdate(handle);
   }
 
-  Point min_box;
-  min_box[0] = 1;
-  min_box[1] = 1;
-  min_box[2] = 1;
+  return NewTagArray(indicator);
+}
 
-  BoxList* boxes = NewBoxList();
+void ComputeBoxes(GrGeomSolid *geom_solid)
+{
+  int num_patches = GrGeomSolidNumPatches(geom_solid);
 
-  BergerRigoutsos(indicator,
-                  min_box,
-                  tag,
-                  boxes);
+  /* The interior, the surface and each patch have their own tags */
+  int num_tag_arrays = 2 + num_patches;
 
-  GrGeomSolidInteriorBoxes(geom_solid) = NewBoxArray(boxes);
+  /* One box array for the interior and one per face for the others */
+  int num_box_arrays = 1 + GrGeomOctreeNumFaces * (1 + num_patches);
+
+  BeginTiming(ClusteringTimingIndex);
+
+  Grid *grid = CreateGrid(GlobalsUserGrid);
+
+  Vector* indicator = NewVectorType(grid, 1, num_ghost, vector_cell_centered);
+
+  TagArray** tag_arrays = ctalloc(TagArray*, num_tag_arrays);
+
+  tag_arrays[0] = ComputeInteriorTags(geom_solid, indicator);
+
+  tag_arrays[1] = ComputeSurfaceTags(geom_solid, indicator);
+
+  for (int patch = 0; patch < num_patches; patch++)
+  {
+    tag_arrays[2 + patch] = ComputePatchTags(geom_solid, patch, indicator);
+  }
 
-  FreeBoxList(boxes);
   FreeVector(indicator);
   FreeGrid(grid);
-}
 
-void ComputeBoxes(GrGeomSolid *geom_solid)
-{
-  BeginTiming(ClusteringTimingIndex);
+  /*
+   * With the tags exchanged the box arrays are independent of each
+   * other so they are clustered concurrently.
+   */
+  BoxArray** box_arrays = ctalloc(BoxArray*, num_box_arrays);
 
-  ComputeInteriorBoxes(geom_solid);
+#ifdef PARFLOW_HAVE_OMP
+  #pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (int n = 0; n < num_box_arrays; n++)
+  {
+    if (n == 0)
+    {
+      box_arrays[n] = ComputeTagBoxes(tag_arrays[0], 1);
+    }
+    else
+    {
+      int face = (n - 1) % GrGeomOctreeNumFaces;
+      box_arrays[n] = ComputeTagBoxes(tag_arrays[1 + (n - 1) / GrGeomOctreeNumFaces],
+                                      1 << face);
+    }
+  }
 
-  ComputeSurfaceBoxes(geom_solid);
+  LimitBoxes(box_arrays, 1);
+  for (int n = 1; n < num_box_arrays; n += GrGeomOctreeNumFaces)
+  {
+    LimitBoxes(box_arrays + n, GrGeomOctreeNumFaces);
+  }
+
+  GrGeomSolidInteriorBoxes(geom_solid) = box_arrays[0];
+
+  for (int face = 0; face < GrGeomOctreeNumFaces; face++)
+  {
+    GrGeomSolidSurfaceBoxes(geom_solid, face) = box_arrays[1 + face];
+
+    for (int patch = 0; patch < num_patches; patch++)
+    {
+      GrGeomSolidPatchBoxes(geom_solid, patch, face) =
+        box_arrays[1 + GrGeomOctreeNumFaces * (1 + patch) + face];
+    }
+  }
 
-  for (int patch = 0; patch < GrGeomSolidNumPatches(geom_solid); patch++)
+  for (int n = 0; n < num_tag_arrays; n++)
   {
-    ComputePatchBoxes(geom_solid, patch);
+    FreeTagArray(tag_arrays[n]);
   }
+  tfree(tag_arrays);
+  tfree(box_arrays);
 
   EndTiming(ClusteringTimingIndex);
 }
@@ -44,6 +44,502 @@
 
 #define pqr_to_nxyz(pqr, mxyz, lxyz)  (pqr < lxyz ? mxyz + 1 : mxyz)
 
+#define weight_index(i, j, k, nx, ny)  ((((k) * (ny)) + (j)) * (nx) + (i))
+
+/*--------------------------------------------------------------------------
+ * Status of the weighted decomposition computed on the root process
+ *--------------------------------------------------------------------------*/
+
+#define DECOMPOSITION_OK          0
+#define DECOMPOSITION_BAD_FILE    1
+#define DECOMPOSITION_BAD_WEIGHT  2
+#define DECOMPOSITION_TOO_SMALL   3
+
+/*--------------------------------------------------------------------------
+ * ReadDecompositionWeights:
+ *   Read the per cell weights of the weighted decomposition from a PFB
+ *   file with the dimensions of the user grid.  Mask weights count the
+ *   cells with a positive value, cost weights are used as given and
+ *   must not be negative.  Only called on the root process.
+ *--------------------------------------------------------------------------*/
+
+static int   ReadDecompositionWeights(
+                                      char *  filename,
+                                      int     method,
+                                      int     nx,
+                                      int     ny,
+                                      int     nz,
+                                      double *weights)
+{
+  amps_File file;
+
+  double X, Y, Z, DX, DY, DZ;
+  int NX, NY, NZ;
+  int num_subgrids;
+
+  int ix, iy, iz, snx, sny, snz, rx, ry, rz;
+  int is, j, k, index;
+
+
+  if ((file = amps_SFopen(filename, "rb")) == NULL)
+  {
+    InputError("Error: can't open decomposition file %s%s\n", filename, "");
+  }
+
+  amps_ReadDouble(file, &X, 1);
+  amps_ReadDouble(file, &Y, 1);
+  amps_ReadDouble(file, &Z, 1);
+
+  amps_ReadInt(file, &NX, 1);
+  amps_ReadInt(file, &NY, 1);
+  amps_ReadInt(file, &NZ, 1);
+
+  amps_ReadDouble(file, &DX, 1);
+  amps_ReadDouble(file, &DY, 1);
+  amps_ReadDouble(file, &DZ, 1);
+
+  amps_ReadInt(file, &num_subgrids, 1);
+
+  if ((NX != nx) || (NY != ny) || (NZ != nz))
+  {
+    amps_SFclose(file);
+    return DECOMPOSITION_BAD_FILE;
+  }
+
+  for (is = 0; is < num_subgrids; is++)
+  {
+    amps_ReadInt(file, &ix, 1);
+    amps_ReadInt(file, &iy, 1);
+    amps_ReadInt(file, &iz, 1);
+
+    amps_ReadInt(file, &snx, 1);
+    amps_ReadInt(file, &sny, 1);
+    amps_ReadInt(file, &snz, 1);
+
+    amps_ReadInt(file, &rx, 1);
+    amps_ReadInt(file, &ry, 1);
+    amps_ReadInt(file, &rz, 1);
+
+    if ((ix < 0) || (iy < 0) || (iz < 0) ||
+        (ix + snx > nx) || (iy + sny > ny) || (iz + snz > nz))
+    {
+      amps_SFclose(file);
+      return DECOMPOSITION_BAD_FILE;
+    }
+
+    for (k = iz; k < iz + snz; k++)
+    {
+      for (j = iy; j < iy + sny; j++)
+      {
+        amps_ReadDouble(file, &weights[weight_index(ix, j, k, nx, ny)], snx);
+      }
+    }
+  }
+
+  amps_SFclose(file);
+
+  for (index = 0; index < nx * ny * nz; index++)
+  {
+    if (method == DECOMPOSITION_MASK)
+    {
+      weights[index] = (weights[index] > 0.0) ? 1.0 : 0.0;
+    }
+    else if (weights[index] < 0.0)
+    {
+      return DECOMPOSITION_BAD_WEIGHT;
+    }
+  }
+
+  return DECOMPOSITION_OK;
+}
+
+/*--------------------------------------------------------------------------
+ * BisectWeights:
+ *   Orthogonal recursive bisection of the box [lo, hi) of the weights
+ *   into num_parts boxes, cutting only along the dimensions first_dim
+ *   to last_dim.  The box is cut along its longest such dimension where
+ *   possible.  The cut minimizes the larger of the weights per process
+ *   of the two halves, ties going to the cut closest to an even split of
+ *   the cells.  Each half keeps at least as many cells in the cut
+ *   dimensions as it has processes.  The boxes are appended to boxes as
+ *   (ix, iy, iz, nx, ny, nz).  Returns 0 if the box is too small.
+ *--------------------------------------------------------------------------*/
+
+static int   BisectWeights(
+                           double *weights,
+                           int     nx,
+                           int     ny,
+                           int     lo[3],
+                           int     hi[3],
+                           int     num_parts,
+                           int     first_dim,
+                           int     last_dim,
+                           int *   boxes,
+                           int *   num_boxes)
+{
+  int n_lo, n_hi;
+  int lo_hi[3], hi_lo[3];
+  int dims[2], num_dims;
+  int area, length, cut;
+  int c, c_min, c_max, c_even;
+  int best_cut, best_dist;
+  int i, j, k, d, n;
+
+  double *slices;
+  double total, best_cost, cost;
+
+
+  if (num_parts == 1)
+  {
+    int *box = boxes + 6 * (*num_boxes);
+
+    for (d = 0; d < 3; d++)
+    {
+      box[d] = lo[d];
+      box[3 + d] = hi[d] - lo[d];
+    }
+    (*num_boxes)++;
+
+    return 1;
+  }
+
+  n_lo = num_parts / 2;
+  n_hi = num_parts - n_lo;
+
+  /* Try the longest dimension first */
+  num_dims = 0;
+  dims[num_dims++] = first_dim;
+  if (last_dim > first_dim)
+  {
+    if (hi[last_dim] - lo[last_dim] > hi[first_dim] - lo[first_dim])
+    {
+      dims[0] = last_dim;
+      dims[num_dims++] = first_dim;
+    }
+    else
+    {
+      dims[num_dims++] = last_dim;
+    }
+  }
+
+  for (n = 0; n < num_dims; n++)
+  {
+    d = dims[n];
+    length = hi[d] - lo[d];
+
+    area = 1;
+    for (i = first_dim; i <= last_dim; i++)
+    {
+      if (i != d)
+      {
+        area *= hi[i] - lo[i];
+      }
+    }
+
+    c_min = (n_lo + area - 1) / area;
+    c_max = length - (n_hi + area - 1) / area;
+    if (c_min > c_max)
+    {
+      continue;
+    }
+
+    /* Sum the weights of the slices along the cut dimension */
+    slices = ctalloc(double, length);
+    for (k = lo[2]; k < hi[2]; k++)
+    {
+      for (j = lo[1]; j < hi[1]; j++)
+      {
+        for (i = lo[0]; i < hi[0]; i++)
+        {
+          c = (d == 0) ? i - lo[0] : ((d == 1) ? j - lo[1] : k - lo[2]);
+          slices[c] += weights[weight_index(i, j, k, nx, ny)];
+        }
+      }
+    }
+
+    total = 0.0;
+    for (c = 0; c < length; c++)
+    {
+      total += slices[c];
+    }
+
+    c_even = (length * n_lo + num_parts / 2) / num_parts;
+
+    best_cut = -1;
+    best_cost = 0.0;
+    best_dist = 0;
+    cost = 0.0;
+    for (c = 0; c < c_max; c++)
+    {
+      cost += slices[c];
+      if (c + 1 >= c_min)
+      {
+        double lo_cost = cost / n_lo;
+        double hi_cost = (total - cost) / n_hi;
+        double max_cost = pfmax(lo_cost, hi_cost);
+        int dist = abs(c + 1 - c_even);
+
+        if ((best_cut < 0) || (max_cost < best_cost) ||
+            ((max_cost == best_cost) && (dist < best_dist)))
+        {
+          best_cut = c + 1;
+          best_cost = max_cost;
+          best_dist = dist;
+        }
+      }
+    }
+
+    tfree(slices);
+
+    cut = lo[d] + best_cut;
+
+    for (i = 0; i < 3; i++)
+    {
+      lo_hi[i] = hi[i];
+      hi_lo[i] = lo[i];
+    }
+    lo_hi[d] = cut;
+    hi_lo[d] = cut;
+
+    return BisectWeights(weights, nx, ny, lo, lo_hi, n_lo,
+                         first_dim, last_dim, boxes, num_boxes) &&
+           BisectWeights(weights, nx, ny, hi_lo, hi, n_hi,
+                         first_dim, last_dim, boxes, num_boxes);
+  }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------
+ * ComputeWeightedDecomposition:
+ *   Cut the user grid into num_columns * num_layers boxes that balance
+ *   the weights.  The x-y columns are bisected first using the weights
+ *   summed over z; each column is then split into num_layers layers.
+ *   Box (column c, layer l) is assigned to process
+ *   pqr_to_process(c, 0, l, num_columns, 1, num_layers).  Only called on
+ *   the root process.
+ *--------------------------------------------------------------------------*/
+
+static int   ComputeWeightedDecomposition(
+                                          int     method,
+                                          char *  filename,
+                                          int     nx,
+                                          int     ny,
+                                          int     nz,
+                                          int     num_columns,
+                                          int     num_layers,
+                                          int *   boxes,
+                                          double *imbalance)
+{
+  double *weights, *column_weights;
+  double total, max_weight;
+
+  int *columns, *layers;
+  int lo[3], hi[3];
+  int status, num_boxes;
+  int c, l, i, j, k, process;
+
+
+  weights = ctalloc(double, nx * ny * nz);
+
+  status = ReadDecompositionWeights(filename, method, nx, ny, nz, weights);
+
+  if (status == DECOMPOSITION_OK)
+  {
+    column_weights = ctalloc(double, nx * ny);
+    for (k = 0; k < nz; k++)
+    {
+      for (j = 0; j < ny; j++)
+      {
+        for (i = 0; i < nx; i++)
+        {
+          column_weights[weight_index(i, j, 0, nx, ny)] +=
+            weights[weight_index(i, j, k, nx, ny)];
+        }
+      }
+    }
+
+    columns = ctalloc(int, 6 * num_columns);
+    layers = ctalloc(int, 6 * num_layers);
+
+    lo[0] = lo[1] = lo[2] = 0;
+    hi[0] = nx;
+    hi[1] = ny;
+    hi[2] = 1;
+
+    num_boxes = 0;
+    if (!BisectWeights(column_weights, nx, ny, lo, hi, num_columns, 0, 1,
+                       columns, &num_boxes))
+    {
+      status = DECOMPOSITION_TOO_SMALL;
+    }
+
+    total = 0.0;
+    max_weight = 0.0;
+    for (c = 0; (c < num_columns) && (status == DECOMPOSITION_OK); c++)
+    {
+      for (i = 0; i < 2; i++)
+      {
+        lo[i] = columns[6 * c + i];
+        hi[i] = columns[6 * c + i] + columns[6 * c + 3 + i];
+      }
+      lo[2] = 0;
+      hi[2] = nz;
+
+      num_boxes = 0;
+      if (!BisectWeights(weights, nx, ny, lo, hi, num_layers, 2, 2,
+                         layers, &num_boxes))
+      {
+        status = DECOMPOSITION_TOO_SMALL;
+        break;
+      }
+
+      for (l = 0; l < num_layers; l++)
+      {
+        double weight = 0.0;
+
+        process = pqr_to_process(c, 0, l, num_columns, 1, num_layers);
+        memcpy(boxes + 6 * process, layers + 6 * l, 6 * sizeof(int));
+
+        for (k = layers[6 * l + 2]; k < layers[6 * l + 2] + layers[6 * l + 5]; k++)
+        {
+          for (j = layers[6 * l + 1]; j < layers[6 * l + 1] + layers[6 * l + 4]; j++)
+          {
+            for (i = layers[6 * l]; i < layers[6 * l] + layers[6 * l + 3]; i++)
+            {
+              weight += weights[weight_index(i, j, k, nx, ny)];
+            }
+          }
+        }
+
+        total += weight;
+        max_weight = pfmax(max_weight, weight);
+      }
+    }
+
+    /* Largest weight on a process relative to the average */
+    *imbalance = (total > 0.0) ?
+                 max_weight * (num_columns * num_layers) / total : 1.0;
+
+    tfree(layers);
+    tfree(columns);
+    tfree(column_weights);
+  }
+
+  tfree(weights);
+
+  return status;
+}
+
+/*--------------------------------------------------------------------------
+ * DistributeWeightedUserGrid:
+ *   Distribute the user grid with one box per process so that the
+ *   weights read from the decomposition file are balanced.  The grid is
+ *   cut into P * Q columns of R layers each.  The root process computes
+ *   the boxes and broadcasts them.  Returns NULL if the process count
+ *   doesn't match the topology.
+ *--------------------------------------------------------------------------*/
+
+static SubgridArray  *DistributeWeightedUserGrid(
+                                                 Subgrid *user_subgrid)
+{
+  SubgridArray  *all_subgrids;
+
+  amps_Invoice invoice;
+
+  double imbalance = 1.0;
+
+  int num_procs, num_columns, num_layers;
+  int status = DECOMPOSITION_OK;
+  int *boxes;
+  int rank, process;
+
+
+  num_procs = GlobalsNumProcs;
+  num_columns = GlobalsNumProcsX * GlobalsNumProcsY;
+  num_layers = GlobalsNumProcsZ;
+
+  if ((num_columns < 1) || (num_layers < 1) ||
+      (num_columns * num_layers != num_procs))
+  {
+    return NULL;
+  }
+
+  boxes = ctalloc(int, 6 * num_procs);
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    status = ComputeWeightedDecomposition(GlobalsDecompositionMethod,
+                                          GlobalsDecompositionFileName,
+                                          SubgridNX(user_subgrid),
+                                          SubgridNY(user_subgrid),
+                                          SubgridNZ(user_subgrid),
+                                          num_columns, num_layers,
+                                          boxes, &imbalance);
+  }
+
+  invoice = amps_NewInvoice("%i%d%*i", &status, &imbalance, 6 * num_procs, boxes);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+
+  switch (status)
+  {
+    case DECOMPOSITION_BAD_FILE:
+      InputError("Error: invalid value <%s> for key <%s>, the file does not match the computational grid\n",
+                 GlobalsDecompositionFileName, "Process.Decomposition.FileName");
+      break;
+
+    case DECOMPOSITION_BAD_WEIGHT:
+      InputError("Error: invalid value <%s> for key <%s>, cost weights can't be negative\n",
+                 GlobalsDecompositionFileName, "Process.Decomposition.FileName");
+      break;
+
+    case DECOMPOSITION_TOO_SMALL:
+      InputError("Error: can't decompose the computational grid into one box per process%s%s\n",
+                 "", "");
+      break;
+  }
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    amps_Printf("Using weighted decomposition (%d columns, %d layers), load imbalance %g\n",
+                num_columns, num_layers, imbalance);
+  }
+
+  /*-----------------------------------------------------------------------
+   * The boxes form a num_columns x 1 x num_layers process grid, so column
+   * based algorithms using GlobalsP, GlobalsQ and GlobalsR still work.
+   *-----------------------------------------------------------------------*/
+
+  GlobalsNumProcsX = num_columns;
+  GlobalsNumProcsY = 1;
+  GlobalsNumProcsZ = num_layers;
+
+  rank = amps_Rank(amps_CommWorld);
+  GlobalsP = rank % num_columns;
+  GlobalsQ = 0;
+  GlobalsR = rank / num_columns;
+
+  all_subgrids = NewSubgridArray();
+
+  for (process = 0; process < num_procs; process++)
+  {
+    int *box = boxes + 6 * process;
+
+    AppendSubgrid(NewSubgrid(SubgridIX(user_subgrid) + box[0],
+                             SubgridIY(user_subgrid) + box[1],
+                             SubgridIZ(user_subgrid) + box[2],
+                             box[3], box[4], box[5],
+                             0, 0, 0,
+                             process),
+                  all_subgrids);
+  }
+
+  tfree(boxes);
+
+  return all_subgrids;
+}
+
 /*--------------------------------------------------------------------------
  * DistributeUserGrid:
  *   We currently assume that the user's grid consists of 1 subgrid only.
@@ -113,6 +609,31 @@ SubgridArray   *DistributeUserGrid(
       AppendSubgrid(new_subgrid, all_subgrids);
     }
   }
+  else if (GlobalsDecompositionMethod != DECOMPOSITION_REGULAR)
+  {
+    /*-----------------------------------------------------------------------
+     * Weighted decomposition, computed on the first call since the grid
+     * is created several times
+     *-----------------------------------------------------------------------*/
+
+    if (!GlobalsDecomposition)
+    {
+      if (!(GlobalsDecomposition = DistributeWeightedUserGrid(user_subgrid)))
+      {
+        FreeGrid(process_grid);
+        return NULL;
+      }
+    }
+
+    all_subgrids = NewSubgridArray();
+
+    int i;
+    ForSubgridI(i, GlobalsDecomposition)
+    {
+      AppendSubgrid(DuplicateSubgrid(SubgridArraySubgrid(GlobalsDecomposition, i)),
+                    all_subgrids);
+    }
+  }
   else
   {
     /*-----------------------------------------------------------------------
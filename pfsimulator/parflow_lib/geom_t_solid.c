@@ -41,19 +41,29 @@
 
 GeomTSolid  *GeomNewTSolid(
                            GeomTIN *surface,
-                           int **   patches, /* arrays of surface triangle indices */
+                           int *    patch_triangles, /* surface triangle indices of all patches */
                            int      num_patches,
                            int *    num_patch_triangles)
 {
   GeomTSolid   *new_geomtsolid;
 
+  int p, offset;
+
 
   new_geomtsolid = talloc(GeomTSolid, 1);
 
   (new_geomtsolid->surface) = surface;
-  (new_geomtsolid->patches) = patches;
+  (new_geomtsolid->patches) = talloc(int *, num_patches);
   (new_geomtsolid->num_patches) = num_patches;
   (new_geomtsolid->num_patch_triangles) = num_patch_triangles;
+  (new_geomtsolid->patch_triangles) = patch_triangles;
+
+  offset = 0;
+  for (p = 0; p < num_patches; p++)
+  {
+    (new_geomtsolid->patches[p]) = patch_triangles + offset;
+    offset += num_patch_triangles[p];
+  }
 
   return new_geomtsolid;
 }
@@ -66,12 +76,8 @@ GeomTSolid  *GeomNewTSolid(
 void         GeomFreeTSolid(
                             GeomTSolid *solid)
 {
-  int p;
-
-
   GeomFreeTIN(solid->surface);
-  for (p = 0; p < (solid->num_patches); p++)
-    tfree(solid->patches[p]);
+  tfree(solid->patch_triangles);
   tfree(solid->patches);
   tfree(solid->num_patch_triangles);
 
@@ -80,22 +86,22 @@ void         GeomFreeTSolid(
 
 
 /*--------------------------------------------------------------------------
- * GeomReadTSolids
+ * GeomReadTSolidsASCII
+ *   Reads a `.pfsol' file.
  *--------------------------------------------------------------------------*/
 
-int            GeomReadTSolids(
-                               GeomTSolid ***solids_data_ptr,
-                               char *        geom_input_name)
+static int     GeomReadTSolidsASCII(
+                                    GeomTSolid ***solids_data_ptr,
+                                    char *        solids_filename)
 {
   GeomTSolid      **solids_data = NULL;
 
   GeomTIN          *surface;
-  GeomVertex      **vertices;
   GeomVertexArray  *vertex_array;
-  GeomTriangle    **triangles;
+  double           *x, *y, *z;
+  int              *triangles;
 
   double *invoiceDBuffer;
-  int *invoiceIBuffer;
 
   int nC, nS, nT, nV;
   int Csize, CsizeR, count;
@@ -103,25 +109,21 @@ int            GeomReadTSolids(
   int             **patches;
   int num_patches;
   int              *num_patch_triangles;
+  int              *patch_triangles;
+  int total_patch_triangles;
 
-  int c, s, t, v, p;
+  int c, s, v, p;
 
-  char              *solids_filename;
   amps_File solids_file;
   int version_number;
 
   amps_Invoice invoice;
 
-  char key[IDB_MAX_KEY_LEN];
-
 
   /*------------------------------------------------------
-   * Read the solids file name and open the file
+   * Open the file
    *------------------------------------------------------*/
 
-  sprintf(key, "GeomInput.%s.FileName", geom_input_name);
-  solids_filename = GetString(key);
-
   if ((solids_file = amps_SFopen(solids_filename, "r")) == NULL)
   {
     InputError("Error: can't open solids file %s%s\n", solids_filename,
@@ -153,7 +155,9 @@ int            GeomReadTSolids(
   amps_SFBCast(amps_CommWorld, solids_file, invoice);
   amps_FreeInvoice(invoice);
 
-  vertices = ctalloc(GeomVertex *, nV);
+  x = talloc(double, nV);
+  y = talloc(double, nV);
+  z = talloc(double, nV);
 
 
   /* Read in all the vertices */
@@ -183,17 +187,16 @@ int            GeomReadTSolids(
     /* FG: copy invoiceBuffer to original data structure*/
     for (v = 0; v < Csize; v++)
     {
-      vertices[count] = ctalloc(GeomVertex, 1);
-      GeomVertexX(vertices[count]) = invoiceDBuffer[3 * v];
-      GeomVertexY(vertices[count]) = invoiceDBuffer[3 * v + 1];
-      GeomVertexZ(vertices[count]) = invoiceDBuffer[3 * v + 2];
+      x[count] = invoiceDBuffer[3 * v];
+      y[count] = invoiceDBuffer[3 * v + 1];
+      z[count] = invoiceDBuffer[3 * v + 2];
       count++;
     }
 
     tfree(invoiceDBuffer);
   }
 
-  vertex_array = GeomNewVertexArray(vertices, nV);
+  vertex_array = GeomNewVertexArray(x, y, z, nV);
 
   /* Input the number of solids */
   invoice = amps_NewInvoice("%i", &nS);
@@ -210,12 +213,11 @@ int            GeomReadTSolids(
     amps_SFBCast(amps_CommWorld, solids_file, invoice);
     amps_FreeInvoice(invoice);
 
-    triangles = ctalloc(GeomTriangle *, nT);
+    triangles = talloc(int, 3 * nT);
 
 
     /* Read in the triangles */
-    /* FG: For performance reasons we load multiple values at once.
-     * This needs extra memory (per default about 240kb with Csize = 10000). If this imposes problems you can reduce the Csize*/
+    /* FG: For performance reasons we load multiple values at once. */
     /* FG: Calculate number of chunks */
     Csize = 10000;
     nC = nT / Csize;
@@ -231,22 +233,10 @@ int            GeomReadTSolids(
       /* FG: if last iteration and not evenly divisible*/
       if ((c == nC - 1) && (CsizeR))
         Csize = CsizeR;
-      invoiceIBuffer = ctalloc(int, 3 * Csize);
-      invoice = amps_NewInvoice("%*i", 3 * Csize, invoiceIBuffer);
+      invoice = amps_NewInvoice("%*i", 3 * Csize, triangles + 3 * count);
       amps_SFBCast(amps_CommWorld, solids_file, invoice);
       amps_FreeInvoice(invoice);
-
-      /* FG: copy invoiceBuffer to original data structure*/
-      for (t = 0; t < Csize; t++)
-      {
-        triangles[count] = ctalloc(GeomTriangle, 1);
-        GeomTriangleV0(triangles[count]) = invoiceIBuffer[3 * t];
-        GeomTriangleV1(triangles[count]) = invoiceIBuffer[3 * t + 1];
-        GeomTriangleV2(triangles[count]) = invoiceIBuffer[3 * t + 2];
-        count++;
-      }
-
-      tfree(invoiceIBuffer);
+      count += Csize;
     }
 
     surface = GeomNewTIN(vertex_array, triangles, nT);
@@ -259,6 +249,7 @@ int            GeomReadTSolids(
     patches = ctalloc(int *, num_patches);
     num_patch_triangles = ctalloc(int, num_patches);
 
+    total_patch_triangles = 0;
     for (p = 0; p < num_patches; p++)
     {
       /* Input the number of patches */
@@ -268,28 +259,306 @@ int            GeomReadTSolids(
 
       patches[p] = talloc(int, num_patch_triangles[p]);
 
-      /* Read in the triangle indices */
-//       for (t = 0; t < num_patch_triangles[p]; t++)
-//       {
       /* FG: send all patch_triangles at once*/
       invoice = amps_NewInvoice("%*i", num_patch_triangles[p], patches[p]);
       amps_SFBCast(amps_CommWorld, solids_file, invoice);
       amps_FreeInvoice(invoice);
-//       }
+
+      total_patch_triangles += num_patch_triangles[p];
+    }
+
+    /* Store the patches contiguously */
+    patch_triangles = talloc(int, total_patch_triangles);
+    count = 0;
+    for (p = 0; p < num_patches; p++)
+    {
+      if (num_patch_triangles[p] > 0)
+      {
+        memcpy(patch_triangles + count, patches[p],
+               num_patch_triangles[p] * sizeof(int));
+      }
+      count += num_patch_triangles[p];
+      tfree(patches[p]);
     }
+    tfree(patches);
 
     solids_data[s] =
-      GeomNewTSolid(surface, patches, num_patches, num_patch_triangles);
+      GeomNewTSolid(surface, patch_triangles, num_patches, num_patch_triangles);
+  }
+
+  amps_SFclose(solids_file);
+
+  *solids_data_ptr = solids_data;
+
+  return(nS);
+}
+
+
+/*--------------------------------------------------------------------------
+ * GeomReadTSolidsBinary
+ *   Reads a `.pfsolb' file.  The layout is that of the `.pfsol' file with
+ *   each value stored in big-endian binary (see pfsolidfmtconvert).  The
+ *   file is read by one process and the arrays of all the solids are
+ *   then broadcast together.
+ *--------------------------------------------------------------------------*/
+
+static int     GeomReadTSolidsBinary(
+                                     GeomTSolid ***solids_data_ptr,
+                                     char *        solids_filename)
+{
+  GeomTSolid      **solids_data = NULL;
+
+  GeomTIN          *surface;
+  GeomVertexArray  *vertex_array;
+  double           *x, *y, *z;
+  int              *triangles;
+
+  int              *num_patch_triangles;
+  int              *patch_triangles;
+
+  /* Flattened file contents */
+  double           *vertices = NULL;
+  int              *solid_sizes = NULL;   /* nT, num_patches, num patch triangles */
+  int              *all_triangles = NULL;
+  int              *all_num_patch_triangles = NULL;
+  int              *all_patch_triangles = NULL;
+  int header[6];
+
+  int nS, nT, nV, num_patches;
+  int triangle_offset, patch_offset, patch_triangle_offset;
+  int s, v, p;
+
+  amps_File solids_file;
+  amps_Invoice invoice;
+
+
+  /*------------------------------------------------------
+   * Read the file on the root process.  The header holds
+   * the version, the number of vertices and solids and the
+   * lengths of the triangle and patch arrays.
+   *------------------------------------------------------*/
+
+  if ((solids_file = amps_SFopen(solids_filename, "rb")) == NULL)
+  {
+    InputError("Error: can't open solids file %s%s\n", solids_filename,
+               "");
+  }
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    int **solid_triangles, **solid_num_patch_triangles, **solid_patch_triangles;
+
+    amps_ReadInt(solids_file, &header[0], 1);
+    if (header[0] == PFSOL_GEOM_T_SOLID_VERSION)
+    {
+      amps_ReadInt(solids_file, &nV, 1);
+      vertices = talloc(double, 3 * nV);
+      amps_ReadDouble(solids_file, vertices, 3 * nV);
+
+      amps_ReadInt(solids_file, &nS, 1);
+      solid_sizes = ctalloc(int, 3 * nS);
+      solid_triangles = ctalloc(int *, nS);
+      solid_num_patch_triangles = ctalloc(int *, nS);
+      solid_patch_triangles = ctalloc(int *, nS);
+
+      header[3] = header[4] = header[5] = 0;
+      for (s = 0; s < nS; s++)
+      {
+        amps_ReadInt(solids_file, &nT, 1);
+        solid_triangles[s] = talloc(int, 3 * nT);
+        amps_ReadInt(solids_file, solid_triangles[s], 3 * nT);
+
+        amps_ReadInt(solids_file, &num_patches, 1);
+        solid_num_patch_triangles[s] = talloc(int, num_patches);
+
+        solid_sizes[3 * s] = nT;
+        solid_sizes[3 * s + 1] = num_patches;
+        for (p = 0; p < num_patches; p++)
+        {
+          int *tmp_patch_triangles = solid_patch_triangles[s];
+          int num = solid_sizes[3 * s + 2];
+
+          amps_ReadInt(solids_file, &solid_num_patch_triangles[s][p], 1);
+
+          solid_patch_triangles[s] =
+            talloc(int, num + solid_num_patch_triangles[s][p]);
+          if (num > 0)
+          {
+            memcpy(solid_patch_triangles[s], tmp_patch_triangles, num * sizeof(int));
+          }
+          tfree(tmp_patch_triangles);
+
+          amps_ReadInt(solids_file, solid_patch_triangles[s] + num,
+                       solid_num_patch_triangles[s][p]);
+          solid_sizes[3 * s + 2] += solid_num_patch_triangles[s][p];
+        }
+
+        header[3] += 3 * nT;
+        header[4] += num_patches;
+        header[5] += solid_sizes[3 * s + 2];
+      }
+
+      /* Pack the solids into single arrays for the broadcast */
+      all_triangles = talloc(int, header[3]);
+      all_num_patch_triangles = talloc(int, header[4]);
+      all_patch_triangles = talloc(int, header[5]);
+
+      triangle_offset = patch_offset = patch_triangle_offset = 0;
+      for (s = 0; s < nS; s++)
+      {
+        memcpy(all_triangles + triangle_offset, solid_triangles[s],
+               3 * solid_sizes[3 * s] * sizeof(int));
+        memcpy(all_num_patch_triangles + patch_offset, solid_num_patch_triangles[s],
+               solid_sizes[3 * s + 1] * sizeof(int));
+        if (solid_sizes[3 * s + 2] > 0)
+        {
+          memcpy(all_patch_triangles + patch_triangle_offset, solid_patch_triangles[s],
+                 solid_sizes[3 * s + 2] * sizeof(int));
+        }
+        triangle_offset += 3 * solid_sizes[3 * s];
+        patch_offset += solid_sizes[3 * s + 1];
+        patch_triangle_offset += solid_sizes[3 * s + 2];
+
+        tfree(solid_triangles[s]);
+        tfree(solid_num_patch_triangles[s]);
+        tfree(solid_patch_triangles[s]);
+      }
+      tfree(solid_triangles);
+      tfree(solid_num_patch_triangles);
+      tfree(solid_patch_triangles);
+
+      header[1] = nV;
+      header[2] = nS;
+    }
   }
 
   amps_SFclose(solids_file);
 
+  invoice = amps_NewInvoice("%*i", 6, header);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+
+  if (header[0] != PFSOL_GEOM_T_SOLID_VERSION)
+  {
+    if (!amps_Rank(amps_CommWorld))
+      amps_Printf("Error: need input file version %d\n",
+                  PFSOL_GEOM_T_SOLID_VERSION);
+    exit(1);
+  }
+
+  nV = header[1];
+  nS = header[2];
+
+  if (amps_Rank(amps_CommWorld))
+  {
+    vertices = talloc(double, 3 * nV);
+    solid_sizes = talloc(int, 3 * nS);
+    all_triangles = talloc(int, header[3]);
+    all_num_patch_triangles = talloc(int, header[4]);
+    all_patch_triangles = talloc(int, header[5]);
+  }
+
+  invoice = amps_NewInvoice("%*d%*i%*i%*i%*i",
+                            3 * nV, vertices,
+                            3 * nS, solid_sizes,
+                            header[3], all_triangles,
+                            header[4], all_num_patch_triangles,
+                            header[5], all_patch_triangles);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+
+  /*------------------------------------------------------
+   * Set up the solids
+   *------------------------------------------------------*/
+
+  x = talloc(double, nV);
+  y = talloc(double, nV);
+  z = talloc(double, nV);
+  for (v = 0; v < nV; v++)
+  {
+    x[v] = vertices[3 * v];
+    y[v] = vertices[3 * v + 1];
+    z[v] = vertices[3 * v + 2];
+  }
+
+  vertex_array = GeomNewVertexArray(x, y, z, nV);
+
+  solids_data = ctalloc(GeomTSolid *, nS);
+
+  triangle_offset = patch_offset = patch_triangle_offset = 0;
+  for (s = 0; s < nS; s++)
+  {
+    nT = solid_sizes[3 * s];
+    num_patches = solid_sizes[3 * s + 1];
+
+    triangles = talloc(int, 3 * nT);
+    memcpy(triangles, all_triangles + triangle_offset, 3 * nT * sizeof(int));
+
+    num_patch_triangles = talloc(int, num_patches);
+    memcpy(num_patch_triangles, all_num_patch_triangles + patch_offset,
+           num_patches * sizeof(int));
+
+    patch_triangles = talloc(int, solid_sizes[3 * s + 2]);
+    if (solid_sizes[3 * s + 2] > 0)
+    {
+      memcpy(patch_triangles, all_patch_triangles + patch_triangle_offset,
+             solid_sizes[3 * s + 2] * sizeof(int));
+    }
+
+    triangle_offset += 3 * nT;
+    patch_offset += num_patches;
+    patch_triangle_offset += solid_sizes[3 * s + 2];
+
+    surface = GeomNewTIN(vertex_array, triangles, nT);
+
+    solids_data[s] =
+      GeomNewTSolid(surface, patch_triangles, num_patches, num_patch_triangles);
+  }
+
+  tfree(vertices);
+  tfree(solid_sizes);
+  tfree(all_triangles);
+  tfree(all_num_patch_triangles);
+  tfree(all_patch_triangles);
+
   *solids_data_ptr = solids_data;
 
   return(nS);
 }
 
 
+/*--------------------------------------------------------------------------
+ * GeomReadTSolids
+ *--------------------------------------------------------------------------*/
+
+int            GeomReadTSolids(
+                               GeomTSolid ***solids_data_ptr,
+                               char *        geom_input_name)
+{
+  char              *solids_filename;
+  char              *extension;
+
+  char key[IDB_MAX_KEY_LEN];
+
+
+  /*------------------------------------------------------
+   * Read the solids file name; binary files are
+   * recognized by the `.pfsolb' extension
+   *------------------------------------------------------*/
+
+  sprintf(key, "GeomInput.%s.FileName", geom_input_name);
+  solids_filename = GetString(key);
+
+  extension = strrchr(solids_filename, '.');
+  if (extension && (strcmp(extension, ".pfsolb") == 0))
+  {
+    return GeomReadTSolidsBinary(solids_data_ptr, solids_filename);
+  }
+
+  return GeomReadTSolidsASCII(solids_data_ptr, solids_filename);
+}
+
+
 /*--------------------------------------------------------------------------
  * GeomTSolidFromBox
  *--------------------------------------------------------------------------*/
@@ -305,149 +574,71 @@ GeomTSolid  *GeomTSolidFromBox(
   GeomTSolid       *solid_data;
 
   GeomTIN          *surface;
-  GeomVertex      **vertices;
   GeomVertexArray  *vertex_array;
-  GeomTriangle    **triangles;
+  double           *x, *y, *z;
+  int              *triangles;
 
-  int             **patches;
   int num_patches;
   int              *num_patch_triangles;
+  int              *patch_triangles;
 
   int i, j, k, v, p;
 
+  /* Vertex triples of the two triangles on each face: x lower, x upper,
+   * y lower, y upper, z lower and z upper */
+  static const int box_triangles[36] =
+  {
+    2, 0, 4, 4, 6, 2,
+    1, 3, 7, 7, 5, 1,
+    0, 1, 5, 5, 4, 0,
+    3, 2, 6, 6, 7, 3,
+    2, 3, 1, 1, 0, 2,
+    4, 5, 7, 7, 6, 4
+  };
+
 
   /*------------------------------------------------------
    * Set up vertex_array
    *------------------------------------------------------*/
 
-  vertices = ctalloc(GeomVertex *, 8);
+  x = talloc(double, 8);
+  y = talloc(double, 8);
+  z = talloc(double, 8);
 
   v = 0;
   for (k = 0; k < 2; k++)
     for (j = 0; j < 2; j++)
       for (i = 0; i < 2; i++)
       {
-        vertices[v] = ctalloc(GeomVertex, 1);
-
-        switch (i)
-        {
-          case 0:
-            GeomVertexX(vertices[v]) = xl;
-            break;
-
-          case 1:
-            GeomVertexX(vertices[v]) = xu;
-            break;
-        }
-
-        switch (j)
-        {
-          case 0:
-            GeomVertexY(vertices[v]) = yl;
-            break;
-
-          case 1:
-            GeomVertexY(vertices[v]) = yu;
-            break;
-        }
-
-        switch (k)
-        {
-          case 0:
-            GeomVertexZ(vertices[v]) = zl;
-            break;
-
-          case 1:
-            GeomVertexZ(vertices[v]) = zu;
-            break;
-        }
+        x[v] = (i == 0) ? xl : xu;
+        y[v] = (j == 0) ? yl : yu;
+        z[v] = (k == 0) ? zl : zu;
 
         v++;
       }
 
-  vertex_array = GeomNewVertexArray(vertices, 8);
+  vertex_array = GeomNewVertexArray(x, y, z, 8);
 
   /*------------------------------------------------------
    * Set up triangles
    *------------------------------------------------------*/
 
-  triangles = ctalloc(GeomTriangle *, 12);
-
-  /* x lower face */
-  triangles[0] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[0]) = 2;
-  GeomTriangleV1(triangles[0]) = 0;
-  GeomTriangleV2(triangles[0]) = 4;
-  triangles[1] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[1]) = 4;
-  GeomTriangleV1(triangles[1]) = 6;
-  GeomTriangleV2(triangles[1]) = 2;
-
-  /* x upper face */
-  triangles[2] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[2]) = 1;
-  GeomTriangleV1(triangles[2]) = 3;
-  GeomTriangleV2(triangles[2]) = 7;
-  triangles[3] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[3]) = 7;
-  GeomTriangleV1(triangles[3]) = 5;
-  GeomTriangleV2(triangles[3]) = 1;
-
-  /* y lower face */
-  triangles[4] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[4]) = 0;
-  GeomTriangleV1(triangles[4]) = 1;
-  GeomTriangleV2(triangles[4]) = 5;
-  triangles[5] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[5]) = 5;
-  GeomTriangleV1(triangles[5]) = 4;
-  GeomTriangleV2(triangles[5]) = 0;
-
-  /* y upper face */
-  triangles[6] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[6]) = 3;
-  GeomTriangleV1(triangles[6]) = 2;
-  GeomTriangleV2(triangles[6]) = 6;
-  triangles[7] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[7]) = 6;
-  GeomTriangleV1(triangles[7]) = 7;
-  GeomTriangleV2(triangles[7]) = 3;
-
-  /* z lower face */
-  triangles[8] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[8]) = 2;
-  GeomTriangleV1(triangles[8]) = 3;
-  GeomTriangleV2(triangles[8]) = 1;
-  triangles[9] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[9]) = 1;
-  GeomTriangleV1(triangles[9]) = 0;
-  GeomTriangleV2(triangles[9]) = 2;
-
-  /* z upper face */
-  triangles[10] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[10]) = 4;
-  GeomTriangleV1(triangles[10]) = 5;
-  GeomTriangleV2(triangles[10]) = 7;
-  triangles[11] = ctalloc(GeomTriangle, 1);
-  GeomTriangleV0(triangles[11]) = 7;
-  GeomTriangleV1(triangles[11]) = 6;
-  GeomTriangleV2(triangles[11]) = 4;
-
+  triangles = talloc(int, 36);
+  memcpy(triangles, box_triangles, 36 * sizeof(int));
 
   /*------------------------------------------------------
    * Set up patches
    *------------------------------------------------------*/
 
   num_patches = 6;
-  patches = ctalloc(int *, num_patches);
   num_patch_triangles = ctalloc(int, num_patches);
+  patch_triangles = talloc(int, 2 * num_patches);
   for (p = 0; p < num_patches; p++)
   {
     num_patch_triangles[p] = 2;
-    patches[p] = talloc(int, 2);
 
-    patches[p][0] = 2 * p;
-    patches[p][1] = 2 * p + 1;
+    patch_triangles[2 * p] = 2 * p;
+    patch_triangles[2 * p + 1] = 2 * p + 1;
   }
 
   /*------------------------------------------------------
@@ -457,8 +648,7 @@ GeomTSolid  *GeomTSolidFromBox(
   surface = GeomNewTIN(vertex_array, triangles, 12);
 
   solid_data =
-    GeomNewTSolid(surface, patches, num_patches, num_patch_triangles);
+    GeomNewTSolid(surface, patch_triangles, num_patches, num_patch_triangles);
 
   return solid_data;
 }
-
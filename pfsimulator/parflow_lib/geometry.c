@@ -40,15 +40,19 @@
  *--------------------------------------------------------------------------*/
 
 GeomVertexArray  *GeomNewVertexArray(
-                                     GeomVertex **vertices,
-                                     int          nV)
+                                     double *x,
+                                     double *y,
+                                     double *z,
+                                     int     nV)
 {
   GeomVertexArray   *new_geom_vertex_array;
 
 
   new_geom_vertex_array = talloc(GeomVertexArray, 1);
 
-  (new_geom_vertex_array->vertices) = vertices;
+  (new_geom_vertex_array->x) = x;
+  (new_geom_vertex_array->y) = y;
+  (new_geom_vertex_array->z) = z;
   (new_geom_vertex_array->nV) = nV;
   (new_geom_vertex_array->num_ptrs_to) = 0;
 
@@ -63,17 +67,14 @@ GeomVertexArray  *GeomNewVertexArray(
 void              GeomFreeVertexArray(
                                       GeomVertexArray *vertex_array)
 {
-  int v;
-
-
   (vertex_array->num_ptrs_to)--;
 
   /* only free up the structure when there are no pointers to it */
   if ((vertex_array->num_ptrs_to) <= 0)
   {
-    for (v = 0; v < (vertex_array->nV); v++)
-      tfree((vertex_array->vertices)[v]);
-    tfree(vertex_array->vertices);
+    tfree(vertex_array->x);
+    tfree(vertex_array->y);
+    tfree(vertex_array->z);
     tfree(vertex_array);
   }
 }
@@ -85,7 +86,7 @@ void              GeomFreeVertexArray(
 
 GeomTIN          *GeomNewTIN(
                              GeomVertexArray *vertex_array,
-                             GeomTriangle **  triangles,
+                             int *            triangles,
                              int              nT)
 {
   GeomTIN   *new_geom_tin;
@@ -108,12 +109,7 @@ GeomTIN          *GeomNewTIN(
 
 void      GeomFreeTIN(GeomTIN *surface)
 {
-  int t;
-
-
   GeomFreeVertexArray(surface->vertex_array);
-  for (t = 0; t < GeomTINNumTriangles(surface); t++)
-    tfree(GeomTINTriangle(surface, t));
   tfree(surface->triangles);
   tfree(surface);
 }
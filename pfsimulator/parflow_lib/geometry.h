@@ -38,23 +38,17 @@
  * Miscellaneous structures:
  *--------------------------------------------------------------------------*/
 
+/* Vertex coordinates are stored in separate contiguous arrays */
 typedef struct {
-  double x, y, z;
-} GeomVertex;
-
-typedef struct {
-  int v0, v1, v2;
-} GeomTriangle;
-
-typedef struct {
-  GeomVertex **vertices;
+  double *x, *y, *z;
   int nV;
   int num_ptrs_to;            /* Number of pointers to this structure. */
 } GeomVertexArray;
 
+/* Triangles are stored as consecutive triples of vertex indices */
 typedef struct {
   GeomVertexArray  *vertex_array;
-  GeomTriangle    **triangles;
+  int              *triangles;
   int nT;
 } GeomTIN;
 
@@ -71,6 +65,7 @@ typedef struct {
   int     **patches;               /* arrays of surface triangle indices */
   int num_patches;
   int      *num_patch_triangles;
+  int      *patch_triangles;       /* storage for all of the patches */
 } GeomTSolid;
 
 typedef struct {
@@ -85,20 +80,14 @@ typedef struct {
  * Accessor macros:
  *--------------------------------------------------------------------------*/
 
-#define GeomVertexX(vertex)       ((vertex)->x)
-#define GeomVertexY(vertex)       ((vertex)->y)
-#define GeomVertexZ(vertex)       ((vertex)->z)
-
-#define GeomTriangleV0(triangle)  ((triangle)->v0)
-#define GeomTriangleV1(triangle)  ((triangle)->v1)
-#define GeomTriangleV2(triangle)  ((triangle)->v2)
-
-#define GeomTINVertices(TIN)      ((TIN)->vertex_array->vertices)
 #define GeomTINNumVertices(TIN)   ((TIN)->vertex_array->nV)
-#define GeomTINTriangles(TIN)     ((TIN)->triangles)
 #define GeomTINNumTriangles(TIN)  ((TIN)->nT)
-#define GeomTINVertex(TIN, i)     (GeomTINVertices(TIN)[i])
-#define GeomTINTriangle(TIN, i)   (GeomTINTriangles(TIN)[i])
+#define GeomTINVertexX(TIN, i)    ((TIN)->vertex_array->x[i])
+#define GeomTINVertexY(TIN, i)    ((TIN)->vertex_array->y[i])
+#define GeomTINVertexZ(TIN, i)    ((TIN)->vertex_array->z[i])
+#define GeomTINTriangleV0(TIN, t) ((TIN)->triangles[3 * (t)])
+#define GeomTINTriangleV1(TIN, t) ((TIN)->triangles[3 * (t) + 1])
+#define GeomTINTriangleV2(TIN, t) ((TIN)->triangles[3 * (t) + 2])
 
 #define GeomSolidData(solid)      ((solid)->data)
 #define GeomSolidType(solid)      ((solid)->type)
@@ -79,6 +79,17 @@ void   NewGlobals(char *run_name)
   globals_ptr->repeat_counts = 0;
 
   globals_ptr->use_clustering = 0;
+  globals_ptr->clustering_max_boxes = 0;
+
+  globals_ptr->geom_cache_directory = NULL;
+
+  globals_ptr->decomposition_method = DECOMPOSITION_REGULAR;
+  globals_ptr->decomposition_file_name = NULL;
+  globals_ptr->decomposition = NULL;
+
+  globals_ptr->pfb_io_method = PFB_IO_SERIAL;
+  globals_ptr->pfb_write_dist = 1;
+  globals_ptr->pfb_async_queue_depth = 2;
 }
 
 
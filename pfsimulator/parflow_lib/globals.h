@@ -87,6 +87,19 @@ typedef struct _Globals {
   Grid     *grid2d;
 
   int use_clustering;
+  int clustering_max_boxes;   /* 0 if the number of boxes is not limited */
+
+  char *geom_cache_directory; /* NULL if geometries are not cached */
+
+  /* Domain decomposition options */
+  int decomposition_method;   /* 0 = regular, 1 = mask, 2 = cost */
+  char *decomposition_file_name;
+  SubgridArray *decomposition; /* weighted decomposition, NULL until computed */
+
+  /* PFB file I/O options */
+  int pfb_io_method;          /* 0 = serial amps_FFopen, 1 = MPI-IO, 2 = async */
+  int pfb_write_dist;         /* write the .dist sidecar file? */
+  int pfb_async_queue_depth;  /* number of staging buffers for async output */
 
 #ifdef HAVE_SAMRAI
   SAMRAI::tbox::Pointer < Parflow > parflow_simulation;
@@ -142,6 +155,32 @@ amps_ThreadLocalDcl(extern IDB *, input_database);
 #define GlobalsParflowSimulation   (globals->parflow_simulation)
 
 #define GlobalsUseClustering      (globals->use_clustering)
+#define GlobalsClusteringMaxBoxes (globals->clustering_max_boxes)
+#define GlobalsGeomCacheDirectory (globals->geom_cache_directory)
+
+#define GlobalsDecompositionMethod   (globals->decomposition_method)
+#define GlobalsDecompositionFileName (globals->decomposition_file_name)
+#define GlobalsDecomposition         (globals->decomposition)
+
+#define GlobalsPFBIOMethod        (globals->pfb_io_method)
+#define GlobalsPFBWriteDist       (globals->pfb_write_dist)
+#define GlobalsPFBAsyncQueueDepth (globals->pfb_async_queue_depth)
+
+/*--------------------------------------------------------------------------
+ * Values for GlobalsPFBIOMethod
+ *--------------------------------------------------------------------------*/
+
+#define PFB_IO_SERIAL 0
+#define PFB_IO_MPIIO  1
+#define PFB_IO_ASYNC  2
+
+/*--------------------------------------------------------------------------
+ * Values for GlobalsDecompositionMethod
+ *--------------------------------------------------------------------------*/
+
+#define DECOMPOSITION_REGULAR 0
+#define DECOMPOSITION_MASK    1
+#define DECOMPOSITION_COST    2
 
 #define pqr_to_process(p, q, r, P, Q, R)  ((((r) * (Q)) + (q)) * (P) + (p))
 
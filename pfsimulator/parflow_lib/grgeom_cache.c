@@ -0,0 +1,722 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+/*****************************************************************************
+*
+* Routines to save and restore GrGeomSolids built from TINs.
+*
+* Building the octrees of a solid and clustering its iteration boxes
+* gives the same result for every run with the same solid, background,
+* user grid and process topology.  When GeomCache.Directory is set, each
+* rank writes its part of every solid to
+*
+*   <directory>/<key>.<rank>.pfgc
+*
+* where <key> is a 64 bit FNV-1a hash of everything the result depends on,
+* and later runs read the solid back instead of rebuilding it.  A file
+* holds:
+*
+*   char   magic[8]                        "PFGEOMC"
+*   int    version, octree_bg_level, octree_ix, octree_iy, octree_iz
+*   int    num_patches
+*   (1 + num_patches) x octree { int num_nodes; num_nodes x node }
+*   int    has_boxes
+*   if has_boxes, the interior boxes, the surface boxes of each face and
+*   the patch boxes of each face and patch, each as
+*          { int size; int boxlimits[6]; size x { int lo[3], up[3] } }
+*   where a size of -1 marks a loop that uses the octree because it
+*   needed more than Clustering.MaxBoxes boxes
+*   int    checksum[2]                     FNV-1a of all preceding bytes
+*   char   magic[8]                        "PFGEOMC"
+*
+* Octree nodes are stored in preorder as three bytes (flags, faces and
+* whether the node has children).  Integers are big-endian, as in PFB
+* files.  Files are written under a temporary name and renamed when
+* complete, so concurrent runs never see a partial file.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+#include "grgeometry.h"
+
+#include <string.h>
+#include <sys/stat.h>
+
+#define GRGEOM_CACHE_MAGIC      "PFGEOMC"
+#define GRGEOM_CACHE_VERSION    1
+#define GRGEOM_CACHE_FNV_BASIS  14695981039346656037ULL
+
+/*--------------------------------------------------------------------------
+ * Key hashing (64 bit FNV-1a)
+ *--------------------------------------------------------------------------*/
+
+typedef unsigned long long GrGeomCacheKey;
+
+static GrGeomCacheKey GrGeomCacheHash(GrGeomCacheKey key, const void *data, size_t size)
+{
+  const unsigned char *bytes = (const unsigned char*)data;
+  size_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    key ^= bytes[i];
+    key *= 1099511628211ULL;
+  }
+
+  return key;
+}
+
+static GrGeomCacheKey GrGeomCacheHashInt(GrGeomCacheKey key, int value)
+{
+  return GrGeomCacheHash(key, &value, sizeof(int));
+}
+
+static GrGeomCacheKey GrGeomCacheHashDouble(GrGeomCacheKey key, double value)
+{
+  return GrGeomCacheHash(key, &value, sizeof(double));
+}
+
+/*--------------------------------------------------------------------------
+ * Growable byte buffer used to pack and unpack a cache file
+ *--------------------------------------------------------------------------*/
+
+typedef struct {
+  char   *data;
+  size_t size;         /* bytes used (pack) or available (unpack) */
+  size_t capacity;
+  size_t pos;          /* unpack position */
+  int ok;              /* cleared when an unpack runs off the end */
+} GrGeomCacheBuffer;
+
+static char *GrGeomCacheReserve(GrGeomCacheBuffer *buffer, size_t size)
+{
+  char *pos;
+
+  if (buffer->size + size > buffer->capacity)
+  {
+    size_t capacity = pfmax(2 * buffer->capacity, buffer->size + size);
+    char   *data = talloc(char, capacity);
+
+    if (buffer->size > 0)
+    {
+      memcpy(data, buffer->data, buffer->size);
+    }
+    tfree(buffer->data);
+
+    buffer->data = data;
+    buffer->capacity = capacity;
+  }
+
+  pos = buffer->data + buffer->size;
+  buffer->size += size;
+
+  return pos;
+}
+
+static void GrGeomCachePackInt(GrGeomCacheBuffer *buffer, int value)
+{
+  PFBPackInt(GrGeomCacheReserve(buffer, 4), value);
+}
+
+static char *GrGeomCacheTake(GrGeomCacheBuffer *buffer, size_t size)
+{
+  char *pos;
+
+  if (!buffer->ok || size > buffer->size - buffer->pos)
+  {
+    buffer->ok = 0;
+    return NULL;
+  }
+
+  pos = buffer->data + buffer->pos;
+  buffer->pos += size;
+
+  return pos;
+}
+
+static int GrGeomCacheUnpackInt(GrGeomCacheBuffer *buffer)
+{
+  char *pos = GrGeomCacheTake(buffer, 4);
+  int value = 0;
+
+  if (pos)
+  {
+    PFBUnpackInt(pos, &value);
+  }
+
+  return value;
+}
+
+/*--------------------------------------------------------------------------
+ * Octrees
+ *--------------------------------------------------------------------------*/
+
+static int GrGeomCacheCountNodes(GrGeomOctree *octree)
+{
+  int num_nodes = 1;
+  int i;
+
+  if (GrGeomOctreeChildren(octree) != NULL)
+  {
+    for (i = 0; i < GrGeomOctreeNumChildren; i++)
+    {
+      num_nodes += GrGeomCacheCountNodes(GrGeomOctreeChild(octree, i));
+    }
+  }
+
+  return num_nodes;
+}
+
+static void GrGeomCachePackNodes(GrGeomCacheBuffer *buffer, GrGeomOctree *octree)
+{
+  char *pos = GrGeomCacheReserve(buffer, 3);
+  int i;
+
+  pos[0] = (char)GrGeomOctreeFlag(octree);
+  pos[1] = (char)GrGeomOctreeFaces(octree);
+  pos[2] = (char)(GrGeomOctreeChildren(octree) != NULL);
+
+  if (GrGeomOctreeChildren(octree) != NULL)
+  {
+    for (i = 0; i < GrGeomOctreeNumChildren; i++)
+    {
+      GrGeomCachePackNodes(buffer, GrGeomOctreeChild(octree, i));
+    }
+  }
+}
+
+static void GrGeomCachePackOctree(GrGeomCacheBuffer *buffer, GrGeomOctree *octree)
+{
+  if (octree == NULL)
+  {
+    GrGeomCachePackInt(buffer, 0);
+    return;
+  }
+
+  GrGeomCachePackInt(buffer, GrGeomCacheCountNodes(octree));
+  GrGeomCachePackNodes(buffer, octree);
+}
+
+/* Nodes deeper than max_depth mean the file is corrupt */
+static GrGeomOctree *GrGeomCacheUnpackNodes(
+                                            GrGeomCacheBuffer *buffer,
+                                            GrGeomOctree *     parent,
+                                            int                max_depth)
+{
+  GrGeomOctree *octree;
+  char         *pos;
+  int i;
+
+  pos = GrGeomCacheTake(buffer, 3);
+  if (pos == NULL)
+  {
+    return NULL;
+  }
+
+  octree = GrGeomNewOctree();
+
+  GrGeomOctreeFlag(octree) = (unsigned char)pos[0];
+  GrGeomOctreeFaces(octree) = (unsigned char)pos[1];
+  GrGeomOctreeParent(octree) = parent;
+
+  if (pos[2])
+  {
+    if (max_depth <= 0)
+    {
+      buffer->ok = 0;
+      return octree;
+    }
+
+    GrGeomOctreeChildren(octree) = ctalloc(GrGeomOctree *, GrGeomOctreeNumChildren);
+    for (i = 0; i < GrGeomOctreeNumChildren && buffer->ok; i++)
+    {
+      GrGeomOctreeChild(octree, i) =
+        GrGeomCacheUnpackNodes(buffer, octree, max_depth - 1);
+    }
+  }
+
+  return octree;
+}
+
+static GrGeomOctree *GrGeomCacheUnpackOctree(
+                                             GrGeomCacheBuffer *buffer,
+                                             int                max_depth)
+{
+  GrGeomOctree *octree;
+  int num_nodes;
+  size_t start;
+
+  num_nodes = GrGeomCacheUnpackInt(buffer);
+  if (num_nodes <= 0)
+  {
+    return NULL;
+  }
+
+  start = buffer->pos;
+  octree = GrGeomCacheUnpackNodes(buffer, NULL, max_depth);
+
+  if (buffer->ok && (buffer->pos - start != 3 * (size_t)num_nodes))
+  {
+    buffer->ok = 0;
+  }
+
+  return octree;
+}
+
+/*--------------------------------------------------------------------------
+ * Box arrays
+ *--------------------------------------------------------------------------*/
+
+static void GrGeomCachePackBoxArray(GrGeomCacheBuffer *buffer, BoxArray *box_array)
+{
+  unsigned int i;
+  int d;
+
+  if (box_array == NULL)
+  {
+    GrGeomCachePackInt(buffer, -1);
+    return;
+  }
+
+  GrGeomCachePackInt(buffer, (int)BoxArraySize(box_array));
+
+  for (d = 0; d < 2 * DIM; d++)
+  {
+    GrGeomCachePackInt(buffer, box_array->boxlimits[d]);
+  }
+
+  for (i = 0; i < BoxArraySize(box_array); i++)
+  {
+    for (d = 0; d < DIM; d++)
+    {
+      GrGeomCachePackInt(buffer, BoxArrayGetBox(box_array, i).lo[d]);
+    }
+    for (d = 0; d < DIM; d++)
+    {
+      GrGeomCachePackInt(buffer, BoxArrayGetBox(box_array, i).up[d]);
+    }
+  }
+}
+
+static BoxArray *GrGeomCacheUnpackBoxArray(GrGeomCacheBuffer *buffer)
+{
+  BoxArray *box_array;
+  int size;
+  int i, d;
+
+  size = GrGeomCacheUnpackInt(buffer);
+  if (buffer->ok && size == -1)
+  {
+    return NULL;
+  }
+
+  if (!buffer->ok || size < 0 ||
+      (size_t)size > (buffer->size - buffer->pos) / (2 * DIM * 4))
+  {
+    buffer->ok = 0;
+    return NULL;
+  }
+
+  box_array = NewBoxArray(NULL);
+
+  for (d = 0; d < 2 * DIM; d++)
+  {
+    box_array->boxlimits[d] = GrGeomCacheUnpackInt(buffer);
+  }
+
+  box_array->size = size;
+  box_array->boxes = ctalloc(Box, size);
+
+  for (i = 0; i < size; i++)
+  {
+    for (d = 0; d < DIM; d++)
+    {
+      box_array->boxes[i].lo[d] = GrGeomCacheUnpackInt(buffer);
+    }
+    for (d = 0; d < DIM; d++)
+    {
+      box_array->boxes[i].up[d] = GrGeomCacheUnpackInt(buffer);
+    }
+  }
+
+  return box_array;
+}
+
+/*--------------------------------------------------------------------------
+ * GrGeomCacheFilename
+ *
+ * Name of the cache file of this rank for a solid built from solid_data on
+ * the given extents, or NULL if the cache is not enabled.  The key covers
+ * the solid, the background, the user grid and its distribution, the
+ * extents and the clustering setting.  The returned name must be freed
+ * with tfree.
+ *--------------------------------------------------------------------------*/
+
+char *GrGeomCacheFilename(
+                          GeomTSolid *       solid_data,
+                          GrGeomExtentArray *extent_array,
+                          int                octree_bg_level)
+{
+  Background     *bg = GlobalsBackground;
+  SubgridArray   *all_subgrids;
+  Subgrid        *subgrid;
+  GeomTIN        *surface;
+
+  GrGeomCacheKey key = GRGEOM_CACHE_FNV_BASIS;
+  char           *filename;
+  int num_indices;
+  int is, e, d, p;
+
+
+  if (GlobalsGeomCacheDirectory == NULL)
+  {
+    return NULL;
+  }
+
+  key = GrGeomCacheHashInt(key, GRGEOM_CACHE_VERSION);
+
+  /* Process topology */
+  key = GrGeomCacheHashInt(key, amps_Rank(amps_CommWorld));
+  key = GrGeomCacheHashInt(key, amps_Size(amps_CommWorld));
+  key = GrGeomCacheHashInt(key, GlobalsNumProcsX);
+  key = GrGeomCacheHashInt(key, GlobalsNumProcsY);
+  key = GrGeomCacheHashInt(key, GlobalsNumProcsZ);
+
+  /* Background and octree setup */
+  key = GrGeomCacheHashDouble(key, BackgroundX(bg));
+  key = GrGeomCacheHashDouble(key, BackgroundY(bg));
+  key = GrGeomCacheHashDouble(key, BackgroundZ(bg));
+  key = GrGeomCacheHashDouble(key, BackgroundDX(bg));
+  key = GrGeomCacheHashDouble(key, BackgroundDY(bg));
+  key = GrGeomCacheHashDouble(key, BackgroundDZ(bg));
+  key = GrGeomCacheHashInt(key, BackgroundIX(bg));
+  key = GrGeomCacheHashInt(key, BackgroundIY(bg));
+  key = GrGeomCacheHashInt(key, BackgroundIZ(bg));
+  key = GrGeomCacheHashInt(key, BackgroundNX(bg));
+  key = GrGeomCacheHashInt(key, BackgroundNY(bg));
+  key = GrGeomCacheHashInt(key, BackgroundNZ(bg));
+  key = GrGeomCacheHashInt(key, octree_bg_level);
+  key = GrGeomCacheHashInt(key, GlobalsMaxRefLevel);
+  key = GrGeomCacheHashInt(key, GlobalsUseClustering);
+  key = GrGeomCacheHashInt(key, GlobalsClusteringMaxBoxes);
+
+  /* User grid distribution, which the clustering depends on */
+  all_subgrids = GridAllSubgrids(GlobalsUserGrid);
+  key = GrGeomCacheHashInt(key, SubgridArraySize(all_subgrids));
+  ForSubgridI(is, all_subgrids)
+  {
+    subgrid = SubgridArraySubgrid(all_subgrids, is);
+    key = GrGeomCacheHashInt(key, SubgridIX(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridIY(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridIZ(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridNX(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridNY(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridNZ(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridRX(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridRY(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridRZ(subgrid));
+    key = GrGeomCacheHashInt(key, SubgridProcess(subgrid));
+  }
+
+  /* Extents of this rank, inside the octree index space as
+   * GrGeomOctreeFromTIN clips them */
+  num_indices = Pow2(octree_bg_level + GlobalsMaxRefLevel);
+  key = GrGeomCacheHashInt(key, GrGeomExtentArraySize(extent_array));
+  for (e = 0; e < GrGeomExtentArraySize(extent_array); e++)
+  {
+    int *extents = GrGeomExtentArrayExtents(extent_array)[e];
+
+    for (d = 0; d < 6; d += 2)
+    {
+      key = GrGeomCacheHashInt(key, pfmax(extents[d], 0));
+      key = GrGeomCacheHashInt(key, pfmin(extents[d + 1], num_indices - 1));
+    }
+  }
+
+  /* The solid */
+  surface = solid_data->surface;
+  key = GrGeomCacheHashInt(key, GeomTINNumVertices(surface));
+  key = GrGeomCacheHash(key, surface->vertex_array->x,
+                        GeomTINNumVertices(surface) * sizeof(double));
+  key = GrGeomCacheHash(key, surface->vertex_array->y,
+                        GeomTINNumVertices(surface) * sizeof(double));
+  key = GrGeomCacheHash(key, surface->vertex_array->z,
+                        GeomTINNumVertices(surface) * sizeof(double));
+  key = GrGeomCacheHashInt(key, GeomTINNumTriangles(surface));
+  key = GrGeomCacheHash(key, surface->triangles,
+                        3 * GeomTINNumTriangles(surface) * sizeof(int));
+  key = GrGeomCacheHashInt(key, solid_data->num_patches);
+  for (p = 0; p < solid_data->num_patches; p++)
+  {
+    key = GrGeomCacheHashInt(key, solid_data->num_patch_triangles[p]);
+    key = GrGeomCacheHash(key, solid_data->patches[p],
+                          solid_data->num_patch_triangles[p] * sizeof(int));
+  }
+
+  filename = talloc(char, strlen(GlobalsGeomCacheDirectory) + 40);
+  sprintf(filename, "%s/%016llx.%05d.pfgc", GlobalsGeomCacheDirectory, key,
+          amps_Rank(amps_CommWorld));
+
+  return filename;
+}
+
+/*--------------------------------------------------------------------------
+ * GrGeomCacheRead
+ *
+ * Set *solid_ptr to the solid stored in filename and return 1 if every
+ * rank could read its cache file, otherwise return 0 and leave *solid_ptr
+ * unchanged so the caller rebuilds the solid.  Collective.
+ *--------------------------------------------------------------------------*/
+
+int GrGeomCacheRead(
+                    GrGeomSolid **solid_ptr,
+                    char *        filename)
+{
+  GrGeomSolid       *solid = NULL;
+  GrGeomCacheBuffer buffer;
+  FILE              *file;
+  long file_size;
+
+  GrGeomOctree      *solid_octree;
+  GrGeomOctree     **patch_octrees = NULL;
+  int octree_bg_level, ix, iy, iz;
+  int num_patches, max_depth;
+  int f, p;
+  char              *pos;
+  GrGeomCacheKey checksum;
+
+  amps_Invoice invoice;
+  int ok;
+
+
+  /* The directory is created by rank 0 before any rank writes to it */
+  if (!amps_Rank(amps_CommWorld))
+  {
+    mkdir(GlobalsGeomCacheDirectory, S_IRWXU | S_IRWXG | S_IRWXO);
+  }
+
+  buffer.data = NULL;
+  buffer.size = 0;
+  buffer.capacity = 0;
+  buffer.pos = 0;
+  buffer.ok = 0;
+
+  if ((file = fopen(filename, "rb")) != NULL)
+  {
+    if (fseek(file, 0, SEEK_END) == 0 && (file_size = ftell(file)) > 0)
+    {
+      rewind(file);
+      buffer.data = talloc(char, file_size);
+      buffer.size = (size_t)file_size;
+      buffer.ok = (fread(buffer.data, 1, buffer.size, file) == buffer.size);
+    }
+    fclose(file);
+  }
+
+  /* Reject files whose contents were changed after they were written */
+  if (buffer.ok && buffer.size >= 16)
+  {
+    checksum = GrGeomCacheHash(GRGEOM_CACHE_FNV_BASIS, buffer.data,
+                               buffer.size - 16);
+    buffer.pos = buffer.size - 16;
+    buffer.ok = (GrGeomCacheUnpackInt(&buffer) == (int)(checksum >> 32) &&
+                 GrGeomCacheUnpackInt(&buffer) == (int)(checksum & 0xffffffffULL));
+    buffer.pos = 0;
+  }
+
+  pos = GrGeomCacheTake(&buffer, 8);
+  if (pos && memcmp(pos, GRGEOM_CACHE_MAGIC, 8) == 0 &&
+      GrGeomCacheUnpackInt(&buffer) == GRGEOM_CACHE_VERSION)
+  {
+    octree_bg_level = GrGeomCacheUnpackInt(&buffer);
+    ix = GrGeomCacheUnpackInt(&buffer);
+    iy = GrGeomCacheUnpackInt(&buffer);
+    iz = GrGeomCacheUnpackInt(&buffer);
+    num_patches = GrGeomCacheUnpackInt(&buffer);
+
+    if (num_patches < 0 || (size_t)num_patches > buffer.size)
+    {
+      buffer.ok = 0;
+    }
+
+    if (buffer.ok)
+    {
+      max_depth = octree_bg_level + GlobalsMaxRefLevel;
+
+      solid_octree = GrGeomCacheUnpackOctree(&buffer, max_depth);
+      patch_octrees = ctalloc(GrGeomOctree *, num_patches);
+      for (p = 0; p < num_patches; p++)
+      {
+        patch_octrees[p] = GrGeomCacheUnpackOctree(&buffer, max_depth);
+      }
+
+      solid = GrGeomNewSolid(solid_octree, patch_octrees, num_patches,
+                             octree_bg_level, ix, iy, iz);
+
+      if (GrGeomCacheUnpackInt(&buffer) != GlobalsUseClustering)
+      {
+        buffer.ok = 0;
+      }
+      else if (GlobalsUseClustering)
+      {
+        GrGeomSolidInteriorBoxes(solid) = GrGeomCacheUnpackBoxArray(&buffer);
+        for (f = 0; f < GrGeomOctreeNumFaces; f++)
+        {
+          GrGeomSolidSurfaceBoxes(solid, f) = GrGeomCacheUnpackBoxArray(&buffer);
+        }
+        for (f = 0; f < GrGeomOctreeNumFaces; f++)
+        {
+          for (p = 0; p < num_patches; p++)
+          {
+            GrGeomSolidPatchBoxes(solid, p, f) = GrGeomCacheUnpackBoxArray(&buffer);
+          }
+        }
+      }
+
+      GrGeomCacheTake(&buffer, 8);
+      pos = GrGeomCacheTake(&buffer, 8);
+      if (!pos || memcmp(pos, GRGEOM_CACHE_MAGIC, 8) != 0 ||
+          buffer.pos != buffer.size || solid_octree == NULL)
+      {
+        buffer.ok = 0;
+      }
+    }
+  }
+  else
+  {
+    buffer.ok = 0;
+  }
+
+  tfree(buffer.data);
+
+  /* Use the cache only if every rank has it, the boxes are
+   * clustered collectively */
+  ok = buffer.ok;
+  invoice = amps_NewInvoice("%i", &ok);
+  amps_AllReduce(amps_CommWorld, invoice, amps_Min);
+  amps_FreeInvoice(invoice);
+
+  if (!ok)
+  {
+    if (solid)
+    {
+      GrGeomFreeSolid(solid);
+    }
+    return 0;
+  }
+
+  *solid_ptr = solid;
+
+  return 1;
+}
+
+/*--------------------------------------------------------------------------
+ * GrGeomCacheWrite
+ *
+ * Store solid in filename.  A file that can't be written only costs a
+ * rebuild in the next run, so failures are reported once and otherwise
+ * ignored.
+ *--------------------------------------------------------------------------*/
+
+void GrGeomCacheWrite(
+                      GrGeomSolid *solid,
+                      char *       filename)
+{
+  static int warned = 0;
+
+  GrGeomCacheBuffer buffer;
+  FILE              *file;
+  char              *tmp_filename;
+  GrGeomCacheKey checksum;
+  int f, p, written;
+
+
+  buffer.data = NULL;
+  buffer.size = 0;
+  buffer.capacity = 0;
+  buffer.pos = 0;
+  buffer.ok = 1;
+
+  memcpy(GrGeomCacheReserve(&buffer, 8), GRGEOM_CACHE_MAGIC, 8);
+  GrGeomCachePackInt(&buffer, GRGEOM_CACHE_VERSION);
+  GrGeomCachePackInt(&buffer, GrGeomSolidOctreeBGLevel(solid));
+  GrGeomCachePackInt(&buffer, GrGeomSolidOctreeIX(solid));
+  GrGeomCachePackInt(&buffer, GrGeomSolidOctreeIY(solid));
+  GrGeomCachePackInt(&buffer, GrGeomSolidOctreeIZ(solid));
+  GrGeomCachePackInt(&buffer, GrGeomSolidNumPatches(solid));
+
+  GrGeomCachePackOctree(&buffer, GrGeomSolidData(solid));
+  for (p = 0; p < GrGeomSolidNumPatches(solid); p++)
+  {
+    GrGeomCachePackOctree(&buffer, GrGeomSolidPatch(solid, p));
+  }
+
+  GrGeomCachePackInt(&buffer, GlobalsUseClustering);
+  if (GlobalsUseClustering)
+  {
+    GrGeomCachePackBoxArray(&buffer, GrGeomSolidInteriorBoxes(solid));
+    for (f = 0; f < GrGeomOctreeNumFaces; f++)
+    {
+      GrGeomCachePackBoxArray(&buffer, GrGeomSolidSurfaceBoxes(solid, f));
+    }
+    for (f = 0; f < GrGeomOctreeNumFaces; f++)
+    {
+      for (p = 0; p < GrGeomSolidNumPatches(solid); p++)
+      {
+        GrGeomCachePackBoxArray(&buffer, GrGeomSolidPatchBoxes(solid, p, f));
+      }
+    }
+  }
+
+  checksum = GrGeomCacheHash(GRGEOM_CACHE_FNV_BASIS, buffer.data, buffer.size);
+  GrGeomCachePackInt(&buffer, (int)(checksum >> 32));
+  GrGeomCachePackInt(&buffer, (int)(checksum & 0xffffffffULL));
+  memcpy(GrGeomCacheReserve(&buffer, 8), GRGEOM_CACHE_MAGIC, 8);
+
+  tmp_filename = talloc(char, strlen(filename) + 5);
+  sprintf(tmp_filename, "%s.tmp", filename);
+
+  written = 0;
+  if ((file = fopen(tmp_filename, "wb")) != NULL)
+  {
+    written = (fwrite(buffer.data, 1, buffer.size, file) == buffer.size);
+    written = (fclose(file) == 0) && written;
+  }
+
+  if (!written || rename(tmp_filename, filename) != 0)
+  {
+    remove(tmp_filename);
+    if (!warned)
+    {
+      amps_Printf("Warning: can't write geometry cache file %s\n", filename);
+      warned = 1;
+    }
+  }
+
+  tfree(tmp_filename);
+  tfree(buffer.data);
+}
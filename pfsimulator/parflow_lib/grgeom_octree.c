@@ -536,6 +536,502 @@ GrGeomOctree   *GrGeomOctreeAddFace(
 }
 
 
+/*--------------------------------------------------------------------------
+ * TIN triangle bins
+ *
+ * The lines of direction XDIRECTION, YDIRECTION or ZDIRECTION only hit
+ * the triangles whose projection onto the perpendicular plane overlaps
+ * them.  For each plane, the triangles overlapping the local extents are
+ * gathered once, in increasing id order, together with their line index
+ * ranges on the two plane axes.  A uniform grid of bins over the plane
+ * then lets GrGeomOctreeFromTIN test each extent against just the nearby
+ * triangles instead of every triangle of the TIN.
+ *--------------------------------------------------------------------------*/
+
+/* Average number of triangles per bin */
+#define TIN_BIN_TRIANGLES 16
+
+/* Number of triangles intersected with the lines at a time */
+#define TIN_HIT_CHUNK 1024
+
+typedef struct {
+  int id;
+  int lower[2];           /* line index range on the plane axes */
+  int upper[2];
+  double v[9];            /* vertex coordinates */
+} TINBinTriangle;
+
+typedef struct {
+  int axis[2];            /* plane axes, axis[0] varies fastest */
+  int lower[2];           /* first line index of the bins */
+  int num_bins[2];
+  int bin_width[2];       /* in line indices */
+
+  int num_triangles;
+  TINBinTriangle *triangles;
+
+  int *bin_start;         /* num_bins[0] * num_bins[1] + 1 offsets */
+  int *bin_triangles;     /* indices into triangles */
+} TINBins;
+
+typedef struct {
+  int index;              /* line index */
+  int component;
+  double point;
+} TINLineHit;
+
+/*--------------------------------------------------------------------------
+ * TINTriangleLineBox:
+ *    Vertices of triangle n and its bounding box in line index space.
+ *--------------------------------------------------------------------------*/
+
+static void TINTriangleLineBox(
+                               GeomTIN *solid,
+                               int      n,
+                               double * lower,
+                               double * d_lines,
+                               int      num_indices,
+                               double * v,
+                               double * box_lower,
+                               double * box_upper)
+{
+  int i0 = GeomTINTriangleV0(solid, n);
+  int i1 = GeomTINTriangleV1(solid, n);
+  int i2 = GeomTINTriangleV2(solid, n);
+  double octree_v0, octree_v1, octree_v2;
+  int a;
+
+  v[0] = GeomTINVertexX(solid, i0);
+  v[1] = GeomTINVertexY(solid, i0);
+  v[2] = GeomTINVertexZ(solid, i0);
+  v[3] = GeomTINVertexX(solid, i1);
+  v[4] = GeomTINVertexY(solid, i1);
+  v[5] = GeomTINVertexZ(solid, i1);
+  v[6] = GeomTINVertexX(solid, i2);
+  v[7] = GeomTINVertexY(solid, i2);
+  v[8] = GeomTINVertexZ(solid, i2);
+
+  for (a = 0; a < 3; a++)
+  {
+    octree_v0 = (v[a] - lower[a]) / d_lines[a];
+    octree_v1 = (v[3 + a] - lower[a]) / d_lines[a];
+    octree_v2 = (v[6 + a] - lower[a]) / d_lines[a];
+
+    box_lower[a] = pfmin(pfmin(octree_v0, octree_v1), octree_v2);
+    box_upper[a] = pfmax(pfmax(octree_v0, octree_v1), octree_v2);
+
+    /* This is to avoid integer overflow below */
+    box_lower[a] = pfmin(box_lower[a], 2 * num_indices);
+    box_upper[a] = pfmax(box_upper[a], -1);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * NewTINBins:
+ *    Bins the triangles of a TIN that overlap the extents over the planes
+ *    perpendicular to the lines of each direction.  Returns one TINBins
+ *    per direction.  The TIN itself is traversed once; the rest of the
+ *    work is proportional to the number of local triangles.
+ *--------------------------------------------------------------------------*/
+
+static TINBins *NewTINBins(
+                           GeomTIN *solid,
+                           int **   l_lines,
+                           int **   u_lines,
+                           int      ea_size,
+                           double * lower,
+                           double * d_lines,
+                           int      num_indices)
+{
+  TINBins *bins = ctalloc(TINBins, 3);
+  int num_triangles = GeomTINNumTriangles(solid);
+  int region_lower[3], region_upper[3];
+  int max_triangles[3];
+  double v[9], box_lower[3], box_upper[3];
+  int line_lower[3], line_upper[3];
+  int bins_per_axis, num_bins;
+  int *bin_count;
+  int direction, ie, n, c, t, bi, bj;
+
+  /* Bounding box of the extents in line index space */
+  for (c = 0; c < 3; c++)
+  {
+    region_lower[c] = 2 * num_indices;
+    region_upper[c] = -1;
+    for (ie = 0; ie < ea_size; ie++)
+    {
+      region_lower[c] = pfmin(region_lower[c], l_lines[c][ie]);
+      region_upper[c] = pfmax(region_upper[c], u_lines[c][ie]);
+    }
+  }
+
+  /*-----------------------------------------------------------------------
+   * Gather the local triangles of each plane
+   *-----------------------------------------------------------------------*/
+
+  for (direction = XDIRECTION; direction <= ZDIRECTION; direction++)
+  {
+    bins[direction].axis[0] = (direction == XDIRECTION) ? YDIRECTION : XDIRECTION;
+    bins[direction].axis[1] = (direction == ZDIRECTION) ? YDIRECTION : ZDIRECTION;
+
+    max_triangles[direction] = 1024;
+    bins[direction].triangles = talloc(TINBinTriangle, max_triangles[direction]);
+  }
+
+  for (n = 0; n < num_triangles; n++)
+  {
+    TINTriangleLineBox(solid, n, lower, d_lines, num_indices,
+                       v, box_lower, box_upper);
+
+    /* Extents start at line 1, so the casts below round like floor and ceil */
+    for (c = 0; c < 3; c++)
+    {
+      double bound_lower = pfmax(box_lower[c], (double)region_lower[c]);
+      double bound_upper = pfmin(box_upper[c], (double)region_upper[c]);
+
+      line_lower[c] = (int)bound_lower;
+      line_upper[c] = (int)bound_upper;
+      line_upper[c] += (line_upper[c] < bound_upper);
+    }
+
+    for (direction = XDIRECTION; direction <= ZDIRECTION; direction++)
+    {
+      TINBins        *plane = &(bins[direction]);
+      TINBinTriangle *bin_triangle;
+
+      if (line_lower[plane->axis[0]] > line_upper[plane->axis[0]] ||
+          line_lower[plane->axis[1]] > line_upper[plane->axis[1]])
+      {
+        continue;
+      }
+
+      if (plane->num_triangles == max_triangles[direction])
+      {
+        TINBinTriangle *tmp_triangles = plane->triangles;
+
+        max_triangles[direction] *= 2;
+        plane->triangles = talloc(TINBinTriangle, max_triangles[direction]);
+        memcpy(plane->triangles, tmp_triangles,
+               plane->num_triangles * sizeof(TINBinTriangle));
+        tfree(tmp_triangles);
+      }
+
+      bin_triangle = &(plane->triangles[plane->num_triangles++]);
+      bin_triangle->id = n;
+      memcpy(bin_triangle->v, v, 9 * sizeof(double));
+      for (c = 0; c < 2; c++)
+      {
+        bin_triangle->lower[c] = line_lower[plane->axis[c]];
+        bin_triangle->upper[c] = line_upper[plane->axis[c]];
+      }
+    }
+  }
+
+  /*-----------------------------------------------------------------------
+   * Count the triangles of each bin, then fill the bins in triangle order
+   *-----------------------------------------------------------------------*/
+
+  for (direction = XDIRECTION; direction <= ZDIRECTION; direction++)
+  {
+    TINBins *plane = &(bins[direction]);
+
+    /* The gathered triangles already match a single extent */
+    if (ea_size > 1)
+    {
+      bins_per_axis = (int)ceil(sqrt((double)pfmax(plane->num_triangles / TIN_BIN_TRIANGLES, 1)));
+    }
+    else
+    {
+      bins_per_axis = 1;
+    }
+
+    for (c = 0; c < 2; c++)
+    {
+      int num_lines = pfmax(region_upper[plane->axis[c]] - region_lower[plane->axis[c]] + 1, 1);
+
+      plane->lower[c] = region_lower[plane->axis[c]];
+      plane->bin_width[c] = (num_lines + bins_per_axis - 1) / bins_per_axis;
+      plane->num_bins[c] = (num_lines + plane->bin_width[c] - 1) / plane->bin_width[c];
+    }
+
+    num_bins = plane->num_bins[0] * plane->num_bins[1];
+    plane->bin_start = ctalloc(int, num_bins + 1);
+    bin_count = ctalloc(int, num_bins);
+
+    for (t = 0; t < plane->num_triangles; t++)
+    {
+      TINBinTriangle *bin_triangle = &(plane->triangles[t]);
+
+      for (bj = (bin_triangle->lower[1] - plane->lower[1]) / plane->bin_width[1];
+           bj <= (bin_triangle->upper[1] - plane->lower[1]) / plane->bin_width[1]; bj++)
+      {
+        for (bi = (bin_triangle->lower[0] - plane->lower[0]) / plane->bin_width[0];
+             bi <= (bin_triangle->upper[0] - plane->lower[0]) / plane->bin_width[0]; bi++)
+        {
+          plane->bin_start[bi + bj * plane->num_bins[0] + 1]++;
+        }
+      }
+    }
+
+    for (bi = 0; bi < num_bins; bi++)
+    {
+      plane->bin_start[bi + 1] += plane->bin_start[bi];
+    }
+    plane->bin_triangles = talloc(int, pfmax(plane->bin_start[num_bins], 1));
+
+    for (t = 0; t < plane->num_triangles; t++)
+    {
+      TINBinTriangle *bin_triangle = &(plane->triangles[t]);
+
+      for (bj = (bin_triangle->lower[1] - plane->lower[1]) / plane->bin_width[1];
+           bj <= (bin_triangle->upper[1] - plane->lower[1]) / plane->bin_width[1]; bj++)
+      {
+        for (bi = (bin_triangle->lower[0] - plane->lower[0]) / plane->bin_width[0];
+             bi <= (bin_triangle->upper[0] - plane->lower[0]) / plane->bin_width[0]; bi++)
+        {
+          int bin = bi + bj * plane->num_bins[0];
+
+          plane->bin_triangles[plane->bin_start[bin] + bin_count[bin]] = t;
+          bin_count[bin]++;
+        }
+      }
+    }
+
+    tfree(bin_count);
+  }
+
+  return bins;
+}
+
+static void FreeTINBins(
+                        TINBins *bins)
+{
+  int direction;
+
+  for (direction = XDIRECTION; direction <= ZDIRECTION; direction++)
+  {
+    tfree(bins[direction].bin_triangles);
+    tfree(bins[direction].bin_start);
+    tfree(bins[direction].triangles);
+  }
+  tfree(bins);
+}
+
+static int TINBinTriangleOverlaps(
+                                  TINBinTriangle *bin_triangle,
+                                  int *           lower,
+                                  int *           upper)
+{
+  return(bin_triangle->lower[0] <= upper[0] && bin_triangle->upper[0] >= lower[0] &&
+         bin_triangle->lower[1] <= upper[1] && bin_triangle->upper[1] >= lower[1]);
+}
+
+/*--------------------------------------------------------------------------
+ * TINBinsQuery:
+ *    Returns, in increasing order, the indices of the binned triangles
+ *    whose line index ranges overlap [lower, upper] on the plane axes.
+ *--------------------------------------------------------------------------*/
+
+static int *TINBinsQuery(
+                         TINBins *bins,
+                         int *    lower,
+                         int *    upper,
+                         int *    num_triangles_ptr)
+{
+  int *triangles;
+  char *found;
+  int bin_lower[2], bin_upper[2];
+  int num_triangles = 0;
+  int bi, bj, c, t;
+
+  for (c = 0; c < 2; c++)
+  {
+    bin_lower[c] = pfmax(lower[c] - bins->lower[c], 0) / bins->bin_width[c];
+    bin_upper[c] = pfmin((upper[c] - bins->lower[c]) / bins->bin_width[c],
+                         bins->num_bins[c] - 1);
+  }
+
+  if (bin_lower[0] == bin_upper[0] && bin_lower[1] == bin_upper[1])
+  {
+    int bin = bin_lower[0] + bin_lower[1] * bins->num_bins[0];
+
+    triangles = talloc(int, pfmax(bins->bin_start[bin + 1] - bins->bin_start[bin], 1));
+    for (t = bins->bin_start[bin]; t < bins->bin_start[bin + 1]; t++)
+    {
+      if (TINBinTriangleOverlaps(&(bins->triangles[bins->bin_triangles[t]]),
+                                 lower, upper))
+      {
+        triangles[num_triangles++] = bins->bin_triangles[t];
+      }
+    }
+  }
+  else
+  {
+    /* Triangles spanning several bins are found more than once */
+    found = ctalloc(char, pfmax(bins->num_triangles, 1));
+    for (bj = bin_lower[1]; bj <= bin_upper[1]; bj++)
+    {
+      for (bi = bin_lower[0]; bi <= bin_upper[0]; bi++)
+      {
+        int bin = bi + bj * bins->num_bins[0];
+
+        for (t = bins->bin_start[bin]; t < bins->bin_start[bin + 1]; t++)
+        {
+          found[bins->bin_triangles[t]] = 1;
+        }
+      }
+    }
+
+    for (t = 0; t < bins->num_triangles; t++)
+    {
+      found[t] = found[t] &&
+                 TINBinTriangleOverlaps(&(bins->triangles[t]), lower, upper);
+      num_triangles += found[t];
+    }
+
+    triangles = talloc(int, pfmax(num_triangles, 1));
+
+    num_triangles = 0;
+    for (t = 0; t < bins->num_triangles; t++)
+    {
+      if (found[t])
+      {
+        triangles[num_triangles++] = t;
+      }
+    }
+
+    tfree(found);
+  }
+
+  *num_triangles_ptr = num_triangles;
+
+  return triangles;
+}
+
+/*--------------------------------------------------------------------------
+ * IntersectLinesWithTINTriangles:
+ *    Adds the intersections of the lines of the given direction in an
+ *    extent with the given binned triangles to the line lists.  The
+ *    intersections of each chunk of triangles are computed in parallel;
+ *    they are added in triangle order so a point shared by several
+ *    triangles is always attributed to the same one.
+ *--------------------------------------------------------------------------*/
+
+static void IntersectLinesWithTINTriangles(
+                                           GeomTIN *    solid,
+                                           int          direction,
+                                           TINBins *    bins,
+                                           int *        triangles,
+                                           int          num_triangles,
+                                           ListMember **lines,
+                                           int *        l_lines,
+                                           int *        u_lines,
+                                           int *        n_lines,
+                                           double *     lower,
+                                           double *     d_lines,
+                                           int          num_indices)
+{
+  TINLineHit *hits;
+  int        *hit_start, *num_hits;
+  int a = bins->axis[0];
+  int b = bins->axis[1];
+  int max_hits;
+  int c_lower, c_upper;
+  int c, h;
+
+  /* Each triangle gets one slot for every line crossing its bounding box */
+  hit_start = talloc(int, num_triangles + 1);
+  hit_start[0] = 0;
+  for (c = 0; c < num_triangles; c++)
+  {
+    TINBinTriangle *bin_triangle = &(bins->triangles[triangles[c]]);
+    int ia_lower = pfmax(bin_triangle->lower[0], l_lines[a]);
+    int ia_upper = pfmin(bin_triangle->upper[0], u_lines[a]);
+    int ib_lower = pfmax(bin_triangle->lower[1], l_lines[b]);
+    int ib_upper = pfmin(bin_triangle->upper[1], u_lines[b]);
+
+    hit_start[c + 1] = hit_start[c] +
+                       (ia_upper - ia_lower + 1) * (ib_upper - ib_lower + 1);
+  }
+
+  /* Triangles are processed in chunks so the hits stay in cache */
+  max_hits = 0;
+  for (c_lower = 0; c_lower < num_triangles; c_lower += TIN_HIT_CHUNK)
+  {
+    c_upper = pfmin(c_lower + TIN_HIT_CHUNK, num_triangles);
+    max_hits = pfmax(max_hits, hit_start[c_upper] - hit_start[c_lower]);
+  }
+  hits = talloc(TINLineHit, pfmax(max_hits, 1));
+  num_hits = talloc(int, TIN_HIT_CHUNK);
+
+  for (c_lower = 0; c_lower < num_triangles; c_lower += TIN_HIT_CHUNK)
+  {
+    c_upper = pfmin(c_lower + TIN_HIT_CHUNK, num_triangles);
+
+#ifdef PARFLOW_HAVE_OMP
+    #pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (c = c_lower; c < c_upper; c++)
+    {
+      TINBinTriangle *bin_triangle = &(bins->triangles[triangles[c]]);
+      double         *v = bin_triangle->v;
+      int ia_lower = pfmax(bin_triangle->lower[0], l_lines[a]);
+      int ia_upper = pfmin(bin_triangle->upper[0], u_lines[a]);
+      int ib_lower = pfmax(bin_triangle->lower[1], l_lines[b]);
+      int ib_upper = pfmin(bin_triangle->upper[1], u_lines[b]);
+      int ia, ib;
+      int hit = hit_start[c] - hit_start[c_lower];
+
+      for (ib = ib_lower; ib <= ib_upper; ib++)
+      {
+        for (ia = ia_lower; ia <= ia_upper; ia++)
+        {
+          double a_center = lower[a] + ia * d_lines[a];
+          double b_center = lower[b] + ib * d_lines[b];
+          int intersects;
+
+          IntersectLineWithTriangle(direction, a_center, b_center,
+                                    v[0], v[1], v[2],
+                                    v[3], v[4], v[5],
+                                    v[6], v[7], v[8],
+                                    &intersects, &(hits[hit].point),
+                                    &(hits[hit].component));
+          if (intersects)
+          {
+            hits[hit].index = (ia - l_lines[a]) + (ib - l_lines[b]) * n_lines[a];
+            hit++;
+          }
+        }
+      }
+
+      num_hits[c - c_lower] = hit - (hit_start[c] - hit_start[c_lower]);
+    }
+
+    for (c = c_lower; c < c_upper; c++)
+    {
+      int hit_lower = hit_start[c] - hit_start[c_lower];
+
+      for (h = hit_lower; h < hit_lower + num_hits[c - c_lower]; h++)
+      {
+        int index = hits[h].index;
+
+        if (ListValueNormalComponentSearch(lines[index], hits[h].point,
+                                           hits[h].component) == NULL)
+        {
+          ListInsert(&lines[index],
+                     NewListMember(hits[h].point, hits[h].component,
+                                   bins->triangles[triangles[c]].id));
+        }
+      }
+    }
+  }
+
+  tfree(num_hits);
+  tfree(hits);
+  tfree(hit_start);
+}
+
+
 /*--------------------------------------------------------------------------
  * GrGeomOctreeFromTIN
  *--------------------------------------------------------------------------*/
@@ -560,10 +1056,8 @@ void GrGeomOctreeFromTIN(
   GrGeomOctree  *solid_octree;
   GrGeomOctree **patch_octrees;
 
-  GeomTriangle  *triangle;
-  GeomVertex    *vertex;
   ListMember  ***xy_lines, ***xz_lines, ***yz_lines;
-  ListMember    *current_member, *tmp_member;
+  ListMember    *current_member;
   GrGeomOctree  *grgeom_octree, *grgeom_child, *patch_octree;
   GrGeomExtents *ea_extents;
 
@@ -573,16 +1067,10 @@ void GrGeomOctreeFromTIN(
   int num_indices, num_triangles;
   int ea_size;
   double dx_lines, dy_lines, dz_lines;
-
-  double v0_x, v0_y, v0_z;
-  double v1_x, v1_y, v1_z;
-  double v2_x, v2_y, v2_z;
-  double octree_v0_x, octree_v0_y, octree_v0_z;
-  double octree_v1_x, octree_v1_y, octree_v1_z;
-  double octree_v2_x, octree_v2_y, octree_v2_z;
-  double tbox_x_lower, tbox_x_upper;
-  double tbox_y_lower, tbox_y_upper;
-  double tbox_z_lower, tbox_z_upper;
+  int           *l_lines_ptrs[3], *u_lines_ptrs[3];
+  double lower[3], d_lines[3];
+  int direction;
+  TINBins *bins;
 
   int nx, ny, nz;
   // SGS there is an error here dz, nz are not being initialized correctly in second loop
@@ -591,19 +1079,16 @@ void GrGeomOctreeFromTIN(
   int ix_lower, iy_lower, iz_lower;
   int ix_upper, iy_upper, iz_upper;
   int index;
-  int intersects, component, state, start_state;
+  int component, state, start_state;
 
   double x_lower, y_lower, z_lower;
   double x_center, y_center, z_center;
   double x_upper, y_upper, z_upper;
-  double point;
 
-  int p, i, j, k, ie, m, n, level, new_level;
+  int p, i, j, k, ie, n, level, new_level;
   int iprime, jprime, kprime, ic, t, face_index = 0;
 
-  int          **patch_table, *patch_table_len;
-  int           *patch_list, *tmp_patch_list;
-  int patch_list_blocksz = 5;
+  int           *patch_table, *patch_table_start;
 
   int           *edge_tag, *triangle_tag;
   unsigned char *interior_tag;
@@ -710,177 +1195,120 @@ void GrGeomOctreeFromTIN(
 
   num_triangles = GeomTINNumTriangles(solid);
 
-  patch_table_len = talloc(int, num_triangles);
-  patch_table = talloc(int *, num_triangles);
+  /* Count the patches of each triangle, then fill the table in
+   * patch order */
+  patch_table_start = ctalloc(int, num_triangles + 1);
+
+  for (p = 0; p < num_patches; p++)
+  {
+    for (n = 0; n < num_patch_triangles[p]; n++)
+    {
+      patch_table_start[patches[p][n] + 1]++;
+    }
+  }
 
   for (n = 0; n < num_triangles; n++)
   {
-    patch_table_len[n] = 0;
-    patch_table[n] = NULL;
+    patch_table_start[n + 1] += patch_table_start[n];
   }
 
+  patch_table = talloc(int, patch_table_start[num_triangles]);
+
   for (p = 0; p < num_patches; p++)
   {
     for (n = 0; n < num_patch_triangles[p]; n++)
     {
       t = patches[p][n];
-      patch_list = patch_table[t];
-      if (!(patch_table_len[t] % patch_list_blocksz))
-      {
-        tmp_patch_list = patch_list;
-        patch_list = ctalloc(int, patch_table_len[t] + patch_list_blocksz);
-        for (m = 0; m < patch_table_len[t]; m++)
-          patch_list[m] = tmp_patch_list[m];
-        tfree(tmp_patch_list);
-      }
-      patch_list[patch_table_len[t]] = p;
-      patch_table[t] = patch_list;
-      patch_table_len[t]++;
+      patch_table[patch_table_start[t]++] = p;
     }
   }
 
+  for (n = num_triangles; n > 0; n--)
+  {
+    patch_table_start[n] = patch_table_start[n - 1];
+  }
+  patch_table_start[0] = 0;
+
   /*-------------------------------------------------------------
-   * Find all unique line intersections
+   * Find all unique line intersections.  The lines of each
+   * direction are only tested against the triangles binned near
+   * the extents, so the cost follows the local extents rather than
+   * the size of the TIN.
    *-------------------------------------------------------------*/
 
-  for (n = 0; n < num_triangles; n++)
-  {
-    /* Get the triangle */
-    triangle = GeomTINTriangle(solid, n);
-
-    /* Get bounds on the cover for the coordinates of vertex 0 */
-    vertex = GeomTINVertex(solid, GeomTriangleV0(triangle));
-    v0_x = GeomVertexX(vertex);
-    v0_y = GeomVertexY(vertex);
-    v0_z = GeomVertexZ(vertex);
-    octree_v0_x = (v0_x - xlower) / dx_lines;
-    octree_v0_y = (v0_y - ylower) / dy_lines;
-    octree_v0_z = (v0_z - zlower) / dz_lines;
-
-    /* Get bounds on the cover for the coordinates of vertex 1 */
-    vertex = GeomTINVertex(solid, GeomTriangleV1(triangle));
-    v1_x = GeomVertexX(vertex);
-    v1_y = GeomVertexY(vertex);
-    v1_z = GeomVertexZ(vertex);
-    octree_v1_x = (v1_x - xlower) / dx_lines;
-    octree_v1_y = (v1_y - ylower) / dy_lines;
-    octree_v1_z = (v1_z - zlower) / dz_lines;
-
-    /* Get bounds on the cover for the coordinates of vertex 2 */
-    vertex = GeomTINVertex(solid, GeomTriangleV2(triangle));
-    v2_x = GeomVertexX(vertex);
-    v2_y = GeomVertexY(vertex);
-    v2_z = GeomVertexZ(vertex);
-    octree_v2_x = (v2_x - xlower) / dx_lines;
-    octree_v2_y = (v2_y - ylower) / dy_lines;
-    octree_v2_z = (v2_z - zlower) / dz_lines;
-
-    /* Get overall bounds for the vertices */
-    tbox_x_lower = pfmin(pfmin(octree_v0_x, octree_v1_x), octree_v2_x);
-    tbox_y_lower = pfmin(pfmin(octree_v0_y, octree_v1_y), octree_v2_y);
-    tbox_z_lower = pfmin(pfmin(octree_v0_z, octree_v1_z), octree_v2_z);
-    tbox_x_upper = pfmax(pfmax(octree_v0_x, octree_v1_x), octree_v2_x);
-    tbox_y_upper = pfmax(pfmax(octree_v0_y, octree_v1_y), octree_v2_y);
-    tbox_z_upper = pfmax(pfmax(octree_v0_z, octree_v1_z), octree_v2_z);
+  lower[0] = xlower;
+  lower[1] = ylower;
+  lower[2] = zlower;
 
-    /* This is to avoid integer overflow below */
-    tbox_x_lower = pfmin(tbox_x_lower, 2 * num_indices);
-    tbox_y_lower = pfmin(tbox_y_lower, 2 * num_indices);
-    tbox_z_lower = pfmin(tbox_z_lower, 2 * num_indices);
-    tbox_x_upper = pfmax(tbox_x_upper, -1);
-    tbox_y_upper = pfmax(tbox_y_upper, -1);
-    tbox_z_upper = pfmax(tbox_z_upper, -1);
+  d_lines[0] = dx_lines;
+  d_lines[1] = dy_lines;
+  d_lines[2] = dz_lines;
+
+  l_lines_ptrs[0] = ixl_lines;
+  l_lines_ptrs[1] = iyl_lines;
+  l_lines_ptrs[2] = izl_lines;
+  u_lines_ptrs[0] = ixu_lines;
+  u_lines_ptrs[1] = iyu_lines;
+  u_lines_ptrs[2] = izu_lines;
 
+  bins = NewTINBins(solid, l_lines_ptrs, u_lines_ptrs, ea_size,
+                    lower, d_lines, num_indices);
+
+  for (direction = XDIRECTION; direction <= ZDIRECTION; direction++)
+  {
     for (ie = 0; ie < ea_size; ie++)
     {
-      /* Intersect bounds with xyz_lines extents */
-      ix_lower = (int)floor((double)pfmax(tbox_x_lower, ixl_lines[ie]));
-      iy_lower = (int)floor((double)pfmax(tbox_y_lower, iyl_lines[ie]));
-      iz_lower = (int)floor((double)pfmax(tbox_z_lower, izl_lines[ie]));
-      ix_upper = (int)ceil((double)pfmin(tbox_x_upper, ixu_lines[ie]));
-      iy_upper = (int)ceil((double)pfmin(tbox_y_upper, iyu_lines[ie]));
-      iz_upper = (int)ceil((double)pfmin(tbox_z_upper, izu_lines[ie]));
-
-      for (j = iy_lower; j <= iy_upper; j++)
+      ListMember **lines;
+      int l_lines[3], u_lines[3], n_lines[3];
+      int query_lower[2], query_upper[2];
+      int *triangles;
+      int num_bin_triangles;
+
+      l_lines[0] = ixl_lines[ie];
+      l_lines[1] = iyl_lines[ie];
+      l_lines[2] = izl_lines[ie];
+      u_lines[0] = ixu_lines[ie];
+      u_lines[1] = iyu_lines[ie];
+      u_lines[2] = izu_lines[ie];
+      n_lines[0] = nx_lines[ie];
+      n_lines[1] = ny_lines[ie];
+      n_lines[2] = nz_lines[ie];
+
+      switch (direction)
       {
-        for (i = ix_lower; i <= ix_upper; i++)
-        {
-          x_center = xlower + i * dx_lines;
-          y_center = ylower + j * dy_lines;
-          IntersectLineWithTriangle(ZDIRECTION, x_center, y_center,
-                                    v0_x, v0_y, v0_z,
-                                    v1_x, v1_y, v1_z,
-                                    v2_x, v2_y, v2_z,
-                                    &intersects, &point, &component);
-          if (intersects)
-          {
-            iprime = i - ixl_lines[ie];
-            jprime = j - iyl_lines[ie];
-            index = iprime + jprime * nx_lines[ie];
-            tmp_member = ListValueNormalComponentSearch(xy_lines[ie][index], point, component);
-            if (tmp_member == NULL)
-            {
-              current_member = NewListMember(point, component, n);
-              ListInsert(&xy_lines[ie][index], current_member);
-            }
-          }
-        }
-      }
+        case XDIRECTION:
+          lines = yz_lines[ie];
+          break;
 
-      for (k = iz_lower; k <= iz_upper; k++)
-      {
-        for (i = ix_lower; i <= ix_upper; i++)
-        {
-          x_center = xlower + i * dx_lines;
-          z_center = zlower + k * dz_lines;
-          IntersectLineWithTriangle(YDIRECTION, x_center, z_center,
-                                    v0_x, v0_y, v0_z,
-                                    v1_x, v1_y, v1_z,
-                                    v2_x, v2_y, v2_z,
-                                    &intersects, &point, &component);
-          if (intersects)
-          {
-            iprime = i - ixl_lines[ie];
-            kprime = k - izl_lines[ie];
-            index = iprime + kprime * nx_lines[ie];
-            tmp_member = ListValueNormalComponentSearch(xz_lines[ie][index], point, component);
-            if (tmp_member == NULL)
-            {
-              current_member = NewListMember(point, component, n);
-              ListInsert(&xz_lines[ie][index], current_member);
-            }
-          }
-        }
+        case YDIRECTION:
+          lines = xz_lines[ie];
+          break;
+
+        default:
+          lines = xy_lines[ie];
+          break;
       }
 
-      for (k = iz_lower; k <= iz_upper; k++)
+      for (i = 0; i < 2; i++)
       {
-        for (j = iy_lower; j <= iy_upper; j++)
-        {
-          y_center = ylower + j * dy_lines;
-          z_center = zlower + k * dz_lines;
-          IntersectLineWithTriangle(XDIRECTION, y_center, z_center,
-                                    v0_x, v0_y, v0_z,
-                                    v1_x, v1_y, v1_z,
-                                    v2_x, v2_y, v2_z,
-                                    &intersects, &point, &component);
-          if (intersects)
-          {
-            jprime = j - iyl_lines[ie];
-            kprime = k - izl_lines[ie];
-            index = jprime + kprime * ny_lines[ie];
-            tmp_member = ListValueNormalComponentSearch(yz_lines[ie][index], point, component);
-            if (tmp_member == NULL)
-            {
-              current_member = NewListMember(point, component, n);
-              ListInsert(&yz_lines[ie][index], current_member);
-            }
-          }
-        }
+        query_lower[i] = l_lines[bins[direction].axis[i]];
+        query_upper[i] = u_lines[bins[direction].axis[i]];
       }
+
+      triangles = TINBinsQuery(&(bins[direction]), query_lower, query_upper,
+                               &num_bin_triangles);
+
+      IntersectLinesWithTINTriangles(solid, direction, &(bins[direction]),
+                                     triangles, num_bin_triangles, lines,
+                                     l_lines, u_lines, n_lines,
+                                     lower, d_lines, num_indices);
+
+      tfree(triangles);
     }
   }
 
+  FreeTINBins(bins);
+
   /*-------------------------------------------------------------
    * Create the octree, by first adding the boundary faces
    *-------------------------------------------------------------*/
@@ -1007,9 +1435,9 @@ void GrGeomOctreeFromTIN(
                                   edge_tag[k]);
 
               t = triangle_tag[k];
-              for (p = 0; p < patch_table_len[t]; p++)
+              for (p = patch_table_start[t]; p < patch_table_start[t + 1]; p++)
               {
-                patch_octree = patch_octrees[patch_table[t][p]];
+                patch_octree = patch_octrees[patch_table[p]];
                 GrGeomOctreeAddFace(patch_octree, ZDIRECTION,
                                     i, j, k, iz_lower, iz_upper, level,
                                     edge_tag[k]);
@@ -1115,9 +1543,9 @@ void GrGeomOctreeFromTIN(
                                   edge_tag[j]);
 
               t = triangle_tag[j];
-              for (p = 0; p < patch_table_len[t]; p++)
+              for (p = patch_table_start[t]; p < patch_table_start[t + 1]; p++)
               {
-                patch_octree = patch_octrees[patch_table[t][p]];
+                patch_octree = patch_octrees[patch_table[p]];
                 GrGeomOctreeAddFace(patch_octree, YDIRECTION,
                                     i, k, j, iy_lower, iy_upper, level,
                                     edge_tag[j]);
@@ -1223,9 +1651,9 @@ void GrGeomOctreeFromTIN(
                                   edge_tag[i]);
 
               t = triangle_tag[i];
-              for (p = 0; p < patch_table_len[t]; p++)
+              for (p = patch_table_start[t]; p < patch_table_start[t + 1]; p++)
               {
-                patch_octree = patch_octrees[patch_table[t][p]];
+                patch_octree = patch_octrees[patch_table[p]];
                 GrGeomOctreeAddFace(patch_octree, XDIRECTION,
                                     j, k, i, ix_lower, ix_upper, level,
                                     edge_tag[i]);
@@ -1512,10 +1940,8 @@ void GrGeomOctreeFromTIN(
   tfree(iyl_lines);
   tfree(izl_lines);
 
-  for (n = 0; n < num_triangles; n++)
-    tfree(patch_table[n]);
   tfree(patch_table);
-  tfree(patch_table_len);
+  tfree(patch_table_start);
 
   /*-------------------------------------------------------------
    * Label branch nodes in octrees
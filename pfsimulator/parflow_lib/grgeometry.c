@@ -321,10 +321,6 @@ GrGeomSolid   *GrGeomNewSolid(
     }
   }
 
-  if (GlobalsUseClustering)
-  {
-    ComputeBoxes(new_grgeomsolid);
-  }
   return new_grgeomsolid;
 }
 
@@ -416,6 +412,11 @@ void             GrGeomSolidFromInd(
                       octree_bg_level, ix, iy, iz);
 
   *solid_ptr = GrGeomNewSolid(solid_octree, NULL, 0, octree_bg_level, ix, iy, iz);
+
+  if (GlobalsUseClustering)
+  {
+    ComputeBoxes(*solid_ptr);
+  }
 }
 
 
@@ -435,6 +436,8 @@ void                GrGeomSolidFromGeom(
   int num_patches = 0;
   int octree_bg_level = 0, ix, iy, iz;
 
+  char           *cache_filename = NULL;
+
 
   /*------------------------------------------------------
    * Convert to GrGeomOctree format
@@ -461,6 +464,15 @@ void                GrGeomSolidFromGeom(
       octree_bg_level = GrGeomGetOctreeInfo(&xl, &yl, &zl, &xu, &yu, &zu,
                                             &ix, &iy, &iz);
 
+      /* Reuse the octrees and boxes of an earlier run if cached */
+      cache_filename = GrGeomCacheFilename(solid_data, extent_array,
+                                           octree_bg_level);
+      if (cache_filename && GrGeomCacheRead(solid_ptr, cache_filename))
+      {
+        tfree(cache_filename);
+        return;
+      }
+
       GrGeomOctreeFromTIN(&solid_octree, &patch_octrees,
                           surface, patches, num_patches, num_patch_triangles,
                           extent_array, xl, yl, zl, xu, yu, zu,
@@ -474,6 +486,17 @@ void                GrGeomSolidFromGeom(
   solid = GrGeomNewSolid(solid_octree, patch_octrees, num_patches,
                          octree_bg_level, ix, iy, iz);
 
+  if (GlobalsUseClustering)
+  {
+    ComputeBoxes(solid);
+  }
+
+  if (cache_filename)
+  {
+    GrGeomCacheWrite(solid, cache_filename);
+    tfree(cache_filename);
+  }
+
   *solid_ptr = solid;
 }
 
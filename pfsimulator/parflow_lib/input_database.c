@@ -29,6 +29,8 @@
 #include "parflow.h"
 
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
 
 /** Whitespace characters */
 #define NA_WHITE_SPACE " \t\n"
@@ -38,9 +40,6 @@ void IDB_Print(FILE *file, void *obj)
 {
   IDB_Entry *entry = (IDB_Entry*)obj;
 
-  if (!entry->used)
-    fprintf(file, "# Not used\n");
-
   fprintf(file, "pfset %s \"%s\"\n", entry->key, entry->value);
 }
 
@@ -56,11 +55,122 @@ void IDB_Free(void *obj)
 {
   IDB_Entry *a = (IDB_Entry*)obj;
 
+  /* Entries read from the file are freed with the database */
+  if (a->in_buffer)
+    return;
+
   free(a->key);
   free(a->value);
   free(a);
 }
 
+/*
+ * FNV-1a hash of a key for the database index.
+ */
+static unsigned int IDB_Hash(const char *key)
+{
+  unsigned int hash = 2166136261u;
+
+  while (*key)
+  {
+    hash ^= (unsigned char)*key++;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+/*
+ * Find the entry for key using the hash index, NULL if not found.
+ */
+static IDB_Entry *IDB_Lookup(IDB *database, const char *key)
+{
+  unsigned int mask = database->index_size - 1;
+  unsigned int slot;
+  IDB_Entry *entry;
+
+  if (database->index_size == 0)
+    return NULL;
+
+  slot = IDB_Hash(key) & mask;
+  while ((entry = database->index[slot]) != NULL)
+  {
+    if (strcmp(entry->key, key) == 0)
+      return entry;
+    slot = (slot + 1) & mask;
+  }
+
+  return NULL;
+}
+
+static void IDB_IndexAdd(IDB *database, IDB_Entry *entry)
+{
+  unsigned int mask = database->index_size - 1;
+  unsigned int slot = IDB_Hash(entry->key) & mask;
+
+  while (database->index[slot] != NULL)
+    slot = (slot + 1) & mask;
+
+  database->index[slot] = entry;
+}
+
+/*
+ * Add an entry to the tree and the index and give it a bit in the used
+ * bitmap.  Returns 0 if the key is already in the database; the first
+ * value given for a key is kept.
+ */
+static int IDB_Insert(IDB *database, IDB_Entry *entry)
+{
+  if (HBT_insert(database->tree, entry, 0) != HBT_INSERTED)
+    return 0;
+
+  entry->id = database->num_entries++;
+
+  /* Keep the index at most half full */
+  if (2 * (unsigned int)database->num_entries > database->index_size)
+  {
+    IDB_Entry **old_index = database->index;
+    unsigned int old_size = database->index_size;
+    unsigned int slot;
+
+    database->index_size = (old_size) ? 2 * old_size : 64;
+    while (2 * (unsigned int)database->num_entries > database->index_size)
+      database->index_size *= 2;
+    database->index = ctalloc(IDB_Entry *, database->index_size);
+
+    for (slot = 0; slot < old_size; slot++)
+    {
+      if (old_index[slot])
+        IDB_IndexAdd(database, old_index[slot]);
+    }
+
+    tfree(old_index);
+  }
+
+  IDB_IndexAdd(database, entry);
+
+  if ((entry->id / 8) >= database->used_size)
+  {
+    int old_size = database->used_size;
+
+    database->used_size = (entry->id / 8 + 1) * 2;
+    database->used = (unsigned char*)realloc(database->used, (size_t)database->used_size);
+    memset(database->used + old_size, 0, (size_t)(database->used_size - old_size));
+  }
+
+  return 1;
+}
+
+static void IDB_MarkUsed(IDB *database, IDB_Entry *entry)
+{
+  database->used[entry->id / 8] |= (unsigned char)(1 << (entry->id % 8));
+}
+
+int IDB_EntryUsed(IDB *database, IDB_Entry *entry)
+{
+  return (database->used[entry->id / 8] >> (entry->id % 8)) & 1;
+}
+
 IDB_Entry *IDB_NewEntry(char *key, char *value)
 {
   IDB_Entry *a;
@@ -73,96 +183,224 @@ IDB_Entry *IDB_NewEntry(char *key, char *value)
   return a;
 }
 
+/*
+ * Reads an integer from the file contents, skipping whitespace before and
+ * after it as the "%d " conversion used by amps_SFBCast does.
+ */
+static int IDB_ScanInt(char **cursor, char *end, int *value)
+{
+  char *ptr = *cursor;
+  char *int_end;
+  long result;
+
+  while ((ptr < end) && isspace((unsigned char)*ptr))
+    ptr++;
+
+  result = strtol(ptr, &int_end, 10);
+  if ((int_end == ptr) || (int_end > end) || (result < 0) || (result > INT_MAX))
+    return 0;
+
+  ptr = int_end;
+  while ((ptr < end) && isspace((unsigned char)*ptr))
+    ptr++;
+
+  *value = (int)result;
+  *cursor = ptr;
+
+  return 1;
+}
+
+/*
+ * Returns a pointer to the next len characters of the file contents and
+ * terminates them in place by overwriting the whitespace that follows.
+ */
+static char *IDB_ScanString(char **cursor, char *end, int len)
+{
+  static char empty[] = "";
+  char *str = *cursor;
+
+  /* The whitespace after an empty string was consumed with its length */
+  if (len == 0)
+    return empty;
+
+  if (len > end - str)
+    return NULL;
+
+  if ((str + len < end) && !isspace((unsigned char)str[len]))
+    return NULL;
+
+  str[len] = '\0';
+  *cursor = (str + len < end) ? str + len + 1 : end;
+
+  return str;
+}
+
 IDB *IDB_NewDB(char *filename)
 {
   int num_entries;
-  amps_Invoice invoice;
+  int buffer_len;
 
   IDB *db;
   IDB_Entry *entry;
 
-  char key[IDB_MAX_KEY_LEN];
-  char value[IDB_MAX_VALUE_LEN];
+  char *cursor;
+  char *end;
 
   int key_len;
   int value_len;
 
   int i;
 
-  amps_File file;
-
   /* Initialize the db structure */
-  db = (IDB*)HBT_new(IDB_Compare,
+  db = ctalloc(IDB, 1);
+  db->tree = HBT_new(IDB_Compare,
                      IDB_Free,
                      IDB_Print,
                      NULL,
                      0);
 
-  if ((file = amps_SFopen(filename, "r")) == NULL)
+  /* Read the whole file on the first process */
+  buffer_len = -1;
+  if (!amps_Rank(amps_CommWorld))
+  {
+    FILE *file;
+
+    if ((file = fopen(filename, "rb")) != NULL)
+    {
+      long file_len;
+
+      if ((fseek(file, 0, SEEK_END) == 0) &&
+          ((file_len = ftell(file)) >= 0) && (file_len < INT_MAX) &&
+          (fseek(file, 0, SEEK_SET) == 0))
+      {
+        db->buffer = talloc(char, file_len + 1);
+        if (fread(db->buffer, 1, (size_t)file_len, file) == (size_t)file_len)
+        {
+          buffer_len = (int)file_len;
+        }
+      }
+      fclose(file);
+    }
+  }
+
+  /* Send the file contents to all processes in one broadcast */
+#ifdef PARFLOW_HAVE_MPI
+  MPI_Bcast(&buffer_len, 1, MPI_INT, 0, amps_CommWorld);
+#else
+  {
+    amps_Invoice invoice = amps_NewInvoice("%i", &buffer_len);
+    amps_BCast(amps_CommWorld, 0, invoice);
+    amps_FreeInvoice(invoice);
+  }
+#endif
+
+  if (buffer_len < 0)
   {
     InputError("Error: can't open file %s%s\n", filename, "");
   }
 
-  /* Read in the number of items in the database */
-  invoice = amps_NewInvoice("%i", &num_entries);
-  amps_SFBCast(amps_CommWorld, file, invoice);
-  amps_FreeInvoice(invoice);
+  if (amps_Rank(amps_CommWorld))
+  {
+    db->buffer = talloc(char, buffer_len + 1);
+  }
+
+#ifdef PARFLOW_HAVE_MPI
+  MPI_Bcast(db->buffer, buffer_len, MPI_CHAR, 0, amps_CommWorld);
+#else
+  {
+    amps_Invoice invoice = amps_NewInvoice("%&c", &buffer_len, db->buffer);
+    amps_BCast(amps_CommWorld, 0, invoice);
+    amps_FreeInvoice(invoice);
+  }
+#endif
+
+  db->buffer[buffer_len] = '\0';
+
+  /* Parse the contents in place; keys and values point into the buffer */
+  cursor = db->buffer;
+  end = db->buffer + buffer_len;
+
+  if (!IDB_ScanInt(&cursor, end, &num_entries))
+  {
+    InputError("Error: can't read the number of entries from file %s%s\n", filename, "");
+  }
+
+  db->entries = ctalloc(IDB_Entry, num_entries);
 
-  /* Read in each of the items in the file and put them in the HBT */
-  invoice = amps_NewInvoice("%i%&c%i%&c", &key_len, &key_len, key,
-                            &value_len, &value_len, value);
   for (i = 0; i < num_entries; i++)
   {
-    /* Read the key and value from the input file */
-    amps_SFBCast(amps_CommWorld, file, invoice);
+    entry = &(db->entries[i]);
+    entry->in_buffer = 1;
+
+    if (!IDB_ScanInt(&cursor, end, &key_len) ||
+        !(entry->key = IDB_ScanString(&cursor, end, key_len)) ||
+        !IDB_ScanInt(&cursor, end, &value_len))
+    {
+      InputError("Error: input database file %s is corrupt%s\n", filename, "");
+    }
+
     if ((value_len + 1) > IDB_MAX_VALUE_LEN)
     {
-      key[key_len] = '\0';
       char s[128];
       sprintf(s, "%d", IDB_MAX_VALUE_LEN - 1);
       InputError("Error: The value associated with input database "
                  "key <%s> is too long. The maximum length is %s. ",
-                 key, s);
+                 entry->key, s);
     }
-    key[key_len] = '\0';
-    value[value_len] = '\0';
 
-    /* Create an new entry */
-    entry = IDB_NewEntry(key, value);
+    if (!(entry->value = IDB_ScanString(&cursor, end, value_len)))
+    {
+      InputError("Error: input database file %s is corrupt%s\n", filename, "");
+    }
 
-    /* Insert into the height balanced tree */
-    HBT_insert(db, entry, 0);
+    /* Insert into the database */
+    IDB_Insert(db, entry);
   }
 
-  amps_FreeInvoice(invoice);
-
-  amps_SFclose(file);
-
   return db;
 }
 
 void IDB_FreeDB(IDB *database)
 {
-  HBT_free(database);
+  HBT_free(database->tree);
+  tfree(database->index);
+  free(database->used);
+  tfree(database->entries);
+  tfree(database->buffer);
+  tfree(database);
+}
+
+static void IDB_PrintUsageTree(FILE *file, IDB *database, HBT_element *element)
+{
+  if (element == NULL)
+    return;
+
+  IDB_PrintUsageTree(file, database, element->left);
+
+  if (!IDB_EntryUsed(database, (IDB_Entry*)element->obj))
+    fprintf(file, "# Not used\n");
+  IDB_Print(file, element->obj);
+
+  IDB_PrintUsageTree(file, database, element->right);
 }
 
 void IDB_PrintUsage(FILE *file, IDB *database)
 {
-  HBT_printf(file, database);
+  fprintf(file, "# %d\n", database->tree->height);
+  fprintf(file, "# %d\n", database->tree->num);
+
+  IDB_PrintUsageTree(file, database, database->tree->root);
 }
 
 char *IDB_GetString(IDB *database, const char *key)
 {
-  IDB_Entry lookup_entry;
   IDB_Entry *result;
 
-  lookup_entry.key = (char*)key;
-
-  result = (IDB_Entry*)HBT_lookup(database, &lookup_entry);
+  result = IDB_Lookup(database, key);
 
   if (result)
   {
-    result->used = 1;
+    IDB_MarkUsed(database, result);
     return result->value;
   }
   else
@@ -176,27 +414,23 @@ char *IDB_GetStringDefault(IDB *       database,
                            const char *key,
                            char *      default_value)
 {
-  IDB_Entry lookup_entry;
   IDB_Entry *result;
   IDB_Entry *entry;
 
-  lookup_entry.key = (char*)key;
-
-  result = (IDB_Entry*)HBT_lookup(database, &lookup_entry);
+  result = IDB_Lookup(database, key);
 
   if (result)
   {
-    result->used = 1;
+    IDB_MarkUsed(database, result);
     return result->value;
   }
   else
   {
     /* Create an new entry */
     entry = IDB_NewEntry((char*)key, default_value);
-    entry->used = 1;
-
-    /* Insert into the height balanced tree */
-    HBT_insert(database, entry, 0);
+    /* Insert into the database */
+    IDB_Insert(database, entry);
+    IDB_MarkUsed(database, entry);
 
     return default_value;
   }
@@ -206,13 +440,10 @@ double IDB_GetDoubleDefault(IDB *       database,
                             const char *key,
                             double      default_value)
 {
-  IDB_Entry lookup_entry;
   IDB_Entry *result;
   double value;
 
-  lookup_entry.key = (char*)key;
-
-  result = (IDB_Entry*)HBT_lookup(database, &lookup_entry);
+  result = IDB_Lookup(database, key);
 
   if (result)
   {
@@ -221,7 +452,7 @@ double IDB_GetDoubleDefault(IDB *       database,
       InputError("Error: The key <%s> is not a valid double: value is <%s>\n", key, result->value);
     }
 
-    result->used = 1;
+    IDB_MarkUsed(database, result);
     return value;
   }
   else
@@ -236,10 +467,10 @@ double IDB_GetDoubleDefault(IDB *       database,
 
     /* Create an new entry */
     entry = IDB_NewEntry((char*)key, default_string);
-    entry->used = 1;
 
-    /* Insert into the height balanced tree */
-    HBT_insert(database, entry, 0);
+    /* Insert into the database */
+    IDB_Insert(database, entry);
+    IDB_MarkUsed(database, entry);
 
     return default_value;
   }
@@ -247,13 +478,10 @@ double IDB_GetDoubleDefault(IDB *       database,
 
 double IDB_GetDouble(IDB *database, const char *key)
 {
-  IDB_Entry lookup_entry;
   IDB_Entry *result;
   double value;
 
-  lookup_entry.key = (char*)key;
-
-  result = (IDB_Entry*)HBT_lookup(database, &lookup_entry);
+  result = IDB_Lookup(database, key);
 
   if (result)
   {
@@ -263,7 +491,7 @@ double IDB_GetDouble(IDB *database, const char *key)
                  key, result->value);
     }
 
-    result->used = 1;
+    IDB_MarkUsed(database, result);
     return value;
   }
   else
@@ -278,13 +506,10 @@ int IDB_GetIntDefault(IDB *       database,
                       const char *key,
                       int         default_value)
 {
-  IDB_Entry lookup_entry;
   IDB_Entry *result;
   int value;
 
-  lookup_entry.key = (char*)key;
-
-  result = (IDB_Entry*)HBT_lookup(database, &lookup_entry);
+  result = IDB_Lookup(database, key);
 
   if (result)
   {
@@ -294,7 +519,7 @@ int IDB_GetIntDefault(IDB *       database,
                  key, result->value);
     }
 
-    result->used = 1;
+    IDB_MarkUsed(database, result);
     return value;
   }
   else
@@ -309,10 +534,10 @@ int IDB_GetIntDefault(IDB *       database,
 
     /* Create an new entry */
     entry = IDB_NewEntry((char*)key, default_string);
-    entry->used = 1;
 
-    /* Insert into the height balanced tree */
-    HBT_insert(database, entry, 0);
+    /* Insert into the database */
+    IDB_Insert(database, entry);
+    IDB_MarkUsed(database, entry);
 
     return default_value;
   }
@@ -320,13 +545,10 @@ int IDB_GetIntDefault(IDB *       database,
 
 int IDB_GetInt(IDB *database, const char *key)
 {
-  IDB_Entry lookup_entry;
   IDB_Entry *result;
   int value;
 
-  lookup_entry.key = (char*)key;
-
-  result = (IDB_Entry*)HBT_lookup(database, &lookup_entry);
+  result = IDB_Lookup(database, key);
 
   if (result)
   {
@@ -336,7 +558,7 @@ int IDB_GetInt(IDB *database, const char *key)
                  key, result->value);
     }
 
-    result->used = 1;
+    IDB_MarkUsed(database, result);
     return value;
   }
   else
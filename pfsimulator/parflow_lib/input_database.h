@@ -50,15 +50,36 @@ typedef struct _IDB_Entry {
   char *key;
   char *value;
 
-  /* Flag indicating if the key was used */
-  char used;
+  /* Index of the entry's bit in the database used bitmap */
+  int id;
+
+  /* Flag indicating the key and value point into the database file buffer */
+  char in_buffer;
 } IDB_Entry;
 
 /**
- * The input database type.  Currently uses a HBT (height balanced tree) for
- * storage.
+ * The input database type.  Entries are stored in a HBT (height balanced
+ * tree), which keeps them ordered for printing, and are found through an
+ * open addressing hash index.  Whether a key was used during the run is
+ * kept in a bitmap indexed by the entry id.
+ *
+ * Entries read from the input file are allocated as a single block and
+ * their keys and values point into the file contents, which are kept in
+ * buffer for the lifetime of the database.
  */
-typedef HBT IDB;
+typedef struct _IDB {
+  HBT *tree;
+
+  IDB_Entry **index;
+  unsigned int index_size;
+
+  int num_entries;
+  unsigned char *used;
+  int used_size;
+
+  char *buffer;
+  IDB_Entry *entries;
+} IDB;
 
 /**
  * NameArray is a specialized string array used in ParFlow input parsing.
@@ -76,8 +97,6 @@ typedef NameArrayStruct *NameArray;
 /**
  * Prints out a database entry.
  *
- * If it was not used during a run it is flagged as being unused.
- *
  * @param file File pointer
  * @param entry The entry to print
  * @return void
@@ -116,10 +135,23 @@ void IDB_Free(void *a);
  */
 IDB_Entry *IDB_NewEntry(char *key, char *value);
 
+/**
+ * Returns true if the key for entry was used during the run.
+ *
+ * @param database The database containing entry
+ * @param entry The entry to check
+ * @return Non-zero if the key was used
+ */
+int IDB_EntryUsed(IDB *database, IDB_Entry *entry);
+
 /**
  * Read in an input database from a flat file.  The returned database
  * can be then used for querying of user input options.
  *
+ * The file is read by the first process and its contents are sent to
+ * all processes in a single broadcast; each process then parses the
+ * contents locally.
+ *
  * A return of NULL indicates and error occurred while reading the database.
  *
  * @param filename The name of the input file containing the database [IN]
@@ -28,9 +28,11 @@
 #if defined (PARFLOW_HAVE_SUNDIALS)
 #include "kinsol/kinsol.h"
 #include <sunlinsol/sunlinsol_spgmr.h> /* access to SPGMR SUNLinearSolver      */
+#include <sunlinsol/sunlinsol_spbcgs.h> /* access to SPBCGS SUNLinearSolver    */
 #else
 #include "../kinsol/kinsol.h"
 #include "../kinsol/iterativ.h"
 #include "../kinsol/kinspgmr.h"
 #include "../kinsol/spgmr.h"
+#include "../kinsol/spbcgp.h"
 #endif
@@ -36,6 +36,8 @@
 typedef struct {
   int max_iter;
   int krylov_dimension;
+  int gs_type;
+  int krylov_method;
   int max_restarts;
   int print_flag;
   int eta_choice;
@@ -294,7 +296,7 @@ void PrintFinalStats(
  * KinsolNonlinSolver
  *--------------------------------------------------------------------------*/
 
-int KinsolNonlinSolver(Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity, Vector *q_overlnd_x, Vector *q_overlnd_y)
+int KinsolNonlinSolver(Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity, Vector *q_overlnd_x, Vector *q_overlnd_y, NonlinSolverStats *stats)
 {
   PFModule     *this_module = ThisPFModule;
   PublicXtra   *public_xtra = (PublicXtra*)PFModulePublicXtra(this_module);
@@ -401,6 +403,12 @@ int KinsolNonlinSolver(Vector *pressure, Vector *density, Vector *old_density, V
   instance_xtra->tot_beta_cond_fails += instance_xtra->num_beta_cond_fails;
   instance_xtra->tot_backtracks += instance_xtra->num_backtracks;
 
+  if (stats)
+  {
+    stats->nonlin_iters = (int)instance_xtra->num_nonlin_iters;
+    stats->lin_iters = (int)instance_xtra->num_lin_iters;
+  }
+
   if (!amps_Rank(amps_CommWorld))
     PrintFinalStats(kinsol_file, instance_xtra);
 
@@ -436,6 +444,12 @@ int KinsolNonlinSolver(Vector *pressure, Vector *density, Vector *old_density, V
   integer_outputs[SPGMR_NPS] += iopt[SPGMR_NPS];
   integer_outputs[SPGMR_NCFL] += iopt[SPGMR_NCFL];
 
+  if (stats)
+  {
+    stats->nonlin_iters = (int)iopt[NNI];
+    stats->lin_iters = (int)iopt[SPGMR_NLI];
+  }
+
   if (!amps_Rank(amps_CommWorld))
     PrintFinalStats(kinsol_file, iopt, integer_outputs);
 
@@ -624,8 +638,19 @@ PFModule  *KinsolNonlinSolverInitInstanceXtra(
     KINSetScaledStepTol(kin_mem, public_xtra->step_tol);
 
     /* Create SUNDIALS linear solver object for kinsol */
-    LS = SUNLinSol_SPGMR(uscale, SUN_PREC_RIGHT, krylov_dimension, sunctx);
-    SUNLinSol_SPGMRSetMaxRestarts(LS, max_restarts);
+    if (public_xtra->krylov_method == SUNLINEARSOLVER_SPBCGS)
+    {
+      /* SUNDIALS has no pipelined BiCGStab; use its standard BiCGStab
+       * with the same iteration budget */
+      LS = SUNLinSol_SPBCGS(uscale, SUN_PREC_RIGHT,
+                            krylov_dimension * (max_restarts + 1), sunctx);
+    }
+    else
+    {
+      LS = SUNLinSol_SPGMR(uscale, SUN_PREC_RIGHT, krylov_dimension, sunctx);
+      SUNLinSol_SPGMRSetMaxRestarts(LS, max_restarts);
+      SUNLinSol_SPGMRSetGSType(LS, public_xtra->gs_type);
+    }
     /* Attach linear solver to KINSol */
     KINSetLinearSolver(kin_mem, LS, NULL);
     KINSetPreconditioner(kin_mem, pcinit, pcsolve);
@@ -660,6 +685,8 @@ PFModule  *KinsolNonlinSolverInitInstanceXtra(
              matvec,                   /* ATimes routine */
              current_state             /* User data for PC stuff */
              );
+    KINSpgmrSetGSType((void*)kin_mem, public_xtra->gs_type);
+    KINSpgmrSetKrylovType((void*)kin_mem, public_xtra->krylov_method);
 
     /* Initialize optional arguments for KINSol */
     iopt = instance_xtra->int_optional_input;
@@ -792,6 +819,93 @@ PFModule  *KinsolNonlinSolverNewPublicXtra()
   sprintf(key, "Solver.Linear.MaxRestarts");
   (public_xtra->max_restarts) = GetIntDefault(key, 0);
 
+  switch_na = NA_NewNameArray("ModifiedGS ClassicalGS CGS2");
+  sprintf(key, "Solver.Linear.Orthogonalization");
+  switch_name = GetStringDefault(key, "ModifiedGS");
+  switch_value = NA_NameToIndexExitOnError(switch_na, switch_name, key);
+  switch (switch_value)
+  {
+#if defined (PARFLOW_HAVE_SUNDIALS)
+    /* SUNDIALS has no CGS2; its classical Gram-Schmidt reorthogonalizes
+     * when needed and uses the fused dot products of the PF N_Vector */
+    case 0:
+    {
+      public_xtra->gs_type = SUN_MODIFIED_GS;
+      break;
+    }
+
+    case 1:
+    case 2:
+    {
+      public_xtra->gs_type = SUN_CLASSICAL_GS;
+      break;
+    }
+#else
+    case 0:
+    {
+      public_xtra->gs_type = MODIFIED_GS;
+      break;
+    }
+
+    case 1:
+    {
+      public_xtra->gs_type = CLASSICAL_GS;
+      break;
+    }
+
+    case 2:
+    {
+      public_xtra->gs_type = CLASSICAL_GS2;
+      break;
+    }
+#endif
+
+    default:
+    {
+      InputError("Invalid switch value <%s> for key <%s>", switch_name, key);
+    }
+  }
+  NA_FreeNameArray(switch_na);
+
+  switch_na = NA_NewNameArray("GMRES PipelinedBiCGStab");
+  sprintf(key, "Solver.Linear.KrylovMethod");
+  switch_name = GetStringDefault(key, "GMRES");
+  switch_value = NA_NameToIndexExitOnError(switch_na, switch_name, key);
+  switch (switch_value)
+  {
+#if defined (PARFLOW_HAVE_SUNDIALS)
+    case 0:
+    {
+      public_xtra->krylov_method = SUNLINEARSOLVER_SPGMR;
+      break;
+    }
+
+    case 1:
+    {
+      public_xtra->krylov_method = SUNLINEARSOLVER_SPBCGS;
+      break;
+    }
+#else
+    case 0:
+    {
+      public_xtra->krylov_method = SPGMR_KRYLOV;
+      break;
+    }
+
+    case 1:
+    {
+      public_xtra->krylov_method = SPBCGP_KRYLOV;
+      break;
+    }
+#endif
+
+    default:
+    {
+      InputError("Invalid switch value <%s> for key <%s>", switch_name, key);
+    }
+  }
+  NA_FreeNameArray(switch_na);
+
   verbosity_switch_na = NA_NewNameArray("NoVerbosity LowVerbosity "
                                         "NormalVerbosity HighVerbosity");
   sprintf(key, "Solver.Nonlinear.PrintFlag");
@@ -150,14 +150,12 @@ void            Matvec(
 
 #ifndef NO_VECTOR_UPDATE
 #ifdef VECTOR_UPDATE_TIMING
-        BeginTiming(VectorUpdateTimingIndex);
         EventTiming[NumEvents][InitStart] = amps_Clock();
 #endif
         handle = InitVectorUpdate(x, VectorUpdateAll);
 
 #ifdef VECTOR_UPDATE_TIMING
         EventTiming[NumEvents][InitEnd] = amps_Clock();
-        EndTiming(VectorUpdateTimingIndex);
 #endif
 #endif
 
@@ -222,14 +220,12 @@ void            Matvec(
 
 #ifndef NO_VECTOR_UPDATE
 #ifdef VECTOR_UPDATE_TIMING
-        BeginTiming(VectorUpdateTimingIndex);
         EventTiming[NumEvents][FinalizeStart] = amps_Clock();
 #endif
         FinalizeVectorUpdate(handle);
 
 #ifdef VECTOR_UPDATE_TIMING
         EventTiming[NumEvents][FinalizeEnd] = amps_Clock();
-        EndTiming(VectorUpdateTimingIndex);
 #endif
 #endif
 
@@ -459,14 +455,12 @@ void            MatvecSubMat(
 
 #ifndef NO_VECTOR_UPDATE
 #ifdef VECTOR_UPDATE_TIMING
-        BeginTiming(VectorUpdateTimingIndex);
         EventTiming[NumEvents][InitStart] = amps_Clock();
 #endif
         handle = InitVectorUpdate(x, VectorUpdateAll);
 
 #ifdef VECTOR_UPDATE_TIMING
         EventTiming[NumEvents][InitEnd] = amps_Clock();
-        EndTiming(VectorUpdateTimingIndex);
 #endif
 #endif
 
@@ -530,14 +524,12 @@ void            MatvecSubMat(
 
 #ifndef NO_VECTOR_UPDATE
 #ifdef VECTOR_UPDATE_TIMING
-        BeginTiming(VectorUpdateTimingIndex);
         EventTiming[NumEvents][FinalizeStart] = amps_Clock();
 #endif
         FinalizeVectorUpdate(handle);
 
 #ifdef VECTOR_UPDATE_TIMING
         EventTiming[NumEvents][FinalizeEnd] = amps_Clock();
-        EndTiming(VectorUpdateTimingIndex);
 #endif
 #endif
 
@@ -802,14 +794,12 @@ void            MatvecJacF(
 
 #ifndef NO_VECTOR_UPDATE
 #ifdef VECTOR_UPDATE_TIMING
-        BeginTiming(VectorUpdateTimingIndex);
         EventTiming[NumEvents][InitStart] = amps_Clock();
 #endif
         handle = InitVectorUpdate(x, VectorUpdateAll);
 
 #ifdef VECTOR_UPDATE_TIMING
         EventTiming[NumEvents][InitEnd] = amps_Clock();
-        EndTiming(VectorUpdateTimingIndex);
 #endif
 #endif
 
@@ -873,14 +863,12 @@ void            MatvecJacF(
 
 #ifndef NO_VECTOR_UPDATE
 #ifdef VECTOR_UPDATE_TIMING
-        BeginTiming(VectorUpdateTimingIndex);
         EventTiming[NumEvents][FinalizeStart] = amps_Clock();
 #endif
         FinalizeVectorUpdate(handle);
 
 #ifdef VECTOR_UPDATE_TIMING
         EventTiming[NumEvents][FinalizeEnd] = amps_Clock();
-        EndTiming(VectorUpdateTimingIndex);
 #endif
 #endif
 
@@ -1138,14 +1126,12 @@ void            MatvecJacE(
 
 #ifndef NO_VECTOR_UPDATE
 #ifdef VECTOR_UPDATE_TIMING
-        BeginTiming(VectorUpdateTimingIndex);
         EventTiming[NumEvents][InitStart] = amps_Clock();
 #endif
         handle = InitVectorUpdate(x, VectorUpdateAll);
 
 #ifdef VECTOR_UPDATE_TIMING
         EventTiming[NumEvents][InitEnd] = amps_Clock();
-        EndTiming(VectorUpdateTimingIndex);
 #endif
 #endif
 
@@ -1209,14 +1195,12 @@ void            MatvecJacE(
 
 #ifndef NO_VECTOR_UPDATE
 #ifdef VECTOR_UPDATE_TIMING
-        BeginTiming(VectorUpdateTimingIndex);
         EventTiming[NumEvents][FinalizeStart] = amps_Clock();
 #endif
         FinalizeVectorUpdate(handle);
 
 #ifdef VECTOR_UPDATE_TIMING
         EventTiming[NumEvents][FinalizeEnd] = amps_Clock();
-        EndTiming(VectorUpdateTimingIndex);
 #endif
 #endif
 
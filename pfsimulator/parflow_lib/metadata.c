@@ -208,27 +208,27 @@ void MetadataAddParflowDomainInfo(cJSON* pf, PFModule* solver, Grid* localGrid)
   free(gkdivs);
 }
 
-static void cJSON_AddIDBEntries(cJSON* json, HBT_element* info, int onlyUsed)
+static void cJSON_AddIDBEntries(cJSON* json, IDB* db, HBT_element* info, int onlyUsed)
 {
   if (!info)
   {
     return;
   }
 
-  cJSON_AddIDBEntries(json, info->left, onlyUsed);
+  cJSON_AddIDBEntries(json, db, info->left, onlyUsed);
   IDB_Entry* entry = (IDB_Entry*)info->obj;
-  if (entry && entry->key && entry->value && (!onlyUsed || entry->used))
+  if (entry && entry->key && entry->value && (!onlyUsed || IDB_EntryUsed(db, entry)))
   {
     cJSON_AddItemToObject(json, entry->key, cJSON_CreateString(entry->value));
   }
-  cJSON_AddIDBEntries(json, info->right, onlyUsed);
+  cJSON_AddIDBEntries(json, db, info->right, onlyUsed);
 }
 
 static cJSON* cJSON_CreateIDBDict(IDB* info, int onlyUsed)
 {
   cJSON* dict = cJSON_CreateObject();
 
-  cJSON_AddIDBEntries(dict, info->root, onlyUsed);
+  cJSON_AddIDBEntries(dict, info, info->tree->root, onlyUsed);
   return dict;
 }
 
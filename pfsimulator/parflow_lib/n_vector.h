@@ -41,6 +41,9 @@
 #define N_VAddConst(x, b, z)          PFVAddConst(x, b, z)
 
 #define N_VDotProd(x, y)              PFVDotProd(x, y)
+#define N_VDotProdMulti(n, x, y, d)   PFVDotProdMulti(n, x, y, d)
+#define N_VDotProdPairsBegin(n, x, y, d) PFVDotProdPairsBegin(n, x, y, d)
+#define N_VDotProdPairsEnd(h)         PFVDotProdPairsEnd(h)
 #define N_VMaxNorm(x)                 PFVMaxNorm(x)
 #define N_VWrmsNorm(x, w)             PFVWrmsNorm(x, w)
 #define N_VWL2Norm(x, w)              PFVWL2Norm(x, w)
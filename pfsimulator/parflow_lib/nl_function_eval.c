@@ -203,7 +203,6 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
 
   /* Reuse saturation vector to save memory */
   Vector      *rel_perm = saturation;
-  Vector      *source = saturation;
 
   /* Overland flow variables */  //sk
   Vector      *KW = (instance_xtra->KW);
@@ -275,13 +274,17 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
   int i, j, k, r, is;
   int ix, iy, iz;
   int nx, ny, nz;
-  int nx_p, ny_p;
+  int nx_p, ny_p, nz_p;
+  int id;
 
   int sy_p, sz_p;
   int diffusive;             //@RMM
 
   double dtmp, dx, dy, dz, vol, ffx, ffy, ffz;
 
+  int phase_type;
+  double phase_const = 0.0, phase_ref = 0.0, phase_comp = 0.0;
+
   BCStruct    *bc_struct;
   GrGeomSolid *gr_domain = ProblemDataGrDomain(problem_data);
   double      *bc_patch_values;
@@ -291,8 +294,6 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
   VectorUpdateCommHandle  *handle;
 
   BeginTiming(public_xtra->time_index);
-  /* Initialize function values to zero. */
-  PFVConstInit(0.0, fval);
 
   if ((instance_xtra->using_overland_flow) == TRUE)
   {
@@ -312,25 +313,39 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
   int overlandspinup;              //@RMM
   overlandspinup = GetIntDefault("OverlandFlowSpinUp", 0);
 
-  /* Pass pressure values to neighbors.  */
-  handle = InitVectorUpdate(pressure, VectorUpdateAll);
-  FinalizeVectorUpdate(handle);
-
-  /* Calculate pressure dependent properties: density and saturation */
+  /* Calculate density from the local pressure values.  The ghost
+   * layer computed here from stale ghost pressures is recomputed once
+   * the pressure update below has been finalized. */
 
   PFModuleInvokeType(PhaseDensityInvoke, density_module, (0, pressure, density, &dtmp, &dtmp,
                                                           CALCFCN));
 
+  /* Pass pressure values to neighbors.  The update is finalized after
+   * the accumulation terms and the boundary condition values, which
+   * only need values local to the subgrid, have been computed. */
+  handle = InitVectorUpdate(pressure, VectorUpdateAll);
+
+  /* Saturation is only computed on the interior cells */
+
   PFModuleInvokeType(SaturationInvoke, saturation_module, (saturation, pressure, density,
                                                            gravity, problem_data, CALCFCN));
 
 
-  /* Calculate accumulation terms for the function values */
+  /* Calculate phase source values, user specified sources and flux
+   * wells, into the function vector.  This also zeroes fval; the
+   * values are consumed in place by the sweep below. */
+  PFModuleInvokeType(PhaseSourceInvoke, phase_source, (fval, 0, problem, problem_data,
+                                                       time));
+
+  /* Calculate the accumulation, compressible storage and source terms
+   * for the function values in a single sweep over the domain */
 
   ForSubgridI(is, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, is);
 
+    ss_sub = VectorSubvector(sstorage, is);
+
     d_sub = VectorSubvector(density, is);
     od_sub = VectorSubvector(old_density, is);
     p_sub = VectorSubvector(pressure, is);
@@ -339,6 +354,7 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
     os_sub = VectorSubvector(old_saturation, is);
     po_sub = VectorSubvector(porosity, is);
     f_sub = VectorSubvector(fval, is);
+    et_sub = VectorSubvector(evap_trans, is);
 
     /* @RMM added to provide access to zmult */
     z_mult_sub = VectorSubvector(z_mult, is);
@@ -351,20 +367,6 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
     x_ssl_dat = SubvectorData(x_ssl_sub);
     y_ssl_dat = SubvectorData(y_ssl_sub);
 
-    /* @RMM added to provide access FB values */
-    FBx_sub = VectorSubvector(FBx, is);
-    FBy_sub = VectorSubvector(FBy, is);
-    FBz_sub = VectorSubvector(FBz, is);
-
-    /* RMM added to provide patch access */
-    patch_sub = VectorSubvector(patch, is);
-    patch_dat = SubvectorData(patch_sub);
-
-    /* @RMM added to provide FB values */
-    FBx_dat = SubvectorData(FBx_sub);
-    FBy_dat = SubvectorData(FBy_sub);
-    FBz_dat = SubvectorData(FBz_sub);
-
     /* RDF: assumes resolutions are the same in all 3 directions */
     r = SubgridRX(subgrid);
 
@@ -382,6 +384,8 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
 
     vol = dx * dy * dz;
 
+    ss = SubvectorData(ss_sub);
+
     dp = SubvectorData(d_sub);
     odp = SubvectorData(od_sub);
     sp = SubvectorData(s_sub);
@@ -390,6 +394,7 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
     osp = SubvectorData(os_sub);
     pop = SubvectorData(po_sub);
     fp = SubvectorData(f_sub);
+    et = SubvectorData(et_sub);
 
     GrGeomInLoop(i, j, k, gr_domain, r, ix, iy, iz, nx, ny, nz,
     {
@@ -401,93 +406,44 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
       double del_x_slope = 1.0;
       double del_y_slope = 1.0;
 
+      double source = fp[ip];
+
+      /* Terms are added in the same order as separate passes would
+       * add them so the result is unchanged to the last bit */
       fp[ip] = (sp[ip] * dp[ip] - osp[ip] * odp[ip]) * pop[ipo] * vol * del_x_slope * del_y_slope * z_mult_dat[ip];
+      fp[ip] += ss[ip] * vol * del_x_slope * del_y_slope * z_mult_dat[ip] * (pp[ip] * sp[ip] * dp[ip] - opp[ip] * osp[ip] * odp[ip]);
+      fp[ip] -= vol * del_x_slope * del_y_slope * z_mult_dat[ip] * dt * (source + et[ip]);
     });
-  }
-
-  /*@ Add in contributions from compressible storage */
-
-  ForSubgridI(is, GridSubgrids(grid))
-  {
-    subgrid = GridSubgrid(grid, is);
-
-    ss_sub = VectorSubvector(sstorage, is);
-
-    d_sub = VectorSubvector(density, is);
-    od_sub = VectorSubvector(old_density, is);
-    p_sub = VectorSubvector(pressure, is);
-    op_sub = VectorSubvector(old_pressure, is);
-    s_sub = VectorSubvector(saturation, is);
-    os_sub = VectorSubvector(old_saturation, is);
-    f_sub = VectorSubvector(fval, is);
-
-    /* @RMM added to provide access to zmult */
-    z_mult_sub = VectorSubvector(z_mult, is);
-    /* @RMM added to provide variable dz */
-    z_mult_dat = SubvectorData(z_mult_sub);
-    /* @RMM added to provide access to x/y slopes */
-    x_ssl_sub = VectorSubvector(x_ssl, is);
-    y_ssl_sub = VectorSubvector(y_ssl, is);
-    /* @RMM  added to provide slopes to terrain fns */
-    x_ssl_dat = SubvectorData(x_ssl_sub);
-    y_ssl_dat = SubvectorData(y_ssl_sub);
-
-    /* RDF: assumes resolutions are the same in all 3 directions */
-    r = SubgridRX(subgrid);
-
-    ix = SubgridIX(subgrid);
-    iy = SubgridIY(subgrid);
-    iz = SubgridIZ(subgrid);
-
-    nx = SubgridNX(subgrid);
-    ny = SubgridNY(subgrid);
-    nz = SubgridNZ(subgrid);
-
-    dx = SubgridDX(subgrid);
-    dy = SubgridDY(subgrid);
-    dz = SubgridDZ(subgrid);
-
-    vol = dx * dy * dz;
 
-    ss = SubvectorData(ss_sub);
-
-    dp = SubvectorData(d_sub);
-    odp = SubvectorData(od_sub);
-    sp = SubvectorData(s_sub);
-    pp = SubvectorData(p_sub);
-    opp = SubvectorData(op_sub);
-    osp = SubvectorData(os_sub);
-    fp = SubvectorData(f_sub);
-
-    GrGeomInLoop(i, j, k, gr_domain, r, ix, iy, iz, nx, ny, nz,
+    /* Flux wells may add source values in inactive cells */
+    GrGeomOutLoop(i, j, k, gr_domain, r, ix, iy, iz, nx, ny, nz,
     {
       int ip = SubvectorEltIndex(f_sub, i, j, k);
 
-      /*     del_x_slope = (1.0/cos(atan(x_ssl_dat[io])));
-       *   del_y_slope = (1.0/cos(atan(y_ssl_dat[io])));  */
-      double del_x_slope = 1.0;
-      double del_y_slope = 1.0;
-
-      fp[ip] += ss[ip] * vol * del_x_slope * del_y_slope * z_mult_dat[ip] * (pp[ip] * sp[ip] * dp[ip] - opp[ip] * osp[ip] * odp[ip]);
+      fp[ip] = 0.0;
     });
   }
 
-  /* Add in contributions from source terms - user specified sources and
-   * flux wells.  Calculate phase source values overwriting current
-   * saturation vector */
-  PFModuleInvokeType(PhaseSourceInvoke, phase_source, (source, 0, problem, problem_data,
-                                                       time));
+  bc_struct = PFModuleInvokeType(BCPressureInvoke, bc_pressure,
+                                 (problem_data, grid, gr_domain, time));
+
+  /* Everything below needs the ghost pressure and density values */
+  FinalizeVectorUpdate(handle);
+
+  /* Density is a pointwise function of pressure, so instead of
+   * exchanging it, recompute it on the ghost layer from the updated
+   * ghost pressures */
+  ThisPFModule = density_module;
+  PhaseDensityConstants(0, CALCFCN, &phase_type, &phase_const,
+                        &phase_ref, &phase_comp);
+  ThisPFModule = this_module;
 
   ForSubgridI(is, GridSubgrids(grid))
   {
     subgrid = GridSubgrid(grid, is);
 
-    s_sub = VectorSubvector(source, is);
-    f_sub = VectorSubvector(fval, is);
-    et_sub = VectorSubvector(evap_trans, is);
-
-    /* RDF: assumes resolutions are the same in all 3 directions */
-    r = SubgridRX(subgrid);
+    p_sub = VectorSubvector(pressure, is);
+    d_sub = VectorSubvector(density, is);
 
     ix = SubgridIX(subgrid);
     iy = SubgridIY(subgrid);
@@ -497,52 +453,31 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
     ny = SubgridNY(subgrid);
     nz = SubgridNZ(subgrid);
 
-    dx = SubgridDX(subgrid);
-    dy = SubgridDY(subgrid);
-    dz = SubgridDZ(subgrid);
-
-    vol = dx * dy * dz;
-
-    sp = SubvectorData(s_sub);
-    fp = SubvectorData(f_sub);
-    et = SubvectorData(et_sub);
-
-    /* @RMM added to provide access to x/y slopes */
-    x_ssl_sub = VectorSubvector(x_ssl, is);
-    y_ssl_sub = VectorSubvector(y_ssl, is);
-    /* @RMM  added to provide slopes to terrain fns */
-    x_ssl_dat = SubvectorData(x_ssl_sub);
-    y_ssl_dat = SubvectorData(y_ssl_sub);
-    /* @RMM added to provide access to zmult */
-    z_mult_sub = VectorSubvector(z_mult, is);
-    /* @RMM added to provide variable dz */
-    z_mult_dat = SubvectorData(z_mult_sub);
-    /* @RMM added to provide access FB values */
-    FBx_sub = VectorSubvector(FBx, is);
-    FBy_sub = VectorSubvector(FBy, is);
-    FBz_sub = VectorSubvector(FBz, is);
+    nx_p = SubvectorNX(p_sub);
+    ny_p = SubvectorNY(p_sub);
+    nz_p = SubvectorNZ(p_sub);
 
-    /* @RMM added to provide FB values */
-    FBx_dat = SubvectorData(FBx_sub);
-    FBy_dat = SubvectorData(FBy_sub);
-    FBz_dat = SubvectorData(FBz_sub);
+    pp = SubvectorElt(p_sub, ix - 1, iy - 1, iz - 1);
+    dp = SubvectorElt(d_sub, ix - 1, iy - 1, iz - 1);
 
-    GrGeomInLoop(i, j, k, gr_domain, r, ix, iy, iz, nx, ny, nz,
+    id = 0;
+    BoxLoopI1(i, j, k, ix - 1, iy - 1, iz - 1, nx + 2, ny + 2, nz + 2,
+              id, nx_p, ny_p, nz_p, 1, 1, 1,
     {
-      int ip = SubvectorEltIndex(f_sub, i, j, k);
-
-      /* del_x_slope = (1.0/cos(atan(x_ssl_dat[io])));
-       * del_y_slope = (1.0/cos(atan(y_ssl_dat[io])));  */
-      double del_x_slope = 1.0;
-      double del_y_slope = 1.0;
-
-      fp[ip] -= vol * del_x_slope * del_y_slope * z_mult_dat[ip] * dt * (sp[ip] + et[ip]);
+      if (i < ix || i >= ix + nx || j < iy || j >= iy + ny || k < iz || k >= iz + nz)
+      {
+        if (phase_type == 0)
+        {
+          dp[id] = phase_const;
+        }
+        else
+        {
+          dp[id] = phase_ref * exp(pp[id] * phase_comp);
+        }
+      }
     });
   }
 
-  bc_struct = PFModuleInvokeType(BCPressureInvoke, bc_pressure,
-                                 (problem_data, grid, gr_domain, time));
-
   /*
    * Temporarily insert boundary pressure values for Dirichlet
    * boundaries into cells that are in the inactive region but next
@@ -648,6 +583,16 @@ void NlFunctionEval(Vector *     pressure, /* Current pressure values */
     patch_sub = VectorSubvector(patch, is);
     patch_dat = SubvectorData(patch_sub);
 
+    /* @RMM added to provide access FB values */
+    FBx_sub = VectorSubvector(FBx, is);
+    FBy_sub = VectorSubvector(FBy, is);
+    FBz_sub = VectorSubvector(FBz, is);
+
+    /* @RMM added to provide FB values */
+    FBx_dat = SubvectorData(FBx_sub);
+    FBy_dat = SubvectorData(FBy_sub);
+    FBz_dat = SubvectorData(FBz_sub);
+
     /* RDF: assumes resolutions are the same in all 3 directions */
     r = SubgridRX(subgrid);
 
@@ -0,0 +1,567 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+/*****************************************************************************
+*
+* Routines to write and read a Vector to/from a PFB file using MPI-IO.
+*
+* The file layout is identical to the one produced by WritePFBinary through
+* amps_FFopen: rank 0 writes the global header, then every rank writes its
+* subgrids (subgrid header followed by the data) in rank order.  Values are
+* stored big-endian (XDR).  Instead of handshaking with rank 0 to get the
+* file offsets, each rank computes its offset with a single MPI_Exscan and
+* the data is moved with one collective MPI_File_write_at_all (or
+* MPI_File_read_at_all) call.
+*
+* The layout and packing routines are also used by the asynchronous
+* PFB writer.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#include <string.h>
+
+/*--------------------------------------------------------------------------
+ * Pack/unpack values in XDR (big-endian) byte order.  Each routine returns
+ * the position after the value.  Also used by the checkpoint files.
+ *--------------------------------------------------------------------------*/
+
+char *PFBPackInt(char *buf, int value)
+{
+  unsigned int u = (unsigned int)value;
+
+  buf[0] = (char)((u >> 24) & 0xff);
+  buf[1] = (char)((u >> 16) & 0xff);
+  buf[2] = (char)((u >> 8) & 0xff);
+  buf[3] = (char)(u & 0xff);
+
+  return buf + 4;
+}
+
+char *PFBPackDouble(char *buf, double value)
+{
+  unsigned long long u;
+  int b;
+
+  memcpy(&u, &value, sizeof(double));
+  for (b = 0; b < 8; b++)
+  {
+    buf[b] = (char)((u >> (56 - 8 * b)) & 0xff);
+  }
+
+  return buf + 8;
+}
+
+char *PFBUnpackInt(char *buf, int *value)
+{
+  unsigned char *ubuf = (unsigned char*)buf;
+
+  *value = (int)(((unsigned int)ubuf[0] << 24) |
+                 ((unsigned int)ubuf[1] << 16) |
+                 ((unsigned int)ubuf[2] << 8) |
+                 ((unsigned int)ubuf[3]));
+
+  return buf + 4;
+}
+
+char *PFBUnpackDouble(char *buf, double *value)
+{
+  unsigned char *ubuf = (unsigned char*)buf;
+  unsigned long long u = 0;
+  int b;
+
+  for (b = 0; b < 8; b++)
+  {
+    u = (u << 8) | ubuf[b];
+  }
+  memcpy(value, &u, sizeof(double));
+
+  return buf + 8;
+}
+
+/*--------------------------------------------------------------------------
+ * SizeofPFBinaryLocal: number of bytes this rank contributes to the file.
+ *--------------------------------------------------------------------------*/
+
+static long long SizeofPFBinaryLocal(Vector *v)
+{
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  long long size;
+  int g;
+
+  if (amps_Rank(amps_CommWorld) == 0)
+    size = 6 * amps_SizeofDouble + 4 * amps_SizeofInt;
+  else
+    size = 0;
+
+  ForSubgridI(g, subgrids)
+  {
+    size += SizeofPFBinarySubvector(VectorSubvector(v, g),
+                                    SubgridArraySubgrid(subgrids, g));
+  }
+
+  return size;
+}
+
+/*--------------------------------------------------------------------------
+ * PFBinaryLocalOffset: byte offset of this rank's data in the file.
+ *--------------------------------------------------------------------------*/
+
+static long long PFBinaryLocalOffset(long long size)
+{
+  long long offset = 0;
+
+#ifdef PARFLOW_HAVE_MPI
+  MPI_Exscan(&size, &offset, 1, MPI_LONG_LONG, MPI_SUM, amps_CommWorld);
+#else
+  (void)size;
+#endif
+
+  /* Result of MPI_Exscan is undefined on rank 0 */
+  if (amps_Rank(amps_CommWorld) == 0)
+  {
+    offset = 0;
+  }
+
+  return offset;
+}
+
+/*--------------------------------------------------------------------------
+ * PFBinaryLayout
+ *
+ * Computes the number of bytes this rank contributes to the PFB file for
+ * Vector v and its byte offset in the file.  Optionally returns the total
+ * file size and the global number of subgrids.  Collective.
+ *--------------------------------------------------------------------------*/
+
+long long PFBinaryLayout(
+                         Vector *   v,
+                         long long *offset,
+                         long long *total,
+                         int *      num_subgrids)
+{
+  long long size;
+  long long counts[2];
+  long long global_counts[2];
+
+  size = SizeofPFBinaryLocal(v);
+  *offset = PFBinaryLocalOffset(size);
+
+  counts[0] = GridNumSubgrids(VectorGrid(v));
+  counts[1] = size;
+
+#ifdef PARFLOW_HAVE_MPI
+  MPI_Allreduce(counts, global_counts, 2, MPI_LONG_LONG, MPI_SUM,
+                amps_CommWorld);
+#else
+  global_counts[0] = counts[0];
+  global_counts[1] = counts[1];
+#endif
+
+  if (num_subgrids)
+  {
+    *num_subgrids = (int)global_counts[0];
+  }
+
+  if (total)
+  {
+    *total = global_counts[1];
+  }
+
+  return size;
+}
+
+/*--------------------------------------------------------------------------
+ * PackPFBinary
+ *
+ * Pack this rank's part of the PFB file for Vector v into buffer; buffer
+ * must hold the size returned by PFBinaryLayout.
+ *--------------------------------------------------------------------------*/
+
+void PackPFBinary(
+                  Vector *v,
+                  int     num_subgrids,
+                  char *  buffer)
+{
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  Subgrid        *subgrid;
+  Subvector      *subvector;
+
+  char           *pos = buffer;
+  int g;
+
+  if (amps_Rank(amps_CommWorld) == 0)
+  {
+    pos = PFBPackDouble(pos, BackgroundX(GlobalsBackground));
+    pos = PFBPackDouble(pos, BackgroundY(GlobalsBackground));
+    pos = PFBPackDouble(pos, BackgroundZ(GlobalsBackground));
+
+    pos = PFBPackInt(pos, SubgridNX(GridBackground(grid)));
+    pos = PFBPackInt(pos, SubgridNY(GridBackground(grid)));
+    pos = PFBPackInt(pos, SubgridNZ(GridBackground(grid)));
+
+    pos = PFBPackDouble(pos, BackgroundDX(GlobalsBackground));
+    pos = PFBPackDouble(pos, BackgroundDY(GlobalsBackground));
+    pos = PFBPackDouble(pos, BackgroundDZ(GlobalsBackground));
+
+    pos = PFBPackInt(pos, num_subgrids);
+  }
+
+  ForSubgridI(g, subgrids)
+  {
+    subgrid = SubgridArraySubgrid(subgrids, g);
+    subvector = VectorSubvector(v, g);
+
+    int ix = SubgridIX(subgrid);
+    int iy = SubgridIY(subgrid);
+    int iz = SubgridIZ(subgrid);
+
+    int nx = SubgridNX(subgrid);
+    int ny = SubgridNY(subgrid);
+    int nz = SubgridNZ(subgrid);
+
+    int nx_v = SubvectorNX(subvector);
+    int ny_v = SubvectorNY(subvector);
+    int nz_v = SubvectorNZ(subvector);
+
+    int i, j, k, ai;
+    double *data;
+
+    pos = PFBPackInt(pos, ix);
+    pos = PFBPackInt(pos, iy);
+    pos = PFBPackInt(pos, iz);
+
+    pos = PFBPackInt(pos, nx);
+    pos = PFBPackInt(pos, ny);
+    pos = PFBPackInt(pos, nz);
+
+    pos = PFBPackInt(pos, SubgridRX(subgrid));
+    pos = PFBPackInt(pos, SubgridRY(subgrid));
+    pos = PFBPackInt(pos, SubgridRZ(subgrid));
+
+    data = SubvectorElt(subvector, ix, iy, iz);
+
+    ai = 0;
+    BoxLoopI1(i, j, k,
+              ix, iy, iz, nx, ny, nz,
+              ai, nx_v, ny_v, nz_v, 1, 1, 1,
+    {
+      pos = PFBPackDouble(pos, data[ai]);
+    });
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * WritePFBinaryDist
+ *
+ * Write the .dist sidecar with the start offset of each rank.  Same format
+ * as the one written by amps_FFopen.  Collective.
+ *--------------------------------------------------------------------------*/
+
+void WritePFBinaryDist(
+                       char *    filename,
+                       long long offset)
+{
+  int p = amps_Rank(amps_CommWorld);
+  int P = amps_Size(amps_CommWorld);
+  long long *offsets = NULL;
+
+  if (p == 0)
+  {
+    offsets = talloc(long long, P);
+  }
+
+#ifdef PARFLOW_HAVE_MPI
+  MPI_Gather(&offset, 1, MPI_LONG_LONG, offsets, 1, MPI_LONG_LONG, 0,
+             amps_CommWorld);
+#else
+  offsets[0] = offset;
+#endif
+
+  if (p == 0)
+  {
+    char dist_filename[2048];
+    FILE *dfile;
+    int r;
+
+    sprintf(dist_filename, "%s.dist", filename);
+
+    if ((dfile = fopen(dist_filename, "w")) == NULL)
+    {
+      amps_Printf("Error: can't open the distribution file %s\n",
+                  dist_filename);
+      exit(1);
+    }
+
+    for (r = 0; r < P; r++)
+    {
+      fprintf(dfile, "%lld\n", offsets[r]);
+    }
+
+    fclose(dfile);
+
+    tfree(offsets);
+  }
+}
+
+#ifdef PARFLOW_HAVE_MPI
+/*--------------------------------------------------------------------------
+ * PFBinaryMPIIOType
+ *
+ * Datatype covering size contiguous bytes.  MPI counts are ints, so a
+ * rank holding more than 2 GB is described as whole blocks of
+ * PFB_MPIIO_BLOCK bytes followed by the remaining bytes.  The caller frees
+ * the type.
+ *--------------------------------------------------------------------------*/
+
+#define PFB_MPIIO_BLOCK (1 << 30)
+
+static MPI_Datatype PFBinaryMPIIOType(long long size)
+{
+  MPI_Datatype block;
+  MPI_Datatype type;
+  MPI_Datatype types[2];
+  MPI_Aint displacements[2];
+  int lengths[2];
+
+  MPI_Type_contiguous(PFB_MPIIO_BLOCK, MPI_BYTE, &block);
+
+  lengths[0] = (int)(size / PFB_MPIIO_BLOCK);
+  lengths[1] = (int)(size % PFB_MPIIO_BLOCK);
+  displacements[0] = 0;
+  displacements[1] = (MPI_Aint)lengths[0] * PFB_MPIIO_BLOCK;
+  types[0] = block;
+  types[1] = MPI_BYTE;
+
+  MPI_Type_create_struct(2, lengths, displacements, types, &type);
+  MPI_Type_commit(&type);
+
+  MPI_Type_free(&block);
+
+  return type;
+}
+#endif
+
+/*--------------------------------------------------------------------------
+ * WritePFBinaryMPIIO
+ *--------------------------------------------------------------------------*/
+
+void     WritePFBinaryMPIIO(
+                            char *  filename,
+                            Vector *v)
+{
+#ifdef PARFLOW_HAVE_MPI
+  int num_subgrids;
+
+  long long size;
+  long long offset;
+  long long total;
+
+  char           *buffer;
+
+  MPI_File fh;
+  MPI_Datatype type;
+  MPI_Status status;
+
+  size = PFBinaryLayout(v, &offset, &total, &num_subgrids);
+
+  buffer = talloc(char, size > 0 ? size : 1);
+  PackPFBinary(v, num_subgrids, buffer);
+
+  if (MPI_File_open(amps_CommWorld, filename,
+                    MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                    MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't open output file %s\n", filename);
+    exit(1);
+  }
+
+  /* Truncate any previous (possibly longer) file with the same name */
+  if (MPI_File_set_size(fh, (MPI_Offset)total) != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't set the size of output file %s\n", filename);
+    exit(1);
+  }
+
+  type = PFBinaryMPIIOType(size);
+  if (MPI_File_write_at_all(fh, (MPI_Offset)offset, buffer, 1, type,
+                            &status) != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't write output file %s\n", filename);
+    exit(1);
+  }
+  MPI_Type_free(&type);
+
+  if (MPI_File_close(&fh) != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't close output file %s\n", filename);
+    exit(1);
+  }
+
+  tfree(buffer);
+
+  if (GlobalsPFBWriteDist)
+  {
+    WritePFBinaryDist(filename, offset);
+  }
+#else
+  (void)filename;
+  (void)v;
+  amps_Printf("Error: MPI-IO PFB writer requires MPI\n");
+  exit(1);
+#endif
+}
+
+/*--------------------------------------------------------------------------
+ * ReadPFBinaryMPIIO
+ *
+ * The file must have been written for the same process topology; the
+ * per-rank offsets are recomputed from the local subgrid sizes so the
+ * .dist file is not needed.
+ *--------------------------------------------------------------------------*/
+
+void ReadPFBinaryMPIIO(
+                       char *  filename,
+                       Vector *v)
+{
+#ifdef PARFLOW_HAVE_MPI
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  Subgrid        *subgrid;
+  Subvector      *subvector;
+
+  int g;
+
+  long long size;
+  long long offset;
+
+  char           *buffer;
+  char           *pos;
+
+  MPI_File fh;
+  MPI_Datatype type;
+  MPI_Status status;
+
+  size = SizeofPFBinaryLocal(v);
+  offset = PFBinaryLocalOffset(size);
+
+  buffer = talloc(char, size > 0 ? size : 1);
+
+  if (MPI_File_open(amps_CommWorld, filename, MPI_MODE_RDONLY,
+                    MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't open input file %s\n", filename);
+    exit(1);
+  }
+
+  type = PFBinaryMPIIOType(size);
+  if (MPI_File_read_at_all(fh, (MPI_Offset)offset, buffer, 1, type,
+                           &status) != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't read input file %s\n", filename);
+    exit(1);
+  }
+  MPI_Type_free(&type);
+
+  if (MPI_File_close(&fh) != MPI_SUCCESS)
+  {
+    amps_Printf("Error: can't close input file %s\n", filename);
+    exit(1);
+  }
+
+  pos = buffer;
+
+  /* Global header is not used */
+  if (amps_Rank(amps_CommWorld) == 0)
+  {
+    pos += 6 * amps_SizeofDouble + 4 * amps_SizeofInt;
+  }
+
+  ForSubgridI(g, subgrids)
+  {
+    subgrid = SubgridArraySubgrid(subgrids, g);
+    subvector = VectorSubvector(v, g);
+
+    int ix, iy, iz;
+    int nx, ny, nz;
+    int rx, ry, rz;
+
+    int nx_v = SubvectorNX(subvector);
+    int ny_v = SubvectorNY(subvector);
+    int nz_v = SubvectorNZ(subvector);
+
+    int i, j, k, ai;
+    double *data;
+
+    pos = PFBUnpackInt(pos, &ix);
+    pos = PFBUnpackInt(pos, &iy);
+    pos = PFBUnpackInt(pos, &iz);
+
+    pos = PFBUnpackInt(pos, &nx);
+    pos = PFBUnpackInt(pos, &ny);
+    pos = PFBUnpackInt(pos, &nz);
+
+    pos = PFBUnpackInt(pos, &rx);
+    pos = PFBUnpackInt(pos, &ry);
+    pos = PFBUnpackInt(pos, &rz);
+
+    PF_UNUSED(rx);
+    PF_UNUSED(ry);
+    PF_UNUSED(rz);
+
+    if (ix != SubgridIX(subgrid) || iy != SubgridIY(subgrid) ||
+        iz != SubgridIZ(subgrid) ||
+        nx != SubgridNX(subgrid) || ny != SubgridNY(subgrid) ||
+        nz != SubgridNZ(subgrid))
+    {
+      amps_Printf("Error: %s was not written for the current process topology\n",
+                  filename);
+      exit(1);
+    }
+
+    data = SubvectorElt(subvector, ix, iy, iz);
+
+    ai = 0;
+    BoxLoopI1(i, j, k,
+              ix, iy, iz, nx, ny, nz,
+              ai, nx_v, ny_v, nz_v, 1, 1, 1,
+    {
+      pos = PFBUnpackDouble(pos, &data[ai]);
+    });
+  }
+
+  tfree(buffer);
+#else
+  (void)filename;
+  (void)v;
+  amps_Printf("Error: MPI-IO PFB reader requires MPI\n");
+  exit(1);
+#endif
+}
@@ -33,6 +33,14 @@ typedef void (*BCPressurePackageInvoke) (ProblemData *problem_data);
 typedef PFModule *(*BCPressurePackageInitInstanceXtraInvoke) (Problem *problem);
 typedef PFModule *(*BCPressurePackageNewPublicXtraInvoke) (int num_phases);
 
+/* bc_pressure_file_cache.c */
+BCPressureFileCache *NewBCPressureFileCache(int num_patches, int max_cached);
+void FreeBCPressureFileCache(BCPressureFileCache *cache);
+int BCPressureFileCacheNumCells(BCPressureFileCache *cache, int ipatch, int is);
+void BCPressureFileCacheSetCells(BCPressureFileCache *cache, int ipatch, int num_intervals, int num_subgrids, int *num_cells, int **cell_indexes);
+double **BCPressureFileCacheRead(BCPressureFileCache *cache, int ipatch, int interval_number, char *filename);
+void BCPressureFileCachePrefetch(BCPressureFileCache *cache, int ipatch, int interval_number, char *filename);
+
 /* bc_pressure_package.c */
 void BCPressurePackage(ProblemData *problem_data);
 PFModule *BCPressurePackageInitInstanceXtra(Problem *problem);
@@ -82,6 +90,10 @@ PFModule *ChebyshevNewPublicXtra(char *name);
 void ChebyshevFreePublicXtra(void);
 int ChebyshevSizeOfTempData(void);
 
+/* checkpoint.c */
+void WriteCheckpoint(char *filename, int num_scalars, const char **scalar_names, double *scalars, int num_vectors, const char **vector_names, Vector **vectors);
+void ReadCheckpoint(char *filename, int num_scalars, const char **scalar_names, double *scalars, int num_vectors, const char **vector_names, Vector **vectors);
+
 /* comm_pkg.c */
 void ProjectRegion(Region *region, int sx, int sy, int sz, int ix, int iy, int iz);
 Region *ProjectRBPoint(Region *region, int rb[4 ][3 ]);
@@ -182,15 +194,15 @@ void recordMemoryInfo();
 void printMaxMemory(FILE *log_file);
 
 /* geom_t_solid.c */
-GeomTSolid *GeomNewTSolid(GeomTIN *surface, int **patches, int num_patches, int *num_patch_triangles);
+GeomTSolid *GeomNewTSolid(GeomTIN *surface, int *patch_triangles, int num_patches, int *num_patch_triangles);
 void GeomFreeTSolid(GeomTSolid *solid);
 int GeomReadTSolids(GeomTSolid ***solids_data_ptr, char *geom_input_name);
 GeomTSolid *GeomTSolidFromBox(double xl, double yl, double zl, double xu, double yu, double zu);
 
 /* geometry.c */
-GeomVertexArray *GeomNewVertexArray(GeomVertex **vertices, int nV);
+GeomVertexArray *GeomNewVertexArray(double *x, double *y, double *z, int nV);
 void GeomFreeVertexArray(GeomVertexArray *vertex_array);
-GeomTIN *GeomNewTIN(GeomVertexArray *vertex_array, GeomTriangle **triangles, int nT);
+GeomTIN *GeomNewTIN(GeomVertexArray *vertex_array, int *triangles, int nT);
 void GeomFreeTIN(GeomTIN *surface);
 GeomSolid *GeomNewSolid(void *data, int type);
 void GeomFreeSolid(GeomSolid *solid);
@@ -203,6 +215,11 @@ void NewGlobals(char *run_name);
 void FreeGlobals(void);
 void LogGlobals(void);
 
+/* grgeom_cache.c */
+char *GrGeomCacheFilename(GeomTSolid *solid_data, GrGeomExtentArray *extent_array, int octree_bg_level);
+int GrGeomCacheRead(GrGeomSolid **solid_ptr, char *filename);
+void GrGeomCacheWrite(GrGeomSolid *solid, char *filename);
+
 /* grgeom_list.c */
 ListMember *NewListMember(double value, int normal_component, int triangle_id);
 void FreeListMember(ListMember *member);
@@ -298,20 +315,20 @@ PFModule *InputRFNewPublicXtra(char *geom_name);
 void InputRFFreePublicXtra(void);
 int InputRFSizeOfTempData(void);
 
-typedef int (*NonlinSolverInvoke) (Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity, Vector *q_overlnd_x, Vector *q_overlnd_y);
+typedef int (*NonlinSolverInvoke) (Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity, Vector *q_overlnd_x, Vector *q_overlnd_y, NonlinSolverStats *stats);
 typedef PFModule *(*NonlinSolverInitInstanceXtraInvoke) (Problem *problem, Grid *grid, Grid *grid2d, ProblemData *problem_data, double *temp_data);
 
 /* kinsol_nonlin_solver.c */
 #if defined (PARFLOW_HAVE_SUNDIALS)
 int KINSolInitPC(N_Vector pf_n_pressure, N_Vector pf_n_uscale, N_Vector pf_n_fval, N_Vector pf_n_fscale, void *    current_state);
 int KINSolCallPC(N_Vector pf_n_pressure, N_Vector pf_n_uscale, N_Vector pf_n_fval, N_Vector pf_n_fscale, N_Vector pf_n_vtem, void *    current_state);
-int KinsolNonlinSolver(Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity, Vector *q_overlnd_x, Vector *q_overlnd_y);
+int KinsolNonlinSolver(Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity, Vector *q_overlnd_x, Vector *q_overlnd_y, NonlinSolverStats *stats);
 PFModule *KinsolNonlinSolverInitInstanceXtra(Problem *problem, Grid *grid, Grid *grid2d, ProblemData *problem_data, double *temp_data);
 #else
 int KINSolInitPC(int neq, N_Vector pressure, N_Vector uscale, N_Vector fval, N_Vector fscale, N_Vector vtemp1, N_Vector vtemp2, void *nl_function, double uround, long int *nfePtr, void *current_state);
 int KINSolCallPC(int neq, N_Vector pressure, N_Vector uscale, N_Vector fval, N_Vector fscale, N_Vector vtem, N_Vector ftem, void *nl_function, double uround, long int *nfePtr, void *current_state);
 void PrintFinalStats(FILE *out_file, long int *integer_outputs_now, long int *integer_outputs_total);
-int KinsolNonlinSolver(Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity, Vector *q_overlnd_x, Vector *q_overlnd_y);
+int KinsolNonlinSolver(Vector *pressure, Vector *density, Vector *old_density, Vector *saturation, Vector *old_saturation, double t, double dt, ProblemData *problem_data, Vector *old_pressure, Vector *evap_trans, Vector *ovrl_bc_flx, Vector *x_velocity, Vector *y_velocity, Vector *z_velocity, Vector *q_overlnd_x, Vector *q_overlnd_y, NonlinSolverStats *stats);
 PFModule *KinsolNonlinSolverInitInstanceXtra(Problem *problem, Grid *grid, Grid *grid2d, ProblemData *problem_data, double *temp_data);
 #endif
 void KinsolNonlinSolverFreeInstanceXtra(void);
@@ -457,6 +474,7 @@ void PFVAbsFcn(N_Vector x, N_Vector z);
 void PFVInvFcn(N_Vector x, N_Vector z);
 void PFVAddConstFcn(N_Vector x, double b, N_Vector z);
 double PFVDotProdFcn(N_Vector x, N_Vector y);
+int PFVDotProdMultiFcn(int nvec, N_Vector x, N_Vector *y, double *dot);
 double PFVMaxNormFcn(N_Vector x);
 double PFVWrmsNormFcn(N_Vector x, N_Vector w);
 double PFVWL2NormFcn(N_Vector x, N_Vector w);
@@ -520,6 +538,17 @@ PFModule *NoDiagScaleNewPublicXtra(char *name);
 void NoDiagScaleFreePublicXtra(void);
 int NoDiagScaleSizeOfTempData(void);
 
+/* parflow_binary_mpiio.c */
+char *PFBPackInt(char *buf, int value);
+char *PFBPackDouble(char *buf, double value);
+char *PFBUnpackInt(char *buf, int *value);
+char *PFBUnpackDouble(char *buf, double *value);
+long long PFBinaryLayout(Vector *v, long long *offset, long long *total, int *num_subgrids);
+void PackPFBinary(Vector *v, int num_subgrids, char *buffer);
+void WritePFBinaryDist(char *filename, long long offset);
+void WritePFBinaryMPIIO(char *filename, Vector *v);
+void ReadPFBinaryMPIIO(char *filename, Vector *v);
+
 /* pcg.c */
 void PCG(Vector *x, Vector *b, double tol, int zero);
 PFModule *PCGInitInstanceXtra(Problem *problem, Grid *grid, ProblemData *problem_data, Matrix *A, Matrix *C, double *temp_data);
@@ -1109,8 +1138,13 @@ void RedBlackGSPointFreePublicXtra(void);
 int RedBlackGSPointSizeOfTempData(void);
 
 /* read_parflow_binary.c */
+PFBLayout *NewPFBLayout(void);
+void FreePFBLayout(PFBLayout *layout);
+int PFBLayoutLoad(PFBLayout *layout, int fd, int force);
+int PFBReadBox(PFBLayout *layout, int fd, int box_ix, int box_iy, int box_iz, int box_nx, int box_ny, int box_nz, double *data);
 void ReadPFBinary_Subvector(amps_File file, Subvector *subvector, Subgrid *subgrid);
 void ReadPFBinary(char *filename, Vector *v);
+void ReadPFBinaryAnyLayout(char *filename, Vector *v);
 
 /* reg_from_stenc.c */
 void ComputeRegFromStencil(Region **dep_reg_ptr, Region **ind_reg_ptr, SubregionArray *cr_array, Region *send_reg, Region *recv_reg, Stencil *stencil);
@@ -1162,15 +1196,17 @@ int SatGodunovSizeOfTempData(void);
 /* scale.c */
 void Scale(double alpha, Vector *y);
 
-typedef void (*SelectTimeStepInvoke) (double *dt, char *dt_info, double time, Problem *problem, ProblemData *problem_data);
+typedef void (*SelectTimeStepInvoke) (double *dt, char *dt_info, double time, Problem *problem, ProblemData *problem_data, NonlinSolverStats *stats);
 
 /* select_time_step.c */
-void SelectTimeStep(double *dt, char *dt_info, double time, Problem *problem, ProblemData *problem_data);
+void SelectTimeStep(double *dt, char *dt_info, double time, Problem *problem, ProblemData *problem_data, NonlinSolverStats *stats);
 PFModule *SelectTimeStepInitInstanceXtra(void);
 void SelectTimeStepFreeInstanceXtra(void);
 PFModule *SelectTimeStepNewPublicXtra(void);
 void SelectTimeStepFreePublicXtra(void);
 int SelectTimeStepSizeOfTempData(void);
+void SelectTimeStepGetState(PFModule *this_module, double *last_dt, double *last_err);
+void SelectTimeStepSetState(PFModule *this_module, double last_dt, double last_err);
 PFModule  *WRFSelectTimeStepNewPublicXtra(
                                           double initial_step,
                                           double growth_factor,
@@ -1369,6 +1405,9 @@ void PFVAbs(Vector *x, Vector *z);
 void PFVInv(Vector *x, Vector *z);
 void PFVAddConst(Vector *x, double b, Vector *z);
 double PFVDotProd(Vector *x, Vector *y);
+void PFVDotProdMulti(int nvec, Vector *x, Vector **y, double *dot);
+VectorReduceHandle *PFVDotProdPairsBegin(int nvec, Vector **x, Vector **y, double *dot);
+void PFVDotProdPairsEnd(VectorReduceHandle *handle);
 double PFVMaxNorm(Vector *x);
 double PFVWrmsNorm(Vector *x, Vector *w);
 double PFVWL2Norm(Vector *x, Vector *w);
@@ -1449,6 +1488,11 @@ long SizeofPFSBinarySubvector(Subvector *subvector, Subgrid *subgrid, double dro
 void WritePFSBinary_Subvector(amps_File file, Subvector *subvector, Subgrid *subgrid, double drop_tolerance);
 void WritePFSBinary(char *file_prefix, char *file_suffix, Vector *v, double drop_tolerance);
 
+/* write_parflow_binary_async.c */
+void WritePFBinaryAsync(char *filename, Vector *v);
+void PFBAsyncFlush(void);
+void PFBAsyncFinalize(void);
+
 /* write_parflow_pdi.c */
 void WritePDI(char *file_prefix, char *file_suffix, int iteration, Vector *v, int with_tolerance, double drop_tolerance);
 
@@ -142,7 +142,8 @@ void SADVECT(double *s, double *sn,
                      clm_snowage_tau0_vis, clm_snowage_tau0_nir, clm_snowage_grain_growth_vis, clm_snowage_grain_growth_nir,                                                                                 \
                      clm_snowage_dirt_soot_vis, clm_snowage_dirt_soot_nir, clm_snowage_reset_factor,                                                                                                         \
                      clm_interception_fpi_max, clm_fwet_exponent, clm_stomata_scheme,                                                                                                                        \
-                     clm_interception_scheme, clm_interception_tanh_alpha)                                                                                                                                   \
+                     clm_interception_scheme, clm_interception_tanh_alpha,                                                                                                                                   \
+                     clm_rst_pfb, clm_rst_nz, clm_rst_data, clm_rst_read, clm_rst_write)                                                                                                                     \
         CLM_LSM(pressure_data, saturation_data, evap_trans_data, top, bottom, porosity_data,                                                                                                                 \
                 dz_mult_data, &istep, &dt, &t, &start_time, &dx, &dy, &dz, &ix, &iy, &nx, &ny, &nz, &nx_f, &ny_f, &nz_f, &nz_rz, &ip, &p, &q, &r, &gnx, &gny, &rank,                                         \
                 sw_data, lw_data, prcp_data, tas_data, u_data, v_data, patm_data, qatm_data,                                                                                                                 \
@@ -164,7 +165,8 @@ void SADVECT(double *s, double *sn,
                 &clm_snowage_tau0_vis, &clm_snowage_tau0_nir, &clm_snowage_grain_growth_vis, &clm_snowage_grain_growth_nir,                                                                                  \
                 &clm_snowage_dirt_soot_vis, &clm_snowage_dirt_soot_nir, &clm_snowage_reset_factor,                                                                                                           \
                 &clm_interception_fpi_max, &clm_fwet_exponent, &clm_stomata_scheme,                                                                                                                          \
-                &clm_interception_scheme, &clm_interception_tanh_alpha);
+                &clm_interception_scheme, &clm_interception_tanh_alpha,                                                                                                                                      \
+                &clm_rst_pfb, &clm_rst_nz, clm_rst_data, &clm_rst_read, &clm_rst_write);
 
 void CLM_LSM(double *pressure_data, double *saturation_data, double *evap_trans_data, double *top, double *bottom, double *porosity_data,
              double *dz_mult_data, int *istep, double *dt, double *t, double *start_time,
@@ -195,7 +197,23 @@ void CLM_LSM(double *pressure_data, double *saturation_data, double *evap_trans_
              double *clm_snowage_grain_growth_vis, double *clm_snowage_grain_growth_nir,
              double *clm_snowage_dirt_soot_vis, double *clm_snowage_dirt_soot_nir, double *clm_snowage_reset_factor,
              double *clm_interception_fpi_max, double *clm_fwet_exponent, int *clm_stomata_scheme,
-             int *clm_interception_scheme, double *clm_interception_tanh_alpha);
+             int *clm_interception_scheme, double *clm_interception_tanh_alpha,
+             int *clm_rst_pfb, int *clm_rst_nz, double *clm_rst_data, int *clm_rst_read, int *clm_rst_write);
+
+/* drv_restart.F90 */
+
+#if defined(_CRAYMPP)
+#define DRV_RESTART_NZ DRV_RESTART_NZ
+#elif defined(__bg__)
+#define DRV_RESTART_NZ drv_restart_nz
+#else
+#define DRV_RESTART_NZ drv_restart_nz_
+#endif
+
+#define CALL_DRV_RESTART_NZ(nlevsoi, rst_nz) \
+        DRV_RESTART_NZ(&nlevsoi, &rst_nz);
+
+void DRV_RESTART_NZ(int *nlevsoi, int *rst_nz);
 
 /* @RMM CRUNCHFLOW.F90*/
 //#define CRUNCHFLOW crunchflow_
@@ -62,6 +62,8 @@ PFModule  *NewPFModule(
   PFModuleInstanceXtra(new_module) = instance_xtra;
   PFModulePublicXtra(new_module) = public_xtra;
 
+  (new_module->name) = NULL;
+
   return new_module;
 }
 
@@ -93,6 +95,8 @@ PFModule  *NewPFModuleExtended(
   PFModuleInstanceXtra(new_module) = instance_xtra;
   PFModulePublicXtra(new_module) = public_xtra;
 
+  (new_module->name) = NULL;
+
   return new_module;
 }
 
@@ -103,16 +107,22 @@ PFModule  *NewPFModuleExtended(
 
 PFModule  *DupPFModule(PFModule *pf_module)
 {
-  return NewPFModuleExtended((void*)(pf_module->call),
-                             (void*)(pf_module->init_instance_xtra),
-                             (void*)(pf_module->free_instance_xtra),
-                             (void*)(pf_module->new_public_xtra),
-                             (void*)(pf_module->free_public_xtra),
-                             (void*)(pf_module->sizeof_temp_data),
-                             (void*)(pf_module->output),
-                             (void*)(pf_module->output_static),
-                             PFModuleInstanceXtra(pf_module),
-                             PFModulePublicXtra(pf_module));
+  PFModule         *new_module;
+
+  new_module = NewPFModuleExtended((void*)(pf_module->call),
+                                   (void*)(pf_module->init_instance_xtra),
+                                   (void*)(pf_module->free_instance_xtra),
+                                   (void*)(pf_module->new_public_xtra),
+                                   (void*)(pf_module->free_public_xtra),
+                                   (void*)(pf_module->sizeof_temp_data),
+                                   (void*)(pf_module->output),
+                                   (void*)(pf_module->output_static),
+                                   PFModuleInstanceXtra(pf_module),
+                                   PFModulePublicXtra(pf_module));
+
+  (new_module->name) = (pf_module->name);
+
+  return new_module;
 }
 
 
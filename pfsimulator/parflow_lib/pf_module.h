@@ -128,6 +128,12 @@ typedef struct {
    * Like class data members in C++.
    */
   void  *public_xtra;
+
+  /**
+   * Name of the module type, used to label the module in the
+   * timing tree.
+   */
+  const char *name;
 } PFModule;
 
 /**
@@ -178,6 +184,14 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
  */
 #define PFModulePublicXtra(pf_module)        (pf_module->public_xtra)
 
+/**
+ * Return the module name.
+ *
+ * @param pf_module The module instance
+ * @return Name of the module type, NULL if it was not set
+ */
+#define PFModuleName(pf_module)              (pf_module->name)
+
 /**
  * Accessor macro for the global/thread variable holding the 'this' pointer
  *
@@ -195,6 +209,24 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
  * PFModule interface macros
  *--------------------------------------------------------------------------*/
 
+/**
+ * Time the module methods in the timing tree.
+ *
+ * When timing is enabled the invoke and instance macros open a node
+ * named after the module for the duration of the method.  The node is
+ * closed by a cleanup attribute on a scope variable so the macros
+ * still yield the value of the method, whatever its type.  This needs
+ * the GNU statement expression extension; other builds invoke the
+ * methods untimed.
+ */
+#if defined(PF_TIMING) && defined(__GNUC__) && !defined(PARFLOW_HAVE_CUDA) && !defined(PARFLOW_HAVE_KOKKOS)
+#define PFMODULE_TIMING
+#define PFModuleTimingScope(pf_module, kind)                     \
+        TimingNode *pf_module_timing_scope                       \
+        __attribute__((cleanup(TimingScopeExit))) =              \
+          TimingScopeEnter(PFModuleName(pf_module), kind)
+#endif
+
 /**
  * Invoke the main algorithm method in the module.
  *
@@ -211,11 +243,20 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
  * @param args Arguments for the method to invoke.
  * @return The invoked method return
  */
+#ifdef PFMODULE_TIMING
+#define PFModuleInvokeType(type, pf_module, args)          \
+        ({                                                 \
+           PFModuleTimingScope(pf_module, TimingNodeCall); \
+           ThisPFModule = pf_module;                       \
+           (*(type)(ThisPFModule->call)) args;             \
+         })
+#else
 #define PFModuleInvokeType(type, pf_module, args)        \
         (                                                \
          ThisPFModule = pf_module,                       \
          (*(type)(ThisPFModule->call)) args              \
         )
+#endif
 
 /**
  * Create a new instance of a module.
@@ -233,11 +274,20 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
  * @param args Arguments for the method to invoke
  * @return The new module instance pointer
  */
+#ifdef PFMODULE_TIMING
+#define PFModuleNewInstance(pf_module, args)                             \
+        ({                                                               \
+           PFModuleTimingScope(pf_module, TimingNodeSetup);              \
+           ThisPFModule = DupPFModule(pf_module);                        \
+           (*(PFModule * (*)())(ThisPFModule->init_instance_xtra)) args; \
+         })
+#else
 #define PFModuleNewInstance(pf_module, args)                          \
         (                                                             \
          ThisPFModule = DupPFModule(pf_module),                       \
          (*(PFModule * (*)())(ThisPFModule->init_instance_xtra)) args \
         )
+#endif
 
 /**
  * Create a new instance of a module.
@@ -251,11 +301,20 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
  * @param args Arguments for the method to invoke
  * @return The new module instance pointer
  */
+#ifdef PFMODULE_TIMING
+#define PFModuleNewInstanceType(type, pf_module, args)       \
+        ({                                                   \
+           PFModuleTimingScope(pf_module, TimingNodeSetup);  \
+           ThisPFModule = DupPFModule(pf_module);            \
+           (*(type)(ThisPFModule->init_instance_xtra)) args; \
+         })
+#else
 #define PFModuleNewInstanceType(type, pf_module, args)        \
         (                                                     \
          ThisPFModule = DupPFModule(pf_module),               \
          (*(type)(ThisPFModule->init_instance_xtra)) args     \
         )
+#endif
 
 /**
  * 'ReNew' the instance of a module.
@@ -275,11 +334,20 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
  * @param args Arguments for the method to invoke
  * @return The new module instance pointer
  */
+#ifdef PFMODULE_TIMING
+#define PFModuleReNewInstance(pf_module, args)                           \
+        ({                                                               \
+           PFModuleTimingScope(pf_module, TimingNodeSetup);              \
+           ThisPFModule = pf_module;                                     \
+           (*(PFModule * (*)())(ThisPFModule->init_instance_xtra)) args; \
+         })
+#else
 #define PFModuleReNewInstance(pf_module, args)                        \
         (                                                             \
          ThisPFModule = pf_module,                                    \
          (*(PFModule * (*)())(ThisPFModule->init_instance_xtra)) args \
         )
+#endif
 
 /**
  * 'ReNew' the instance of a module.
@@ -294,11 +362,20 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
  * @param args Arguments for the method to invoke.
  * @return The new module instance pointer.
  */
+#ifdef PFMODULE_TIMING
+#define PFModuleReNewInstanceType(type, pf_module, args)     \
+        ({                                                   \
+           PFModuleTimingScope(pf_module, TimingNodeSetup);  \
+           ThisPFModule = pf_module;                         \
+           (*(type)(ThisPFModule->init_instance_xtra)) args; \
+         })
+#else
 #define PFModuleReNewInstanceType(type, pf_module, args)        \
         (                                                       \
          ThisPFModule = pf_module,                              \
          (*(type)(ThisPFModule->init_instance_xtra)) args       \
         )
+#endif
 
 /**
  * Free the module.
@@ -368,6 +445,7 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
                                     (void*)name ## FreePublicXtra,    \
                                     (void*)name ## SizeOfTempData,    \
                                     NULL, NULL),                      \
+         PFModuleName(ThisPFModule) = #name,                          \
          (*(PFModule * (*)())(ThisPFModule->new_public_xtra)) args    \
         )
 
@@ -391,6 +469,7 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
                                     (void*)name ## FreePublicXtra,    \
                                     (void*)name ## SizeOfTempData,    \
                                     NULL, NULL),                      \
+         PFModuleName(ThisPFModule) = #name,                          \
          (*(type)(ThisPFModule->new_public_xtra)) args                \
         )
 
@@ -419,6 +498,7 @@ extern __device__ PFModule *dev_global_ptr_this_pf_module;
                                             (void*)name ## Output,           \
                                             (void*)name ## OutputStatic,     \
                                             NULL, NULL),                     \
+         PFModuleName(ThisPFModule) = #name,                                 \
          (*(type)(ThisPFModule->new_public_xtra)) args                       \
         )
 
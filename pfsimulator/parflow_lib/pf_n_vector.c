@@ -62,6 +62,7 @@ N_Vector PF_NVNewEmpty(SUNContext sunctx)
   v->ops->nvinv = PFVInvFcn;
   v->ops->nvaddconst = PFVAddConstFcn;
   v->ops->nvdotprod = PFVDotProdFcn;
+  v->ops->nvdotprodmulti = PFVDotProdMultiFcn;
   v->ops->nvmaxnorm = PFVMaxNormFcn;
   v->ops->nvwrmsnorm = PFVWrmsNormFcn;
   v->ops->nvwrmsnormmask = NULL;
@@ -288,6 +289,27 @@ double PFVDotProdFcn(
   return PFVDotProd(x, y);
 }
 
+int PFVDotProdMultiFcn(
+/* dot[m] = x dot y[m] with a single reduction   */
+                       int       nvec,
+                       N_Vector  xvec,
+                       N_Vector *yvec,
+                       double *  dot)
+{
+  Vector *x = N_VectorData(xvec);
+  Vector *y[nvec];
+  int m;
+
+  for (m = 0; m < nvec; m++)
+  {
+    y[m] = N_VectorData(yvec[m]);
+  }
+
+  PFVDotProdMulti(nvec, x, y, dot);
+
+  return 0;
+}
+
 double PFVMaxNormFcn(
 /* MaxNorm = || x ||_{max}   */
                      N_Vector xvec)
@@ -43,6 +43,9 @@ typedef struct {
   int smoother;
   int raptype;
 
+  int setup_interval;
+  int setup_iter_threshold;
+
   int hypre_logging;
 
   int time_index_pfmg;
@@ -58,6 +61,9 @@ typedef struct {
   HYPRE_StructStencil hypre_stencil;
 
   HYPRE_StructSolver hypre_pfmg_data;
+
+  int num_lagged_setups;        /* coefficient refreshes since the last PFMG setup */
+  int num_applies;              /* PFMG applications since the last refresh */
 } InstanceXtra;
 
 #endif
@@ -85,6 +91,8 @@ void         PFMG(
 
   HYPRE_StructSolver hypre_pfmg_data = instance_xtra->hypre_pfmg_data;
 
+  instance_xtra->num_applies++;
+
   /* Copy rhs to hypre_b vector. */
   BeginTiming(public_xtra->time_index_copy_hypre);
 
@@ -166,13 +174,21 @@ PFModule  *PFMGInitInstanceXtra(
 
   HypreAssembleGrid(grid, &(instance_xtra->hypre_grid), instance_xtra->dxyz);
 
-  /* Reset the HYPRE solver for each recompute of the PC matrix.
-   * This reset will require a matrix copy from PF format to HYPRE format. */
+  /* Copy the PC matrix from PF format to HYPRE format on each recompute.
+   * The PFMG hierarchy is rebuilt every SetupInterval recomputes, or
+   * sooner if the previous linear solve needed more than
+   * SetupLinearIterThreshold applications; otherwise the coefficients are
+   * refreshed in place and the lagged coarse levels are reused. */
   if (pf_Bmat != NULL)
   {
+    int rebuild = (instance_xtra->hypre_pfmg_data == NULL)
+                  || (instance_xtra->num_lagged_setups + 1 >= public_xtra->setup_interval)
+                  || (public_xtra->setup_iter_threshold > 0
+                      && instance_xtra->num_applies > public_xtra->setup_iter_threshold);
+
     /* Free old solver data because HYPRE requires a new solver if
-     * matrix values change */
-    if (instance_xtra->hypre_pfmg_data)
+     * the hierarchy is rebuilt */
+    if (rebuild && instance_xtra->hypre_pfmg_data)
     {
       HYPRE_StructPFMGDestroy(instance_xtra->hypre_pfmg_data);
       instance_xtra->hypre_pfmg_data = NULL;
@@ -196,41 +212,51 @@ PFModule  *PFMGInitInstanceXtra(
 
     EndTiming(public_xtra->time_index_copy_hypre);
 
-    /* Set up the PFMG preconditioner */
-    HYPRE_StructPFMGCreate(amps_CommWorld,
-                           &(instance_xtra->hypre_pfmg_data));
-
-    HYPRE_StructPFMGSetTol(instance_xtra->hypre_pfmg_data, 1.0e-30);
-    /* Set user parameters for PFMG */
-    HYPRE_StructPFMGSetMaxIter(instance_xtra->hypre_pfmg_data, max_iter);
-    HYPRE_StructPFMGSetNumPreRelax(instance_xtra->hypre_pfmg_data,
-                                   num_pre_relax);
-    HYPRE_StructPFMGSetNumPostRelax(instance_xtra->hypre_pfmg_data,
-                                    num_post_relax);
-    /* Jacobi = 0; weighted Jacobi = 1; red-black GS symmetric = 2; red-black GS non-symmetric = 3 */
-    HYPRE_StructPFMGSetRelaxType(instance_xtra->hypre_pfmg_data, smoother);
-
-    /* Galerkin=0; non-Galkerkin=1 */
-    HYPRE_StructPFMGSetRAPType(instance_xtra->hypre_pfmg_data, raptype);
-
-    HYPRE_StructPFMGSetSkipRelax(instance_xtra->hypre_pfmg_data, 1);
-
-    HYPRE_StructPFMGSetDxyz(instance_xtra->hypre_pfmg_data,
-                            instance_xtra->dxyz);
-
-    /* Enable logging BEFORE setup so that norms arrays are allocated */
-    if (public_xtra->hypre_logging)
+    if (rebuild)
     {
-      IfLogging(1)
+      /* Set up the PFMG preconditioner */
+      HYPRE_StructPFMGCreate(amps_CommWorld,
+                             &(instance_xtra->hypre_pfmg_data));
+
+      HYPRE_StructPFMGSetTol(instance_xtra->hypre_pfmg_data, 1.0e-30);
+      /* Set user parameters for PFMG */
+      HYPRE_StructPFMGSetMaxIter(instance_xtra->hypre_pfmg_data, max_iter);
+      HYPRE_StructPFMGSetNumPreRelax(instance_xtra->hypre_pfmg_data,
+                                     num_pre_relax);
+      HYPRE_StructPFMGSetNumPostRelax(instance_xtra->hypre_pfmg_data,
+                                      num_post_relax);
+      /* Jacobi = 0; weighted Jacobi = 1; red-black GS symmetric = 2; red-black GS non-symmetric = 3 */
+      HYPRE_StructPFMGSetRelaxType(instance_xtra->hypre_pfmg_data, smoother);
+
+      /* Galerkin=0; non-Galkerkin=1 */
+      HYPRE_StructPFMGSetRAPType(instance_xtra->hypre_pfmg_data, raptype);
+
+      HYPRE_StructPFMGSetSkipRelax(instance_xtra->hypre_pfmg_data, 1);
+
+      HYPRE_StructPFMGSetDxyz(instance_xtra->hypre_pfmg_data,
+                              instance_xtra->dxyz);
+
+      /* Enable logging BEFORE setup so that norms arrays are allocated */
+      if (public_xtra->hypre_logging)
       {
-        HYPRE_StructPFMGSetLogging(instance_xtra->hypre_pfmg_data, 1);
-        HYPRE_StructPFMGSetPrintLevel(instance_xtra->hypre_pfmg_data, 2);
+        IfLogging(1)
+        {
+          HYPRE_StructPFMGSetLogging(instance_xtra->hypre_pfmg_data, 1);
+          HYPRE_StructPFMGSetPrintLevel(instance_xtra->hypre_pfmg_data, 2);
+        }
       }
-    }
 
-    HYPRE_StructPFMGSetup(instance_xtra->hypre_pfmg_data,
-                          instance_xtra->hypre_mat,
-                          instance_xtra->hypre_b, instance_xtra->hypre_x);
+      HYPRE_StructPFMGSetup(instance_xtra->hypre_pfmg_data,
+                            instance_xtra->hypre_mat,
+                            instance_xtra->hypre_b, instance_xtra->hypre_x);
+
+      instance_xtra->num_lagged_setups = 0;
+    }
+    else
+    {
+      instance_xtra->num_lagged_setups++;
+    }
+    instance_xtra->num_applies = 0;
   }
 
   PFModuleInstanceXtra(this_module) = instance_xtra;
@@ -317,6 +343,17 @@ PFModule  *PFMGNewPublicXtra(char *name)
                smoother_name, key);
   }
 
+  sprintf(key, "%s.SetupInterval", name);
+  public_xtra->setup_interval = GetIntDefault(key, 1);
+  if (public_xtra->setup_interval < 1)
+  {
+    InputError("Error: invalid value <%s> for key <%s>, must be at least 1\n",
+               GetString(key), key);
+  }
+
+  sprintf(key, "%s.SetupLinearIterThreshold", name);
+  public_xtra->setup_iter_threshold = GetIntDefault(key, 0);
+
   {
     char *hypre_logging_str = GetStringDefault("Solver.Linear.Preconditioner.HypreLogging", "False");
     public_xtra->hypre_logging = (!strcmp(hypre_logging_str, "True")) ? 1 : 0;
@@ -54,6 +54,9 @@ typedef struct {
 
   int box_size_power;
 
+  int setup_interval;
+  int setup_iter_threshold;
+
   int hypre_logging;
 
   int time_index_pfmg;
@@ -72,6 +75,9 @@ typedef struct {
   HYPRE_StructStencil hypre_stencil;
 
   HYPRE_StructSolver hypre_pfmg_data;
+
+  int num_lagged_setups;        /* coefficient refreshes since the last PFMG setup */
+  int num_applies;              /* PFMG applications since the last refresh */
 } InstanceXtra;
 
 /*--------------------------------------------------------------------------
@@ -116,6 +122,8 @@ void         PFMGOctree(
 
   (void)zero;
 
+  instance_xtra->num_applies++;
+
   /* Copy rhs to hypre_b vector. */
   BeginTiming(public_xtra->time_index_copy_hypre);
 
@@ -414,13 +422,19 @@ PFModule  *PFMGOctreeInitInstanceXtra(
     HYPRE_StructGridAssemble(instance_xtra->hypre_grid);
   }
 
-  /* Reset the HYPRE solver for each recompute of the PC matrix.
-   * This reset will require a matrix copy from PF format to HYPRE format. */
+  /* Copy the PC matrix from PF format to HYPRE format on each recompute.
+   * The PFMG hierarchy is only rebuilt as described in PFMGInitInstanceXtra;
+   * between rebuilds the coefficients are refreshed in place. */
   if (pf_Bmat != NULL)
   {
+    int rebuild = (instance_xtra->hypre_pfmg_data == NULL)
+                  || (instance_xtra->num_lagged_setups + 1 >= public_xtra->setup_interval)
+                  || (public_xtra->setup_iter_threshold > 0
+                      && instance_xtra->num_applies > public_xtra->setup_iter_threshold);
+
     /* Free old solver data because HYPRE requires a new solver if
-     * matrix values change */
-    if (instance_xtra->hypre_pfmg_data)
+     * the hierarchy is rebuilt */
+    if (rebuild && instance_xtra->hypre_pfmg_data)
     {
       HYPRE_StructPFMGDestroy(instance_xtra->hypre_pfmg_data);
       instance_xtra->hypre_pfmg_data = NULL;
@@ -1009,41 +1023,51 @@ PFModule  *PFMGOctreeInitInstanceXtra(
 
     EndTiming(public_xtra->time_index_copy_hypre);
 
-    /* Set up the PFMG preconditioner */
-    HYPRE_StructPFMGCreate(amps_CommWorld,
-                           &(instance_xtra->hypre_pfmg_data));
-
-    HYPRE_StructPFMGSetTol(instance_xtra->hypre_pfmg_data, 1.0e-30);
-    /* Set user parameters for PFMG */
-    HYPRE_StructPFMGSetMaxIter(instance_xtra->hypre_pfmg_data, max_iter);
-    HYPRE_StructPFMGSetNumPreRelax(instance_xtra->hypre_pfmg_data,
-                                   num_pre_relax);
-    HYPRE_StructPFMGSetNumPostRelax(instance_xtra->hypre_pfmg_data,
-                                    num_post_relax);
-    /* Jacobi = 0; weighted Jacobi = 1; red-black GS symmetric = 2; red-black GS non-symmetric = 3 */
-    HYPRE_StructPFMGSetRelaxType(instance_xtra->hypre_pfmg_data, smoother);
-
-    /* Use non-Galkerkin option */
-    HYPRE_StructPFMGSetRAPType(instance_xtra->hypre_pfmg_data, 1);
-
-    HYPRE_StructPFMGSetSkipRelax(instance_xtra->hypre_pfmg_data, 1);
-
-    HYPRE_StructPFMGSetDxyz(instance_xtra->hypre_pfmg_data,
-                            instance_xtra->dxyz);
-
-    /* Set logging and print level for hypre output */
-    if (public_xtra->hypre_logging)
+    if (rebuild)
     {
-      IfLogging(1)
+      /* Set up the PFMG preconditioner */
+      HYPRE_StructPFMGCreate(amps_CommWorld,
+                             &(instance_xtra->hypre_pfmg_data));
+
+      HYPRE_StructPFMGSetTol(instance_xtra->hypre_pfmg_data, 1.0e-30);
+      /* Set user parameters for PFMG */
+      HYPRE_StructPFMGSetMaxIter(instance_xtra->hypre_pfmg_data, max_iter);
+      HYPRE_StructPFMGSetNumPreRelax(instance_xtra->hypre_pfmg_data,
+                                     num_pre_relax);
+      HYPRE_StructPFMGSetNumPostRelax(instance_xtra->hypre_pfmg_data,
+                                      num_post_relax);
+      /* Jacobi = 0; weighted Jacobi = 1; red-black GS symmetric = 2; red-black GS non-symmetric = 3 */
+      HYPRE_StructPFMGSetRelaxType(instance_xtra->hypre_pfmg_data, smoother);
+
+      /* Use non-Galkerkin option */
+      HYPRE_StructPFMGSetRAPType(instance_xtra->hypre_pfmg_data, 1);
+
+      HYPRE_StructPFMGSetSkipRelax(instance_xtra->hypre_pfmg_data, 1);
+
+      HYPRE_StructPFMGSetDxyz(instance_xtra->hypre_pfmg_data,
+                              instance_xtra->dxyz);
+
+      /* Set logging and print level for hypre output */
+      if (public_xtra->hypre_logging)
       {
-        HYPRE_StructPFMGSetLogging(instance_xtra->hypre_pfmg_data, 1);
-        HYPRE_StructPFMGSetPrintLevel(instance_xtra->hypre_pfmg_data, 2);
+        IfLogging(1)
+        {
+          HYPRE_StructPFMGSetLogging(instance_xtra->hypre_pfmg_data, 1);
+          HYPRE_StructPFMGSetPrintLevel(instance_xtra->hypre_pfmg_data, 2);
+        }
       }
-    }
 
-    HYPRE_StructPFMGSetup(instance_xtra->hypre_pfmg_data,
-                          instance_xtra->hypre_mat,
-                          instance_xtra->hypre_b, instance_xtra->hypre_x);
+      HYPRE_StructPFMGSetup(instance_xtra->hypre_pfmg_data,
+                            instance_xtra->hypre_mat,
+                            instance_xtra->hypre_b, instance_xtra->hypre_x);
+
+      instance_xtra->num_lagged_setups = 0;
+    }
+    else
+    {
+      instance_xtra->num_lagged_setups++;
+    }
+    instance_xtra->num_applies = 0;
   }
 
   PFModuleInstanceXtra(this_module) = instance_xtra;
@@ -1113,6 +1137,17 @@ PFModule  *PFMGOctreeNewPublicXtra(char *name)
   public_xtra->smoother = NA_NameToIndexExitOnError(smoother_switch_na, smoother_name, key);
   NA_FreeNameArray(smoother_switch_na);
 
+  sprintf(key, "%s.SetupInterval", name);
+  public_xtra->setup_interval = GetIntDefault(key, 1);
+  if (public_xtra->setup_interval < 1)
+  {
+    InputError("Error: invalid value <%s> for key <%s>, must be at least 1\n",
+               GetString(key), key);
+  }
+
+  sprintf(key, "%s.SetupLinearIterThreshold", name);
+  public_xtra->setup_iter_threshold = GetIntDefault(key, 0);
+
   {
     char *hypre_logging_str = GetStringDefault("Solver.Linear.Preconditioner.HypreLogging", "False");
     public_xtra->hypre_logging = (!strcmp(hypre_logging_str, "True")) ? 1 : 0;
@@ -40,6 +40,8 @@
 typedef struct {
   int num_phases;
   //int     iflag;   //@RMM
+
+  int file_cache_size;
 } PublicXtra;
 
 typedef struct {
@@ -49,8 +51,160 @@ typedef struct {
   double     ***elevations;
   ProblemData  *problem_data;
   Grid         *grid;
+
+  BCPressureFileCache *file_cache;
 } InstanceXtra;
 
+/*--------------------------------------------------------------------------
+ * BCPressureFileName:
+ *   Name of the input file of a file based patch for an interval.
+ *--------------------------------------------------------------------------*/
+
+static char *BCPressureFileName(
+                                BCPressureData *bc_pressure_data,
+                                int             ipatch,
+                                int             interval_number)
+{
+  switch (BCPressureDataType(bc_pressure_data, ipatch))
+  {
+    case PressureFile:
+    {
+      GetBCPressureTypeStruct(PressureFile, interval_data, bc_pressure_data,
+                              ipatch, interval_number);
+      return PressureFileName(interval_data);
+    }
+
+    case FluxFile:
+    {
+      GetBCPressureTypeStruct(FluxFile, interval_data, bc_pressure_data,
+                              ipatch, interval_number);
+      return FluxFileName(interval_data);
+    }
+
+    case OverlandFlowPFB:
+    {
+      GetBCPressureTypeStruct(OverlandFlowPFB, interval_data, bc_pressure_data,
+                              ipatch, interval_number);
+      return OverlandFlowPFBFileName(interval_data);
+    }
+  }
+
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------
+ * BCPressureFileValues:
+ *   Set the patch values of a file based patch.  Only the patch cells are
+ *   read from the file, the values are cached across repeats of the time
+ *   cycle and the file of the next interval is read ahead.
+ *--------------------------------------------------------------------------*/
+
+static void BCPressureFileValues(
+                                 InstanceXtra *  instance_xtra,
+                                 int             file_cache_size,
+                                 BCPressureData *bc_pressure_data,
+                                 BCStruct *      bc_struct,
+                                 SubgridArray *  subgrids,
+                                 int             ipatch,
+                                 int             interval_number,
+                                 double ***      values)
+{
+  TimeCycleData *time_cycle_data = BCPressureDataTimeCycleData(bc_pressure_data);
+  int cycle_number = BCPressureDataCycleNumber(bc_pressure_data, ipatch);
+  int num_intervals = TimeCycleDataIntervalDivision(time_cycle_data, cycle_number);
+  int repeat_count = TimeCycleDataRepeatCount(time_cycle_data, cycle_number);
+  int num_subgrids = SubgridArraySize(subgrids);
+
+  BCPressureFileCache *file_cache;
+  double             **file_values;
+  double              *patch_values;
+  int                 *num_cells;
+  int                **cell_indexes;
+  int patch_values_size;
+  int next_interval;
+  int is, i, j, k, ival;
+  int cells_changed;
+
+  if (instance_xtra->file_cache == NULL)
+  {
+    instance_xtra->file_cache =
+      NewBCPressureFileCache(BCPressureDataNumPatches(bc_pressure_data),
+                             file_cache_size);
+  }
+  file_cache = instance_xtra->file_cache;
+
+  num_cells = ctalloc(int, num_subgrids);
+
+  cells_changed = 0;
+  ForSubgridI(is, subgrids)
+  {
+    ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
+    {
+      num_cells[is]++;
+    });
+
+    if (num_cells[is] != BCPressureFileCacheNumCells(file_cache, ipatch, is))
+    {
+      cells_changed = 1;
+    }
+  }
+
+  /* The patch cells only change with the grid */
+  if (cells_changed)
+  {
+    cell_indexes = ctalloc(int *, num_subgrids);
+    ForSubgridI(is, subgrids)
+    {
+      cell_indexes[is] = talloc(int, 3 * num_cells[is]);
+      ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
+      {
+        cell_indexes[is][3 * ival] = i;
+        cell_indexes[is][3 * ival + 1] = j;
+        cell_indexes[is][3 * ival + 2] = k;
+      });
+    }
+
+    BCPressureFileCacheSetCells(file_cache, ipatch, num_intervals,
+                                num_subgrids, num_cells, cell_indexes);
+
+    ForSubgridI(is, subgrids)
+    {
+      tfree(cell_indexes[is]);
+    }
+    tfree(cell_indexes);
+  }
+
+  file_values = BCPressureFileCacheRead(file_cache, ipatch, interval_number,
+                                        BCPressureFileName(bc_pressure_data, ipatch,
+                                                           interval_number));
+
+  ForSubgridI(is, subgrids)
+  {
+    patch_values_size = num_cells[is];
+
+    patch_values = talloc(double, patch_values_size);
+    memcpy(patch_values, file_values[is], patch_values_size * sizeof(double));
+    values[ipatch][is] = patch_values;
+  }
+
+  tfree(num_cells);
+
+  /* Read ahead the file of the next interval, wrapping around if the
+   * cycle repeats */
+  next_interval = interval_number + 1;
+  if (next_interval == num_intervals)
+  {
+    next_interval = (repeat_count < 0 || repeat_count > 1) ? 0 : -1;
+  }
+
+  if (next_interval >= 0 && next_interval != interval_number)
+  {
+    BCPressureFileCachePrefetch(file_cache, ipatch, next_interval,
+                                BCPressureFileName(bc_pressure_data, ipatch,
+                                                   next_interval));
+  }
+}
+
 /*--------------------------------------------------------------------------
  * BCPressure:
  *   This routine returns a BCStruct structure which describes where
@@ -674,106 +828,18 @@ BCStruct    *BCPressure(
           /* Read input pressures from file (temporary).
            * This case assumes hydraulic head input conditions and
            * a constant density.  */
-          Vector          *tmp_vector;
-          Subvector       *subvector;
-          char            *filename;
-          double          *tmpp;
-          int itmp;
-          double density, dtmp;
-
-          /* Calculate density using dtmp as dummy argument. */
-          dtmp = 0.0;
-          PFModuleInvokeType(PhaseDensityInvoke, phase_density,
-                             (0, NULL, NULL, &dtmp, &density, CALCFCN));
-
-          GetBCPressureTypeStruct(PressureFile, interval_data, bc_pressure_data,
-                                  ipatch, interval_number);
-
-          ForSubgridI(is, subgrids)
-          {
-            subgrid = SubgridArraySubgrid(subgrids, is);
-
-            z_mult_sub = VectorSubvector(z_mult, is);
-            rsz_sub = VectorSubvector(rsz, is);
-            z_mult_dat = SubvectorData(z_mult_sub);
-            rsz_dat = SubvectorData(rsz_sub);
-
-            /* compute patch_values_size (this isn't really needed yet) */
-            patch_values_size = 0;
-            ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
-            {
-              patch_values_size++;
-            });
-
-            patch_values = talloc(double, patch_values_size);
-            memset(patch_values, 0, patch_values_size * sizeof(double));
-            values[ipatch][is] = patch_values;
-
-            tmp_vector = NewVectorType(grid, 1, 0, vector_cell_centered);
-
-            filename = PressureFileName(interval_data);
-            ReadPFBinary(filename, tmp_vector);
-
-            subvector = VectorSubvector(tmp_vector, is);
-
-            tmpp = SubvectorData(subvector);
-            ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
-            {
-              /*int ips = SubvectorEltIndex(z_mult_sub, i, j, k);*/
-              itmp = SubvectorEltIndex(subvector, i, j, k);
-
-              patch_values[ival] = tmpp[itmp];     /*- density*gravity*z;*/
-              /*last part taken out, very likely to be a bug)*/
-            });
-
-            FreeVector(tmp_vector);
-          }             /* End subgrid loop */
+          BCPressureFileValues(instance_xtra, public_xtra->file_cache_size,
+                               bc_pressure_data, bc_struct, subgrids,
+                               ipatch, interval_number, values);
           break;
         } /* End PressureFile */
 
         case FluxFile:
         {
           /* Read input fluxes from file (temporary) */
-          Vector          *tmp_vector;
-          Subvector       *subvector;
-          char            *filename;
-          double          *tmpp;
-          int itmp;
-
-          GetBCPressureTypeStruct(FluxFile, interval_data, bc_pressure_data,
-                                  ipatch, interval_number);
-
-
-          ForSubgridI(is, subgrids)
-          {
-            /* compute patch_values_size (this isn't really needed yet) */
-            patch_values_size = 0;
-            ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
-            {
-              patch_values_size++;
-            });
-
-            patch_values = talloc(double, patch_values_size);
-            memset(patch_values, 0, patch_values_size * sizeof(double));
-            values[ipatch][is] = patch_values;
-
-            tmp_vector = NewVectorType(grid, 1, 0, vector_cell_centered);
-
-            filename = FluxFileName(interval_data);
-            ReadPFBinary(filename, tmp_vector);
-
-            subvector = VectorSubvector(tmp_vector, is);
-
-            tmpp = SubvectorData(subvector);
-            ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
-            {
-              itmp = SubvectorEltIndex(subvector, i, j, k);
-
-              patch_values[ival] = tmpp[itmp];
-            });
-
-            FreeVector(tmp_vector);
-          }         /* End subgrid loop */
+          BCPressureFileValues(instance_xtra, public_xtra->file_cache_size,
+                               bc_pressure_data, bc_struct, subgrids,
+                               ipatch, interval_number, values);
           break;
         } /* End FluxFile */
 
@@ -990,50 +1056,9 @@ BCStruct    *BCPressure(
         case OverlandFlowPFB:
         {
           /* Read input fluxes from file (overland) */
-          Vector          *tmp_vector;
-          Subvector       *subvector;
-          //double          *data;
-          char            *filename;
-          double          *tmpp;
-          int itmp;
-
-          GetBCPressureTypeStruct(OverlandFlowPFB, interval_data, bc_pressure_data,
-                                  ipatch, interval_number);
-
-          ForSubgridI(is, subgrids)
-          {
-            /* compute patch_values_size (this isn't really needed yet) */
-            patch_values_size = 0;
-            ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
-            {
-              patch_values_size++;
-            });
-
-            patch_values = talloc(double, patch_values_size);
-            memset(patch_values, 0, patch_values_size * sizeof(double));
-            values[ipatch][is] = patch_values;
-
-            tmp_vector = NewVectorType(grid, 1, 0, vector_cell_centered);
-            //data = ctalloc(double, SizeOfVector(tmp_vector));
-            //SetTempVectorData(tmp_vector, data);
-
-            printf("reading overland file \n");
-            filename = OverlandFlowPFBFileName(interval_data);
-            ReadPFBinary(filename, tmp_vector);
-
-            subvector = VectorSubvector(tmp_vector, is);
-
-            tmpp = SubvectorData(subvector);
-            ForEachPatchCell(i, j, k, ival, bc_struct, ipatch, is,
-            {
-              itmp = SubvectorEltIndex(subvector, i, j, k);
-
-              patch_values[ival] = tmpp[itmp];
-            });
-
-            //tfree(VectorData(tmp_vector));
-            FreeVector(tmp_vector);
-          }              /* End subgrid loop */
+          BCPressureFileValues(instance_xtra, public_xtra->file_cache_size,
+                               bc_pressure_data, bc_struct, subgrids,
+                               ipatch, interval_number, values);
           break;
         } /* End OverlandFlowPFB */
 
@@ -1217,6 +1242,7 @@ void BCPressureFreeInstanceXtra()
 
       tfree(instance_xtra->elevations);
     }
+    FreeBCPressureFileCache(instance_xtra->file_cache);
     PFModuleFreeInstance(instance_xtra->phase_density);
     tfree(instance_xtra);
   }
@@ -1238,6 +1264,8 @@ PFModule  *BCPressureNewPublicXtra(
 
   (public_xtra->num_phases) = num_phases;
 
+  public_xtra->file_cache_size = GetIntDefault("BCPressure.FileCacheSize", 32);
+
   PFModulePublicXtra(this_module) = public_xtra;
   return this_module;
 }
@@ -27,6 +27,7 @@
 **********************************************************************EHEADER*/
 
 #include "parflow.h"
+#include "van_genuchten.h"
 
 #include <string.h>
 #include <assert.h>
@@ -56,37 +57,19 @@ typedef struct {
 } Type0;
 
 
-typedef struct {
-  double min_pressure_head;
-  int num_sample_points;
-
-  double *x;
-  double *a;
-  double *d;
-  double *a_der;
-  double *d_der;
-
-  /* used by linear interpolation method */
-  double *slope;
-  double *slope_der;
-
-  int interpolation_method;
-
-  double interval;
-} VanGTable;
-
 typedef struct {
   int num_regions;
   int    *region_indices;
   int data_from_file;
   double *alphas;
   double *ns;
+  double *ms;                 /* 1 - 1/n */
   char   *alpha_file;
   char   *n_file;
   Vector *alpha_values;
   Vector *n_values;
 
-  VanGTable **lookup_tables;
+  VanGTables *lookup_tables;
 
 #ifdef PF_PRINT_VG_TABLE
   int     *print_table;
@@ -113,293 +96,6 @@ typedef struct {
 } Type4;                      /* Polynomial Function for Rel. Perm. */
 
 
-VanGTable *VanGComputeTable(
-                            int    interpolation_method,
-                            int    num_sample_points,
-                            double min_pressure_head,
-                            double alpha,
-                            double n)
-{
-  double *x, *a, *d, *a_der, *d_der;
-
-  VanGTable *new_table = ctalloc(VanGTable, 1);
-
-  new_table->interpolation_method = interpolation_method;
-
-  new_table->num_sample_points = num_sample_points;
-  new_table->min_pressure_head = min_pressure_head;
-
-  new_table->x = ctalloc(double, num_sample_points + 1); // interpolation points
-  new_table->a = ctalloc(double, num_sample_points + 1); // function value at interpolation point
-  new_table->d = ctalloc(double, num_sample_points + 1); // derivative used in monotonic spline
-  new_table->a_der = ctalloc(double, num_sample_points + 1); // function derivative value
-  new_table->d_der = ctalloc(double, num_sample_points + 1); // derivative of function derivative
-
-  /* Fill in slope for linear interpolation */
-  if (interpolation_method == 1)
-  {
-    new_table->slope = ctalloc(double, num_sample_points + 1);      // slope for linear interpolation
-    new_table->slope_der = ctalloc(double, num_sample_points + 1);  // slope for linear interpolation
-  }
-
-  x = new_table->x;
-  a = new_table->a;
-  d = new_table->d;
-  a_der = new_table->a_der;
-  d_der = new_table->d_der;
-
-  double h[num_sample_points + 1];
-  double f[num_sample_points + 1], del[num_sample_points + 1], f_der[num_sample_points + 1];
-  double del_der[num_sample_points + 1];
-  double alph, beta, magn;
-  int index;
-  double interval, m;
-
-  // Loop over sample min_pressure_head to 0.0, min_pressure_head/num_sample_points step
-  interval = min_pressure_head / (double)(num_sample_points - 1);
-  new_table->interval = fabs(interval);
-  m = 1.0e0 - (1.0e0 / n);
-
-  // evenly spaced interpolation points (future: variably spaced points)
-  for (index = 0; index <= num_sample_points; index++)
-  {
-    x[index] = fabs(index * interval);
-    double opahn = 1.0 + pow(alpha * x[index], n);
-    double ahnm1 = pow(alpha * x[index], n - 1);
-    // calculating function at interpolation points
-    a[index] = pow(1.0 - ahnm1 / (pow(opahn, m)), 2)
-               / pow(opahn, (m / 2));
-
-    double coeff = 1.0 - ahnm1 * pow(opahn, -m);
-    // calculating derivative at interpolation points
-    a_der[index] = 2.0 * (coeff / (pow(opahn, (m / 2))))
-                   * ((n - 1) * pow(alpha * x[index], n - 2) * alpha
-                      * pow(opahn, -m)
-                      - ahnm1 * m * pow(opahn, -(m + 1)) * n * alpha * ahnm1)
-                   + pow(coeff, 2) * (m / 2) * pow(opahn, (-(m + 2) / 2))
-                   * n * alpha * ahnm1;
-    //CPS fix of 1<n<2, K is infinite at pressure head = 0
-    if ((n < 2) && (index == 0))
-    {
-      a_der[index] = 0;
-    }
-  }
-
-  /* Fill in slope for linear interpolation */
-  if (interpolation_method == 1)
-  {
-    for (index = 0; index < num_sample_points; index++)
-    {
-      new_table->slope[index] = (a[index + 1] - a[index]) /
-                                new_table->interval;
-      new_table->slope_der[index] = (a_der[index + 1] - a_der[index]) /
-                                    new_table->interval;
-    }
-  }
-
-  // GCC 11.3.0 WITH optimization warns that del is possibly used without initialization.
-  // This silences the warning.   Looks like a false warning, what is the opt doing?
-  memset(del, num_sample_points + 1, sizeof(double));
-  // begin monotonic spline (see Fritsch and Carlson, SIAM J. Num. Anal., 17 (2), 1980)
-  for (index = 0; index < num_sample_points; index++)
-  {
-    h[index] = x[index + 1] - x[index];
-    f[index] = a[index + 1] - a[index];
-    del[index] = f[index] / h[index];
-    f_der[index] = a_der[index + 1] - a_der[index];
-    del_der[index] = f_der[index] / h[index];
-  }
-  d[0] = del[0];
-  d[num_sample_points] = del[num_sample_points - 1];
-  d_der[0] = del_der[0];
-  d_der[num_sample_points] = del_der[num_sample_points - 1];
-
-  for (index = 1; index < num_sample_points; index++)
-  {
-    d[index] = (del[index - 1] + del[index]) / 2;
-    d_der[index] = (del_der[index - 1] + del_der[index]) / 2;
-  }
-
-
-  for (index = 0; index < num_sample_points; index++)
-  {
-    if (del[index] == 0.0)
-    {
-      d[index] = 0;
-      d[index + 1] = 0;
-    }
-    else
-    {
-      alph = d[index] / del[index];
-      beta = d[index + 1] / del[index];
-      magn = pow(alph, 2) + pow(beta, 2);
-      if (magn > 9.0)
-      {
-        d[index] = 3 * alph * del[index] / magn;
-        d[index + 1] = 3 * beta * del[index] / magn;
-      }
-    }
-
-    if (del_der[index] == 0.0)
-    {
-      d_der[index] = 0;
-      d_der[index + 1] = 0;
-    }
-    else
-    {
-      // to ensure monotonicity
-      alph = d_der[index] / del_der[index];
-      beta = d_der[index + 1] / del_der[index];
-      magn = pow(alph, 2) + pow(beta, 2);
-      if (magn > 9.0)
-      {
-        d_der[index] = 3 * alph * del_der[index] / magn;
-        d_der[index + 1] = 3 * beta * del_der[index] / magn;
-      }
-    }
-  }
-  return new_table;
-}
-
-__host__ __device__
-static inline double VanGLookupSpline(
-                                      double     pressure_head,
-                                      VanGTable *lookup_table,
-                                      int        fcn)
-{
-  double rel_perm, t;
-  int pt = 0;
-  int num_sample_points = lookup_table->num_sample_points;
-  double min_pressure_head = lookup_table->min_pressure_head;
-  int max = num_sample_points + 1;
-
-  // This table goes from 0 to fabs(min_pressure_head)
-  assert(pressure_head >= 0);
-
-  // SGS TODO add warning in output?
-  // Make sure values are in the table range, if lower then set to the 0.0 which is limit of VG curve
-  if (pressure_head >= fabs(min_pressure_head))
-  {
-    return 0.0;
-  }
-  else
-  {
-    // Use direct table lookup to avoid using this binary search since
-    // we have uniformly spaced points.
-    double interval = lookup_table->interval;
-    pt = (int)floor(pressure_head / interval);
-    if (pt > max)
-    {
-      pt = max - 1;
-    }
-
-#if 0
-    // When using variably spaced interpolation points, use binary
-    // search to find the interval
-    {
-      int min = 0;
-      int mid;
-
-      while (max != min + 1)
-      {
-        mid = min + floor((max - min) / 2);
-        if (pressure_head == lookup_table->x[mid])
-        {
-          min = mid;
-          max = min + 1;
-        }
-        if (pressure_head < lookup_table->x[mid])
-        {
-          max = mid;
-        }
-        else
-        {
-          min = mid;
-        }
-      }
-      pt = min;
-    }
-#endif
-  }
-
-  double x = lookup_table->x[pt];
-  double a = lookup_table->a[pt];
-  double d = lookup_table->d[pt];
-  double a_der = lookup_table->a_der[pt];
-  double d_der = lookup_table->d_der[pt];
-
-  // using cubic Hermite interpolation
-  if (fcn == CALCFCN)
-  {
-    t = (pressure_head - x) / (lookup_table->x[pt + 1] - x);
-    rel_perm = (2.0 * pow(t, 3) - 3.0 * pow(t, 2) + 1.0) * a
-               + (pow(t, 3) - 2.0 * pow(t, 2) + t)
-               * (lookup_table->x[pt + 1] - x) * d + (-2.0 * pow(t, 3)
-                                                      + 3.0 * pow(t, 2)) * (lookup_table->a[pt + 1])
-               + (pow(t, 3) - pow(t, 2)) * (lookup_table->x[pt + 1] - x)
-               * (lookup_table->d[pt + 1]);
-  }
-  else
-  {
-    t = (pressure_head - x) / (lookup_table->x[pt + 1] - x);
-    rel_perm = (2.0 * pow(t, 3) - 3.0 * pow(t, 2) + 1.0) * a_der
-               + (pow(t, 3) - 2.0 * pow(t, 2) + t)
-               * (lookup_table->x[pt + 1] - x) * d_der + (-2.0 * pow(t, 3)
-                                                          + 3.0 * pow(t, 2)) * (lookup_table->a_der[pt + 1])
-               + (pow(t, 3) - pow(t, 2)) * (lookup_table->x[pt + 1] - x)
-               * (lookup_table->d_der[pt + 1]);
-  }
-
-  return rel_perm;
-}
-
-#ifdef PF_PRINT_VG_TABLE
-static inline double VanGLookupLinear(
-                                      double     pressure_head,
-                                      VanGTable *lookup_table,
-                                      int        fcn)
-{
-  double rel_perm = 0.0;
-  int pt = 0;
-  int num_sample_points = lookup_table->num_sample_points;
-  double min_pressure_head = lookup_table->min_pressure_head;
-  int max = num_sample_points + 1;
-
-  PF_UNUSED(max);
-
-  // This table goes from 0 to fabs(min_pressure_head)
-  assert(pressure_head >= 0);
-
-  // SGS TODO add warning in output?
-  // Make sure values are in the table range, if lower then set to the 0.0 which is limit of VG curve
-  if (pressure_head < fabs(min_pressure_head))
-  {
-    double interval = lookup_table->interval;
-
-    // Use direct table lookup to avoid using this binary search since
-    // we have uniformly spaced points.
-
-    pt = (int)floor(pressure_head / interval);
-    assert(pt < max);
-
-    // using cubic Hermite interpolation
-
-
-    if (fcn == CALCFCN)
-    {
-      rel_perm = lookup_table->a[pt] + lookup_table->slope[pt] * (pressure_head - lookup_table->x[pt]);
-    }
-    else
-    {
-      rel_perm = lookup_table->a_der[pt] + lookup_table->slope_der[pt] * (pressure_head - lookup_table->x[pt]);
-    }
-  }
-
-  return rel_perm;
-}
-#endif
-
-
 /*--------------------------------------------------------------------------
  * PhaseRelPerm:
  *    This routine calculates relative permeabilities given a set of
@@ -567,7 +263,7 @@ void         PhaseRelPerm(
     case 1: /* Van Genuchten relative permeability */
     {
       int data_from_file;
-      double  *alphas, *ns;
+      double  *alphas, *ns, *ms;
 
       Vector  *n_values, *alpha_values;
 
@@ -577,6 +273,7 @@ void         PhaseRelPerm(
       region_indices = (dummy1->region_indices);
       alphas = (dummy1->alphas);
       ns = (dummy1->ns);
+      ms = (dummy1->ms);
       data_from_file = (dummy1->data_from_file);
 
       /* Compute rel perms for Dirichlet boundary conditions */
@@ -612,43 +309,41 @@ void         PhaseRelPerm(
             /*
              * This is a debugging tool that prints out function eval
              * and table values */
-            if (dummy1->print_table[ir] && (dummy1->lookup_tables[ir]))
+            if (dummy1->print_table[ir] && VanGTablesTable(dummy1->lookup_tables, ir))
             {
+              VanGTable *print_table = VanGTablesTable(dummy1->lookup_tables, ir);
+
               dummy1->print_table[ir] = 0;
 
-              for (double head = 0.0; head < fabs((dummy1->lookup_tables[ir])->min_pressure_head); head += 0.001)
+              for (double head = 0.0; head < print_table->max_head; head += 0.001)
               {
                 double alpha = alphas[ir];
                 double n = ns[ir];
-                double m = 1.0e0 - (1.0e0 / n);
+                double m = ms[ir];
 
                 double opahn = 1.0 + pow(alpha * head, n);
                 double ahnm1 = pow(alpha * head, n - 1);
                 double f_val = pow(1.0 - ahnm1 / (pow(opahn, m)), 2)
                                / pow(opahn, (m / 2));
+                double t_val = (print_table->interpolation_method == VANG_TABLE_LINEAR)
+                               ? VanGTableLookupLinear(print_table, head, CALCFCN)
+                               : VanGTableLookupSpline(print_table, head, CALCFCN);
 
                 printf("DebugTableFn, %d, %e, %e, %e, %e, %e\n",
                        ir,
                        head,
                        f_val,
-                       VanGLookupLinear(head,
-                                        dummy1->lookup_tables[ir],
-                                        CALCFCN),
-                       fabs(VanGLookupLinear(head,
-                                             dummy1->lookup_tables[ir],
-                                             CALCFCN) - f_val),
-                       fabs((VanGLookupLinear(head,
-                                              dummy1->lookup_tables[ir],
-                                              CALCFCN) - f_val) / f_val)
-
+                       t_val,
+                       fabs(t_val - f_val),
+                       fabs((t_val - f_val) / f_val)
                        );
               }
 
-              for (double head = 0.0; head < fabs((dummy1->lookup_tables[ir])->min_pressure_head); head += 0.001)
+              for (double head = 0.0; head < print_table->max_head; head += 0.001)
               {
                 double alpha = alphas[ir];
                 double n = ns[ir];
-                double m = 1.0e0 - (1.0e0 / n);
+                double m = ms[ir];
 
                 double opahn = 1.0 + pow(alpha * head, n);
                 double ahnm1 = pow(alpha * head, n - 1);
@@ -660,20 +355,17 @@ void         PhaseRelPerm(
                                   - ahnm1 * m * pow(opahn, -(m + 1)) * n * alpha * ahnm1)
                                + pow(coeff, 2) * (m / 2) * pow(opahn, (-(m + 2) / 2))
                                * n * alpha * ahnm1;
+                double t_val = (print_table->interpolation_method == VANG_TABLE_LINEAR)
+                               ? VanGTableLookupLinear(print_table, head, CALCDER)
+                               : VanGTableLookupSpline(print_table, head, CALCDER);
 
                 printf("DebugTableDer, %d, %e, %e, %e, %e, %e\n",
                        ir,
                        head,
                        f_val,
-                       VanGLookupLinear(head,
-                                        dummy1->lookup_tables[ir],
-                                        CALCDER),
-                       fabs(VanGLookupLinear(head,
-                                             dummy1->lookup_tables[ir],
-                                             CALCDER) - f_val),
-                       fabs((VanGLookupLinear(head,
-                                              dummy1->lookup_tables[ir],
-                                              CALCDER) - f_val) / f_val)
+                       t_val,
+                       fabs(t_val - f_val),
+                       fabs((t_val - f_val) / f_val)
                        );
               }
             }
@@ -681,12 +373,13 @@ void         PhaseRelPerm(
 
             if (fcn == CALCFCN)
             {
-              if (dummy1->lookup_tables[ir])
+              VanGTable *lookup_table = VanGTablesTable(dummy1->lookup_tables, ir);
+
+              if (lookup_table)
               {
-                switch (dummy1->lookup_tables[ir]->interpolation_method)
+                switch (lookup_table->interpolation_method)
                 {
-                  // Spline
-                  case 0:
+                  case VANG_TABLE_SPLINE:
                   {
                     GrGeomSurfLoop(i, j, k, fdir, gr_solid, r, ix, iy, iz,
                                    nx, ny, nz,
@@ -706,24 +399,14 @@ void         PhaseRelPerm(
                       {
                         double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
 
-                        prdat[ipr] = VanGLookupSpline(head,
-                                                      dummy1->lookup_tables[ir],
-                                                      CALCFCN);
+                        prdat[ipr] = VanGTableLookupSpline(lookup_table, head, CALCFCN);
                       }
                     });
                   }
                   break;
 
-                  // Linear
-                  case 1:
+                  case VANG_TABLE_LINEAR:
                   {
-                    VanGTable *lookup_table = dummy1->lookup_tables[ir];
-                    double interval = lookup_table->interval;
-                    double min_pressure_head = lookup_table->min_pressure_head;
-                    int num_sample_points = lookup_table->num_sample_points;
-                    int max = num_sample_points + 1;
-                    PF_UNUSED(max);
-
                     GrGeomSurfLoop(i, j, k, fdir, gr_solid, r, ix, iy, iz,
                                    nx, ny, nz,
                     {
@@ -742,18 +425,7 @@ void         PhaseRelPerm(
                       {
                         double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
 
-                        if (head < fabs(min_pressure_head))
-                        {
-                          int pt = (int)floor(head / interval);
-                          assert(pt < max);
-
-                          prdat[ipr] = lookup_table->a[pt] + lookup_table->slope[pt] *
-                                       (head - lookup_table->x[pt]);
-                        }
-                        else
-                        {
-                          prdat[ipr] = 0.0;
-                        }
+                        prdat[ipr] = VanGTableLookupLinear(lookup_table, head, CALCFCN);
                       }
                     });
                   }
@@ -780,25 +452,27 @@ void         PhaseRelPerm(
                   {
                     double alpha = alphas[ir];
                     double n = ns[ir];
-                    double m = 1.0e0 - (1.0e0 / n);
+                    double m = ms[ir];
 
                     double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                    double opahn = 1.0 + pow(alpha * head, n);
-                    double ahnm1 = pow(alpha * head, n - 1);
-                    prdat[ipr] = pow(1.0 - ahnm1 / (pow(opahn, m)), 2)
-                                 / pow(opahn, (m / 2));
+                    double rel_perm;
+                    double rel_perm_der;
+
+                    VanGRelPerm(head, alpha, n, m, &rel_perm, &rel_perm_der);
+                    prdat[ipr] = rel_perm;
                   }
                 });
               }
             }
             else  /* fcn = CALCDER */
             {
-              if (dummy1->lookup_tables[ir])
+              VanGTable *lookup_table = VanGTablesTable(dummy1->lookup_tables, ir);
+
+              if (lookup_table)
               {
-                switch (dummy1->lookup_tables[ir]->interpolation_method)
+                switch (lookup_table->interpolation_method)
                 {
-                  // Spline
-                  case 0:
+                  case VANG_TABLE_SPLINE:
                   {
                     GrGeomSurfLoop(i, j, k, fdir, gr_solid, r, ix, iy, iz,
                                    nx, ny, nz,
@@ -817,24 +491,14 @@ void         PhaseRelPerm(
                       else
                       {
                         double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                        prdat[ipr] = VanGLookupSpline(head,
-                                                      dummy1->lookup_tables[ir],
-                                                      CALCDER);
+                        prdat[ipr] = VanGTableLookupSpline(lookup_table, head, CALCDER);
                       }
                     });
                   }
                   break;
 
-                  // Linear
-                  case 1:
+                  case VANG_TABLE_LINEAR:
                   {
-                    VanGTable *lookup_table = dummy1->lookup_tables[ir];
-                    double interval = lookup_table->interval;
-                    double min_pressure_head = lookup_table->min_pressure_head;
-                    int num_sample_points = lookup_table->num_sample_points;
-                    int max = num_sample_points + 1;
-                    PF_UNUSED(max);
-
                     GrGeomSurfLoop(i, j, k, fdir, gr_solid, r, ix, iy, iz,
                                    nx, ny, nz,
                     {
@@ -852,25 +516,7 @@ void         PhaseRelPerm(
                       else
                       {
                         double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                        if (ppdat[ipp] >= 0.0)
-                          prdat[ipr] = 1.0;
-                        else
-                        {
-                          head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-
-                          if (head < fabs(min_pressure_head))
-                          {
-                            int pt = (int)floor(head / interval);
-                            assert(pt < max);
-
-                            prdat[ipr] = lookup_table->a_der[pt] + lookup_table->slope_der[pt] *
-                                         (head - lookup_table->x[pt]);
-                          }
-                          else
-                          {
-                            prdat[ipr] = 0.0;
-                          }
-                        }
+                        prdat[ipr] = VanGTableLookupLinear(lookup_table, head, CALCDER);
                       }
                     });
                   }
@@ -897,19 +543,14 @@ void         PhaseRelPerm(
                   {
                     double alpha = alphas[ir];
                     double n = ns[ir];
-                    double m = 1.0e0 - (1.0e0 / n);
+                    double m = ms[ir];
 
                     double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                    double opahn = 1.0 + pow(alpha * head, n);
-                    double ahnm1 = pow(alpha * head, n - 1);
-                    double coeff = 1.0 - ahnm1 * pow(opahn, -m);
-
-                    prdat[ipr] = 2.0 * (coeff / (pow(opahn, (m / 2))))
-                                 * ((n - 1) * pow(alpha * head, n - 2) * alpha
-                                    * pow(opahn, -m)
-                                    - ahnm1 * m * pow(opahn, -(m + 1)) * n * alpha * ahnm1)
-                                 + pow(coeff, 2) * (m / 2) * pow(opahn, (-(m + 2) / 2))
-                                 * n * alpha * ahnm1;
+                    double rel_perm;
+                    double rel_perm_der;
+
+                    VanGRelPerm(head, alpha, n, m, &rel_perm, &rel_perm_der);
+                    prdat[ipr] = rel_perm_der;
                   }
                 });
               }
@@ -976,10 +617,11 @@ void         PhaseRelPerm(
                 double m = 1.0e0 - (1.0e0 / n);
 
                 double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                double opahn = 1.0 + pow(alpha * head, n);
-                double ahnm1 = pow(alpha * head, n - 1);
-                prdat[ipr] = pow(1.0 - ahnm1 / (pow(opahn, m)), 2)
-                             / pow(opahn, (m / 2));
+                double rel_perm;
+                double rel_perm_der;
+
+                VanGRelPerm(head, alpha, n, m, &rel_perm, &rel_perm_der);
+                prdat[ipr] = rel_perm;
               }
             });
           }
@@ -1007,16 +649,11 @@ void         PhaseRelPerm(
                 double m = 1.0e0 - (1.0e0 / n);
 
                 double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                double opahn = 1.0 + pow(alpha * head, n);
-                double ahnm1 = pow(alpha * head, n - 1);
-                double coeff = 1.0 - ahnm1 * pow(opahn, -m);
+                double rel_perm;
+                double rel_perm_der;
 
-                prdat[ipr] = 2.0 * (coeff / (pow(opahn, (m / 2))))
-                             * ((n - 1) * pow(alpha * head, n - 2) * alpha
-                                * pow(opahn, -m)
-                                - ahnm1 * m * pow(opahn, -(m + 1)) * n * alpha * ahnm1)
-                             + pow(coeff, 2) * (m / 2) * pow(opahn, (-(m + 2) / 2))
-                             * n * alpha * ahnm1;
+                VanGRelPerm(head, alpha, n, m, &rel_perm, &rel_perm_der);
+                prdat[ipr] = rel_perm_der;
               }
             });
           }     /* End else clause */
@@ -1054,12 +691,13 @@ void         PhaseRelPerm(
 
             if (fcn == CALCFCN)
             {
-              if (dummy1->lookup_tables[ir])
+              VanGTable *lookup_table = VanGTablesTable(dummy1->lookup_tables, ir);
+
+              if (lookup_table)
               {
-                switch (dummy1->lookup_tables[ir]->interpolation_method)
+                switch (lookup_table->interpolation_method)
                 {
-                  // Spline
-                  case 0:
+                  case VANG_TABLE_SPLINE:
                   {
                     GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
                     {
@@ -1073,24 +711,14 @@ void         PhaseRelPerm(
                       else
                       {
                         double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                        prdat[ipr] = VanGLookupSpline(head,
-                                                      dummy1->lookup_tables[ir],
-                                                      CALCFCN);
+                        prdat[ipr] = VanGTableLookupSpline(lookup_table, head, CALCFCN);
                       }
                     });
                   }
                   break;
 
-                  // Linear
-                  case 1:
+                  case VANG_TABLE_LINEAR:
                   {
-                    VanGTable *lookup_table = dummy1->lookup_tables[ir];
-                    double interval = lookup_table->interval;
-                    double min_pressure_head = lookup_table->min_pressure_head;
-                    int num_sample_points = lookup_table->num_sample_points;
-                    int max = num_sample_points + 1;
-                    PF_UNUSED(max);
-
                     GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
                     {
                       /* Table Lookup */
@@ -1103,25 +731,7 @@ void         PhaseRelPerm(
                       else
                       {
                         double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                        if (ppdat[ipp] >= 0.0)
-                          prdat[ipr] = 1.0;
-                        else
-                        {
-                          head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-
-                          if (head < fabs(min_pressure_head))
-                          {
-                            int pt = (int)floor(head / interval);
-                            assert(pt < max);
-
-                            prdat[ipr] = lookup_table->a[pt] + lookup_table->slope[pt] *
-                                         (head - lookup_table->x[pt]);
-                          }
-                          else
-                          {
-                            prdat[ipr] = 0.0;
-                          }
-                        }
+                        prdat[ipr] = VanGTableLookupLinear(lookup_table, head, CALCFCN);
                       }
                     });
                   }
@@ -1144,25 +754,27 @@ void         PhaseRelPerm(
                   {
                     double alpha = alphas[ir];
                     double n = ns[ir];
-                    double m = 1.0e0 - (1.0e0 / n);
+                    double m = ms[ir];
 
                     double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                    double opahn = 1.0 + pow(alpha * head, n);
-                    double ahnm1 = pow(alpha * head, n - 1);
-                    prdat[ipr] = pow(1.0 - ahnm1 / (pow(opahn, m)), 2)
-                                 / pow(opahn, (m / 2));
+                    double rel_perm;
+                    double rel_perm_der;
+
+                    VanGRelPerm(head, alpha, n, m, &rel_perm, &rel_perm_der);
+                    prdat[ipr] = rel_perm;
                   }
                 });
               }
             }    /* End if clause */
             else /* fcn = CALCDER */
             {
-              if (dummy1->lookup_tables[ir])
+              VanGTable *lookup_table = VanGTablesTable(dummy1->lookup_tables, ir);
+
+              if (lookup_table)
               {
-                switch (dummy1->lookup_tables[ir]->interpolation_method)
+                switch (lookup_table->interpolation_method)
                 {
-                  // Spline
-                  case 0:
+                  case VANG_TABLE_SPLINE:
                   {
                     GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
                     {
@@ -1177,23 +789,14 @@ void         PhaseRelPerm(
                       {
                         double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
 
-                        prdat[ipr] = VanGLookupSpline(head,
-                                                      dummy1->lookup_tables[ir],
-                                                      CALCDER);
+                        prdat[ipr] = VanGTableLookupSpline(lookup_table, head, CALCDER);
                       }
                     });
                   }
                   break;
 
-                  case 1:
+                  case VANG_TABLE_LINEAR:
                   {
-                    VanGTable *lookup_table = dummy1->lookup_tables[ir];
-                    double interval = lookup_table->interval;
-                    double min_pressure_head = lookup_table->min_pressure_head;
-                    int num_sample_points = lookup_table->num_sample_points;
-                    int max = num_sample_points + 1;
-                    PF_UNUSED(max);
-
                     GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
                     {
                       /* Table Lookup */
@@ -1207,18 +810,7 @@ void         PhaseRelPerm(
                       {
                         double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
 
-                        if (head < fabs(min_pressure_head))
-                        {
-                          int pt = (int)floor(head / interval);
-                          assert(pt < max);
-
-                          prdat[ipr] = lookup_table->a_der[pt] + lookup_table->slope_der[pt] *
-                                       (head - lookup_table->x[pt]);
-                        }
-                        else
-                        {
-                          prdat[ipr] = 0.0;
-                        }
+                        prdat[ipr] = VanGTableLookupLinear(lookup_table, head, CALCDER);
                       }
                     });
                   }
@@ -1241,19 +833,14 @@ void         PhaseRelPerm(
                   {
                     double alpha = alphas[ir];
                     double n = ns[ir];
-                    double m = 1.0e0 - (1.0e0 / n);
+                    double m = ms[ir];
 
                     double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                    double opahn = 1.0 + pow(alpha * head, n);
-                    double ahnm1 = pow(alpha * head, n - 1);
-                    double coeff = 1.0 - ahnm1 * pow(opahn, -m);
-
-                    prdat[ipr] = 2.0 * (coeff / (pow(opahn, (m / 2))))
-                                 * ((n - 1) * pow(alpha * head, n - 2) * alpha
-                                    * pow(opahn, -m)
-                                    - ahnm1 * m * pow(opahn, -(m + 1)) * n * alpha * ahnm1)
-                                 + pow(coeff, 2) * (m / 2) * pow(opahn, (-(m + 2) / 2))
-                                 * n * alpha * ahnm1;
+                    double rel_perm;
+                    double rel_perm_der;
+
+                    VanGRelPerm(head, alpha, n, m, &rel_perm, &rel_perm_der);
+                    prdat[ipr] = rel_perm_der;
                   }
                 });
               }
@@ -1315,10 +902,11 @@ void         PhaseRelPerm(
                 double m = 1.0e0 - (1.0e0 / n);
 
                 double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                double opahn = 1.0 + pow(alpha * head, n);
-                double ahnm1 = pow(alpha * head, n - 1);
-                prdat[ipr] = pow(1.0 - ahnm1 / (pow(opahn, m)), 2)
-                             / pow(opahn, (m / 2));
+                double rel_perm;
+                double rel_perm_der;
+
+                VanGRelPerm(head, alpha, n, m, &rel_perm, &rel_perm_der);
+                prdat[ipr] = rel_perm;
               }
             });
           }      /* End if clause */
@@ -1342,16 +930,11 @@ void         PhaseRelPerm(
                 double m = 1.0e0 - (1.0e0 / n);
 
                 double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                double opahn = 1.0 + pow(alpha * head, n);
-                double ahnm1 = pow(alpha * head, n - 1);
-                double coeff = 1.0 - ahnm1 * pow(opahn, -m);
+                double rel_perm;
+                double rel_perm_der;
 
-                prdat[ipr] = 2.0 * (coeff / (pow(opahn, (m / 2))))
-                             * ((n - 1) * pow(alpha * head, n - 2) * alpha
-                                * pow(opahn, -m)
-                                - ahnm1 * m * pow(opahn, -(m + 1)) * n * alpha * ahnm1)
-                             + pow(coeff, 2) * (m / 2) * pow(opahn, (-(m + 2) / 2))
-                             * n * alpha * ahnm1;
+                VanGRelPerm(head, alpha, n, m, &rel_perm, &rel_perm_der);
+                prdat[ipr] = rel_perm_der;
               }
             });
           }     /* End else clause */
@@ -1868,11 +1451,14 @@ PFModule   *PhaseRelPermNewPublicXtra()
         (dummy1->region_indices) = ctalloc(int, num_regions);
         (dummy1->alphas) = ctalloc(double, num_regions);
         (dummy1->ns) = ctalloc(double, num_regions);
+        (dummy1->ms) = ctalloc(double, num_regions);
 #if PF_PRINT_VG_TABLE
         (dummy1->print_table) = ctalloc(int, num_regions);
 #endif
 
-        (dummy1->lookup_tables) = ctalloc(VanGTable*, num_regions);
+        int *num_sample_points = ctalloc(int, num_regions);
+        int *interpolation_methods = ctalloc(int, num_regions);
+        double *min_pressure_heads = ctalloc(double, num_regions);
 
         for (ir = 0; ir < num_regions; ir++)
         {
@@ -1890,36 +1476,46 @@ PFModule   *PhaseRelPermNewPublicXtra()
 
           sprintf(key, "Geom.%s.RelPerm.N", region);
           dummy1->ns[ir] = GetDouble(key);
+          dummy1->ms[ir] = 1.0e0 - (1.0e0 / dummy1->ns[ir]);
 
           sprintf(key, "Geom.%s.RelPerm.NumSamplePoints", region);
+          num_sample_points[ir] = GetIntDefault(key, 0);
 
-          int num_sample_points = GetIntDefault(key, 0);
-
-          if (num_sample_points)
+          if (num_sample_points[ir])
           {
             sprintf(key, "Geom.%s.RelPerm.MinPressureHead", region);
-            double min_pressure_head = GetDouble(key);
+            min_pressure_heads[ir] = GetDouble(key);
 
             type_na = NA_NewNameArray("Spline Linear");
 
             sprintf(key, "Geom.%s.RelPerm.InterpolationMethod", region);
             switch_name = GetStringDefault(key, "Spline");
-            int interpolation_method = NA_NameToIndexExitOnError(type_na, switch_name, key);
+            interpolation_methods[ir] = NA_NameToIndexExitOnError(type_na, switch_name, key);
             NA_FreeNameArray(type_na);
-
-            dummy1->lookup_tables[ir] = VanGComputeTable(
-                                                         interpolation_method,
-                                                         num_sample_points,
-                                                         min_pressure_head,
-                                                         dummy1->alphas[ir],
-                                                         dummy1->ns[ir]);
           }
-          else
+        }
+
+        /* The tables of all regions share one array of sample points */
+        dummy1->lookup_tables = NewVanGTables(num_regions, num_sample_points);
+
+        for (ir = 0; ir < num_regions; ir++)
+        {
+          VanGTable *lookup_table = VanGTablesTable(dummy1->lookup_tables, ir);
+
+          if (lookup_table)
           {
-            dummy1->lookup_tables[ir] = NULL;
+            VanGComputeRelPermTable(lookup_table,
+                                    interpolation_methods[ir],
+                                    min_pressure_heads[ir],
+                                    dummy1->alphas[ir],
+                                    dummy1->ns[ir]);
           }
         }
 
+        tfree(num_sample_points);
+        tfree(interpolation_methods);
+        tfree(min_pressure_heads);
+
         dummy1->alpha_file = NULL;
         dummy1->n_file = NULL;
         dummy1->alpha_values = NULL;
@@ -1936,6 +1532,8 @@ PFModule   *PhaseRelPermNewPublicXtra()
         dummy1->region_indices = NULL;
         dummy1->alphas = NULL;
         dummy1->ns = NULL;
+        dummy1->ms = NULL;
+        dummy1->lookup_tables = NULL;
       }
 
       (public_xtra->data) = (void*)dummy1;
@@ -2083,26 +1681,9 @@ void  PhaseRelPermFreePublicXtra()
         tfree(dummy1->region_indices);
         tfree(dummy1->alphas);
         tfree(dummy1->ns);
+        tfree(dummy1->ms);
 
-        num_regions = (dummy1->num_regions);
-        for (ir = 0; ir < num_regions; ir++)
-        {
-          if (dummy1->lookup_tables[ir])
-          {
-            tfree(dummy1->lookup_tables[ir]->x);
-            tfree(dummy1->lookup_tables[ir]->a);
-            tfree(dummy1->lookup_tables[ir]->d);
-            tfree(dummy1->lookup_tables[ir]->a_der);
-            tfree(dummy1->lookup_tables[ir]->d_der);
-
-            tfree(dummy1->lookup_tables[ir]->slope);
-            tfree(dummy1->lookup_tables[ir]->slope_der);
-
-            tfree(dummy1->lookup_tables[ir]);
-          }
-        }
-
-        tfree(dummy1->lookup_tables);
+        FreeVanGTables(dummy1->lookup_tables);
 
         tfree(dummy1);
 
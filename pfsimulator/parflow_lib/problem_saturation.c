@@ -27,6 +27,7 @@
 **********************************************************************EHEADER*/
 
 #include "parflow.h"
+#include "van_genuchten.h"
 
 #include <string.h>
 #include <float.h>
@@ -64,12 +65,15 @@ typedef struct {
   char   *s_res_file;
   double *alphas;
   double *ns;
+  double *ms;                 /* 1 - 1/n */
   double *s_ress;
   double *s_difs;
   Vector *alpha_values;
   Vector *n_values;
   Vector *s_res_values;
   Vector *s_sat_values;
+
+  VanGTables *lookup_tables;
 } Type1;                      /* Van Genuchten Saturation Curve */
 
 typedef struct {
@@ -221,7 +225,7 @@ void     Saturation(
     case 1: /* Van Genuchten saturation curve */
     {
       int data_from_file;
-      double *alphas, *ns, *s_ress, *s_difs;
+      double *alphas, *ns, *ms, *s_ress, *s_difs;
 
       Vector *n_values, *alpha_values, *s_res_values, *s_sat_values;
 
@@ -231,6 +235,7 @@ void     Saturation(
       region_indices = (dummy1->region_indices);
       alphas = (dummy1->alphas);
       ns = (dummy1->ns);
+      ms = (dummy1->ms);
       s_ress = (dummy1->s_ress);
       s_difs = (dummy1->s_difs);
       data_from_file = (dummy1->data_from_file);
@@ -262,52 +267,160 @@ void     Saturation(
             ppdat = SubvectorData(pp_sub);
             pddat = SubvectorData(pd_sub);
 
+            VanGTable *lookup_table = VanGTablesTable(dummy1->lookup_tables, ir);
+
             if (fcn == CALCFCN)
             {
-              GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
+              if (lookup_table)
               {
-                int ips = SubvectorEltIndex(ps_sub, i, j, k);
-                int ipp = SubvectorEltIndex(pp_sub, i, j, k);
-                int ipd = SubvectorEltIndex(pd_sub, i, j, k);
-
-                double alpha = alphas[ir];
-                double n = ns[ir];
-                double m = 1.0e0 - (1.0e0 / n);
-                double s_res = s_ress[ir];
-                double s_dif = s_difs[ir];
-
-                if (ppdat[ipp] >= 0.0)
-                  psdat[ips] = s_dif + s_res;
-                else
+                switch (lookup_table->interpolation_method)
                 {
-                  double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                  psdat[ips] = s_dif / pow(1.0 + pow((alpha * head), n), m)
-                               + s_res;
+                  case VANG_TABLE_SPLINE:
+                  {
+                    GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
+                    {
+                      /* Table Lookup */
+                      int ips = SubvectorEltIndex(ps_sub, i, j, k);
+                      int ipp = SubvectorEltIndex(pp_sub, i, j, k);
+                      int ipd = SubvectorEltIndex(pd_sub, i, j, k);
+
+                      if (ppdat[ipp] >= 0.0)
+                        psdat[ips] = s_difs[ir] + s_ress[ir];
+                      else
+                      {
+                        double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
+
+                        psdat[ips] = VanGTableLookupSpline(lookup_table, head, CALCFCN);
+                      }
+                    });
+                  }
+                  break;
+
+                  case VANG_TABLE_LINEAR:
+                  {
+                    GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
+                    {
+                      /* Table Lookup */
+                      int ips = SubvectorEltIndex(ps_sub, i, j, k);
+                      int ipp = SubvectorEltIndex(pp_sub, i, j, k);
+                      int ipd = SubvectorEltIndex(pd_sub, i, j, k);
+
+                      if (ppdat[ipp] >= 0.0)
+                        psdat[ips] = s_difs[ir] + s_ress[ir];
+                      else
+                      {
+                        double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
+
+                        psdat[ips] = VanGTableLookupLinear(lookup_table, head, CALCFCN);
+                      }
+                    });
+                  }
+                  break;
                 }
-              });
+              }
+              else
+              {
+                /* Compute VanG curve */
+
+                GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
+                {
+                  int ips = SubvectorEltIndex(ps_sub, i, j, k);
+                  int ipp = SubvectorEltIndex(pp_sub, i, j, k);
+                  int ipd = SubvectorEltIndex(pd_sub, i, j, k);
+
+                  double s_res = s_ress[ir];
+                  double s_dif = s_difs[ir];
+
+                  if (ppdat[ipp] >= 0.0)
+                    psdat[ips] = s_dif + s_res;
+                  else
+                  {
+                    double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
+                    double sat;
+                    double sat_der;
+
+                    VanGSaturation(head, alphas[ir], ns[ir], ms[ir],
+                                   s_res, s_dif, &sat, &sat_der);
+                    psdat[ips] = sat;
+                  }
+                });
+              }
             }    /* End if clause */
             else /* fcn = CALCDER */
             {
-              GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
+              if (lookup_table)
               {
-                int ips = SubvectorEltIndex(ps_sub, i, j, k);
-                int ipp = SubvectorEltIndex(pp_sub, i, j, k);
-                int ipd = SubvectorEltIndex(pd_sub, i, j, k);
-
-                double alpha = alphas[ir];
-                double n = ns[ir];
-                double m = 1.0e0 - (1.0e0 / n);
-                double s_dif = s_difs[ir];
-
-                if (ppdat[ipp] >= 0.0)
-                  psdat[ips] = 0.0;
-                else
+                switch (lookup_table->interpolation_method)
                 {
-                  double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                  psdat[ips] = (m * n * alpha * pow(alpha * head, (n - 1))) * s_dif
-                               / (pow(1.0 + pow(alpha * head, n), m + 1));
+                  case VANG_TABLE_SPLINE:
+                  {
+                    GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
+                    {
+                      /* Table Lookup */
+                      int ips = SubvectorEltIndex(ps_sub, i, j, k);
+                      int ipp = SubvectorEltIndex(pp_sub, i, j, k);
+                      int ipd = SubvectorEltIndex(pd_sub, i, j, k);
+
+                      if (ppdat[ipp] >= 0.0)
+                        psdat[ips] = 0.0;
+                      else
+                      {
+                        double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
+
+                        psdat[ips] = VanGTableLookupSpline(lookup_table, head, CALCDER);
+                      }
+                    });
+                  }
+                  break;
+
+                  case VANG_TABLE_LINEAR:
+                  {
+                    GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
+                    {
+                      /* Table Lookup */
+                      int ips = SubvectorEltIndex(ps_sub, i, j, k);
+                      int ipp = SubvectorEltIndex(pp_sub, i, j, k);
+                      int ipd = SubvectorEltIndex(pd_sub, i, j, k);
+
+                      if (ppdat[ipp] >= 0.0)
+                        psdat[ips] = 0.0;
+                      else
+                      {
+                        double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
+
+                        psdat[ips] = VanGTableLookupLinear(lookup_table, head, CALCDER);
+                      }
+                    });
+                  }
+                  break;
                 }
-              });
+              }
+              else
+              {
+                /* Compute VanG curve */
+
+                GrGeomInLoop(i, j, k, gr_solid, r, ix, iy, iz, nx, ny, nz,
+                {
+                  int ips = SubvectorEltIndex(ps_sub, i, j, k);
+                  int ipp = SubvectorEltIndex(pp_sub, i, j, k);
+                  int ipd = SubvectorEltIndex(pd_sub, i, j, k);
+
+                  double s_dif = s_difs[ir];
+
+                  if (ppdat[ipp] >= 0.0)
+                    psdat[ips] = 0.0;
+                  else
+                  {
+                    double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
+                    double sat;
+                    double sat_der;
+
+                    VanGSaturation(head, alphas[ir], ns[ir], ms[ir],
+                                   s_ress[ir], s_dif, &sat, &sat_der);
+                    psdat[ips] = sat_der;
+                  }
+                });
+              }
             }   /* End else clause */
           }     /* End subgrid loop */
         }       /* End loop over regions */
@@ -375,9 +488,12 @@ void     Saturation(
               else
               {
                 double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                psdat[ips] = (s_sat - s_res) /
-                             pow(1.0 + pow((alpha * head), n), m)
-                             + s_res;
+                double sat;
+                double sat_der;
+
+                VanGSaturation(head, alpha, n, m, s_res, s_sat - s_res,
+                               &sat, &sat_der);
+                psdat[ips] = sat;
               }
             });
           }      /* End if clause */
@@ -406,8 +522,12 @@ void     Saturation(
               else
               {
                 double head = fabs(ppdat[ipp]) / (pddat[ipd] * gravity);
-                psdat[ips] = (m * n * alpha * pow(alpha * head, (n - 1))) * s_dif
-                             / (pow(1.0 + pow(alpha * head, n), m + 1));
+                double sat;
+                double sat_der;
+
+                VanGSaturation(head, alpha, n, m, s_res, s_dif,
+                               &sat, &sat_der);
+                psdat[ips] = sat_der;
               }
             });
           }     /* End else clause */
@@ -897,9 +1017,14 @@ PFModule   *SaturationNewPublicXtra()
         (dummy1->region_indices) = ctalloc(int, num_regions);
         (dummy1->alphas) = ctalloc(double, num_regions);
         (dummy1->ns) = ctalloc(double, num_regions);
+        (dummy1->ms) = ctalloc(double, num_regions);
         (dummy1->s_ress) = ctalloc(double, num_regions);
         (dummy1->s_difs) = ctalloc(double, num_regions);
 
+        int *num_sample_points = ctalloc(int, num_regions);
+        int *interpolation_methods = ctalloc(int, num_regions);
+        double *min_pressure_heads = ctalloc(double, num_regions);
+
         for (ir = 0; ir < num_regions; ir++)
         {
           region = NA_IndexToName(public_xtra->regions, ir);
@@ -919,6 +1044,7 @@ PFModule   *SaturationNewPublicXtra()
 
           sprintf(key, "Geom.%s.Saturation.N", region);
           dummy1->ns[ir] = GetDouble(key);
+          dummy1->ms[ir] = 1.0e0 - (1.0e0 / dummy1->ns[ir]);
 
           sprintf(key, "Geom.%s.Saturation.SRes", region);
           dummy1->s_ress[ir] = GetDouble(key);
@@ -927,8 +1053,47 @@ PFModule   *SaturationNewPublicXtra()
           s_sat = GetDouble(key);
 
           (dummy1->s_difs[ir]) = s_sat - (dummy1->s_ress[ir]);
+
+          sprintf(key, "Geom.%s.Saturation.NumSamplePoints", region);
+          num_sample_points[ir] = GetIntDefault(key, 0);
+
+          if (num_sample_points[ir])
+          {
+            sprintf(key, "Geom.%s.Saturation.MinPressureHead", region);
+            min_pressure_heads[ir] = GetDouble(key);
+
+            NameArray method_na = NA_NewNameArray("Spline Linear");
+
+            sprintf(key, "Geom.%s.Saturation.InterpolationMethod", region);
+            char *method_name = GetStringDefault(key, "Spline");
+            interpolation_methods[ir] = NA_NameToIndexExitOnError(method_na, method_name, key);
+            NA_FreeNameArray(method_na);
+          }
         }
 
+        /* The tables of all regions share one array of sample points */
+        dummy1->lookup_tables = NewVanGTables(num_regions, num_sample_points);
+
+        for (ir = 0; ir < num_regions; ir++)
+        {
+          VanGTable *lookup_table = VanGTablesTable(dummy1->lookup_tables, ir);
+
+          if (lookup_table)
+          {
+            VanGComputeSaturationTable(lookup_table,
+                                       interpolation_methods[ir],
+                                       min_pressure_heads[ir],
+                                       dummy1->alphas[ir],
+                                       dummy1->ns[ir],
+                                       dummy1->s_ress[ir],
+                                       dummy1->s_difs[ir]);
+          }
+        }
+
+        tfree(num_sample_points);
+        tfree(interpolation_methods);
+        tfree(min_pressure_heads);
+
         dummy1->alpha_file = NULL;
         dummy1->n_file = NULL;
         dummy1->s_res_file = NULL;
@@ -953,8 +1118,10 @@ PFModule   *SaturationNewPublicXtra()
         dummy1->region_indices = NULL;
         dummy1->alphas = NULL;
         dummy1->ns = NULL;
+        dummy1->ms = NULL;
         dummy1->s_ress = NULL;
         dummy1->s_difs = NULL;
+        dummy1->lookup_tables = NULL;
       }
 
       (public_xtra->data) = (void*)dummy1;
@@ -1128,8 +1295,11 @@ void  SaturationFreePublicXtra()
           tfree(dummy1->region_indices);
           tfree(dummy1->alphas);
           tfree(dummy1->ns);
+          tfree(dummy1->ms);
           tfree(dummy1->s_ress);
           tfree(dummy1->s_difs);
+
+          FreeVanGTables(dummy1->lookup_tables);
         }
 
         tfree(dummy1);
@@ -29,11 +29,281 @@
 *
 * Routines to read a Vector from a distributed file.
 *
+* ReadPFBinary needs the file to be distributed for the current process
+* topology.  ReadPFBinaryAnyLayout instead locates the data from the PFB
+* subgrid headers, so it reads a file written by any number of processes.
+*
 *****************************************************************************/
 #include "parflow.h"
 
 #include <string.h>
 #include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define PFB_HEADER_SIZE   64    /* 6 doubles and 4 ints */
+#define PFB_SUBGRID_SIZE  36    /* 9 ints */
+
+typedef struct {
+  int ix, iy, iz;
+  int nx, ny, nz;
+  long long offset;           /* offset of the subgrid data in the file */
+} PFBSubgridExtent;
+
+struct _PFBLayout {
+  int nx, ny, nz;
+  int num_subgrids;
+  long long size;             /* file size, 0 if no layout is known */
+  PFBSubgridExtent *subgrids;
+};
+
+/*--------------------------------------------------------------------------
+ * NewPFBLayout, FreePFBLayout
+ *--------------------------------------------------------------------------*/
+
+PFBLayout *NewPFBLayout(void)
+{
+  return ctalloc(PFBLayout, 1);
+}
+
+void FreePFBLayout(PFBLayout *layout)
+{
+  if (layout)
+  {
+    tfree(layout->subgrids);
+    tfree(layout);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * PFBRead: read size bytes at offset, 0 if the file is too short.
+ *--------------------------------------------------------------------------*/
+
+static int PFBRead(int fd, char *buffer, long long size, long long offset)
+{
+  while (size > 0)
+  {
+    ssize_t count = pread(fd, buffer, (size_t)size, (off_t)offset);
+
+    if (count <= 0)
+    {
+      return 0;
+    }
+
+    buffer += count;
+    offset += count;
+    size -= count;
+  }
+
+  return 1;
+}
+
+/*--------------------------------------------------------------------------
+ * PFBLayoutLoad: locate the subgrids of an open PFB file.
+ *
+ * Files of a time series are almost always distributed the same way, so
+ * the layout of the previous file is kept when the dimensions, subgrid
+ * count and file size match.  The headers of the subgrids that are read
+ * are checked again by PFBLayoutCheck.
+ *--------------------------------------------------------------------------*/
+
+int PFBLayoutLoad(PFBLayout *layout, int fd, int force)
+{
+  char header[PFB_HEADER_SIZE];
+  char subgrid_header[PFB_SUBGRID_SIZE];
+  char *pos;
+  struct stat file_stat;
+  double dummy;
+  int nx, ny, nz, num_subgrids;
+  int s, n;
+  long long offset;
+
+  if (fstat(fd, &file_stat) != 0 ||
+      !PFBRead(fd, header, PFB_HEADER_SIZE, 0))
+  {
+    return 0;
+  }
+
+  pos = header;
+  for (n = 0; n < 3; n++)
+  {
+    pos = PFBUnpackDouble(pos, &dummy);
+  }
+  pos = PFBUnpackInt(pos, &nx);
+  pos = PFBUnpackInt(pos, &ny);
+  pos = PFBUnpackInt(pos, &nz);
+  for (n = 0; n < 3; n++)
+  {
+    pos = PFBUnpackDouble(pos, &dummy);
+  }
+  pos = PFBUnpackInt(pos, &num_subgrids);
+
+  if (!force && layout->size == (long long)file_stat.st_size &&
+      layout->nx == nx && layout->ny == ny && layout->nz == nz &&
+      layout->num_subgrids == num_subgrids)
+  {
+    return 1;
+  }
+
+  if (num_subgrids < 0)
+  {
+    return 0;
+  }
+
+  tfree(layout->subgrids);
+  layout->subgrids = talloc(PFBSubgridExtent, num_subgrids);
+  layout->num_subgrids = 0;
+  layout->size = 0;
+
+  offset = PFB_HEADER_SIZE;
+  for (s = 0; s < num_subgrids; s++)
+  {
+    PFBSubgridExtent *extent = &(layout->subgrids[s]);
+
+    if (!PFBRead(fd, subgrid_header, PFB_SUBGRID_SIZE, offset))
+    {
+      return 0;
+    }
+
+    pos = subgrid_header;
+    pos = PFBUnpackInt(pos, &(extent->ix));
+    pos = PFBUnpackInt(pos, &(extent->iy));
+    pos = PFBUnpackInt(pos, &(extent->iz));
+    pos = PFBUnpackInt(pos, &(extent->nx));
+    pos = PFBUnpackInt(pos, &(extent->ny));
+    pos = PFBUnpackInt(pos, &(extent->nz));
+
+    extent->offset = offset + PFB_SUBGRID_SIZE;
+    offset = extent->offset
+             + 8LL * extent->nx * extent->ny * extent->nz;
+  }
+
+  if (offset > (long long)file_stat.st_size)
+  {
+    return 0;
+  }
+
+  layout->nx = nx;
+  layout->ny = ny;
+  layout->nz = nz;
+  layout->num_subgrids = num_subgrids;
+  layout->size = (long long)file_stat.st_size;
+
+  return 1;
+}
+
+/*--------------------------------------------------------------------------
+ * PFBLayoutCheck: does the file still have subgrid s where expected?
+ *--------------------------------------------------------------------------*/
+
+static int PFBLayoutCheck(PFBLayout *layout, int fd, int s)
+{
+  PFBSubgridExtent *extent = &(layout->subgrids[s]);
+  char subgrid_header[PFB_SUBGRID_SIZE];
+  char *pos;
+  int values[6];
+  int n;
+
+  if (!PFBRead(fd, subgrid_header, PFB_SUBGRID_SIZE,
+               extent->offset - PFB_SUBGRID_SIZE))
+  {
+    return 0;
+  }
+
+  pos = subgrid_header;
+  for (n = 0; n < 6; n++)
+  {
+    pos = PFBUnpackInt(pos, &values[n]);
+  }
+
+  return (values[0] == extent->ix && values[1] == extent->iy &&
+          values[2] == extent->iz && values[3] == extent->nx &&
+          values[4] == extent->ny && values[5] == extent->nz);
+}
+
+/*--------------------------------------------------------------------------
+ * PFBReadBox: read the values of a box of cells, x fastest.
+ *
+ * Returns 1 on success, 0 if the layout of a subgrid changed and -1 if the
+ * file does not cover the box.
+ *--------------------------------------------------------------------------*/
+
+int PFBReadBox(PFBLayout *layout, int fd, int box_ix, int box_iy, int box_iz,
+               int box_nx, int box_ny, int box_nz, double *data)
+{
+  char *buffer = NULL;
+  long long buffer_size = 0;
+  long long covered = 0;
+  int s;
+
+  for (s = 0; s < layout->num_subgrids; s++)
+  {
+    PFBSubgridExtent *extent = &(layout->subgrids[s]);
+
+    int ix = pfmax(box_ix, extent->ix);
+    int iy = pfmax(box_iy, extent->iy);
+    int iz = pfmax(box_iz, extent->iz);
+    int nx = pfmin(box_ix + box_nx, extent->ix + extent->nx) - ix;
+    int ny = pfmin(box_iy + box_ny, extent->iy + extent->ny) - iy;
+    int nz = pfmin(box_iz + box_nz, extent->iz + extent->nz) - iz;
+
+    long long span;
+    int i, j, k;
+
+    if (nx <= 0 || ny <= 0 || nz <= 0)
+    {
+      continue;
+    }
+
+    if (!PFBLayoutCheck(layout, fd, s))
+    {
+      tfree(buffer);
+      return 0;
+    }
+
+    /* Read each z plane of the intersection in one piece */
+    span = (long long)(ny - 1) * extent->nx + nx;
+    if (span * 8 > buffer_size)
+    {
+      tfree(buffer);
+      buffer_size = span * 8;
+      buffer = talloc(char, buffer_size);
+    }
+
+    for (k = iz; k < iz + nz; k++)
+    {
+      long long first = ((long long)(k - extent->iz) * extent->ny
+                         + (iy - extent->iy)) * extent->nx + (ix - extent->ix);
+
+      if (!PFBRead(fd, buffer, span * 8, extent->offset + 8 * first))
+      {
+        tfree(buffer);
+        return 0;
+      }
+
+      for (j = 0; j < ny; j++)
+      {
+        char *pos = buffer + 8LL * j * extent->nx;
+        double *box_data = data
+                           + ((long long)(k - box_iz) * box_ny
+                              + (iy + j - box_iy)) * box_nx + (ix - box_ix);
+
+        for (i = 0; i < nx; i++)
+        {
+          pos = PFBUnpackDouble(pos, &box_data[i]);
+        }
+      }
+    }
+
+    covered += (long long)nx * ny * nz;
+  }
+
+  tfree(buffer);
+
+  return (covered == (long long)box_nx * box_ny * box_nz) ? 1 : -1;
+}
+
 
 void ReadPFBinary_Subvector(
                             amps_File  file,
@@ -107,6 +377,20 @@ void ReadPFBinary(
     exit(1);
   }
 
+  /* File may still be queued for output */
+  if (GlobalsPFBIOMethod == PFB_IO_ASYNC)
+  {
+    PFBAsyncFlush();
+    amps_Sync(amps_CommWorld);
+  }
+
+  if (GlobalsPFBIOMethod == PFB_IO_MPIIO)
+  {
+    ReadPFBinaryMPIIO(filename, v);
+    EndTiming(PFBTimingIndex);
+    return;
+  }
+
   if ((file = amps_FFopen(amps_CommWorld, filename, "rb", 0)) == NULL)
   {
     amps_Printf("Error: can't open input file %s\n", filename);
@@ -141,3 +425,182 @@ void ReadPFBinary(
 
   EndTiming(PFBTimingIndex);
 }
+
+
+/*--------------------------------------------------------------------------
+ * ReadPFBinaryAnyLayout: read a PFB file distributed for any topology.
+ *
+ * Process 0 walks the subgrid headers once and broadcasts the extents, so
+ * the header walk is not repeated on every process.  Each process then
+ * reads the parts of the file subgrids covering its own subgrids.
+ *--------------------------------------------------------------------------*/
+
+void ReadPFBinaryAnyLayout(
+                           char *  filename,
+                           Vector *v)
+{
+  Grid           *grid = VectorGrid(v);
+  SubgridArray   *subgrids = GridSubgrids(grid);
+  Subgrid        *subgrid;
+  Subvector      *subvector;
+
+  PFBLayout      *layout = NewPFBLayout();
+  amps_Invoice invoice;
+  int header[4];
+  int num_extents;
+  int            *extents;
+  long long offset;
+
+  int num_chars, fd, g, s, status;
+
+  BeginTiming(PFBTimingIndex);
+
+  if (((num_chars = strlen(filename)) < 4) ||
+      (strcmp(".pfb", &filename[num_chars - 4])))
+  {
+    amps_Printf("Error: %s is not in pfb format\n", filename);
+    exit(1);
+  }
+
+  /* File may still be queued for output */
+  if (GlobalsPFBIOMethod == PFB_IO_ASYNC)
+  {
+    PFBAsyncFlush();
+    amps_Sync(amps_CommWorld);
+  }
+
+  header[3] = -1;
+  if (!amps_Rank(amps_CommWorld))
+  {
+    if ((fd = open(filename, O_RDONLY)) >= 0)
+    {
+      if (PFBLayoutLoad(layout, fd, 1))
+      {
+        header[0] = layout->nx;
+        header[1] = layout->ny;
+        header[2] = layout->nz;
+        header[3] = layout->num_subgrids;
+      }
+      close(fd);
+    }
+  }
+
+  invoice = amps_NewInvoice("%4i", header);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+
+  if (header[3] < 0)
+  {
+    if (!amps_Rank(amps_CommWorld))
+    {
+      amps_Printf("Error: can't read pfb file %s\n", filename);
+    }
+    exit(1);
+  }
+
+  num_extents = 6 * header[3];
+  extents = talloc(int, pfmax(num_extents, 1));
+  if (!amps_Rank(amps_CommWorld))
+  {
+    for (s = 0; s < header[3]; s++)
+    {
+      PFBSubgridExtent *extent = &(layout->subgrids[s]);
+
+      extents[6 * s] = extent->ix;
+      extents[6 * s + 1] = extent->iy;
+      extents[6 * s + 2] = extent->iz;
+      extents[6 * s + 3] = extent->nx;
+      extents[6 * s + 4] = extent->ny;
+      extents[6 * s + 5] = extent->nz;
+    }
+  }
+
+  invoice = amps_NewInvoice("%&i", &num_extents, extents);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+
+  if (amps_Rank(amps_CommWorld))
+  {
+    layout->nx = header[0];
+    layout->ny = header[1];
+    layout->nz = header[2];
+    layout->num_subgrids = header[3];
+    layout->subgrids = talloc(PFBSubgridExtent, header[3]);
+
+    offset = PFB_HEADER_SIZE;
+    for (s = 0; s < header[3]; s++)
+    {
+      PFBSubgridExtent *extent = &(layout->subgrids[s]);
+
+      extent->ix = extents[6 * s];
+      extent->iy = extents[6 * s + 1];
+      extent->iz = extents[6 * s + 2];
+      extent->nx = extents[6 * s + 3];
+      extent->ny = extents[6 * s + 4];
+      extent->nz = extents[6 * s + 5];
+
+      extent->offset = offset + PFB_SUBGRID_SIZE;
+      offset = extent->offset
+               + 8LL * extent->nx * extent->ny * extent->nz;
+    }
+  }
+  tfree(extents);
+
+  if ((fd = open(filename, O_RDONLY)) < 0)
+  {
+    amps_Printf("Error: can't open input file %s\n", filename);
+    exit(1);
+  }
+
+  ForSubgridI(g, subgrids)
+  {
+    int ix, iy, iz, nx, ny, nz;
+    int nx_v, ny_v, nz_v;
+    int i, j, k, ai, bi;
+    double *data, *box_data;
+
+    subgrid = SubgridArraySubgrid(subgrids, g);
+    subvector = VectorSubvector(v, g);
+
+    ix = SubgridIX(subgrid);
+    iy = SubgridIY(subgrid);
+    iz = SubgridIZ(subgrid);
+    nx = SubgridNX(subgrid);
+    ny = SubgridNY(subgrid);
+    nz = SubgridNZ(subgrid);
+
+    nx_v = SubvectorNX(subvector);
+    ny_v = SubvectorNY(subvector);
+    nz_v = SubvectorNZ(subvector);
+
+    box_data = talloc(double, pfmax(nx * ny * nz, 1));
+
+    status = PFBReadBox(layout, fd, ix, iy, iz, nx, ny, nz, box_data);
+    if (status != 1)
+    {
+      amps_Printf("Error: %s %s\n", filename, (status < 0) ?
+                  "does not cover the domain" : "is not a valid pfb file");
+      exit(1);
+    }
+
+    data = SubvectorElt(subvector, ix, iy, iz);
+
+    ai = 0;
+    bi = 0;
+    BoxLoopI2(i, j, k,
+              ix, iy, iz, nx, ny, nz,
+              ai, nx_v, ny_v, nz_v, 1, 1, 1,
+              bi, nx, ny, nz, 1, 1, 1,
+    {
+      data[ai] = box_data[bi];
+    });
+
+    tfree(box_data);
+  }
+
+  close(fd);
+
+  FreePFBLayout(layout);
+
+  EndTiming(PFBTimingIndex);
+}
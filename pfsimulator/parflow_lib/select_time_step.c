@@ -37,7 +37,11 @@ typedef struct {
   void    *data;
 } PublicXtra;
 
-typedef void InstanceXtra;
+typedef struct {
+  double last_dt;              /* step chosen by the controller, before
+                                * well, BC and dump truncation */
+  double last_err;             /* iteration error of the previous step */
+} InstanceXtra;
 
 typedef struct {
   double step;
@@ -50,6 +54,18 @@ typedef struct {
   double max_step;
 } Type1;                       /* step increases to a max value */
 
+typedef struct {
+  double initial_step;
+  double min_step;
+  double max_step;
+  double target_nonlin_iters;
+  double target_lin_iters;
+  double integral_gain;
+  double proportional_gain;
+  double min_factor;
+  double max_factor;
+} Type2;                       /* step follows nonlinear solver effort */
+
 /*--------------------------------------------------------------------------
  * SelectTimeStep:
  *    This routine returns a time step size.
@@ -62,13 +78,17 @@ void     SelectTimeStep(
                                                * chose the time step */
                         double       time,
                         Problem *    problem,
-                        ProblemData *problem_data)
+                        ProblemData *problem_data,
+                        NonlinSolverStats *stats) /* Solver effort for the
+                                                   * previous step, may be NULL */
 {
   PFModule      *this_module = ThisPFModule;
   PublicXtra    *public_xtra = (PublicXtra*)PFModulePublicXtra(this_module);
+  InstanceXtra  *instance_xtra = (InstanceXtra*)PFModuleInstanceXtra(this_module);
 
   Type0         *dummy0;
   Type1         *dummy1;
+  Type2         *dummy2;
 
   double well_dt, bc_dt;
 
@@ -116,6 +136,69 @@ void     SelectTimeStep(
 
       break;
     }    /* End case 1 */
+
+    case 2:
+    {
+      double err, lin_err, factor, base_dt;
+
+      dummy2 = (Type2*)(public_xtra->data);
+
+      if ((*dt) == 0.0 || stats == NULL || stats->nonlin_iters < 0)
+      {
+        (*dt) = dummy2->initial_step;
+        instance_xtra->last_err = 1.0;
+      }
+      else
+      {
+        /*
+         * Error is the ratio of the work done on the previous step
+         * to the target work; the linear target is per Newton
+         * iteration.  A PI law then moves dt to drive it toward one.
+         */
+        err = stats->nonlin_iters / dummy2->target_nonlin_iters;
+        if (dummy2->target_lin_iters > 0.0 && stats->nonlin_iters > 0)
+        {
+          lin_err = ((double)stats->lin_iters / stats->nonlin_iters)
+                    / dummy2->target_lin_iters;
+          err = pfmax(err, lin_err);
+        }
+        err = pfmax(err, 1.0e-3);
+
+        factor = pow(1.0 / err, dummy2->integral_gain)
+                 * pow(instance_xtra->last_err / err,
+                       dummy2->proportional_gain);
+        factor = pfmax(factor, dummy2->min_factor);
+        factor = pfmin(factor, dummy2->max_factor);
+
+        /*
+         * The previous step only succeeded after the solver cut dt, so
+         * do not grow past the step that actually converged.  Otherwise
+         * grow from the controller's own step so that truncation for
+         * wells, BCs or output does not reset the growth.
+         */
+        if (stats->conv_failures > 0)
+        {
+          factor = pfmin(factor, 1.0);
+          base_dt = (*dt);
+        }
+        else
+        {
+          base_dt = pfmax(instance_xtra->last_dt, (*dt));
+        }
+
+        (*dt) = base_dt * factor;
+        instance_xtra->last_err = err;
+      }
+
+      if ((*dt) < dummy2->min_step)
+        (*dt) = dummy2->min_step;
+      if ((*dt) > dummy2->max_step)
+        (*dt) = dummy2->max_step;
+
+      instance_xtra->last_dt = (*dt);
+
+      break;
+    }    /* End case 2 */
   }      /* End switch */
 
   /*-----------------------------------------------------------------
@@ -164,7 +247,13 @@ PFModule  *SelectTimeStepInitInstanceXtra()
   PFModule      *this_module = ThisPFModule;
   InstanceXtra  *instance_xtra;
 
-  instance_xtra = NULL;
+  if (PFModuleInstanceXtra(this_module) == NULL)
+  {
+    instance_xtra = ctalloc(InstanceXtra, 1);
+    instance_xtra->last_err = 1.0;
+  }
+  else
+    instance_xtra = (InstanceXtra*)PFModuleInstanceXtra(this_module);
 
   PFModuleInstanceXtra(this_module) = instance_xtra;
   return this_module;
@@ -198,12 +287,13 @@ PFModule  *SelectTimeStepNewPublicXtra()
 
   Type0            *dummy0;
   Type1            *dummy1;
+  Type2            *dummy2;
 
   char *switch_name;
 
   NameArray type_na;
 
-  type_na = NA_NewNameArray("Constant Growth");
+  type_na = NA_NewNameArray("Constant Growth Adaptive");
 
   public_xtra = ctalloc(PublicXtra, 1);
 
@@ -237,6 +327,50 @@ PFModule  *SelectTimeStepNewPublicXtra()
       break;
     }
 
+    case 2:
+    {
+      dummy2 = ctalloc(Type2, 1);
+
+      dummy2->initial_step = GetDouble("TimeStep.InitialStep");
+      dummy2->max_step = GetDouble("TimeStep.MaxStep");
+      dummy2->min_step = GetDouble("TimeStep.MinStep");
+
+      dummy2->target_nonlin_iters =
+        GetIntDefault("TimeStep.Adaptive.TargetNonlinIters", 5);
+      dummy2->target_lin_iters =
+        GetDoubleDefault("TimeStep.Adaptive.TargetLinearIters", 0.0);
+      dummy2->integral_gain =
+        GetDoubleDefault("TimeStep.Adaptive.IntegralGain", 0.5);
+      dummy2->proportional_gain =
+        GetDoubleDefault("TimeStep.Adaptive.ProportionalGain", 0.25);
+      dummy2->min_factor =
+        GetDoubleDefault("TimeStep.Adaptive.MinFactor", 0.5);
+      dummy2->max_factor =
+        GetDoubleDefault("TimeStep.Adaptive.MaxFactor", 2.0);
+
+      if (dummy2->target_nonlin_iters <= 0.0)
+      {
+        InputError("Error: <%s> must be positive%s\n",
+                   "TimeStep.Adaptive.TargetNonlinIters", "");
+      }
+
+      if (dummy2->min_factor <= 0.0 || dummy2->min_factor > 1.0)
+      {
+        InputError("Error: <%s> must be in (0, 1]%s\n",
+                   "TimeStep.Adaptive.MinFactor", "");
+      }
+
+      if (dummy2->max_factor < 1.0)
+      {
+        InputError("Error: <%s> must be at least 1%s\n",
+                   "TimeStep.Adaptive.MaxFactor", "");
+      }
+
+      (public_xtra->data) = (void*)dummy2;
+
+      break;
+    }
+
     default:
     {
       InputError("Invalid switch value <%s> for key <%s>", switch_name, "TimeStep.Type");
@@ -261,6 +395,7 @@ void  SelectTimeStepFreePublicXtra()
 
   Type0        *dummy0;
   Type1        *dummy1;
+  Type2        *dummy2;
 
   if (public_xtra)
   {
@@ -279,6 +414,13 @@ void  SelectTimeStepFreePublicXtra()
         tfree(dummy1);
         break;
       }
+
+      case 2:
+      {
+        dummy2 = (Type2*)(public_xtra->data);
+        tfree(dummy2);
+        break;
+      }
     }
 
     tfree(public_xtra);
@@ -294,6 +436,36 @@ int  SelectTimeStepSizeOfTempData()
   return 0;
 }
 
+/*--------------------------------------------------------------------------
+ * SelectTimeStepGetState, SelectTimeStepSetState
+ *
+ * Access the adaptive controller's memory of the previous step so that it
+ * can be saved in and restored from a checkpoint.  Called directly on the
+ * module instance, not through PFModuleInvoke.
+ *--------------------------------------------------------------------------*/
+
+void  SelectTimeStepGetState(
+                             PFModule *this_module,
+                             double *  last_dt,
+                             double *  last_err)
+{
+  InstanceXtra  *instance_xtra = (InstanceXtra*)PFModuleInstanceXtra(this_module);
+
+  (*last_dt) = instance_xtra->last_dt;
+  (*last_err) = instance_xtra->last_err;
+}
+
+void  SelectTimeStepSetState(
+                             PFModule *this_module,
+                             double    last_dt,
+                             double    last_err)
+{
+  InstanceXtra  *instance_xtra = (InstanceXtra*)PFModuleInstanceXtra(this_module);
+
+  instance_xtra->last_dt = last_dt;
+  instance_xtra->last_err = last_err;
+}
+
 
 /*--------------------------------------------------------------------------
  * WRFSelectTimeStepInitInstanceXtra
@@ -87,6 +87,19 @@ NewSolver()
 
   GlobalsNumProcs = amps_Size(amps_CommWorld);
 
+  {
+    NameArray method_na;
+    method_na = NA_NewNameArray("Regular Mask Cost");
+    switch_name = GetStringDefault("Process.Decomposition.Method", "Regular");
+    GlobalsDecompositionMethod = NA_NameToIndexExitOnError(method_na, switch_name, "Process.Decomposition.Method");
+    NA_FreeNameArray(method_na);
+
+    if (GlobalsDecompositionMethod != DECOMPOSITION_REGULAR)
+    {
+      GlobalsDecompositionFileName = GetString("Process.Decomposition.FileName");
+    }
+  }
+
   GlobalsBackground = ReadBackground();
 
   GlobalsUserGrid = ReadUserGrid();
@@ -100,9 +113,67 @@ NewSolver()
     switch_na = NA_NewNameArray("False True");
     switch_name = GetStringDefault("UseClustering", "True");
     GlobalsUseClustering = NA_NameToIndexExitOnError(switch_na, switch_name, "UseClustering");
+
+    switch_name = GetStringDefault("PFB.WriteDist", "True");
+    GlobalsPFBWriteDist = NA_NameToIndexExitOnError(switch_na, switch_name, "PFB.WriteDist");
     NA_FreeNameArray(switch_na);
   }
 
+  GlobalsClusteringMaxBoxes = GetIntDefault("Clustering.MaxBoxes", 0);
+  if (GlobalsClusteringMaxBoxes < 0)
+  {
+    InputError("Error: invalid value <%s> for key <%s>, the number of boxes can't be negative\n",
+               GetString("Clustering.MaxBoxes"), "Clustering.MaxBoxes");
+  }
+
+  switch_name = GetStringDefault("GeomCache.Directory", "");
+  if (strlen(switch_name) > 0)
+  {
+    GlobalsGeomCacheDirectory = switch_name;
+  }
+
+  {
+    NameArray method_na;
+    method_na = NA_NewNameArray("Serial MPIIO Async");
+    switch_name = GetStringDefault("PFB.IOMethod", "Serial");
+    GlobalsPFBIOMethod = NA_NameToIndexExitOnError(method_na, switch_name, "PFB.IOMethod");
+    NA_FreeNameArray(method_na);
+
+#ifndef PARFLOW_HAVE_MPI
+    if (GlobalsPFBIOMethod == PFB_IO_MPIIO)
+    {
+      InputError("Error: invalid value <%s> for key <%s>, MPI-IO requires an MPI based AMPS layer\n",
+                 switch_name, "PFB.IOMethod");
+    }
+#endif
+
+    GlobalsPFBAsyncQueueDepth = GetIntDefault("PFB.AsyncQueueDepth", 2);
+    if (GlobalsPFBAsyncQueueDepth < 1)
+    {
+      InputError("Error: invalid value <%s> for key <%s>, queue depth must be at least 1\n",
+                 GetString("PFB.AsyncQueueDepth"), "PFB.AsyncQueueDepth");
+    }
+  }
+
+  {
+    NameArray method_na;
+    int method;
+    method_na = NA_NewNameArray("Persistent Neighbor");
+    switch_name = GetStringDefault("Process.Exchange.Method", "Persistent");
+    method = NA_NameToIndexExitOnError(method_na, switch_name, "Process.Exchange.Method");
+    NA_FreeNameArray(method_na);
+
+#ifdef AMPS_HAVE_NEIGHBOR_EXCHANGE
+    amps_SetExchangeMethod((method == 1) ? AMPS_EXCHANGE_NEIGHBOR : AMPS_EXCHANGE_PERSISTENT);
+#else
+    if (method == 1)
+    {
+      InputError("Error: invalid value <%s> for key <%s>, neighborhood collectives require the mpi1 AMPS layer with persistent exchanges and MPI-3\n",
+                 switch_name, "Process.Exchange.Method");
+    }
+#endif
+  }
+
   /*-----------------------------------------------------------------------
    * Initialize SAMRAI hierarchy
    *-----------------------------------------------------------------------*/
@@ -161,6 +232,14 @@ FreeSolver()
     amps_ThreadLocal(Solver_module) = NULL;
   }
 
+  PFBAsyncFinalize();
+
+  if (GlobalsDecomposition)
+  {
+    FreeSubgridArray(GlobalsDecomposition);
+    GlobalsDecomposition = NULL;
+  }
+
   FreeUserGrid(GlobalsUserGrid);
 
   FreeBackground(GlobalsBackground);
@@ -48,6 +48,19 @@
 
 #define CellFaceConductivity  HarmonicMean
 
+/*--------------------------------------------------------------------------
+ * Nonlinear solver statistics for the most recent time step.  Filled in
+ * by the nonlinear solver and passed to the time step selection so the
+ * step size can follow solver effort.  nonlin_iters is negative when no
+ * step has been solved yet.
+ *--------------------------------------------------------------------------*/
+
+typedef struct {
+  int nonlin_iters;             /* Newton iterations of the last solve */
+  int lin_iters;                /* Linear iterations of the last solve */
+  int conv_failures;            /* Failed solves before the step converged */
+} NonlinSolverStats;
+
 
 #endif
 
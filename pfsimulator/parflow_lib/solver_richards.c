@@ -73,6 +73,10 @@ typedef struct {
   int terrain_following_grid;   /* @RMM flag for terrain following grid in NL fn eval, sets sslopes=toposl */
   int variable_dz;              /* @RMM flag for variable dz-multipliers */
 
+  double checkpoint_wall_interval;      /* wall clock seconds between checkpoints, 0 is off */
+  int checkpoint_step_interval;         /* time steps between checkpoints, 0 is off */
+  char *checkpoint_restart_file;        /* checkpoint to restart from, "" is none */
+
   int print_initial_conditions; /* print the initial conditions, turning this off is useful during restart */
   int print_subsurf_data;       /* print permeability/porosity? */
   int print_press;              /* print pressures? */
@@ -268,6 +272,7 @@ typedef struct {
   int slope_accounting_CLM;     /* account for slopes in energy budget */
 
   int single_clm_file;          /* NBE: Write all CLM outputs into a single multi-layer PFB */
+  int clm_single_rst;           /* Write CLM restarts as one PFB instead of a file per rank */
 
   /* KKu netcdf output flags */
   int write_netcdf_press;       /* write pressures? */
@@ -380,6 +385,10 @@ typedef struct {
 
   Grid *snglclm;                /* NBE: New grid for single file CLM output */
   Vector *clm_out_grid;         /* NBE - Holds multi-layer, single file output of CLM */
+
+  int clm_rst_nz;               /* Layers of the shared CLM restart, from drv_restart_nz */
+  Grid *clm_rst_grid;           /* Grid for the shared CLM restart file */
+  Vector *clm_rst;              /* CLM restart state, one layer per field and CLM layer */
 #endif
 
   double *time_log;
@@ -394,6 +403,18 @@ typedef struct {
   int iteration_number;
   double dump_index;
   double clm_dump_index;
+
+  /* Time loop state read from a checkpoint for the next AdvanceRichards */
+  int restart_pending;
+  double restart_t;
+  double restart_dt;
+  double restart_ct;
+  double restart_cdt;
+  int restart_istep;
+  int restart_clm_next;
+  NonlinSolverStats restart_stats;
+  double restart_controller_dt;
+  double restart_controller_err;
 } InstanceXtra;
 
 static const char* dswr_filenames[] = { "DSWR" };
@@ -434,6 +455,423 @@ static const CLMForcingField clmForcingFields[] = {
 };
 int numForcingFields = sizeof(clmForcingFields) / sizeof(clmForcingFields[0]);
 
+/*--------------------------------------------------------------------------
+ * Checkpoint/restart
+ *
+ * A checkpoint holds the vectors that carry state from one time step to
+ * the next and the scalars of the time loop.  The velocities and
+ * q_overlnd are included since the surface predictor uses them from the
+ * previous step.  The reservoir storage and the cumulative well and
+ * reservoir statistics are saved as further scalars.  CLM keeps its own
+ * state in its restart files.
+ *--------------------------------------------------------------------------*/
+
+enum richards_checkpoint_scalar {
+  CHECKPOINT_TIME,
+  CHECKPOINT_DT,
+  CHECKPOINT_CT,
+  CHECKPOINT_CDT,
+  CHECKPOINT_FILE_NUMBER,
+  CHECKPOINT_ITERATION_NUMBER,
+  CHECKPOINT_DUMP_INDEX,
+  CHECKPOINT_CLM_DUMP_INDEX,
+  CHECKPOINT_NONLIN_ITERS,
+  CHECKPOINT_LIN_ITERS,
+  CHECKPOINT_CONV_FAILURES,
+  CHECKPOINT_CONTROLLER_DT,
+  CHECKPOINT_CONTROLLER_ERR,
+#ifdef HAVE_CLM
+  CHECKPOINT_CLM_ISTEP,
+  CHECKPOINT_CLM_NEXT,
+#endif
+  CHECKPOINT_NUM_SCALARS
+};
+
+static const char *richards_checkpoint_scalars[CHECKPOINT_NUM_SCALARS] = {
+  "Time",
+  "DeltaT",
+  "CouplingTime",
+  "CouplingDeltaT",
+  "FileNumber",
+  "IterationNumber",
+  "DumpIndex",
+  "CLMDumpIndex",
+  "NonlinIters",
+  "LinIters",
+  "ConvFailures",
+  "TimeStep.LastDeltaT",
+  "TimeStep.LastError",
+#ifdef HAVE_CLM
+  "CLM.IStep",
+  "CLM.ReuseNext",
+#endif
+};
+
+#define CHECKPOINT_MAX_VECTORS 15
+
+static int
+CheckpointVectorsRichards(InstanceXtra *instance_xtra,
+                          const char ** names,
+                          Vector **     vectors)
+{
+  Vector *state[CHECKPOINT_MAX_VECTORS] = {
+    instance_xtra->pressure,
+    instance_xtra->saturation,
+    instance_xtra->density,
+    instance_xtra->old_pressure,
+    instance_xtra->old_saturation,
+    instance_xtra->old_density,
+    instance_xtra->evap_trans,
+    instance_xtra->evap_trans_sum,
+    instance_xtra->overland_sum,
+    instance_xtra->ovrl_bc_flx,
+    instance_xtra->x_velocity,
+    instance_xtra->y_velocity,
+    instance_xtra->z_velocity,
+    instance_xtra->q_overlnd_x,
+    instance_xtra->q_overlnd_y
+  };
+  const char *state_names[CHECKPOINT_MAX_VECTORS] = {
+    "Pressure",
+    "Saturation",
+    "Density",
+    "OldPressure",
+    "OldSaturation",
+    "OldDensity",
+    "EvapTrans",
+    "EvapTransSum",
+    "OverlandSum",
+    "OverlandBCFlux",
+    "VelocityX",
+    "VelocityY",
+    "VelocityZ",
+    "OverlandFlowX",
+    "OverlandFlowY"
+  };
+  int num_vectors = 0;
+  int m;
+
+  /* overland_sum and q_overlnd are only allocated for some outputs */
+  for (m = 0; m < CHECKPOINT_MAX_VECTORS; m++)
+  {
+    if (state[m])
+    {
+      names[num_vectors] = state_names[m];
+      vectors[num_vectors] = state[m];
+      num_vectors++;
+    }
+  }
+
+  return num_vectors;
+}
+
+/* Names longer than the checkpoint file format allows would be truncated
+ * and could match another value on restart, so they are rejected */
+#define CHECKPOINT_STAT_NAME_LEN 32
+
+/* Reservoir and well values carried across a restart: one name and one
+ * pointer per value.  The reservoir storage is only exact on the rank
+ * that owns the release cell, which is stored in owners.  The amounts
+ * since the last print are the ones rank 0 prints, and the well
+ * statistics are the same on all ranks; their owner is -1, which stands
+ * for rank 0.  Returns the number of values; with names NULL they are
+ * only counted. */
+static int
+CheckpointStatsRichards(ProblemData *problem_data,
+                        char (*names)[CHECKPOINT_STAT_NAME_LEN],
+                        double **    values,
+                        int *        owners)
+{
+  ReservoirData *reservoir_data = ProblemDataReservoirData(problem_data);
+  WellData      *well_data = ProblemDataWellData(problem_data);
+  int num_phases = WellDataNumPhases(well_data);
+  int num_stats = 0;
+  int reservoir, well, kind, i;
+
+  for (reservoir = 0; reservoir < ReservoirDataNumReservoirs(reservoir_data);
+       reservoir++)
+  {
+    ReservoirDataPhysical *physical =
+      ReservoirDataReservoirPhysical(reservoir_data, reservoir);
+    double *reservoir_values[3] = {
+      &ReservoirDataPhysicalStorage(physical),
+      &ReservoirDataPhysicalIntakeAmountSinceLastPrint(physical),
+      &ReservoirDataPhysicalReleaseAmountSinceLastPrint(physical)
+    };
+    const char *reservoir_names[3] = { "Storage", "Intake", "Release" };
+
+    for (i = 0; i < 3; i++)
+    {
+      if (names)
+      {
+        if (snprintf(names[num_stats], CHECKPOINT_STAT_NAME_LEN,
+                     "Reservoir.%d.%s", reservoir, reservoir_names[i])
+            >= CHECKPOINT_STAT_NAME_LEN)
+        {
+          PARFLOW_ERROR("Reservoir checkpoint name is too long\n");
+        }
+        values[num_stats] = reservoir_values[i];
+        owners[num_stats] = (i == 0) ?
+                            ReservoirDataPhysicalReleaseCellMpiRank(physical) : -1;
+      }
+      num_stats++;
+    }
+  }
+
+  for (kind = 0; kind < 2; kind++)
+  {
+    int num_wells = kind ? WellDataNumFluxWells(well_data)
+                    : WellDataNumPressWells(well_data);
+
+    for (well = 0; well < num_wells; well++)
+    {
+      WellDataStat *stat = kind ? WellDataFluxWellStat(well_data, well)
+                           : WellDataPressWellStat(well_data, well);
+      int num_contaminants = num_phases * WellDataNumContaminants(well_data);
+      double *stat_arrays[6] = {
+        WellDataStatDeltaPhases(stat),
+        WellDataStatPhaseStats(stat),
+        WellDataStatDeltaSaturations(stat),
+        WellDataStatSaturationStats(stat),
+        WellDataStatDeltaContaminants(stat),
+        WellDataStatContaminantStats(stat)
+      };
+      int stat_sizes[6] = {
+        num_phases, num_phases, num_phases, num_phases,
+        num_contaminants, num_contaminants
+      };
+      const char *stat_names[6] = {
+        "DPhase", "Phase", "DSat", "Sat", "DContam", "Contam"
+      };
+      int a;
+
+      for (a = 0; a < 6; a++)
+      {
+        for (i = 0; i < stat_sizes[a]; i++)
+        {
+          if (names)
+          {
+            if (snprintf(names[num_stats], CHECKPOINT_STAT_NAME_LEN,
+                         "%sWell.%d.%s.%d", kind ? "Flux" : "Press", well,
+                         stat_names[a], i) >= CHECKPOINT_STAT_NAME_LEN)
+            {
+              PARFLOW_ERROR("Well checkpoint name is too long\n");
+            }
+            values[num_stats] = &stat_arrays[a][i];
+            owners[num_stats] = -1;
+          }
+          num_stats++;
+        }
+      }
+    }
+  }
+
+  return num_stats;
+}
+
+static void
+WriteCheckpointRichards(PFModule *         this_module,
+                        double             t,
+                        double             dt,
+                        double             ct,
+                        double             cdt,
+                        int                istep,
+                        int                clm_next,
+                        NonlinSolverStats *nonlin_stats)
+{
+  InstanceXtra *instance_xtra =
+    (InstanceXtra*)PFModuleInstanceXtra(this_module);
+  ProblemData *problem_data = (instance_xtra->problem_data);
+
+  const char *vector_names[CHECKPOINT_MAX_VECTORS];
+  Vector *vectors[CHECKPOINT_MAX_VECTORS];
+  const char **scalar_names;
+  double *scalars;
+  char (*stat_names)[CHECKPOINT_STAT_NAME_LEN];
+  double **stat_values;
+  int *stat_owners;
+  int num_vectors;
+  int num_stats;
+  int m;
+  char filename[2048];
+
+  amps_Invoice invoice;
+
+  num_stats = CheckpointStatsRichards(problem_data, NULL, NULL, NULL);
+
+  scalar_names = talloc(const char *, CHECKPOINT_NUM_SCALARS + num_stats);
+  scalars = ctalloc(double, CHECKPOINT_NUM_SCALARS + num_stats);
+  stat_names = (char (*)[CHECKPOINT_STAT_NAME_LEN])talloc(char, pfmax(num_stats, 1) * CHECKPOINT_STAT_NAME_LEN);
+  stat_values = talloc(double *, pfmax(num_stats, 1));
+  stat_owners = talloc(int, pfmax(num_stats, 1));
+
+  CheckpointStatsRichards(problem_data, stat_names, stat_values, stat_owners);
+
+  for (m = 0; m < CHECKPOINT_NUM_SCALARS; m++)
+  {
+    scalar_names[m] = richards_checkpoint_scalars[m];
+  }
+
+  scalars[CHECKPOINT_TIME] = t;
+  scalars[CHECKPOINT_DT] = dt;
+  scalars[CHECKPOINT_CT] = ct;
+  scalars[CHECKPOINT_CDT] = cdt;
+  scalars[CHECKPOINT_FILE_NUMBER] = instance_xtra->file_number;
+  scalars[CHECKPOINT_ITERATION_NUMBER] = instance_xtra->iteration_number;
+  scalars[CHECKPOINT_DUMP_INDEX] = instance_xtra->dump_index;
+  scalars[CHECKPOINT_CLM_DUMP_INDEX] = instance_xtra->clm_dump_index;
+  scalars[CHECKPOINT_NONLIN_ITERS] = nonlin_stats->nonlin_iters;
+  scalars[CHECKPOINT_LIN_ITERS] = nonlin_stats->lin_iters;
+  scalars[CHECKPOINT_CONV_FAILURES] = nonlin_stats->conv_failures;
+  SelectTimeStepGetState(instance_xtra->select_time_step,
+                         &scalars[CHECKPOINT_CONTROLLER_DT],
+                         &scalars[CHECKPOINT_CONTROLLER_ERR]);
+#ifdef HAVE_CLM
+  scalars[CHECKPOINT_CLM_ISTEP] = istep;
+  scalars[CHECKPOINT_CLM_NEXT] = clm_next;
+#else
+  PF_UNUSED(istep);
+  PF_UNUSED(clm_next);
+#endif
+
+  /* Take every value from its owner, rank 0 for the global ones */
+  for (m = 0; m < num_stats; m++)
+  {
+    scalar_names[CHECKPOINT_NUM_SCALARS + m] = stat_names[m];
+    if (pfmax(stat_owners[m], 0) == amps_Rank(amps_CommWorld))
+    {
+      scalars[CHECKPOINT_NUM_SCALARS + m] = *stat_values[m];
+    }
+  }
+
+  if (num_stats > 0)
+  {
+    invoice = amps_NewInvoice("%*d", num_stats,
+                              scalars + CHECKPOINT_NUM_SCALARS);
+    amps_AllReduce(amps_CommWorld, invoice, amps_Add);
+    amps_FreeInvoice(invoice);
+  }
+
+  num_vectors = CheckpointVectorsRichards(instance_xtra, vector_names,
+                                          vectors);
+
+  sprintf(filename, "%s.checkpoint.%05d", GlobalsOutFileName,
+          instance_xtra->iteration_number);
+
+  WriteCheckpoint(filename, CHECKPOINT_NUM_SCALARS + num_stats,
+                  scalar_names, scalars,
+                  num_vectors, vector_names, vectors);
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    amps_Printf("Wrote checkpoint %s at time %e\n", filename, t);
+  }
+
+  tfree(scalar_names);
+  tfree(scalars);
+  tfree(stat_names);
+  tfree(stat_values);
+  tfree(stat_owners);
+}
+
+static void
+ReadCheckpointRichards(PFModule *this_module,
+                       char *    filename)
+{
+  InstanceXtra *instance_xtra =
+    (InstanceXtra*)PFModuleInstanceXtra(this_module);
+  ProblemData *problem_data = (instance_xtra->problem_data);
+
+  const char *vector_names[CHECKPOINT_MAX_VECTORS];
+  Vector *vectors[CHECKPOINT_MAX_VECTORS];
+  const char **scalar_names;
+  double *scalars;
+  char (*stat_names)[CHECKPOINT_STAT_NAME_LEN];
+  double **stat_values;
+  int *stat_owners;
+  int num_vectors;
+  int num_stats;
+  int m;
+
+  VectorUpdateCommHandle *handle;
+
+  num_stats = CheckpointStatsRichards(problem_data, NULL, NULL, NULL);
+
+  scalar_names = talloc(const char *, CHECKPOINT_NUM_SCALARS + num_stats);
+  scalars = ctalloc(double, CHECKPOINT_NUM_SCALARS + num_stats);
+  stat_names = (char (*)[CHECKPOINT_STAT_NAME_LEN])talloc(char, pfmax(num_stats, 1) * CHECKPOINT_STAT_NAME_LEN);
+  stat_values = talloc(double *, pfmax(num_stats, 1));
+  stat_owners = talloc(int, pfmax(num_stats, 1));
+
+  CheckpointStatsRichards(problem_data, stat_names, stat_values, stat_owners);
+
+  for (m = 0; m < CHECKPOINT_NUM_SCALARS; m++)
+  {
+    scalar_names[m] = richards_checkpoint_scalars[m];
+  }
+  for (m = 0; m < num_stats; m++)
+  {
+    scalar_names[CHECKPOINT_NUM_SCALARS + m] = stat_names[m];
+  }
+
+  num_vectors = CheckpointVectorsRichards(instance_xtra, vector_names,
+                                          vectors);
+
+  ReadCheckpoint(filename, CHECKPOINT_NUM_SCALARS + num_stats,
+                 scalar_names, scalars,
+                 num_vectors, vector_names, vectors);
+
+  for (m = 0; m < num_vectors; m++)
+  {
+    if (VectorNumGhost(vectors[m]) > 0)
+    {
+      handle = InitVectorUpdate(vectors[m], VectorUpdateAll);
+      FinalizeVectorUpdate(handle);
+    }
+  }
+
+  /* Every rank continues from the owner's values */
+  for (m = 0; m < num_stats; m++)
+  {
+    *stat_values[m] = scalars[CHECKPOINT_NUM_SCALARS + m];
+  }
+
+  instance_xtra->file_number = (int)scalars[CHECKPOINT_FILE_NUMBER];
+  instance_xtra->iteration_number =
+    (int)scalars[CHECKPOINT_ITERATION_NUMBER];
+  instance_xtra->dump_index = scalars[CHECKPOINT_DUMP_INDEX];
+  instance_xtra->clm_dump_index = scalars[CHECKPOINT_CLM_DUMP_INDEX];
+
+  instance_xtra->restart_pending = 1;
+  instance_xtra->restart_t = scalars[CHECKPOINT_TIME];
+  instance_xtra->restart_dt = scalars[CHECKPOINT_DT];
+  instance_xtra->restart_ct = scalars[CHECKPOINT_CT];
+  instance_xtra->restart_cdt = scalars[CHECKPOINT_CDT];
+  instance_xtra->restart_stats.nonlin_iters =
+    (int)scalars[CHECKPOINT_NONLIN_ITERS];
+  instance_xtra->restart_stats.lin_iters = (int)scalars[CHECKPOINT_LIN_ITERS];
+  instance_xtra->restart_stats.conv_failures =
+    (int)scalars[CHECKPOINT_CONV_FAILURES];
+#ifdef HAVE_CLM
+  instance_xtra->restart_istep = (int)scalars[CHECKPOINT_CLM_ISTEP];
+  instance_xtra->restart_clm_next = (int)scalars[CHECKPOINT_CLM_NEXT];
+#endif
+  instance_xtra->restart_controller_dt = scalars[CHECKPOINT_CONTROLLER_DT];
+  instance_xtra->restart_controller_err = scalars[CHECKPOINT_CONTROLLER_ERR];
+
+  if (!amps_Rank(amps_CommWorld))
+  {
+    amps_Printf("Restarting from checkpoint %s at time %e\n", filename,
+                instance_xtra->restart_t);
+  }
+
+  tfree(scalar_names);
+  tfree(scalars);
+  tfree(stat_names);
+  tfree(stat_values);
+  tfree(stat_owners);
+}
+
 void
 SetupRichards(PFModule * this_module)
 {
@@ -1114,6 +1552,13 @@ SetupRichards(PFModule * this_module)
       InitVectorAll(instance_xtra->clm_out_grid, 0.0);
     }
 
+    if (public_xtra->clm_single_rst)
+    {
+      instance_xtra->clm_rst =
+        NewVectorType(instance_xtra->clm_rst_grid, 1, 1, vector_met);
+      InitVectorAll(instance_xtra->clm_rst, 0.0);
+    }
+
     /*IMF Initialize variables for printing CLM output */
     instance_xtra->eflx_lh_tot =
       NewVectorType(grid2d, 1, 1, vector_cell_centered_2D);
@@ -1442,6 +1887,15 @@ SetupRichards(PFModule * this_module)
     handle = InitVectorUpdate(instance_xtra->pressure, VectorUpdateAll);
     FinalizeVectorUpdate(handle);
 
+    /*****************************************************************/
+    /*    Replace the initial state with a checkpoint if requested   */
+    /*****************************************************************/
+
+    if (strlen(public_xtra->checkpoint_restart_file) > 0)
+    {
+      ReadCheckpointRichards(this_module,
+                             public_xtra->checkpoint_restart_file);
+    }
 
     /*****************************************************************/
     /*          Print out any of the requested initial data          */
@@ -1449,7 +1903,8 @@ SetupRichards(PFModule * this_module)
 
     any_file_dumped = 0;
 
-    if (print_initial_conditions)
+    /* A restarted run already wrote its initial data */
+    if (print_initial_conditions && !instance_xtra->restart_pending)
     {
       /*-------------------------------------------------------------------
        * Print out the initial reservoir data?
@@ -1891,7 +2346,8 @@ SetupRichards(PFModule * this_module)
       instance_xtra->number_logged++;
     }
 
-    if (any_file_dumped)
+    /* The file number from a checkpoint is already the next one */
+    if (any_file_dumped && !instance_xtra->restart_pending)
     {
       instance_xtra->file_number++;
     }
@@ -1962,6 +2418,12 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
   int clm_last_rst = public_xtra->clm_last_rst; // Reuse of the RST file
   int clm_water_stress_type = public_xtra->clm_water_stress_type;        // Water stress RZ
   int clm_daily_rst = public_xtra->clm_daily_rst;       // Daily or hourly RST files, defaults to daily
+  int clm_single_rst = public_xtra->clm_single_rst;     // Restart through one shared PFB file
+  int clm_rst_nz = 0;           // Layers of the shared restart, 0 if unused
+  int clm_rst_read = 0;         // Shared restart read for CLM to start from
+  int clm_rst_write = -1;       // Time stamp of the shared restart CLM filled, -1 if none
+  double clm_rst_unused = 0.0;
+  double *clm_rst_data;
 
   int fstep = INT_MIN;
   int fflag, fstart, fstop;     // IMF: index w/in 3D forcing array corresponding to istep
@@ -2018,6 +2480,7 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
   int take_more_time_steps;
   int conv_failures;
   int max_failures = public_xtra->max_convergence_failures;
+  NonlinSolverStats nonlin_stats = { -1, 0, 0 };
 
   double t;
   double dt = 0.0;
@@ -2035,6 +2498,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
 
   int first_tstep = 1;
 
+  amps_Clock_t checkpoint_clock;
+
   sprintf(file_prefix, "%s", GlobalsOutFileName);
 
   //CPS oasis definition phase
@@ -2079,12 +2544,14 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
   if (time_step_control)
   {
     PFModuleInvokeType(SelectTimeStepInvoke, time_step_control,
-                       (&cdt, &dt_info, t, problem, problem_data));
+                       (&cdt, &dt_info, t, problem, problem_data,
+                        NULL));
   }
   else
   {
     PFModuleInvokeType(SelectTimeStepInvoke, select_time_step,
-                       (&cdt, &dt_info, t, problem, problem_data));
+                       (&cdt, &dt_info, t, problem, problem_data,
+                        NULL));
   }
   dt = cdt;
 
@@ -2111,6 +2578,26 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
   fstop = 0;                    // init to something, only used with 3D met forcing
 #endif
 
+  /* Continue the time loop of a checkpoint read by SetupRichards */
+  if (instance_xtra->restart_pending)
+  {
+    t = instance_xtra->restart_t;
+    dt = instance_xtra->restart_dt;
+    ct = instance_xtra->restart_ct;
+    cdt = instance_xtra->restart_cdt;
+    nonlin_stats = instance_xtra->restart_stats;
+#ifdef HAVE_CLM
+    istep = instance_xtra->restart_istep;
+    clm_next = instance_xtra->restart_clm_next;
+#endif
+    SelectTimeStepSetState(instance_xtra->select_time_step,
+                           instance_xtra->restart_controller_dt,
+                           instance_xtra->restart_controller_err);
+    instance_xtra->restart_pending = 0;
+  }
+
+  checkpoint_clock = amps_Clock();
+
   do                            /* while take_more_time_steps */
   {
     if (t == ct)
@@ -2561,6 +3048,38 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
 
 
 
+      /* The shared CLM restart is read here, CLM only reads it when it
+       * starts from a restart */
+      if (clm_single_rst)
+      {
+        clm_rst_nz = instance_xtra->clm_rst_nz;
+        clm_rst_read = 0;
+        clm_rst_write = -1;
+
+        if (t == start_time)
+        {
+          if (snprintf(filename, sizeof(filename), "%s.clm_rst.%05d.pfb",
+                       file_prefix, istep - 1) >= (int)sizeof(filename))
+          {
+            PARFLOW_ERROR("CLM restart file name is too long\n");
+          }
+
+          if (!amps_Rank(amps_CommWorld))
+          {
+            clm_rst_read = (access(filename, R_OK) == 0);
+          }
+
+          amps_Invoice invoice = amps_NewInvoice("%i", &clm_rst_read);
+          amps_BCast(amps_CommWorld, 0, invoice);
+          amps_FreeInvoice(invoice);
+
+          if (clm_rst_read)
+          {
+            ReadPFBinaryAnyLayout(filename, instance_xtra->clm_rst);
+          }
+        }
+      }
+
       ForSubgridI(is, GridSubgrids(grid))
       {
         double dx, dy, dz;
@@ -2788,6 +3307,9 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
           {
             /*BH: added vegetation forcings and associated option (clm_forc_veg) */
             clm_file_dir_length = strlen(public_xtra->clm_file_dir);
+            clm_rst_data = clm_single_rst ?
+                           SubvectorData(VectorSubvector(instance_xtra->clm_rst, is)) :
+                           &clm_rst_unused;
             CALL_CLM_LSM(pp, sp, et, top_dat, bot_dat, po_dat, dz_dat, istep,
                          cdt, t, start_time, dx, dy, dz, ix, iy, nx, ny, nz,
                          nx_f, ny_f, nz_f, nz_rz, ip, p, q, r, gnx,
@@ -2867,7 +3389,9 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
                          public_xtra->clm_fwet_exponent,
                          public_xtra->clm_stomata_scheme,
                          public_xtra->clm_interception_scheme,
-                         public_xtra->clm_interception_tanh_alpha);
+                         public_xtra->clm_interception_tanh_alpha,
+                         clm_single_rst, clm_rst_nz, clm_rst_data,
+                         clm_rst_read, clm_rst_write);
 
             break;
           }
@@ -2879,6 +3403,12 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         }                       /* switch on LSM */
       }
 
+      /* CLM filled the shared restart, every rank takes the same decision */
+      if (clm_rst_write >= 0)
+      {
+        sprintf(file_postfix, "clm_rst.%05d", clm_rst_write);
+        WritePFBinary(file_prefix, file_postfix, instance_xtra->clm_rst);
+      }
 
       handle = InitVectorUpdate(evap_trans, VectorUpdateAll);
       FinalizeVectorUpdate(handle);
@@ -2984,13 +3514,13 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         {
           PFModuleInvokeType(SelectTimeStepInvoke, time_step_control,
                              (&dt, &dt_info, t, problem,
-                              problem_data));
+                              problem_data, &nonlin_stats));
         }
         else
         {
           PFModuleInvokeType(SelectTimeStepInvoke, select_time_step,
                              (&dt, &dt_info, t, problem,
-                              problem_data));
+                              problem_data, &nonlin_stats));
         }
 
         PFVCopy(instance_xtra->density, instance_xtra->old_density);
@@ -3380,7 +3910,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
                                    instance_xtra->y_velocity,
                                    instance_xtra->z_velocity,
                                    instance_xtra->q_overlnd_x,
-                                   instance_xtra->q_overlnd_y));
+                                   instance_xtra->q_overlnd_y,
+                                   &nonlin_stats));
 
       if (retval != 0)
       {
@@ -3405,6 +3936,8 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
     }                           /* Ends do for convergence of time step loop */
     while ((!converged) && (conv_failures < max_failures));
 
+    nonlin_stats.conv_failures = conv_failures;
+
     instance_xtra->iteration_number++;
 
     /***************************************************************
@@ -4618,6 +5151,52 @@ AdvanceRichards(PFModule * this_module, double start_time,      /* Starting time
         && (t < stop_time);
     }
 
+    /*-----------------------------------------------------------------
+     * Write a checkpoint every Solver.Checkpoint.StepInterval time
+     * steps, or once Solver.Checkpoint.WallClockInterval seconds have
+     * passed since the last one.  Rank 0's clock decides for all.
+     *-----------------------------------------------------------------*/
+
+    if (converged && (public_xtra->checkpoint_step_interval > 0
+                      || public_xtra->checkpoint_wall_interval > 0.0))
+    {
+      int write_checkpoint = 0;
+
+      if (public_xtra->checkpoint_step_interval > 0
+          && (instance_xtra->iteration_number
+              % public_xtra->checkpoint_step_interval) == 0)
+      {
+        write_checkpoint = 1;
+      }
+
+      if (public_xtra->checkpoint_wall_interval > 0.0)
+      {
+        double elapsed = (double)(amps_Clock() - checkpoint_clock)
+                         / AMPS_TICKS_PER_SEC;
+        amps_Invoice invoice = amps_NewInvoice("%d", &elapsed);
+
+        amps_BCast(amps_CommWorld, 0, invoice);
+        amps_FreeInvoice(invoice);
+
+        if (elapsed >= public_xtra->checkpoint_wall_interval)
+        {
+          write_checkpoint = 1;
+        }
+      }
+
+      if (write_checkpoint)
+      {
+#ifdef HAVE_CLM
+        WriteCheckpointRichards(this_module, t, dt, ct, cdt, istep, clm_next,
+                                &nonlin_stats);
+#else
+        WriteCheckpointRichards(this_module, t, dt, ct, cdt, 0, 0,
+                                &nonlin_stats);
+#endif
+        checkpoint_clock = amps_Clock();
+      }
+    }
+
 #ifdef HAVE_SLURM
     /*
      * If at end of a dump_interval and user requests halt if
@@ -4927,6 +5506,10 @@ TeardownRichards(PFModule * this_module)
     FreeVector(instance_xtra->irr_flag);
     FreeVector(instance_xtra->qflx_qirr);
     FreeVector(instance_xtra->qflx_qirr_inst);
+    if (instance_xtra->clm_rst)
+    {
+      FreeVector(instance_xtra->clm_rst);
+    }
     /*IMF Initialize variables for CLM forcing fields
      * SW rad, LW rad, precip, T(air), U, V, P(air), q(air) */
     FreeVector(instance_xtra->sw_forc);
@@ -5202,6 +5785,27 @@ SolverRichardsInitInstanceXtra()
     (instance_xtra->snglclm) = snglclm;
   }
 
+  /* Grid for the shared CLM restart file, one layer per restart field.
+   * CLM owns the layout, so it also provides the number of layers. */
+  if (public_xtra->clm_single_rst)
+  {
+    CALL_DRV_RESTART_NZ(public_xtra->clm_nz, instance_xtra->clm_rst_nz);
+
+    all_subgrids = GridAllSubgrids(grid);
+    new_all_subgrids = NewSubgridArray();
+    ForSubgridI(i, all_subgrids)
+    {
+      subgrid = SubgridArraySubgrid(all_subgrids, i);
+      new_subgrid = DuplicateSubgrid(subgrid);
+      SubgridIZ(new_subgrid) = 0;
+      SubgridNZ(new_subgrid) = instance_xtra->clm_rst_nz;
+      AppendSubgrid(new_subgrid, new_all_subgrids);
+    }
+    new_subgrids = GetGridSubgrids(new_all_subgrids);
+    (instance_xtra->clm_rst_grid) = NewGrid(new_subgrids, new_all_subgrids);
+    CreateComputePkgs(instance_xtra->clm_rst_grid);
+  }
+
   /* IMF New grid for Tsoil (nx*ny*10) */
   all_subgrids = GridAllSubgrids(grid);
   new_all_subgrids = NewSubgridArray();
@@ -5445,6 +6049,10 @@ SolverRichardsFreeInstanceXtra()
     FreeGrid((instance_xtra->gridTs));
 
     FreeGrid((instance_xtra->snglclm));         //NBE
+    if (instance_xtra->clm_rst_grid)
+    {
+      FreeGrid((instance_xtra->clm_rst_grid));
+    }
 #endif
 
     tfree(instance_xtra);
@@ -5625,6 +6233,12 @@ SolverRichardsNewPublicXtra(char *name)
   switch_value = NA_NameToIndexExitOnError(switch_na, switch_name, key);
   public_xtra->clm_daily_rst = switch_value;
 
+  /* Write the CLM restart as one PFB file for all ranks */
+  sprintf(key, "%s.CLM.SingleFileRST", name);
+  switch_name = GetStringDefault(key, "False");
+  switch_value = NA_NameToIndexExitOnError(switch_na, switch_name, key);
+  public_xtra->clm_single_rst = switch_value;
+
 
   // -------------------
 
@@ -6249,6 +6863,15 @@ SolverRichardsNewPublicXtra(char *name)
       ("         wrong times times due to how Parflow discretizes time.\n");
   }
 
+  sprintf(key, "%s.Checkpoint.WallClockInterval", name);
+  public_xtra->checkpoint_wall_interval = GetDoubleDefault(key, 0.0);
+
+  sprintf(key, "%s.Checkpoint.StepInterval", name);
+  public_xtra->checkpoint_step_interval = GetIntDefault(key, 0);
+
+  sprintf(key, "%s.Checkpoint.RestartFile", name);
+  public_xtra->checkpoint_restart_file = GetStringDefault(key, "");
+
   sprintf(key, "%s.AdvectOrder", name);
   public_xtra->advect_order = GetIntDefault(key, 2);
 
@@ -35,9 +35,250 @@
 #include "parflow.h"
 #include "timing.h"
 
+#include "cJSON.h"
+
+#ifdef PARFLOW_HAVE_OMP
+#include <omp.h>
+#endif
+
 
 #ifdef PF_TIMING
 
+/*--------------------------------------------------------------------------
+ * Wall clock in seconds.  amps_Clock only resolves 1/AMPS_TICKS_PER_SEC,
+ * which is too coarse for the individual module calls.
+ *--------------------------------------------------------------------------*/
+
+static double TimingClock()
+{
+#ifdef PARFLOW_HAVE_MPI
+  return MPI_Wtime();
+#else
+  return (double)amps_Clock() / AMPS_TICKS_PER_SEC;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------
+ * NewTimingNode
+ *--------------------------------------------------------------------------*/
+
+static TimingNode  *NewTimingNode(
+                                  TimingNode *parent,
+                                  const char *name,
+                                  int         kind,
+                                  int         index)
+{
+  TimingNode  *node = ctalloc(TimingNode, 1);
+  TimingNode **last;
+
+  node->name = ctalloc(char, strlen(name) + 1);
+  strcpy(node->name, name);
+  node->kind = kind;
+  node->index = index;
+  node->parent = parent;
+
+  /* Keep the children in the order they were first opened */
+  if (parent)
+  {
+    for (last = &(parent->child); *last; last = &((*last)->sibling))
+      ;
+    *last = node;
+  }
+
+  return node;
+}
+
+
+/*--------------------------------------------------------------------------
+ * FreeTimingNode
+ *--------------------------------------------------------------------------*/
+
+static void  FreeTimingNode(
+                            TimingNode *node)
+{
+  TimingNode *child, *next;
+
+  for (child = node->child; child; child = next)
+  {
+    next = child->sibling;
+    FreeTimingNode(child);
+  }
+
+  tfree(node->name);
+  tfree(node);
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingChild: find or create the child of parent with the given key
+ *--------------------------------------------------------------------------*/
+
+static TimingNode  *TimingChild(
+                                TimingNode *parent,
+                                const char *name,
+                                int         kind,
+                                int         index)
+{
+  TimingNode *child;
+
+  for (child = parent->child; child; child = child->sibling)
+  {
+    if (child->kind == kind && strcmp(child->name, name) == 0)
+    {
+      return child;
+    }
+  }
+
+  return NewTimingNode(parent, name, kind, index);
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingOpen
+ *--------------------------------------------------------------------------*/
+
+static TimingNode  *TimingOpen(
+                               const char *name,
+                               int         kind,
+                               int         index)
+{
+  TimingNode *node = TimingChild(timing->current, name, kind, index);
+
+  node->count++;
+  node->start = TimingClock();
+  node->start_flops = TimingFLOPCount;
+
+  if (index >= 0 && (timing->depth)[index]++ == 0)
+  {
+    (timing->time)[index] -= node->start;
+    (timing->cpu_time)[index] -= amps_CPUClock();
+    (timing->flops)[index] -= TimingFLOPCount;
+  }
+
+  timing->current = node;
+
+  return node;
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingClose: close every open node up to and including node.
+ *
+ * Nodes left open by an early return in a timed region are closed
+ * with their enclosing node.  Closing a node that is not open is a
+ * no-op.
+ *--------------------------------------------------------------------------*/
+
+static void  TimingClose(
+                         TimingNode *node)
+{
+  TimingNode *open;
+  double now;
+
+  for (open = timing->current; open != node; open = open->parent)
+  {
+    if (open == timing->root)
+    {
+      return;
+    }
+  }
+
+  now = TimingClock();
+
+  do
+  {
+    open = timing->current;
+
+    open->time += now - open->start;
+    open->flops += TimingFLOPCount - open->start_flops;
+
+    if (open->index >= 0 && --(timing->depth)[open->index] == 0)
+    {
+      (timing->time)[open->index] += now;
+      (timing->cpu_time)[open->index] += amps_CPUClock();
+      (timing->flops)[open->index] += TimingFLOPCount;
+    }
+
+    timing->current = open->parent;
+  }
+  while (open != node);
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingBegin
+ *--------------------------------------------------------------------------*/
+
+void  TimingBegin(
+                  int index)
+{
+  TimingOpen(TimingName(index), TimingNodeTimer, index);
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingEnd
+ *--------------------------------------------------------------------------*/
+
+void  TimingEnd(
+                int index)
+{
+  TimingNode *node;
+
+  for (node = timing->current; node != timing->root; node = node->parent)
+  {
+    if (node->kind == TimingNodeTimer && node->index == index)
+    {
+      TimingClose(node);
+      return;
+    }
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingScopeEnter: open a node for a PFModule method.
+ *
+ * Returns NULL when nothing was opened; module calls made before
+ * NewTiming, after FreeTiming or from inside a threaded loop are not
+ * timed.
+ *--------------------------------------------------------------------------*/
+
+TimingNode  *TimingScopeEnter(
+                              const char *name,
+                              int         kind)
+{
+  if (timing == NULL)
+  {
+    return NULL;
+  }
+
+#ifdef PARFLOW_HAVE_OMP
+  if (omp_in_parallel())
+  {
+    return NULL;
+  }
+#endif
+
+  return TimingOpen(name ? name : "(unnamed module)", kind, -1);
+}
+
+
+/*--------------------------------------------------------------------------
+ * TimingScopeExit: cleanup handler for the node opened by TimingScopeEnter
+ *--------------------------------------------------------------------------*/
+
+void  TimingScopeExit(
+                      TimingNode **node)
+{
+  if (*node && timing)
+  {
+    TimingClose(*node);
+  }
+}
+
+
 /*--------------------------------------------------------------------------
  * NewTiming
  *--------------------------------------------------------------------------*/
@@ -46,6 +287,11 @@ void  NewTiming()
 {
   timing = ctalloc(TimingType, 1);
 
+  timing->root = NewTimingNode(NULL, "ParFlow", TimingNodeRoot, -1);
+  timing->root->count = 1;
+  timing->root->start = TimingClock();
+  timing->current = timing->root;
+
   /* The order of these registers need to be in sync with the defines
    * found in timing.h
    */
@@ -62,9 +308,7 @@ void  NewTiming()
   RegisterTiming("Clustering");
   RegisterTiming("Netcdf I/O");
   RegisterTiming("PDI I/O");
-#ifdef VECTOR_UPDATE_TIMING
   RegisterTiming("VectorUpdate");
-#endif
 }
 
 
@@ -75,18 +319,20 @@ void  NewTiming()
 int  RegisterTiming(
                     char *name)
 {
-  amps_Clock_t     *old_time = (timing->time);
+  double           *old_time = (timing->time);
   amps_CPUClock_t  *old_cpu_time = (timing->cpu_time);
   FLOPType         *old_flops = (timing->flops);
+  int              *old_depth = (timing->depth);
   char            **old_name = (timing->name);
   int old_size = (timing->size);
 
   int i;
 
 
-  (timing->time) = ctalloc(amps_Clock_t, (old_size + 1));
+  (timing->time) = ctalloc(double, (old_size + 1));
   (timing->cpu_time) = ctalloc(amps_CPUClock_t, (old_size + 1));
   (timing->flops) = ctalloc(FLOPType, (old_size + 1));
+  (timing->depth) = ctalloc(int, (old_size + 1));
   (timing->name) = ctalloc(char *, (old_size + 1));
 
   (timing->size)++;
@@ -96,12 +342,14 @@ int  RegisterTiming(
     (timing->time)[i] = old_time[i];
     (timing->cpu_time)[i] = old_cpu_time[i];
     (timing->flops)[i] = old_flops[i];
+    (timing->depth)[i] = old_depth[i];
     (timing->name)[i] = old_name[i];
   }
 
   tfree(old_time);
   tfree(old_cpu_time);
   tfree(old_flops);
+  tfree(old_depth);
   tfree(old_name);
 
   (timing->name)[old_size] = ctalloc(char, 50);
@@ -111,6 +359,391 @@ int  RegisterTiming(
 }
 
 
+/*--------------------------------------------------------------------------
+ * Cross rank summary of the timing tree.
+ *
+ * Each rank flattens its tree into one text record per node in
+ * preorder. Rank 0 broadcasts its records, which fix the shape of the
+ * summary tree on every rank; each rank then fills in its own values by
+ * path and min/max/sum over the ranks are formed with one reduction per
+ * operation. Nodes that rank 0 never opened are left out.
+ *--------------------------------------------------------------------------*/
+
+typedef struct {
+  double min;
+  double max;
+  double sum;
+} TimingStat;
+
+typedef struct _TimingSummary {
+  char                  *name;
+  int kind;
+  int ranks;
+
+  TimingStat calls;
+  TimingStat inclusive;
+  TimingStat exclusive;
+  double flops;
+
+  struct _TimingSummary *child;
+  struct _TimingSummary *sibling;
+} TimingSummary;
+
+static const char *timing_kind_names[] = { "root", "timer", "module", "setup" };
+
+static void  TimingStatAdd(
+                           TimingStat *stat,
+                           int         first,
+                           double      value)
+{
+  if (first)
+  {
+    stat->min = stat->max = stat->sum = value;
+  }
+  else
+  {
+    stat->min = pfmin(stat->min, value);
+    stat->max = pfmax(stat->max, value);
+    stat->sum += value;
+  }
+}
+
+
+static void  FreeTimingSummary(
+                               TimingSummary *summary)
+{
+  TimingSummary *child, *next;
+
+  for (child = summary->child; child; child = next)
+  {
+    next = child->sibling;
+    FreeTimingSummary(child);
+  }
+
+  tfree(summary->name);
+  tfree(summary);
+}
+
+
+/* Append one record per node of the subtree to buffer */
+static void  TimingRecords(
+                           TimingNode *node,
+                           int         depth,
+                           char      **buffer,
+                           int        *length,
+                           int        *size)
+{
+  TimingNode *child;
+  double exclusive = node->time;
+  int needed;
+
+  for (child = node->child; child; child = child->sibling)
+  {
+    exclusive -= child->time;
+  }
+
+  needed = (int)strlen(node->name) + 128;
+  if (*length + needed >= *size)
+  {
+    *size = 2 * (*size) + needed;
+    *buffer = (char*)realloc(*buffer, (size_t)(*size));
+  }
+
+  *length += sprintf(*buffer + *length, "%d %d %d %.17g %.17g %.17g %s\n",
+                     depth, node->kind, node->count, node->time,
+                     pfmax(exclusive, 0.0), node->flops, node->name);
+
+  for (child = node->child; child; child = child->sibling)
+  {
+    TimingRecords(child, depth + 1, buffer, length, size);
+  }
+}
+
+
+/* Merge the records of one rank into the summary tree; without create,
+ * records for nodes that are not in the tree yet are skipped */
+static void  TimingMergeRecords(
+                                TimingSummary *root,
+                                char          *records,
+                                int            create)
+{
+  TimingSummary **path = NULL;
+  int path_size = 0;
+  char *line = records;
+
+  while (line && *line)
+  {
+    char *end = strchr(line, '\n');
+    char *name;
+    int depth, kind, count, offset;
+    double inclusive, exclusive, flops;
+    TimingSummary *node;
+
+    if (end)
+    {
+      *end = '\0';
+    }
+
+    if (sscanf(line, "%d %d %d %lf %lf %lf %n", &depth, &kind, &count,
+               &inclusive, &exclusive, &flops, &offset) >= 6)
+    {
+      name = line + offset;
+
+      if (depth >= path_size)
+      {
+        path_size = depth + 16;
+        path = (TimingSummary**)realloc(path, sizeof(TimingSummary*) * (size_t)path_size);
+      }
+
+      if (depth == 0)
+      {
+        node = root;
+        if (node->name == NULL)
+        {
+          node->name = ctalloc(char, strlen(name) + 1);
+          strcpy(node->name, name);
+          node->kind = kind;
+        }
+      }
+      else if (path[depth - 1] == NULL)
+      {
+        node = NULL;
+      }
+      else
+      {
+        TimingSummary *parent = path[depth - 1];
+        TimingSummary **last = &(parent->child);
+
+        for (node = parent->child; node; node = node->sibling)
+        {
+          if (node->kind == kind && strcmp(node->name, name) == 0)
+          {
+            break;
+          }
+          last = &(node->sibling);
+        }
+
+        if (node == NULL && create)
+        {
+          node = ctalloc(TimingSummary, 1);
+          node->name = ctalloc(char, strlen(name) + 1);
+          strcpy(node->name, name);
+          node->kind = kind;
+          *last = node;
+        }
+      }
+
+      if (node)
+      {
+        TimingStatAdd(&(node->calls), node->ranks == 0, (double)count);
+        TimingStatAdd(&(node->inclusive), node->ranks == 0, inclusive);
+        TimingStatAdd(&(node->exclusive), node->ranks == 0, exclusive);
+        node->flops += flops;
+        node->ranks++;
+      }
+
+      path[depth] = node;
+    }
+
+    line = end ? end + 1 : NULL;
+  }
+
+  free(path);
+}
+
+
+static cJSON  *TimingStatToJSON(
+                                TimingStat *stat,
+                                int         ranks)
+{
+  cJSON *json = cJSON_CreateObject();
+
+  cJSON_AddNumberToObject(json, "min", stat->min);
+  cJSON_AddNumberToObject(json, "max", stat->max);
+  cJSON_AddNumberToObject(json, "mean", stat->sum / ranks);
+
+  return json;
+}
+
+
+static cJSON  *TimingSummaryToJSON(
+                                   TimingSummary *summary)
+{
+  cJSON *json = cJSON_CreateObject();
+  TimingSummary *child;
+
+  cJSON_AddStringToObject(json, "name", summary->name);
+  cJSON_AddStringToObject(json, "kind", timing_kind_names[summary->kind]);
+  cJSON_AddNumberToObject(json, "ranks", summary->ranks);
+  cJSON_AddItemToObject(json, "calls", TimingStatToJSON(&(summary->calls), summary->ranks));
+  cJSON_AddItemToObject(json, "inclusive", TimingStatToJSON(&(summary->inclusive), summary->ranks));
+  cJSON_AddItemToObject(json, "exclusive", TimingStatToJSON(&(summary->exclusive), summary->ranks));
+  cJSON_AddNumberToObject(json, "flops", summary->flops);
+
+  if (summary->child)
+  {
+    cJSON *children = cJSON_CreateArray();
+    cJSON_AddItemToObject(json, "children", children);
+    for (child = summary->child; child; child = child->sibling)
+    {
+      cJSON_AddItemToArray(children, TimingSummaryToJSON(child));
+    }
+  }
+
+  return json;
+}
+
+
+static void  PrintTimingSummary(
+                                amps_File      file,
+                                TimingSummary *summary,
+                                int            depth)
+{
+  TimingSummary *child;
+  char label[2048];
+
+  snprintf(label, sizeof(label), "%s%s", summary->name,
+           summary->kind == TimingNodeSetup ? " (setup)" : "");
+
+  amps_Fprintf(file, "%*s%-*s %10.0f %12.6f %12.6f %12.6f\n",
+               2 * depth, "", 48 - 2 * depth, label,
+               summary->calls.max, summary->inclusive.max,
+               summary->inclusive.sum / summary->ranks,
+               summary->exclusive.max);
+
+  for (child = summary->child; child; child = child->sibling)
+  {
+    PrintTimingSummary(file, child, depth + 1);
+  }
+}
+
+
+/* Preorder list of the summary nodes; clears the values of every node */
+static void  TimingSummaryNodes(
+                                TimingSummary  *summary,
+                                TimingSummary **nodes,
+                                int            *num_nodes)
+{
+  TimingSummary *child;
+
+  summary->ranks = 0;
+  summary->flops = 0.0;
+  nodes[(*num_nodes)++] = summary;
+
+  for (child = summary->child; child; child = child->sibling)
+  {
+    TimingSummaryNodes(child, nodes, num_nodes);
+  }
+}
+
+
+/*--------------------------------------------------------------------------
+ * GatherTimingSummary: collective, the summary is returned on all ranks
+ *--------------------------------------------------------------------------*/
+
+static TimingSummary  *GatherTimingSummary()
+{
+  TimingSummary *summary;
+  TimingSummary **nodes;
+  TimingSummary *node;
+  amps_Invoice invoice;
+  char *records = NULL;
+  char *shape;
+  int length = 0;
+  int size = 0;
+  int shape_length;
+  int num_nodes;
+  int n;
+  double *min, *max, *sum;
+
+  TimingRecords(timing->root, 0, &records, &length, &size);
+
+  /* The tree of rank 0 gives the shape of the summary */
+  shape_length = length;
+  invoice = amps_NewInvoice("%i", &shape_length);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+
+  shape = talloc(char, shape_length + 1);
+  if (amps_Rank(amps_CommWorld) == 0)
+  {
+    memcpy(shape, records, (size_t)shape_length);
+  }
+  invoice = amps_NewInvoice("%&c", &shape_length, shape);
+  amps_BCast(amps_CommWorld, 0, invoice);
+  amps_FreeInvoice(invoice);
+  shape[shape_length] = '\0';
+
+  summary = ctalloc(TimingSummary, 1);
+  TimingMergeRecords(summary, shape, TRUE);
+  tfree(shape);
+
+  nodes = talloc(TimingSummary *, shape_length + 1);
+  num_nodes = 0;
+  TimingSummaryNodes(summary, nodes, &num_nodes);
+
+  /* Values of this rank only */
+  TimingMergeRecords(summary, records, FALSE);
+  free(records);
+
+  min = ctalloc(double, 3 * num_nodes);
+  max = ctalloc(double, 3 * num_nodes);
+  sum = ctalloc(double, 5 * num_nodes);
+
+  for (n = 0; n < num_nodes; n++)
+  {
+    node = nodes[n];
+    if (node->ranks)
+    {
+      min[3 * n] = max[3 * n] = sum[5 * n] = node->calls.sum;
+      min[3 * n + 1] = max[3 * n + 1] = sum[5 * n + 1] = node->inclusive.sum;
+      min[3 * n + 2] = max[3 * n + 2] = sum[5 * n + 2] = node->exclusive.sum;
+      sum[5 * n + 3] = node->flops;
+      sum[5 * n + 4] = 1.0;
+    }
+    else
+    {
+      min[3 * n] = min[3 * n + 1] = min[3 * n + 2] = DBL_MAX;
+    }
+  }
+
+  invoice = amps_NewInvoice("%*d", 3 * num_nodes, min);
+  amps_AllReduce(amps_CommWorld, invoice, amps_Min);
+  amps_FreeInvoice(invoice);
+
+  invoice = amps_NewInvoice("%*d", 3 * num_nodes, max);
+  amps_AllReduce(amps_CommWorld, invoice, amps_Max);
+  amps_FreeInvoice(invoice);
+
+  invoice = amps_NewInvoice("%*d", 5 * num_nodes, sum);
+  amps_AllReduce(amps_CommWorld, invoice, amps_Add);
+  amps_FreeInvoice(invoice);
+
+  for (n = 0; n < num_nodes; n++)
+  {
+    node = nodes[n];
+    node->calls.min = min[3 * n];
+    node->calls.max = max[3 * n];
+    node->calls.sum = sum[5 * n];
+    node->inclusive.min = min[3 * n + 1];
+    node->inclusive.max = max[3 * n + 1];
+    node->inclusive.sum = sum[5 * n + 1];
+    node->exclusive.min = min[3 * n + 2];
+    node->exclusive.max = max[3 * n + 2];
+    node->exclusive.sum = sum[5 * n + 2];
+    node->flops = sum[5 * n + 3];
+    node->ranks = (int)sum[5 * n + 4];
+  }
+
+  tfree(min);
+  tfree(max);
+  tfree(sum);
+  tfree(nodes);
+
+  return summary;
+}
+
+
 /*--------------------------------------------------------------------------
  * PrintTiming
  *--------------------------------------------------------------------------*/
@@ -119,18 +752,31 @@ void  PrintTiming()
 {
   amps_File file = NULL;
   amps_Invoice max_invoice;
+  TimingSummary *summary;
+  TimingNode *node;
 
-  double time_ticks[timing->size];
+  double wall_time[timing->size];
   double cpu_ticks[timing->size];
   double mflops[timing->size];
 
   int i;
 
-  max_invoice = amps_NewInvoice("%*d%*d", timing->size, &time_ticks, timing->size, &cpu_ticks);
+  /* Anything still open is charged up to now */
+  for (node = timing->current; node != timing->root && node->parent != timing->root;
+       node = node->parent)
+    ;
+  if (node != timing->root)
+  {
+    TimingClose(node);
+  }
+  timing->root->time = TimingClock() - timing->root->start;
+  timing->root->flops = TimingFLOPCount;
+
+  max_invoice = amps_NewInvoice("%*d%*d", timing->size, &wall_time, timing->size, &cpu_ticks);
 
   for (i = 0; i < (timing->size); i++)
   {
-    time_ticks[i] = (double)((timing->time)[i]);
+    wall_time[i] = (timing->time)[i];
     cpu_ticks[i] = (double)((timing->cpu_time)[i]);
   }
 
@@ -138,11 +784,13 @@ void  PrintTiming()
 
   for (i = 0; i < (timing->size); i++)
   {
-    mflops[i] = time_ticks[i] ?
-                ((timing->flops)[i] / (time_ticks[i] / AMPS_TICKS_PER_SEC)) / 1.0E6
+    mflops[i] = wall_time[i] ?
+                ((timing->flops)[i] / wall_time[i]) / 1.0E6
                 : 0.0;
   }
 
+  summary = GatherTimingSummary();
+
   IfLogging(0)
   {
     file = OpenLogFile("Timing");
@@ -151,7 +799,7 @@ void  PrintTiming()
     {
       amps_Fprintf(file, "%s:\n", (timing->name)[i]);
       amps_Fprintf(file, "  wall clock time   = %f seconds\n",
-                   time_ticks[i] / AMPS_TICKS_PER_SEC);
+                   wall_time[i]);
       amps_Fprintf(file, "  wall MFLOPS = %f (%g)\n", mflops[i],
                    (timing->flops)[i]);
 #ifdef CPUTiming
@@ -167,6 +815,12 @@ void  PrintTiming()
 #endif
     }
 
+    amps_Fprintf(file, "\nTiming tree (seconds over %d ranks):\n",
+                 amps_Size(amps_CommWorld));
+    amps_Fprintf(file, "%-48s %10s %12s %12s %12s\n", "",
+                 "max calls", "max incl", "mean incl", "max excl");
+    PrintTimingSummary(file, summary, 0);
+
     CloseLogFile(file);
 
     char filename[2048];
@@ -181,13 +835,32 @@ void  PrintTiming()
     for (i = 0; i < (timing->size); i++)
     {
       fprintf(file, "%s,%f,%f,%g\n", timing->name[i],
-              time_ticks[i] / AMPS_TICKS_PER_SEC,
+              wall_time[i],
               mflops[i], (timing->flops)[i]);
     }
 
     fclose(file);
+
+    sprintf(filename, "%s.timing.json", GlobalsOutFileName);
+
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "ranks", amps_Size(amps_CommWorld));
+    cJSON_AddItemToObject(json, "tree", TimingSummaryToJSON(summary));
+
+    char *text = cJSON_Print(json);
+    if ((file = fopen(filename, "w")) == NULL)
+    {
+      InputError("Error: can't open output file %s%s\n", filename, "");
+    }
+    fprintf(file, "%s\n", text);
+    fclose(file);
+
+    free(text);
+    cJSON_Delete(json);
   }
 
+  FreeTimingSummary(summary);
+
 #ifdef VECTOR_UPDATE_TIMING
   {
     FILE *file;
@@ -232,9 +905,13 @@ void  FreeTiming()
   tfree(timing->time);
   tfree(timing->cpu_time);
   tfree(timing->flops);
+  tfree(timing->depth);
   tfree(timing->name);
 
+  FreeTimingNode(timing->root);
+
   tfree(timing);
+  timing = NULL;
 }
 
 
@@ -51,29 +51,62 @@
 #define ClusteringTimingIndex 9
 #define NetcdfTimingIndex 10
 #define PDITimingIndex  11
-#ifdef VECTOR_UPDATE_TIMING
 #define VectorUpdateTimingIndex  12
-#endif
 
 
 
 #if defined(PF_TIMING)
 /*--------------------------------------------------------------------------
- * Global timing structure
+ * Timing tree
+ *
+ * Every registered timer and every PFModule invocation opens a node
+ * below the node that is currently open, so the tree records the call
+ * path each piece of time was spent on.  Nodes are keyed by kind and
+ * name within their parent and accumulate a call count, the inclusive
+ * wall clock time and the FLOPs counted while they were open.
  *--------------------------------------------------------------------------*/
 
 typedef double FLOPType;
 
+#define TimingNodeRoot   0      /* whole run */
+#define TimingNodeTimer  1      /* BeginTiming/EndTiming */
+#define TimingNodeCall   2      /* PFModuleInvoke */
+#define TimingNodeSetup  3      /* PFModuleNewInstance/ReNewInstance */
+
+typedef struct _TimingNode {
+  char               *name;
+  int kind;
+  int index;                    /* registered timer, -1 for module nodes */
+
+  int count;
+  double time;                  /* inclusive seconds */
+  FLOPType flops;
+
+  double start;
+  FLOPType start_flops;
+
+  struct _TimingNode *parent;
+  struct _TimingNode *child;
+  struct _TimingNode *sibling;
+} TimingNode;
+
+/*--------------------------------------------------------------------------
+ * Global timing structure
+ *--------------------------------------------------------------------------*/
+
 typedef struct {
-  amps_Clock_t     *time;
+  /* Registered timers, summed over their outermost scopes */
+  double           *time;
   amps_CPUClock_t  *cpu_time;
   FLOPType         *flops;
+  int              *depth;
   char            **name;
 
   int size;
 
-  amps_Clock_t time_count;
-  amps_CPUClock_t CPU_count;
+  TimingNode       *root;
+  TimingNode       *current;
+
   FLOPType FLOP_count;
 } TimingType;
 
@@ -96,49 +129,42 @@ amps_ThreadLocalDcl(extern TimingType *, timing_ptr);
 
 #define TimingSize       (timing->size)
 
-#define TimingTimeCount  (timing->time_count)
-#define TimingCPUCount   (timing->CPU_count)
 #define TimingFLOPCount  (timing->FLOP_count)
 
+/*--------------------------------------------------------------------------
+ * Timing tree functions
+ *--------------------------------------------------------------------------*/
+
+void TimingBegin(int index);
+void TimingEnd(int index);
+TimingNode *TimingScopeEnter(const char *name, int kind);
+void TimingScopeExit(TimingNode **node);
+
 /*--------------------------------------------------------------------------
  * Timing macros
+ *
+ * With TIMING_WITH_SYNC the ranks are synchronized before a registered
+ * timer is opened; the per module nodes are never synchronized.
+ * BeginTimingNoSync opens a registered timer without synchronizing, for
+ * timers around the halo exchanges, which run far too often for a
+ * barrier each.
  *--------------------------------------------------------------------------*/
 
 #define IncFLOPCount(inc) TimingFLOPCount += (FLOPType)inc
-#define StartTiming()     TimingTimeCount -= amps_Clock(); \
-        TimingCPUCount -= amps_CPUClock()
-#define StopTiming()      TimingTimeCount += amps_Clock(); \
-        TimingCPUCount += amps_CPUClock()
 
 #ifdef TIMING_WITH_SYNC
-#define BeginTiming(i)                        \
-        {                                     \
-          StopTiming();                       \
-          TimingTime(i) -= TimingTimeCount;   \
-          TimingCPUTime(i) -= TimingCPUCount; \
-          TimingFLOPS(i) -= TimingFLOPCount;  \
-          amps_Sync(amps_CommWorld);          \
-          StartTiming();                      \
+#define BeginTiming(i)               \
+        {                            \
+          amps_Sync(amps_CommWorld); \
+          TimingBegin(i);            \
         }
 #else
-#define BeginTiming(i)                        \
-        {                                     \
-          StopTiming();                       \
-          TimingTime(i) -= TimingTimeCount;   \
-          TimingCPUTime(i) -= TimingCPUCount; \
-          TimingFLOPS(i) -= TimingFLOPCount;  \
-          StartTiming();                      \
-        }
+#define BeginTiming(i) TimingBegin(i)
 #endif
 
-#define EndTiming(i)                          \
-        {                                     \
-          StopTiming();                       \
-          TimingTime(i) += TimingTimeCount;   \
-          TimingCPUTime(i) += TimingCPUCount; \
-          TimingFLOPS(i) += TimingFLOPCount;  \
-          StartTiming();                      \
-        }
+#define BeginTimingNoSync(i) TimingBegin(i)
+
+#define EndTiming(i) TimingEnd(i)
 
 #ifdef VECTOR_UPDATE_TIMING
 
@@ -169,9 +195,8 @@ extern EventTiming[][6];
  *--------------------------------------------------------------------------*/
 
 #define IncFLOPCount(inc)
-#define StartTiming()
-#define StopTiming()
 #define BeginTiming(i) if (i == 0)
+#define BeginTimingNoSync(i)
 #define EndTiming(i)
 #define NewTiming()
 #define RegisterTiming(name) 0
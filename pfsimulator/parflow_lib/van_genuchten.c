@@ -0,0 +1,277 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+
+#include "parflow.h"
+#include "van_genuchten.h"
+
+/*--------------------------------------------------------------------------
+ * NewVanGTables:
+ *    Allocates one table per region, with the sample points of all the
+ *    regions in a single array.  Regions with no sample points get no
+ *    table.  Returns NULL if no region has a table.
+ *--------------------------------------------------------------------------*/
+
+VanGTables *NewVanGTables(
+                          int  num_tables,
+                          int *num_sample_points)
+{
+  VanGTables *van_g_tables;
+  int num_points = 0;
+  int i;
+
+  for (i = 0; i < num_tables; i++)
+  {
+    if (num_sample_points[i] > 0)
+    {
+      num_points += num_sample_points[i] + 1;
+    }
+  }
+
+  if (num_points == 0)
+  {
+    return NULL;
+  }
+
+  van_g_tables = ctalloc(VanGTables, 1);
+  van_g_tables->num_tables = num_tables;
+  van_g_tables->tables = ctalloc(VanGTable, num_tables);
+  van_g_tables->points = ctalloc(VanGTablePoint, num_points);
+
+  num_points = 0;
+  for (i = 0; i < num_tables; i++)
+  {
+    if (num_sample_points[i] > 0)
+    {
+      van_g_tables->tables[i].num_sample_points = num_sample_points[i];
+      van_g_tables->tables[i].points = van_g_tables->points + num_points;
+      num_points += num_sample_points[i] + 1;
+    }
+  }
+
+  return van_g_tables;
+}
+
+void FreeVanGTables(
+                    VanGTables *van_g_tables)
+{
+  if (van_g_tables)
+  {
+    tfree(van_g_tables->points);
+    tfree(van_g_tables->tables);
+    tfree(van_g_tables);
+  }
+}
+
+/*--------------------------------------------------------------------------
+ * VanGSetTableRange:
+ *    Sets the evenly spaced sample heads of a table, from 0 to
+ *    |min_pressure_head|.
+ *--------------------------------------------------------------------------*/
+
+static void VanGSetTableRange(
+                              VanGTable *table,
+                              int        interpolation_method,
+                              double     min_pressure_head,
+                              double     limit)
+{
+  table->interpolation_method = interpolation_method;
+  table->min_pressure_head = min_pressure_head;
+  table->max_head = fabs(min_pressure_head);
+  table->interval = fabs(min_pressure_head / (double)(table->num_sample_points - 1));
+  table->limit = limit;
+}
+
+/*--------------------------------------------------------------------------
+ * VanGFitTable:
+ *    Computes the interpolation slopes of a table from the sampled values
+ *    and derivatives.
+ *--------------------------------------------------------------------------*/
+
+static void VanGFitTable(
+                         VanGTable *table)
+{
+  VanGTablePoint *points = table->points;
+  int num_sample_points = table->num_sample_points;
+  double interval = table->interval;
+  double *del = ctalloc(double, num_sample_points);
+  double *del_der = ctalloc(double, num_sample_points);
+  double alph, beta, magn;
+  int index;
+
+  if (table->interpolation_method == VANG_TABLE_LINEAR)
+  {
+    for (index = 0; index < num_sample_points; index++)
+    {
+      points[index].d = (points[index + 1].a - points[index].a) / interval;
+      points[index].d_der = (points[index + 1].a_der - points[index].a_der) / interval;
+    }
+    points[num_sample_points].d = 0.0;
+    points[num_sample_points].d_der = 0.0;
+
+    tfree(del);
+    tfree(del_der);
+    return;
+  }
+
+  // begin monotonic spline (see Fritsch and Carlson, SIAM J. Num. Anal., 17 (2), 1980)
+  for (index = 0; index < num_sample_points; index++)
+  {
+    double h = (index + 1) * interval - index * interval;
+
+    del[index] = (points[index + 1].a - points[index].a) / h;
+    del_der[index] = (points[index + 1].a_der - points[index].a_der) / h;
+  }
+  points[0].d = del[0];
+  points[num_sample_points].d = del[num_sample_points - 1];
+  points[0].d_der = del_der[0];
+  points[num_sample_points].d_der = del_der[num_sample_points - 1];
+
+  for (index = 1; index < num_sample_points; index++)
+  {
+    points[index].d = (del[index - 1] + del[index]) / 2;
+    points[index].d_der = (del_der[index - 1] + del_der[index]) / 2;
+  }
+
+  for (index = 0; index < num_sample_points; index++)
+  {
+    if (del[index] == 0.0)
+    {
+      points[index].d = 0;
+      points[index + 1].d = 0;
+    }
+    else
+    {
+      alph = points[index].d / del[index];
+      beta = points[index + 1].d / del[index];
+      magn = pow(alph, 2) + pow(beta, 2);
+      if (magn > 9.0)
+      {
+        points[index].d = 3 * alph * del[index] / magn;
+        points[index + 1].d = 3 * beta * del[index] / magn;
+      }
+    }
+
+    if (del_der[index] == 0.0)
+    {
+      points[index].d_der = 0;
+      points[index + 1].d_der = 0;
+    }
+    else
+    {
+      // to ensure monotonicity
+      alph = points[index].d_der / del_der[index];
+      beta = points[index + 1].d_der / del_der[index];
+      magn = pow(alph, 2) + pow(beta, 2);
+      if (magn > 9.0)
+      {
+        points[index].d_der = 3 * alph * del_der[index] / magn;
+        points[index + 1].d_der = 3 * beta * del_der[index] / magn;
+      }
+    }
+  }
+
+  tfree(del);
+  tfree(del_der);
+}
+
+/*--------------------------------------------------------------------------
+ * VanGComputeRelPermTable:
+ *    Fills a table allocated by NewVanGTables with the Van Genuchten
+ *    relative permeability.
+ *--------------------------------------------------------------------------*/
+
+void VanGComputeRelPermTable(
+                             VanGTable *table,
+                             int        interpolation_method,
+                             double     min_pressure_head,
+                             double     alpha,
+                             double     n)
+{
+  VanGTablePoint *points = table->points;
+  double m = 1.0e0 - (1.0e0 / n);
+  int index;
+
+  VanGSetTableRange(table, interpolation_method, min_pressure_head, 0.0);
+
+  // evenly spaced interpolation points (future: variably spaced points)
+  for (index = 0; index <= table->num_sample_points; index++)
+  {
+    double x = index * table->interval;
+    double opahn = 1.0 + pow(alpha * x, n);
+    double ahnm1 = pow(alpha * x, n - 1);
+    // calculating function at interpolation points
+    points[index].a = pow(1.0 - ahnm1 / (pow(opahn, m)), 2)
+                      / pow(opahn, (m / 2));
+
+    double coeff = 1.0 - ahnm1 * pow(opahn, -m);
+    // calculating derivative at interpolation points
+    points[index].a_der = 2.0 * (coeff / (pow(opahn, (m / 2))))
+                          * ((n - 1) * pow(alpha * x, n - 2) * alpha
+                             * pow(opahn, -m)
+                             - ahnm1 * m * pow(opahn, -(m + 1)) * n * alpha * ahnm1)
+                          + pow(coeff, 2) * (m / 2) * pow(opahn, (-(m + 2) / 2))
+                          * n * alpha * ahnm1;
+    //CPS fix of 1<n<2, K is infinite at pressure head = 0
+    if ((n < 2) && (index == 0))
+    {
+      points[index].a_der = 0;
+    }
+  }
+
+  VanGFitTable(table);
+}
+
+/*--------------------------------------------------------------------------
+ * VanGComputeSaturationTable:
+ *    Fills a table allocated by NewVanGTables with the Van Genuchten
+ *    saturation.
+ *--------------------------------------------------------------------------*/
+
+void VanGComputeSaturationTable(
+                                VanGTable *table,
+                                int        interpolation_method,
+                                double     min_pressure_head,
+                                double     alpha,
+                                double     n,
+                                double     s_res,
+                                double     s_dif)
+{
+  VanGTablePoint *points = table->points;
+  double m = 1.0e0 - (1.0e0 / n);
+  int index;
+
+  VanGSetTableRange(table, interpolation_method, min_pressure_head, s_res);
+
+  for (index = 0; index <= table->num_sample_points; index++)
+  {
+    VanGSaturation(index * table->interval, alpha, n, m, s_res, s_dif,
+                   &(points[index].a), &(points[index].a_der));
+  }
+
+  VanGFitTable(table);
+}
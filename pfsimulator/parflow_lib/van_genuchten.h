@@ -0,0 +1,238 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+
+#ifndef _PARFLOW_VAN_GENUCHTEN_HEADER
+#define _PARFLOW_VAN_GENUCHTEN_HEADER
+
+#include "general.h"
+
+#include <math.h>
+
+/*--------------------------------------------------------------------------
+ * Van Genuchten curves for a pressure head h > 0 (suction), with
+ * m = 1 - 1/n.  The value and the derivative of each curve are computed
+ * together from
+ *
+ *   ahnm1 = (alpha h)^(n-1),  t = (alpha h)^n,  opahn_m = (1 + t)^-m
+ *
+ * which costs two log/exp pairs instead of the three to eight calls to
+ * pow of the textbook forms.  The derivatives match the sign convention
+ * of the existing code (derivative with respect to pressure).
+ *--------------------------------------------------------------------------*/
+
+/**
+ * @brief Van Genuchten saturation and its derivative
+ *
+ * @param head Pressure head, must be positive
+ * @param alpha Van Genuchten alpha
+ * @param n Van Genuchten n
+ * @param m 1 - 1/n
+ * @param s_res Residual saturation
+ * @param s_dif Saturated minus residual saturation
+ * @param sat Returns the saturation
+ * @param sat_der Returns the derivative of the saturation
+ */
+__host__ __device__ static inline void
+VanGSaturation(double head, double alpha, double n, double m,
+               double s_res, double s_dif, double *sat, double *sat_der)
+{
+  double ahead = alpha * head;
+  double ahnm1 = exp((n - 1.0) * log(ahead));
+  double t = ahnm1 * ahead;
+  double opahn_m = exp(-m * log1p(t));
+
+  *sat = s_dif * opahn_m + s_res;
+  *sat_der = m * n * alpha * ahnm1 * s_dif * opahn_m / (1.0 + t);
+}
+
+/**
+ * @brief Van Genuchten (Mualem) relative permeability and its derivative
+ *
+ * The factor 1 - (alpha h)^(n-1) (1 + (alpha h)^n)^-m cancels
+ * catastrophically for dry cells, so it is computed as
+ * 1 - (t / (1 + t))^m = -expm1(-m log1p(1/t)), which keeps the relative
+ * error near machine precision for any head.
+ *
+ * @param head Pressure head, must be positive
+ * @param alpha Van Genuchten alpha
+ * @param n Van Genuchten n
+ * @param m 1 - 1/n
+ * @param rel_perm Returns the relative permeability
+ * @param rel_perm_der Returns the derivative of the relative permeability
+ */
+__host__ __device__ static inline void
+VanGRelPerm(double head, double alpha, double n, double m,
+            double *rel_perm, double *rel_perm_der)
+{
+  double ahead = alpha * head;
+  double ahnm1 = exp((n - 1.0) * log(ahead));
+  double t = ahnm1 * ahead;
+  double opahn = 1.0 + t;
+  double opahn_m = exp(-m * log1p(t));
+  double sqrt_opahn_m = sqrt(opahn_m);
+  double coeff = -expm1(-m * log1p(1.0 / t));
+
+  *rel_perm = coeff * coeff * sqrt_opahn_m;
+  *rel_perm_der = coeff * sqrt_opahn_m * alpha * (n - 1.0) * ahnm1 / opahn
+                  * (2.0 * opahn_m / ahead + 0.5 * coeff);
+}
+
+/*--------------------------------------------------------------------------
+ * Van Genuchten lookup tables.
+ *
+ * A table samples a curve and its derivative at num_sample_points + 1
+ * evenly spaced heads from 0 to |min_pressure_head|.  The samples of all
+ * regions of a curve are stored contiguously in one VanGTables so the
+ * saturation and relative permeability tables share a single layout and
+ * a single set of lookup routines.
+ *--------------------------------------------------------------------------*/
+
+#define VANG_TABLE_SPLINE 0
+#define VANG_TABLE_LINEAR 1
+
+typedef struct {
+  double a;       /* curve value */
+  double d;       /* spline slope of a, or linear slope to the next point */
+  double a_der;   /* curve derivative */
+  double d_der;   /* spline slope of a_der, or linear slope to the next point */
+} VanGTablePoint;
+
+typedef struct {
+  int interpolation_method;
+  int num_sample_points;
+  double min_pressure_head;
+  double max_head;          /* |min_pressure_head| */
+  double interval;
+  double limit;             /* curve value for heads beyond the table */
+  VanGTablePoint *points;   /* NULL if the region has no table */
+} VanGTable;
+
+typedef struct {
+  int num_tables;
+  VanGTable *tables;
+  VanGTablePoint *points;   /* points of all tables */
+} VanGTables;
+
+/* Table of region i, or NULL if the curve is evaluated directly */
+#define VanGTablesTable(van_g_tables, i)                      \
+  (((van_g_tables) && (van_g_tables)->tables[i].points)       \
+   ? &((van_g_tables)->tables[i]) : NULL)
+
+/**
+ * @brief Look up a curve value or derivative with monotone cubic
+ * Hermite interpolation
+ *
+ * @param table Table of the region
+ * @param head Pressure head, must be non-negative
+ * @param fcn CALCFCN for the value, CALCDER for the derivative
+ * @return Interpolated value
+ */
+__host__ __device__ static inline double
+VanGTableLookupSpline(const VanGTable *table, double head, int fcn)
+{
+  // Make sure values are in the table range, if lower then use the limit of the VG curve
+  if (head >= table->max_head)
+  {
+    return (fcn == CALCFCN) ? table->limit : 0.0;
+  }
+
+  // Direct index lookup, the points are uniformly spaced
+  double interval = table->interval;
+  int pt = (int)floor(head / interval);
+  if (pt >= table->num_sample_points)
+  {
+    pt = table->num_sample_points - 1;
+  }
+
+  const VanGTablePoint *p0 = &(table->points[pt]);
+  const VanGTablePoint *p1 = p0 + 1;
+  double x = pt * interval;
+  double h = (pt + 1) * interval - x;
+  double t = (head - x) / h;
+
+  if (fcn == CALCFCN)
+  {
+    return (2.0 * pow(t, 3) - 3.0 * pow(t, 2) + 1.0) * p0->a
+           + (pow(t, 3) - 2.0 * pow(t, 2) + t) * h * p0->d
+           + (-2.0 * pow(t, 3) + 3.0 * pow(t, 2)) * p1->a
+           + (pow(t, 3) - pow(t, 2)) * h * p1->d;
+  }
+  else
+  {
+    return (2.0 * pow(t, 3) - 3.0 * pow(t, 2) + 1.0) * p0->a_der
+           + (pow(t, 3) - 2.0 * pow(t, 2) + t) * h * p0->d_der
+           + (-2.0 * pow(t, 3) + 3.0 * pow(t, 2)) * p1->a_der
+           + (pow(t, 3) - pow(t, 2)) * h * p1->d_der;
+  }
+}
+
+/**
+ * @brief Look up a curve value or derivative with linear interpolation
+ *
+ * @param table Table of the region
+ * @param head Pressure head, must be non-negative
+ * @param fcn CALCFCN for the value, CALCDER for the derivative
+ * @return Interpolated value
+ */
+__host__ __device__ static inline double
+VanGTableLookupLinear(const VanGTable *table, double head, int fcn)
+{
+  if (head >= table->max_head)
+  {
+    return (fcn == CALCFCN) ? table->limit : 0.0;
+  }
+
+  int pt = (int)floor(head / table->interval);
+  const VanGTablePoint *p0 = &(table->points[pt]);
+  double dx = head - pt * table->interval;
+
+  if (fcn == CALCFCN)
+  {
+    return p0->a + p0->d * dx;
+  }
+  else
+  {
+    return p0->a_der + p0->d_der * dx;
+  }
+}
+
+
+VanGTables *NewVanGTables(int num_tables, int *num_sample_points);
+
+void FreeVanGTables(VanGTables *van_g_tables);
+
+void VanGComputeRelPermTable(VanGTable *table, int interpolation_method,
+                             double min_pressure_head,
+                             double alpha, double n);
+
+void VanGComputeSaturationTable(VanGTable *table, int interpolation_method,
+                                double min_pressure_head,
+                                double alpha, double n,
+                                double s_res, double s_dif);
+
+#endif
@@ -85,6 +85,8 @@ VectorUpdateCommHandle  *InitVectorUpdate(
 {
   enum ParflowGridType grid_type = invalid_grid_type;
 
+  BeginTimingNoSync(VectorUpdateTimingIndex);
+
 #ifdef HAVE_SAMRAI
   switch (vector->type)
   {
@@ -174,6 +176,7 @@ VectorUpdateCommHandle  *InitVectorUpdate(
   vector_update_comm_handle->vector = vector;
   vector_update_comm_handle->comm_handle = amps_com_handle;
 
+  EndTiming(VectorUpdateTimingIndex);
 
   return vector_update_comm_handle;
 }
@@ -186,6 +189,8 @@ VectorUpdateCommHandle  *InitVectorUpdate(
 void         FinalizeVectorUpdate(
                                   VectorUpdateCommHandle *handle)
 {
+  BeginTimingNoSync(VectorUpdateTimingIndex);
+
   switch (handle->vector->type)
   {
     case vector_cell_centered:
@@ -216,6 +221,8 @@ void         FinalizeVectorUpdate(
   ;
 
   tfree(handle);
+
+  EndTiming(VectorUpdateTimingIndex);
 }
 
 
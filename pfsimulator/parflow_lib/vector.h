@@ -114,6 +114,14 @@ typedef struct _VectorUpdateCommHandle {
   CommHandle *comm_handle;
 } VectorUpdateCommHandle;
 
+typedef struct _VectorReduceHandle {
+  amps_Invoice invoice;
+  amps_ReduceHandle reduce_handle;
+} VectorReduceHandle;
+
+/* Subgrid layout of a PFB file, see read_parflow_binary.c */
+typedef struct _PFBLayout PFBLayout;
+
 /*--------------------------------------------------------------------------
  * Accessor functions for the Subvector structure
  *--------------------------------------------------------------------------*/
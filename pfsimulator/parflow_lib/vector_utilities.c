@@ -745,6 +745,227 @@ double PFVDotProd(
   return(sum);
 }
 
+void PFVDotProdMulti(
+/* dot[m] = x dot y[m], m = 0, ..., nvec - 1, with a single global reduction.
+ * The y vectors must share the layout of y[0]. */
+                     int      nvec,
+                     Vector * x,
+                     Vector **y,
+                     double * dot)
+{
+  Grid       *grid = VectorGrid(x);
+  Subgrid    *subgrid;
+
+  Subvector  *x_sub;
+  Subvector  *y_sub;
+
+  const double * __restrict__ xp;
+  const double *yp[nvec];
+
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int nx_x, ny_x, nz_x;
+  int nx_y, ny_y, nz_y;
+
+  int sg, i, j, k, i_x, i_y, m;
+
+  amps_Invoice result_invoice;
+
+  for (m = 0; m < nvec; m++)
+  {
+    dot[m] = ZERO;
+  }
+
+  ForSubgridI(sg, GridSubgrids(grid))
+  {
+    subgrid = GridSubgrid(grid, sg);
+
+    x_sub = VectorSubvector(x, sg);
+    y_sub = VectorSubvector(y[0], sg);
+
+    ix = SubgridIX(subgrid);
+    iy = SubgridIY(subgrid);
+    iz = SubgridIZ(subgrid);
+
+    nx = SubgridNX(subgrid);
+    ny = SubgridNY(subgrid);
+    nz = SubgridNZ(subgrid);
+
+    nx_x = SubvectorNX(x_sub);
+    ny_x = SubvectorNY(x_sub);
+    nz_x = SubvectorNZ(x_sub);
+
+    nx_y = SubvectorNX(y_sub);
+    ny_y = SubvectorNY(y_sub);
+    nz_y = SubvectorNZ(y_sub);
+
+    xp = SubvectorElt(x_sub, ix, iy, iz);
+    for (m = 0; m < nvec; m++)
+    {
+      yp[m] = SubvectorElt(VectorSubvector(y[m], sg), ix, iy, iz);
+    }
+
+#if defined(PARFLOW_HAVE_CUDA) || defined(PARFLOW_HAVE_KOKKOS) || defined(PARFLOW_HAVE_OMP)
+    /* The accelerated loops only reduce into scalars; sweep once per
+     * vector but still reduce globally once. */
+    for (m = 0; m < nvec; m++)
+    {
+      const double * __restrict__ ymp = yp[m];
+      double sum = ZERO;
+
+      i_x = 0;
+      i_y = 0;
+
+      BoxLoopReduceI2(sum,
+                      i, j, k, ix, iy, iz, nx, ny, nz,
+                      i_x, nx_x, ny_x, nz_x, 1, 1, 1,
+                      i_y, nx_y, ny_y, nz_y, 1, 1, 1,
+      {
+        ReduceSum(sum, xp[i_x] * ymp[i_y]);
+      });
+
+      dot[m] += sum;
+    }
+#else
+    i_x = 0;
+    i_y = 0;
+
+    BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
+              i_x, nx_x, ny_x, nz_x, 1, 1, 1,
+              i_y, nx_y, ny_y, nz_y, 1, 1, 1,
+    {
+      const double xv = xp[i_x];
+      for (m = 0; m < nvec; m++)
+      {
+        dot[m] += xv * yp[m][i_y];
+      }
+    });
+#endif
+  }
+
+  result_invoice = amps_NewInvoice("%*d", nvec, dot);
+  amps_AllReduce(amps_CommWorld, result_invoice, amps_Add);
+  amps_FreeInvoice(result_invoice);
+
+  IncFLOPCount(2 * nvec * VectorSize(x));
+}
+
+VectorReduceHandle *PFVDotProdPairsBegin(
+/* dot[m] = x[m] dot y[m], m = 0, ..., nvec - 1.  Only the local sums are
+ * formed here; the global reduction is left in flight and dot is not
+ * valid until PFVDotProdPairsEnd.  All vectors must share a layout. */
+                                          int      nvec,
+                                          Vector **x,
+                                          Vector **y,
+                                          double * dot)
+{
+  Grid       *grid = VectorGrid(x[0]);
+  Subgrid    *subgrid;
+
+  Subvector  *x_sub;
+  Subvector  *y_sub;
+
+  const double *xp[nvec];
+  const double *yp[nvec];
+
+  int ix, iy, iz;
+  int nx, ny, nz;
+  int nx_x, ny_x, nz_x;
+  int nx_y, ny_y, nz_y;
+
+  int sg, i, j, k, i_x, i_y, m;
+
+  VectorReduceHandle *handle;
+
+  for (m = 0; m < nvec; m++)
+  {
+    dot[m] = ZERO;
+  }
+
+  ForSubgridI(sg, GridSubgrids(grid))
+  {
+    subgrid = GridSubgrid(grid, sg);
+
+    x_sub = VectorSubvector(x[0], sg);
+    y_sub = VectorSubvector(y[0], sg);
+
+    ix = SubgridIX(subgrid);
+    iy = SubgridIY(subgrid);
+    iz = SubgridIZ(subgrid);
+
+    nx = SubgridNX(subgrid);
+    ny = SubgridNY(subgrid);
+    nz = SubgridNZ(subgrid);
+
+    nx_x = SubvectorNX(x_sub);
+    ny_x = SubvectorNY(x_sub);
+    nz_x = SubvectorNZ(x_sub);
+
+    nx_y = SubvectorNX(y_sub);
+    ny_y = SubvectorNY(y_sub);
+    nz_y = SubvectorNZ(y_sub);
+
+    for (m = 0; m < nvec; m++)
+    {
+      xp[m] = SubvectorElt(VectorSubvector(x[m], sg), ix, iy, iz);
+      yp[m] = SubvectorElt(VectorSubvector(y[m], sg), ix, iy, iz);
+    }
+
+#if defined(PARFLOW_HAVE_CUDA) || defined(PARFLOW_HAVE_KOKKOS) || defined(PARFLOW_HAVE_OMP)
+    for (m = 0; m < nvec; m++)
+    {
+      const double * __restrict__ xmp = xp[m];
+      const double * __restrict__ ymp = yp[m];
+      double sum = ZERO;
+
+      i_x = 0;
+      i_y = 0;
+
+      BoxLoopReduceI2(sum,
+                      i, j, k, ix, iy, iz, nx, ny, nz,
+                      i_x, nx_x, ny_x, nz_x, 1, 1, 1,
+                      i_y, nx_y, ny_y, nz_y, 1, 1, 1,
+      {
+        ReduceSum(sum, xmp[i_x] * ymp[i_y]);
+      });
+
+      dot[m] += sum;
+    }
+#else
+    i_x = 0;
+    i_y = 0;
+
+    BoxLoopI2(i, j, k, ix, iy, iz, nx, ny, nz,
+              i_x, nx_x, ny_x, nz_x, 1, 1, 1,
+              i_y, nx_y, ny_y, nz_y, 1, 1, 1,
+    {
+      for (m = 0; m < nvec; m++)
+      {
+        dot[m] += xp[m][i_x] * yp[m][i_y];
+      }
+    });
+#endif
+  }
+
+  handle = talloc(VectorReduceHandle, 1);
+  handle->invoice = amps_NewInvoice("%*d", nvec, dot);
+  handle->reduce_handle = amps_IAllReduce(amps_CommWorld, handle->invoice,
+                                          amps_Add);
+
+  IncFLOPCount(2 * nvec * VectorSize(x[0]));
+
+  return handle;
+}
+
+void PFVDotProdPairsEnd(
+/* Complete the reduction started by PFVDotProdPairsBegin */
+                        VectorReduceHandle *handle)
+{
+  amps_WaitAllReduce(handle->reduce_handle);
+  amps_FreeInvoice(handle->invoice);
+  tfree(handle);
+}
+
 double PFVMaxNorm(
 /* MaxNorm = || x ||_{max}   */
                   Vector *x)
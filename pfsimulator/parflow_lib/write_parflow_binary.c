@@ -140,6 +140,22 @@ void     WritePFBinary(
 
   BeginTiming(PFBTimingIndex);
 
+  if (GlobalsPFBIOMethod == PFB_IO_MPIIO)
+  {
+    sprintf(filename, "%s.%s.%s", file_prefix, file_suffix, file_extn);
+    WritePFBinaryMPIIO(filename, v);
+    EndTiming(PFBTimingIndex);
+    return;
+  }
+
+  if (GlobalsPFBIOMethod == PFB_IO_ASYNC)
+  {
+    sprintf(filename, "%s.%s.%s", file_prefix, file_suffix, file_extn);
+    WritePFBinaryAsync(filename, v);
+    EndTiming(PFBTimingIndex);
+    return;
+  }
+
   p = amps_Rank(amps_CommWorld);
 
   if (p == 0)
@@ -0,0 +1,322 @@
+/*BHEADER**********************************************************************
+*
+*  Copyright (c) 1995-2024, Lawrence Livermore National Security,
+*  LLC. Produced at the Lawrence Livermore National Laboratory. Written
+*  by the Parflow Team (see the CONTRIBUTORS file)
+*  <parflow@lists.llnl.gov> CODE-OCEC-08-103. All rights reserved.
+*
+*  This file is part of Parflow. For details, see
+*  http://www.llnl.gov/casc/parflow
+*
+*  Please read the COPYRIGHT file or Our Notice and the LICENSE file
+*  for the GNU Lesser General Public License.
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License (as published
+*  by the Free Software Foundation) version 2.1 dated February 1999.
+*
+*  This program is distributed in the hope that it will be useful, but
+*  WITHOUT ANY WARRANTY; without even the IMPLIED WARRANTY OF
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the terms
+*  and conditions of the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this program; if not, write to the Free Software
+*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307
+*  USA
+**********************************************************************EHEADER*/
+/*****************************************************************************
+*
+* Asynchronous PFB output.
+*
+* WritePFBinaryAsync snapshots a Vector into one of a pool of staging
+* buffers, already packed in the PFB file layout, and returns.  A dedicated
+* I/O thread drains the buffers to disk while the solver continues.  File
+* offsets are computed collectively on the calling thread so the I/O thread
+* only uses POSIX calls and never calls MPI.
+*
+* The number of staging buffers bounds the queue depth; when all buffers
+* are in flight the caller blocks until one is drained (back-pressure).
+* PFBAsyncFlush waits until all queued writes are on disk.
+*
+*****************************************************************************/
+
+#include "parflow.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef PARFLOW_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+typedef struct {
+  char filename[2048];
+
+  char      *buffer;          /* packed PFB data for this rank */
+  long long capacity;         /* allocated size of buffer */
+  long long size;             /* number of bytes to write */
+  long long offset;           /* offset of the data in the file */
+  long long total;            /* total file size, used to truncate */
+} PFBAsyncRequest;
+
+typedef struct {
+  PFBAsyncRequest *requests;  /* pool of staging buffers */
+  int depth;                  /* number of staging buffers */
+  int head;                   /* next request to be written */
+  int count;                  /* number of queued requests */
+
+#ifdef PARFLOW_HAVE_PTHREADS
+  int shutdown;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+#endif
+} PFBAsyncQueue;
+
+amps_ThreadLocalDcl(static PFBAsyncQueue *, pfb_async_queue);
+
+/*--------------------------------------------------------------------------
+ * PFBAsyncWriteRequest: write a staged buffer to its place in the file.
+ *--------------------------------------------------------------------------*/
+
+static void PFBAsyncWriteRequest(PFBAsyncRequest *request)
+{
+  char      *buffer = request->buffer;
+  long long remaining = request->size;
+  off_t offset = (off_t)request->offset;
+  int fd;
+
+  if ((fd = open(request->filename, O_WRONLY | O_CREAT, 0666)) < 0)
+  {
+    amps_Printf("Error: can't open output file %s\n", request->filename);
+    exit(1);
+  }
+
+  /* Rank 0 removes the tail of any previous (longer) file; truncating to
+   * the final size never discards data written by other ranks. */
+  if (request->total >= 0)
+  {
+    if (ftruncate(fd, (off_t)request->total) != 0)
+    {
+      amps_Printf("Error: can't truncate output file %s\n", request->filename);
+      exit(1);
+    }
+  }
+
+  while (remaining > 0)
+  {
+    ssize_t written = pwrite(fd, buffer, (size_t)remaining, offset);
+
+    if (written <= 0)
+    {
+      amps_Printf("Error: can't write output file %s\n", request->filename);
+      exit(1);
+    }
+
+    buffer += written;
+    offset += written;
+    remaining -= written;
+  }
+
+  close(fd);
+}
+
+#ifdef PARFLOW_HAVE_PTHREADS
+/*--------------------------------------------------------------------------
+ * PFBAsyncThread: I/O thread draining the queue.
+ *--------------------------------------------------------------------------*/
+
+static void *PFBAsyncThread(void *arg)
+{
+  PFBAsyncQueue *queue = (PFBAsyncQueue*)arg;
+
+  pthread_mutex_lock(&queue->mutex);
+  while (1)
+  {
+    while (queue->count == 0 && !queue->shutdown)
+    {
+      pthread_cond_wait(&queue->not_empty, &queue->mutex);
+    }
+
+    if (queue->count == 0)
+    {
+      break;
+    }
+
+    /* Request stays owned by the queue until it is written */
+    PFBAsyncRequest *request = &(queue->requests[queue->head]);
+    pthread_mutex_unlock(&queue->mutex);
+
+    PFBAsyncWriteRequest(request);
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->head = (queue->head + 1) % queue->depth;
+    queue->count--;
+    pthread_cond_broadcast(&queue->not_full);
+  }
+  pthread_mutex_unlock(&queue->mutex);
+
+  return NULL;
+}
+#endif
+
+/*--------------------------------------------------------------------------
+ * PFBAsyncGetQueue: create the queue and I/O thread on first use.
+ *--------------------------------------------------------------------------*/
+
+static PFBAsyncQueue *PFBAsyncGetQueue()
+{
+  PFBAsyncQueue *queue = amps_ThreadLocal(pfb_async_queue);
+
+  if (queue == NULL)
+  {
+    queue = ctalloc(PFBAsyncQueue, 1);
+
+    queue->depth = GlobalsPFBAsyncQueueDepth;
+    queue->requests = ctalloc(PFBAsyncRequest, queue->depth);
+
+#ifdef PARFLOW_HAVE_PTHREADS
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+
+    if (pthread_create(&queue->thread, NULL, PFBAsyncThread, queue) != 0)
+    {
+      amps_Printf("Error: can't create PFB output thread\n");
+      exit(1);
+    }
+#endif
+
+    amps_ThreadLocal(pfb_async_queue) = queue;
+  }
+
+  return queue;
+}
+
+/*--------------------------------------------------------------------------
+ * WritePFBinaryAsync
+ *
+ * Queue Vector v to be written to filename.  Collective.  The Vector may be
+ * modified as soon as this returns.
+ *--------------------------------------------------------------------------*/
+
+void WritePFBinaryAsync(
+                        char *  filename,
+                        Vector *v)
+{
+  PFBAsyncQueue   *queue = PFBAsyncGetQueue();
+  PFBAsyncRequest *request;
+
+  int num_subgrids;
+
+  long long size;
+  long long offset;
+  long long total;
+
+  size = PFBinaryLayout(v, &offset, &total, &num_subgrids);
+
+  if (GlobalsPFBWriteDist)
+  {
+    WritePFBinaryDist(filename, offset);
+  }
+
+  /* Wait for a free staging buffer */
+#ifdef PARFLOW_HAVE_PTHREADS
+  pthread_mutex_lock(&queue->mutex);
+  while (queue->count == queue->depth)
+  {
+    pthread_cond_wait(&queue->not_full, &queue->mutex);
+  }
+  request = &(queue->requests[(queue->head + queue->count) % queue->depth]);
+  pthread_mutex_unlock(&queue->mutex);
+#else
+  request = &(queue->requests[0]);
+#endif
+
+  if (request->capacity < size)
+  {
+    tfree(request->buffer);
+    request->buffer = talloc(char, size);
+    request->capacity = size;
+  }
+
+  strncpy(request->filename, filename, sizeof(request->filename) - 1);
+  request->size = size;
+  request->offset = offset;
+  request->total = (amps_Rank(amps_CommWorld) == 0) ? total : -1;
+
+  PackPFBinary(v, num_subgrids, request->buffer);
+
+#ifdef PARFLOW_HAVE_PTHREADS
+  pthread_mutex_lock(&queue->mutex);
+  queue->count++;
+  pthread_cond_signal(&queue->not_empty);
+  pthread_mutex_unlock(&queue->mutex);
+#else
+  PFBAsyncWriteRequest(request);
+#endif
+}
+
+/*--------------------------------------------------------------------------
+ * PFBAsyncFlush
+ *
+ * Wait until all queued PFB writes have completed.  Local; callers that
+ * need the files to be complete on all ranks must synchronize afterwards.
+ *--------------------------------------------------------------------------*/
+
+void PFBAsyncFlush()
+{
+#ifdef PARFLOW_HAVE_PTHREADS
+  PFBAsyncQueue *queue = amps_ThreadLocal(pfb_async_queue);
+
+  if (queue)
+  {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count > 0)
+    {
+      pthread_cond_wait(&queue->not_full, &queue->mutex);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+  }
+#endif
+}
+
+/*--------------------------------------------------------------------------
+ * PFBAsyncFinalize
+ *
+ * Drain the queue, stop the I/O thread and free the staging buffers.
+ *--------------------------------------------------------------------------*/
+
+void PFBAsyncFinalize()
+{
+  PFBAsyncQueue *queue = amps_ThreadLocal(pfb_async_queue);
+  int r;
+
+  if (queue)
+  {
+#ifdef PARFLOW_HAVE_PTHREADS
+    pthread_mutex_lock(&queue->mutex);
+    queue->shutdown = 1;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->mutex);
+
+    pthread_join(queue->thread, NULL);
+
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+#endif
+
+    for (r = 0; r < queue->depth; r++)
+    {
+      tfree(queue->requests[r].buffer);
+    }
+    tfree(queue->requests);
+    tfree(queue);
+
+    amps_ThreadLocal(pfb_async_queue) = NULL;
+  }
+}
@@ -158,9 +158,9 @@ static char *PFSURFACERUNOFFUSAGE = "Usage: pfsuracerunoff top slope_x slope_y m
 static char *PFWATERTABLEDEPTHUSAGE = "Usage: pfwatertabledepth top saturation\n";
 static char *PFSLOPEXUSAGE = "Usage: pfslopex dem\n";
 static char *PFSLOPEYUSAGE = "Usage: pfslopey dem\n";
-static char *PFUPSTREAMAREAUSAGE = "Usage: pfupstreamarea dem sx sy\n";
+static char *PFUPSTREAMAREAUSAGE = "Usage: pfupstreamarea dem sx sy\n       pfupstreamarea -split dem sx sy\n";
 static char *PFFILLFLATSUSAGE = "Usage: pffillflats dem \n";
-static char *PFPITFILLDEMUSAGE = "Usage: pfpitfilldem dem dpit maxiter\n";
+static char *PFPITFILLDEMUSAGE = "Usage: pfpitfilldem dem dpit maxiter\n       pfpitfilldem -priorityflood dem [epsilon]\n";
 static char *PFMOVINGAVGDEMUSAGE = "Usage: pfmovingavgdem dem wsize maxiter\n";
 static char *PFSATTRANSUSAGE = "Usage: pfsattrans nlayers mask perm\n";
 static char *PFTOPODEFTOWTUSAGE = "Usage: pftopowt deficit porosity ssat sres mask top \n";
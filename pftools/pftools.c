@@ -6206,15 +6206,15 @@ int            SlopeYUpwindCommand(
  * Description: Compute upstream contributing area for each point [i,j]
  *              based on neighboring slopes (sx and sy).
  *
- * Notes:       loops of over all [i,j]
- *              at each [i,j], loops over neighbors to find parent(s)
- *              adds parent area to area[i,j]
- *              recursively loops over each parent's neighbors, calculates
- *                area over ALL upstream cells until reaches a divide
+ * Notes:       accumulates areas downstream in one topological pass
+ *              area is the number of distinct upstream cells
+ *              with -split, a cell draining in both x and y splits its
+ *                area between its receivers in proportion to |sx| and |sy|
  *              returns values as NUMBER OF CELLS (not actual area)
  *                to calculate areas, simply multiply area*dx*dy
  *
- * Cmd. syntax: pfupstreamarea sx sy
+ * Cmd. syntax: pfupstreamarea dem sx sy
+ *              pfupstreamarea -split dem sx sy
  *-----------------------------------------------------------------------*/
 int            UpstreamAreaCommand(
                                    ClientData  clientData,
@@ -6238,16 +6238,21 @@ int            UpstreamAreaCommand(
   char area_hashkey[MAX_KEY_SIZE];
   char          *filename = "upstream contributing area";
 
-  /* Check if two arguments following command  */
-  if (argc == 3)
+  // Local
+  int split;
+
+  split = (argc > 1) && (strcmp(argv[1], "-split") == 0);
+
+  /* Check for dem, sx and sy following command (and flag) */
+  if (argc != 4 + split)
   {
     WrongNumArgsError(interp, PFUPSTREAMAREAUSAGE);
     return TCL_ERROR;
   }
 
-  dem_hashkey = argv[1];
-  sx_hashkey = argv[2];
-  sy_hashkey = argv[3];
+  dem_hashkey = argv[1 + split];
+  sx_hashkey = argv[2 + split];
+  sy_hashkey = argv[3 + split];
 
   if ((dem = DataMember(data, dem_hashkey, entryPtr)) == NULL)
   {
@@ -6292,7 +6297,14 @@ int            UpstreamAreaCommand(
       }
 
       /* Compute areas */
-      ComputeUpstreamArea(dem, sx, sy, area);
+      if (split)
+      {
+        ComputeUpstreamAreaSplit(dem, sx, sy, area);
+      }
+      else
+      {
+        ComputeUpstreamArea(dem, sx, sy, area);
+      }
     }
 
     else
@@ -6388,10 +6400,15 @@ int            FillFlatsCommand(
  * routine for `pfpitfilldem' command
  * Description: Iterative pit-fill routine to calculate upstream  [i,j]
  *              based on neighboring slopes (sx and sy).
+ *              With -priorityflood, all depressions are filled in a
+ *              single priority-flood pass; epsilon (default 0) is the
+ *              minimum drop imposed across filled cells.
  *
- * Notes:       Assumes that user specifies dpit in same units as DEM
+ * Notes:       Assumes that user specifies dpit and epsilon in same
+ *              units as DEM
  *
  * Cmd. syntax: pfpitfilldem dem dpit maxiter
+ *              pfpitfilldem -priorityflood dem [epsilon]
  *-----------------------------------------------------------------------*/
 int            PitFillCommand(
                               ClientData  clientData,
@@ -6405,8 +6422,10 @@ int            PitFillCommand(
   // Inputs
   Databox       *dem;
   char          *dem_hashkey;
-  double dpit;
-  int maxiter;
+  double dpit = 0.0;
+  int maxiter = 0;
+  int priority_flood;
+  double epsilon = 0.0;
 
   // Output
   Databox       *newdem;
@@ -6421,23 +6440,49 @@ int            PitFillCommand(
   double x, y, z;
   double dx, dy, dz;
 
-  /* Check if three arguments following command  */
-  if (argc == 3)
-  {
-    WrongNumArgsError(interp, PFPITFILLDEMUSAGE);
-    return TCL_ERROR;
-  }
+  priority_flood = (argc > 1) && (strcmp(argv[1], "-priorityflood") == 0);
 
-  dem_hashkey = argv[1];
-  if (Tcl_GetDouble(interp, argv[2], &dpit) == TCL_ERROR)
+  if (priority_flood)
   {
-    NotADoubleError(interp, 1, PFPITFILLDEMUSAGE);
-    return TCL_ERROR;
+    /* Check for dem and optional epsilon following flag */
+    if ((argc != 3) && (argc != 4))
+    {
+      WrongNumArgsError(interp, PFPITFILLDEMUSAGE);
+      return TCL_ERROR;
+    }
+
+    dem_hashkey = argv[2];
+    if ((argc == 4) && (Tcl_GetDouble(interp, argv[3], &epsilon) == TCL_ERROR))
+    {
+      NotADoubleError(interp, 2, PFPITFILLDEMUSAGE);
+      return TCL_ERROR;
+    }
+    if (epsilon < 0.0)
+    {
+      NumberNotPositiveError(interp, 3);
+      return TCL_ERROR;
+    }
   }
-  if (Tcl_GetInt(interp, argv[3], &maxiter) == TCL_ERROR)
+  else
   {
-    NotAnIntError(interp, 1, PFPITFILLDEMUSAGE);
-    return TCL_ERROR;
+    /* Check if three arguments following command  */
+    if (argc != 4)
+    {
+      WrongNumArgsError(interp, PFPITFILLDEMUSAGE);
+      return TCL_ERROR;
+    }
+
+    dem_hashkey = argv[1];
+    if (Tcl_GetDouble(interp, argv[2], &dpit) == TCL_ERROR)
+    {
+      NotADoubleError(interp, 1, PFPITFILLDEMUSAGE);
+      return TCL_ERROR;
+    }
+    if (Tcl_GetInt(interp, argv[3], &maxiter) == TCL_ERROR)
+    {
+      NotAnIntError(interp, 1, PFPITFILLDEMUSAGE);
+      return TCL_ERROR;
+    }
   }
 
   if ((dem = DataMember(data, dem_hashkey, entryPtr)) == NULL)
@@ -6480,22 +6525,38 @@ int            PitFillCommand(
         }
       }
 
-      // Iterate to fill pits...
-      iter = 0;
-      nsink = 9999;
-      while ((iter < maxiter) && (nsink > 0))
+      if (priority_flood)
       {
-        nsink = ComputePitFill(newdem, dpit);
-        iter = iter + 1;
+        // Fill all depressions in one pass...
+        nsink = ComputePriorityFloodFill(newdem, epsilon);
+
+        // Print summary...
+        printf("*******************************************************\n");
+        printf("SUMMARY: pfpitfilldem -priorityflood \n");
+        printf("*******************************************************\n");
+        printf("EPSILON: \t\t %e \n", epsilon);
+        printf("RAISED CELLS: \t\t %d \n", nsink);
+        printf("   \n");
       }
+      else
+      {
+        // Iterate to fill pits...
+        iter = 0;
+        nsink = 9999;
+        while ((iter < maxiter) && (nsink > 0))
+        {
+          nsink = ComputePitFill(newdem, dpit);
+          iter = iter + 1;
+        }
 
-      // Print summary...
-      printf("*******************************************************\n");
-      printf("SUMMARY: pfpitfilldem  \n");
-      printf("*******************************************************\n");
-      printf("ITERATIONS: \t\t %d \n", iter);
-      printf("REMAINING SINKS: \t %d \n", nsink);
-      printf("   \n");
+        // Print summary...
+        printf("*******************************************************\n");
+        printf("SUMMARY: pfpitfilldem  \n");
+        printf("*******************************************************\n");
+        printf("ITERATIONS: \t\t %d \n", iter);
+        printf("REMAINING SINKS: \t %d \n", nsink);
+        printf("   \n");
+      }
     }
     else
     {
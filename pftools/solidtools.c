@@ -1338,8 +1338,7 @@ int         ConvertPfsolAscii2Bin(FILE *fp_asc,
     printf("\n * * Debugging for Ascii2Bin converter * * \n");
 
   int read_int, read_ivec[3], i, j, k;
-  float read_fltV[3];
-  double read_dble;
+  double read_dbleV[3];
 
   int n_vertex, n_tins, n_patches, n_obj;
 
@@ -1355,13 +1354,10 @@ int         ConvertPfsolAscii2Bin(FILE *fp_asc,
 
   for (i = 0; i < n_vertex; ++i)
   {
-    fscanf(fp_asc, "%f %f %f", &read_fltV[0], &read_fltV[1], &read_fltV[2]);
-
-    for (j = 0; j < 3; ++j)
-    {
-      read_dble = (double)read_fltV[j];
-      tools_WriteDouble(fp_bin, &read_dble, 1);
-    }
+    // Vertices are kept in double precision so the binary file holds
+    // the same values ParFlow reads from the ASCII file
+    fscanf(fp_asc, "%lf %lf %lf", &read_dbleV[0], &read_dbleV[1], &read_dbleV[2]);
+    tools_WriteDouble(fp_bin, read_dbleV, 3);
   }
 
   int nS;
@@ -1436,8 +1432,7 @@ int         ConvertPfsolBin2Ascii(FILE *fp_bin,
     printf("\n * * Debugging for Bin2Ascii converter * * \n");
 
   int read_int, read_ivec[3], i, j, k;
-  float read_fltV[3];
-  double read_dble;
+  double read_dbleV[3];
 
   int n_vertex, n_tins, n_patches, n_obj;
 
@@ -1452,12 +1447,8 @@ int         ConvertPfsolBin2Ascii(FILE *fp_bin,
     printf("--> N-Vertices %i \n", n_vertex);
   for (i = 0; i < n_vertex; ++i)
   {
-    for (j = 0; j < 3; ++j)
-    {
-      tools_ReadDouble(fp_bin, &read_dble, 1);
-      read_fltV[j] = read_dble;
-    }
-    fprintf(fp_asc, "%17.4f %17.4f %17.4f\n", read_fltV[0], read_fltV[1], read_fltV[2]);
+    tools_ReadDouble(fp_bin, read_dbleV, 3);
+    fprintf(fp_asc, "%.17g %.17g %.17g\n", read_dbleV[0], read_dbleV[1], read_dbleV[2]);
   }
 
   int nS;
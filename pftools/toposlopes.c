@@ -26,6 +26,7 @@
 *  USA
 **********************************************************************EHEADER*/
 #include "toposlopes.h"
+#include "general.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -1417,12 +1418,145 @@ int ComputeTestParent(
 }
 
 
+/*-----------------------------------------------------------------------
+ * FlowReceiversD4, FlowWeightsD4, FlowParentsD4:
+ *
+ * Drainage graph of the two-direction model used by ParFlow. Each cell
+ * drains to at most one neighbor in x (given by the sign of sx) and one
+ * neighbor in y (given by the sign of sy). Nodata cells (dem=-9999.0)
+ * neither drain nor receive flow.
+ *
+ * FlowReceiversD4 returns the number of cells [i,j] drains to and stores
+ * their linear indices (j*nx+i) in receivers[2].
+ * FlowWeightsD4 stores the share of the flow of [i,j] going to each of
+ * its nr receivers: all of it for a single receiver, otherwise |sx| and
+ * |sy| relative to their sum (x receiver first).
+ * FlowParentsD4 returns the number of cells draining to [i,j] and stores
+ * their linear indices in parents[4]; [ii,jj] is a parent of [i,j]
+ * exactly when ComputeTestParent(i,j,ii,jj,...) is 1.
+ *
+ *-----------------------------------------------------------------------*/
+
+static int FlowReceiversD4(
+                           int      i,
+                           int      j,
+                           Databox *dem,
+                           Databox *sx,
+                           Databox *sy,
+                           int *    receivers)
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  int ii, jj;
+  int n = 0;
+
+  if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+  {
+    return 0;
+  }
+
+  // x receiver: sx<0 drains east, sx>0 drains west
+  ii = i;
+  if (*DataboxCoeff(sx, i, j, 0) < 0.)
+  {
+    ii = i + 1;
+  }
+  else if (*DataboxCoeff(sx, i, j, 0) > 0.)
+  {
+    ii = i - 1;
+  }
+  if ((ii != i) && (ii >= 0) && (ii < nx) && (*DataboxCoeff(dem, ii, j, 0) != -9999.0))
+  {
+    receivers[n++] = j * nx + ii;
+  }
+
+  // y receiver: sy<0 drains north, sy>0 drains south
+  jj = j;
+  if (*DataboxCoeff(sy, i, j, 0) < 0.)
+  {
+    jj = j + 1;
+  }
+  else if (*DataboxCoeff(sy, i, j, 0) > 0.)
+  {
+    jj = j - 1;
+  }
+  if ((jj != j) && (jj >= 0) && (jj < ny) && (*DataboxCoeff(dem, i, jj, 0) != -9999.0))
+  {
+    receivers[n++] = jj * nx + i;
+  }
+
+  return n;
+}
+
+static void FlowWeightsD4(
+                          int      i,
+                          int      j,
+                          Databox *sx,
+                          Databox *sy,
+                          int      nr,
+                          double * weights)
+{
+  double ax, ay;
+
+  if (nr < 2)
+  {
+    weights[0] = 1.0;
+    return;
+  }
+
+  ax = fabs(*DataboxCoeff(sx, i, j, 0));
+  ay = fabs(*DataboxCoeff(sy, i, j, 0));
+  weights[0] = ax / (ax + ay);
+  weights[1] = ay / (ax + ay);
+}
+
+static int FlowParentsD4(
+                         int      i,
+                         int      j,
+                         Databox *dem,
+                         Databox *sx,
+                         Databox *sy,
+                         int *    parents)
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  int n = 0;
+
+  if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+  {
+    return 0;
+  }
+
+  if ((i > 0) && (*DataboxCoeff(dem, i - 1, j, 0) != -9999.0) && (*DataboxCoeff(sx, i - 1, j, 0) < 0.))
+  {
+    parents[n++] = j * nx + i - 1;
+  }
+  if ((i < nx - 1) && (*DataboxCoeff(dem, i + 1, j, 0) != -9999.0) && (*DataboxCoeff(sx, i + 1, j, 0) > 0.))
+  {
+    parents[n++] = j * nx + i + 1;
+  }
+  if ((j > 0) && (*DataboxCoeff(dem, i, j - 1, 0) != -9999.0) && (*DataboxCoeff(sy, i, j - 1, 0) < 0.))
+  {
+    parents[n++] = (j - 1) * nx + i;
+  }
+  if ((j < ny - 1) && (*DataboxCoeff(dem, i, j + 1, 0) != -9999.0) && (*DataboxCoeff(sy, i, j + 1, 0) > 0.))
+  {
+    parents[n++] = (j + 1) * nx + i;
+  }
+
+  return n;
+}
+
+
 /*-----------------------------------------------------------------------
  * ComputeParentMap:
  *
- * Computes upstream area for the given cell [i,j] by recursively looping
- * over neighbors and summing area of all parent cells (moving from cell [i,j]
- * to parents, to their parents, etc. until reaches upper end of basin).
+ * Computes upstream area for the given cell [i,j] by walking over neighbors
+ * and flagging all parent cells (moving from cell [i,j] to parents, to their
+ * parents, etc. until reaches upper end of basin).
+ *
+ * Parents are visited with an explicit stack rather than by recursion so
+ * large basins cannot overflow the call stack.
  *
  * Area returned as NUMBER OF CELLS
  * To get actual area, multiply area_ij*dx*dy
@@ -1436,138 +1570,467 @@ void ComputeParentMap(int      i,
                       Databox *sy,
                       Databox *parentmap)
 {
-  int ii, jj;
-  int parent;
-
   int nx = DataboxNx(sx);
   int ny = DataboxNy(sx);
+  int n, np, cell;
+  int parents[4];
+  int *stack;
+  int top;
 
   // skip if self is nodata cell (dem=-9999.0)
   if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
   {
-    ;
+    return;
   }
 
-  // otherwise, loop over neighbors...
-  else
+  // every cell is pushed at most once, when it is first flagged
+  stack = talloc(int, nx * ny);
+  top = 0;
+
+  // Add self to parent map
+  *DataboxCoeff(parentmap, i, j, 0) = 1.0;
+  stack[top++] = j * nx + i;
+
+  while (top > 0)
   {
-    // Add self to parent map
-    *DataboxCoeff(parentmap, i, j, 0) = 1.0;
+    cell = stack[--top];
 
-    // Loop over neighbors
-    for (jj = j - 1; jj <= j + 1; jj++)
+    np = FlowParentsD4(cell % nx, cell / nx, dem, sx, sy, parents);
+    for (n = 0; n < np; n++)
     {
-      for (ii = i - 1; ii <= i + 1; ii++)
+      if (DataboxCoeffs(parentmap)[parents[n]] != 1.0)
       {
-        // skip self
-        if ((ii == i) && (jj == j))
-        {
-          ;
-        }
+        DataboxCoeffs(parentmap)[parents[n]] = 1.0;
+        stack[top++] = parents[n];
+      }
+    }
+  }
 
-        // skip diagonals
-        else if ((ii != i) && (jj != j))
+  tfree(stack);
+}
+
+
+/*-----------------------------------------------------------------------
+ * FlowComponentsD4:
+ *
+ * Collapses drainage cycles into strongly connected components (iterative
+ * Tarjan), which leaves an acyclic graph between components. Stores the
+ * component of every cell in comp (-1 for nodata cells) and returns the
+ * number of components. Components are numbered so that a component only
+ * drains to components with a lower number.
+ *
+ *-----------------------------------------------------------------------*/
+
+static int FlowComponentsD4(
+                            Databox *dem,
+                            Databox *sx,
+                            Databox *sy,
+                            int *    comp)
+{
+  int nx = DataboxNx(dem);
+  int ncells = DataboxNx(dem) * DataboxNy(dem);
+  int cell, other, root, nr, depth, sp;
+  int counter, ncomp;
+  int receivers[2];
+
+  int            *index;
+  int            *low;
+  int            *edge;
+  int            *call;
+  int            *scc;
+
+  index = ctalloc(int, ncells);
+  low = talloc(int, ncells);
+  edge = talloc(int, ncells);
+  call = talloc(int, ncells);
+  scc = talloc(int, ncells);
+
+  for (cell = 0; cell < ncells; cell++)
+  {
+    comp[cell] = -1;
+  }
+
+  // a cell is on the Tarjan stack while it has an index but no component yet
+  counter = 0;
+  ncomp = 0;
+  sp = 0;
+  for (root = 0; root < ncells; root++)
+  {
+    if ((DataboxCoeffs(dem)[root] == -9999.0) || (index[root] != 0))
+    {
+      continue;
+    }
+
+    depth = 0;
+    call[0] = root;
+    edge[0] = 0;
+    index[root] = low[root] = ++counter;
+    scc[sp++] = root;
+
+    while (depth >= 0)
+    {
+      cell = call[depth];
+      nr = FlowReceiversD4(cell % nx, cell / nx, dem, sx, sy, receivers);
+      if (edge[depth] < nr)
+      {
+        other = receivers[edge[depth]++];
+        if (index[other] == 0)
         {
-          ;
+          depth++;
+          call[depth] = other;
+          edge[depth] = 0;
+          index[other] = low[other] = ++counter;
+          scc[sp++] = other;
         }
-
-        // skip off-grid cells
-        else if (ii < 0 || jj < 0 || ii > nx - 1 || jj > ny - 1)
+        else if ((comp[other] < 0) && (index[other] < low[cell]))
         {
-          ;
+          low[cell] = index[other];
         }
+        continue;
+      }
 
-        // skip if NEIGHBOR is nodata cell (dem=-9999.0)
-        else if (*DataboxCoeff(dem, ii, jj, 0) == -9999.0)
+      if (low[cell] == index[cell])
+      {
+        do
         {
-          ;
+          other = scc[--sp];
+          comp[other] = ncomp;
         }
+        while (other != cell);
+        ncomp++;
+      }
 
-        // otherwise, test if [ii,jj] is parent of [i,j]...
-        else
-        {
-          parent = ComputeTestParent(i, j, ii, jj, dem, sx, sy);
+      depth--;
+      if ((depth >= 0) && (low[cell] < low[call[depth]]))
+      {
+        low[call[depth]] = low[cell];
+      }
+    }
+  }
 
-          // if parent, loop recursively
-          if ((parent == 1) && (*DataboxCoeff(parentmap, ii, jj, 0) != 1.0))
-          {
-            ComputeParentMap(ii, jj, dem, sx, sy, parentmap);
-          }
-        }
-      }    // end loop over i
-    }   // end loop over j
-  }  // end if self==nodata
+  tfree(index);
+  tfree(low);
+  tfree(edge);
+  tfree(call);
+  tfree(scc);
+
+  return ncomp;
 }
 
 
 /*-----------------------------------------------------------------------
- * ComputeUpstreamArea:
+ * AccumulateUpstreamArea:
  *
- * Computes upstream area for all cells by looping over grid and calling
- * ComputeUpstreamAreaIJ for each cell.
+ * Accumulates upstream areas in a single topological (Kahn) pass over the
+ * component graph of FlowComponentsD4: each component passes its area
+ * downstream once all of its parents are done, and every cell gets the
+ * area of its component.
  *
- * Area returned as NUMBER OF CELLS
- * To get actual area, multiply area_ij*dx*dy
+ * With split set, a component draining to several components splits its
+ * area between them in proportion to |sx| and |sy| of the draining cells.
+ *
+ * Otherwise the area is the number of distinct upstream cells. Summing
+ * the parents is exact as long as no upstream component drains to more
+ * than one component, since the upstream cells of the parents are then
+ * disjoint. Components below such a split are flagged and counted with an
+ * upstream walk that stops at unflagged components, whose (tree) areas
+ * are already exact and cannot be reached along any other path. A walk
+ * costs up to the upstream area of its component, so with split set the
+ * pass stays linear on grids where most cells drain both in x and y.
  *
  *-----------------------------------------------------------------------*/
-void ComputeUpstreamArea(
-                         Databox *dem,
-                         Databox *sx,
-                         Databox *sy,
-                         Databox *area)
+
+static void AccumulateUpstreamArea(
+                                   Databox *dem,
+                                   Databox *sx,
+                                   Databox *sy,
+                                   Databox *area,
+                                   int      split)
 {
-  int i, j;
-  int ii, jj;
-  int nx, ny, nz;
-  double x, y, z;
-  double dx, dy, dz;
-  Databox        *parentmap;
+  int i, j, n;
+  int nx, ny, ncells;
+  int cell, other, nr, np, top, sp;
+  int ncomp, c, a, k, ndown, down;
+  int receivers[2];
+  int parents[4];
+  double weights[2];
+  double wsum, total;
+
+  int            *comp;
+  int            *start;
+  int            *member;
+  int            *indegree;
+  int            *ready;
+  int            *mark;
+  int            *stamp;
+  int            *walk;
+  int            *pstart;
+  int            *plist;
+  char           *shared;
+  double         *count;
 
-  // create new databox for parentmap
   nx = DataboxNx(sx);
   ny = DataboxNy(sx);
-  nz = DataboxNz(sx);
-  x = DataboxX(sx);
-  y = DataboxY(sx);
-  z = DataboxZ(sx);
-  dx = DataboxDx(sx);
-  dy = DataboxDy(sx);
-  dz = DataboxDz(sx);
-  parentmap = NewDatabox(nx, ny, nz, x, y, z, dx, dy, dz);
+  ncells = nx * ny;
 
-  // loop over all [i,j]
-  for (j = 0; j < ny; j++)
+  comp = talloc(int, ncells);
+  ncomp = FlowComponentsD4(dem, sx, sy, comp);
+
+  // list members of every component, and count the edges entering it
+  // from other components
+  start = ctalloc(int, ncomp + 1);
+  member = talloc(int, ncells);
+  indegree = ctalloc(int, ncomp);
+  count = ctalloc(double, ncomp);
+
+  for (cell = 0; cell < ncells; cell++)
   {
-    for (i = 0; i < nx; i++)
+    if (comp[cell] >= 0)
     {
-      // zero out parentmap
-      for (jj = 0; jj < ny; jj++)
+      start[comp[cell] + 1]++;
+      count[comp[cell]] += 1.0;
+
+      nr = FlowReceiversD4(cell % nx, cell / nx, dem, sx, sy, receivers);
+      for (n = 0; n < nr; n++)
       {
-        for (ii = 0; ii < nx; ii++)
+        if (comp[receivers[n]] != comp[cell])
         {
-          *DataboxCoeff(parentmap, ii, jj, 0) = 0.0;
+          indegree[comp[receivers[n]]]++;
         }
       }
+    }
+  }
+  for (c = 0; c < ncomp; c++)
+  {
+    start[c + 1] += start[c];
+  }
+  for (cell = 0; cell < ncells; cell++)
+  {
+    if (comp[cell] >= 0)
+    {
+      member[start[comp[cell]]++] = cell;
+    }
+  }
+  for (c = ncomp; c > 0; c--)
+  {
+    start[c] = start[c - 1];
+  }
+  start[0] = 0;
+
+  ready = talloc(int, ncomp);
+  mark = talloc(int, ncomp);
+  stamp = talloc(int, ncomp);
+  walk = talloc(int, ncomp);
+  shared = ctalloc(char, ncomp);
+  for (c = 0; c < ncomp; c++)
+  {
+    mark[c] = -1;
+    stamp[c] = -1;
+  }
 
-      // generate parent map for [i,j]
-      // (skip nodata cells...if not nodata, recursive loop)
-      if (*DataboxCoeff(dem, i, j, 0) != -9999.0)
+  // distinct parent components of every component, for the walks
+  pstart = talloc(int, ncomp + 1);
+  plist = talloc(int, 2 * ncells);
+  pstart[0] = 0;
+  for (c = 0; c < ncomp; c++)
+  {
+    pstart[c + 1] = pstart[c];
+    for (k = start[c]; k < start[c + 1]; k++)
+    {
+      cell = member[k];
+      np = FlowParentsD4(cell % nx, cell / nx, dem, sx, sy, parents);
+      for (n = 0; n < np; n++)
       {
-        ComputeParentMap(i, j, dem, sx, sy, parentmap);
+        other = comp[parents[n]];
+        if ((other != c) && (stamp[other] != c))
+        {
+          stamp[other] = c;
+          plist[pstart[c + 1]++] = other;
+        }
       }
+    }
+  }
+  for (c = 0; c < ncomp; c++)
+  {
+    stamp[c] = -1;
+  }
 
-      // calculate area as sum over parentmap
-      for (jj = 0; jj < ny; jj++)
+  // topological pass: pass areas downstream once all parents are done
+  top = 0;
+  for (c = 0; c < ncomp; c++)
+  {
+    if (indegree[c] == 0)
+    {
+      ready[top++] = c;
+    }
+  }
+
+  while (top > 0)
+  {
+    c = ready[--top];
+
+    // distinct upstream cells below a split, walking up to the
+    // unflagged components
+    if (!split && shared[c])
+    {
+      total = start[c + 1] - start[c];
+      stamp[c] = c;
+      sp = 0;
+      walk[sp++] = c;
+      while (sp > 0)
       {
-        for (ii = 0; ii < nx; ii++)
+        a = walk[--sp];
+        for (k = pstart[a]; k < pstart[a + 1]; k++)
         {
-          *DataboxCoeff(area, i, j, 0) = *DataboxCoeff(area, i, j, 0) + *DataboxCoeff(parentmap, ii, jj, 0);
+          other = plist[k];
+          if (stamp[other] == c)
+          {
+            continue;
+          }
+          stamp[other] = c;
+          if (shared[other])
+          {
+            total += start[other + 1] - start[other];
+            walk[sp++] = other;
+          }
+          else
+          {
+            total += count[other];
+          }
         }
       }
-    }   // end loop over i
-  }  // end loop over j
+      count[c] = total;
+    }
 
-  FreeDatabox(parentmap);
+    // distinct components c drains to
+    ndown = 0;
+    down = -1;
+    wsum = 0.0;
+    for (k = start[c]; k < start[c + 1]; k++)
+    {
+      cell = member[k];
+      nr = FlowReceiversD4(cell % nx, cell / nx, dem, sx, sy, receivers);
+      FlowWeightsD4(cell % nx, cell / nx, sx, sy, nr, weights);
+      for (n = 0; n < nr; n++)
+      {
+        other = comp[receivers[n]];
+        if (other != c)
+        {
+          wsum += weights[n];
+          if (mark[other] != c)
+          {
+            mark[other] = c;
+            ndown++;
+            down = other;
+          }
+        }
+      }
+    }
+
+    for (k = start[c]; k < start[c + 1]; k++)
+    {
+      cell = member[k];
+      nr = FlowReceiversD4(cell % nx, cell / nx, dem, sx, sy, receivers);
+      FlowWeightsD4(cell % nx, cell / nx, sx, sy, nr, weights);
+      for (n = 0; n < nr; n++)
+      {
+        other = comp[receivers[n]];
+        if (other != c)
+        {
+          if (split)
+          {
+            count[other] += count[c] * (weights[n] / wsum);
+          }
+          else if (shared[c] || (ndown > 1))
+          {
+            shared[other] = 1;
+          }
+
+          if (--indegree[other] == 0)
+          {
+            ready[top++] = other;
+          }
+        }
+      }
+    }
+
+    // a flagged component is counted by its walk, so the sum is only
+    // used (and exact) for unflagged ones
+    if (!split && (ndown == 1))
+    {
+      count[down] += count[c];
+    }
+  }
+
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      cell = j * nx + i;
+      if (comp[cell] >= 0)
+      {
+        *DataboxCoeff(area, i, j, 0) = count[comp[cell]];
+      }
+    }
+  }
+
+  tfree(comp);
+  tfree(start);
+  tfree(member);
+  tfree(indegree);
+  tfree(ready);
+  tfree(mark);
+  tfree(stamp);
+  tfree(walk);
+  tfree(pstart);
+  tfree(plist);
+  tfree(shared);
+  tfree(count);
+}
+
+
+/*-----------------------------------------------------------------------
+ * ComputeUpstreamArea:
+ *
+ * Computes upstream area for all cells, i.e. the number of distinct cells
+ * that drain to [i,j] directly or through other cells, including [i,j]
+ * itself. The result equals summing ComputeParentMap over the grid for
+ * every cell.
+ *
+ * Area returned as NUMBER OF CELLS
+ * To get actual area, multiply area_ij*dx*dy
+ *
+ *-----------------------------------------------------------------------*/
+void ComputeUpstreamArea(
+                         Databox *dem,
+                         Databox *sx,
+                         Databox *sy,
+                         Databox *area)
+{
+  AccumulateUpstreamArea(dem, sx, sy, area, 0);
+}
+
+
+/*-----------------------------------------------------------------------
+ * ComputeUpstreamAreaSplit:
+ *
+ * Computes upstream area for all cells like ComputeUpstreamArea, except
+ * that a cell draining both in x and y splits its area between the two
+ * receivers in proportion to |sx| and |sy| instead of passing all of it
+ * to both. Areas are fractional below such cells. When every cell drains
+ * to a single receiver the result equals ComputeUpstreamArea.
+ *
+ * Area returned as NUMBER OF CELLS
+ * To get actual area, multiply area_ij*dx*dy
+ *
+ *-----------------------------------------------------------------------*/
+void ComputeUpstreamAreaSplit(
+                              Databox *dem,
+                              Databox *sx,
+                              Databox *sy,
+                              Databox *area)
+{
+  AccumulateUpstreamArea(dem, sx, sy, area, 1);
 }
 
 
@@ -1969,6 +2432,218 @@ int ComputePitFill(
 }
 
 
+/*-----------------------------------------------------------------------
+ * ComputePriorityFloodFill:
+ *
+ * Fills all depressions in a DEM in a single pass using the priority-flood
+ * algorithm (Barnes et al., 2014). Cells on the domain boundary or next
+ * to a nodata (-9999.0) cell are seeded into a priority queue ordered by
+ * elevation; cells are then removed lowest first and their unvisited D4
+ * neighbors are raised to at least the elevation of the cell that reached
+ * them. The result is the minimal surface with no interior sinks.
+ *
+ * If epsilon > 0, a raised cell is set to epsilon above the cell that
+ * reached it, so that filled depressions drain toward their spill point
+ * instead of being flat.
+ * If epsilon == 0, depressions are filled flat and cells inside them are
+ * processed through a FIFO queue rather than the priority queue.
+ *
+ * Nodata cells are left unchanged. Returns the number of raised cells.
+ *
+ *-----------------------------------------------------------------------*/
+
+typedef struct {
+  double z;
+  int order;
+  int cell;
+} FloodNode;
+
+static int FloodNodeLess(
+                         FloodNode *a,
+                         FloodNode *b)
+{
+  /* ties are broken by insertion order so results are deterministic */
+  return (a->z < b->z) || ((a->z == b->z) && (a->order < b->order));
+}
+
+static void FloodHeapPush(
+                          FloodNode *heap,
+                          int *      size,
+                          double     z,
+                          int        order,
+                          int        cell)
+{
+  int n = (*size)++;
+  FloodNode node;
+
+  node.z = z;
+  node.order = order;
+  node.cell = cell;
+
+  while (n > 0)
+  {
+    int parent = (n - 1) / 2;
+    if (!FloodNodeLess(&node, &heap[parent]))
+    {
+      break;
+    }
+    heap[n] = heap[parent];
+    n = parent;
+  }
+  heap[n] = node;
+}
+
+static int FloodHeapPop(
+                        FloodNode *heap,
+                        int *      size)
+{
+  int cell = heap[0].cell;
+  FloodNode last = heap[--(*size)];
+  int n = 0;
+
+  while (2 * n + 1 < *size)
+  {
+    int child = 2 * n + 1;
+    if ((child + 1 < *size) && FloodNodeLess(&heap[child + 1], &heap[child]))
+    {
+      child++;
+    }
+    if (!FloodNodeLess(&heap[child], &last))
+    {
+      break;
+    }
+    heap[n] = heap[child];
+    n = child;
+  }
+  if (*size > 0)
+  {
+    heap[n] = last;
+  }
+
+  return cell;
+}
+
+int ComputePriorityFloodFill(
+                             Databox *dem,
+                             double   epsilon)
+{
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  int ncell = nx * ny;
+  double *z = DataboxCoeffs(dem);
+
+  int ioff[4] = { -1, 1, 0, 0 };
+  int joff[4] = { 0, 0, -1, 1 };
+
+  FloodNode      *heap;
+  int            *pit;
+  char           *closed;
+  int heap_size = 0;
+  int pit_head = 0, pit_tail = 0;
+  int order = 0;
+  int nraised = 0;
+  int i, j, n, c;
+
+  if (ncell == 0)
+  {
+    return 0;
+  }
+
+  heap = talloc(FloodNode, ncell);
+  pit = talloc(int, ncell);
+  closed = ctalloc(char, ncell);
+
+  // Seed with data cells on the domain edge or next to nodata
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      c = j * nx + i;
+      if (z[c] == -9999.0)
+      {
+        closed[c] = 1;
+        continue;
+      }
+
+      if ((i == 0) || (j == 0) || (i == nx - 1) || (j == ny - 1) ||
+          (z[c - 1] == -9999.0) || (z[c + 1] == -9999.0) ||
+          (z[c - nx] == -9999.0) || (z[c + nx] == -9999.0))
+      {
+        closed[c] = 1;
+        FloodHeapPush(heap, &heap_size, z[c], order++, c);
+      }
+    }
+  }
+
+  // Flood inward from the lowest open cell
+  while ((heap_size > 0) || (pit_head < pit_tail))
+  {
+    if (pit_head < pit_tail)
+    {
+      c = pit[pit_head++];
+    }
+    else
+    {
+      c = FloodHeapPop(heap, &heap_size);
+    }
+
+    i = c % nx;
+    j = c / nx;
+    for (n = 0; n < 4; n++)
+    {
+      int ii = i + ioff[n];
+      int jj = j + joff[n];
+      int nc;
+
+      if ((ii < 0) || (jj < 0) || (ii >= nx) || (jj >= ny))
+      {
+        continue;
+      }
+
+      nc = jj * nx + ii;
+      if (closed[nc])
+      {
+        continue;
+      }
+      closed[nc] = 1;
+
+      if (epsilon > 0.0)
+      {
+        if (z[nc] <= z[c])
+        {
+          z[nc] = z[c] + epsilon;
+          if (z[nc] <= z[c])
+          {
+            z[nc] = nextafter(z[c], HUGE_VAL);
+          }
+          nraised++;
+        }
+        FloodHeapPush(heap, &heap_size, z[nc], order++, nc);
+      }
+      else if (z[nc] <= z[c])
+      {
+        if (z[nc] < z[c])
+        {
+          z[nc] = z[c];
+          nraised++;
+        }
+        pit[pit_tail++] = nc;
+      }
+      else
+      {
+        FloodHeapPush(heap, &heap_size, z[nc], order++, nc);
+      }
+    }
+  }
+
+  tfree(heap);
+  tfree(pit);
+  tfree(closed);
+
+  return nraised;
+}
+
+
 /*-----------------------------------------------------------------------
  * ComputeMovingAvg:
  *
@@ -3186,11 +3861,109 @@ void ComputeSlopeD8(
             s3 = fabs(*DataboxCoeff(dem, i, j, 0) - 0.0) / dxy;
           }
 
-          *DataboxCoeff(slope, i, j, 0) = fmax(s1, fmax(s2, s3));
-        }     // end if nodata>1
-      }    // end if nodata
-    }    // end loop over i
-  }  // end loop over j
+          *DataboxCoeff(slope, i, j, 0) = fmax(s1, fmax(s2, s3));
+        }     // end if nodata>1
+      }    // end if nodata
+    }    // end loop over i
+  }  // end loop over j
+}
+
+
+/*-----------------------------------------------------------------------
+ * FlowLowestNeighborD8, FlowReceiverD8:
+ *
+ * D8 drainage graph. FlowLowestNeighborD8 scans the adjacent and diagonal
+ * neighbors of [i,j] (and [i,j] itself unless skip_self is set), ignoring
+ * off-grid cells, and returns the lowest elevation found. The first
+ * lowest cell in scan order is returned in [imin,jmin] and, if nodata is
+ * not NULL, the number of nodata cells scanned in nodata.
+ *
+ * FlowReceiverD8 returns the linear index (j*nx+i) of the D8 child of
+ * [i,j], or -1 if [i,j] is nodata, a local minimum or drains to nodata;
+ * [i,j] is the D8 parent of its child exactly when ComputeTestParentD8
+ * is 1.
+ *
+ *-----------------------------------------------------------------------*/
+
+static double FlowLowestNeighborD8(
+                                   int      i,
+                                   int      j,
+                                   Databox *dem,
+                                   int      skip_self,
+                                   int *    imin,
+                                   int *    jmin,
+                                   int *    nodata)
+{
+  int ii, jj;
+  int nx = DataboxNx(dem);
+  int ny = DataboxNy(dem);
+  double zmin = 100000000000.0;
+
+  *imin = -9999;
+  *jmin = -9999;
+  if (nodata)
+  {
+    *nodata = 0;
+  }
+
+  for (jj = j - 1; jj <= j + 1; jj++)
+  {
+    for (ii = i - 1; ii <= i + 1; ii++)
+    {
+      // skip if off grid
+      if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
+      {
+        ;
+      }
+
+      // skip self if requested
+      else if (skip_self && (ii == i) && (jj == j))
+      {
+        ;
+      }
+
+      // find lowest neighbor
+      else
+      {
+        if (nodata && (*DataboxCoeff(dem, ii, jj, 0) == -9999.0))
+        {
+          *nodata = *nodata + 1;
+        }
+        if (*DataboxCoeff(dem, ii, jj, 0) < zmin)
+        {
+          zmin = *DataboxCoeff(dem, ii, jj, 0);
+          *imin = ii;
+          *jmin = jj;
+        }
+      }
+    }
+  }
+
+  return zmin;
+}
+
+static int FlowReceiverD8(
+                          int      i,
+                          int      j,
+                          Databox *dem)
+{
+  int imin, jmin;
+  double zmin;
+
+  if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+  {
+    return -1;
+  }
+
+  zmin = FlowLowestNeighborD8(i, j, dem, 1, &imin, &jmin, NULL);
+
+  // no neighbors, drains to nodata (ocean), or not lower than [i,j]
+  if ((imin < 0) || (zmin == -9999.0) || !(zmin < *DataboxCoeff(dem, i, j, 0)))
+  {
+    return -1;
+  }
+
+  return jmin * DataboxNx(dem) + imin;
 }
 
 
@@ -3213,7 +3986,7 @@ void ComputeSegmentD8(
                       Databox *dem,
                       Databox *ds)
 {
-  int i, j, ii, jj;
+  int i, j;
   int imin, jmin;
   int nx, ny;
   int nodata;
@@ -3250,38 +4023,8 @@ void ComputeSegmentD8(
         // Loop over neighbors (adjacent and diagonal)
         // ** Find elevation and indices of lowest neighbor
         // ** Exclude self and off-grid cells
-        imin = -9999;
-        jmin = -9999;
-        zmin = 100000000000.0;
-        nodata = 0;
-        for (jj = j - 1; jj <= j + 1; jj++)
-        {
-          for (ii = i - 1; ii <= i + 1; ii++)
-          {
-            // skip if off grid
-            if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
-            {
-              ;
-            }
-
-            // find lowest neighbor
-            else
-            {
-              // count number of nodata neighbors
-              if (*DataboxCoeff(dem, ii, jj, 0) == -9999.0)
-              {
-                nodata = nodata + 1;
-              }
-              // set zmin, imin, jmin if lower than previous zmin
-              if (*DataboxCoeff(dem, ii, jj, 0) < zmin)
-              {
-                zmin = *DataboxCoeff(dem, ii, jj, 0);
-                imin = ii;
-                jmin = jj;
-              }
-            }       // end find lowest neighbor
-          }
-        }
+        // ** Count number of nodata neighbors
+        zmin = FlowLowestNeighborD8(i, j, dem, 0, &imin, &jmin, &nodata);
 
         // Calculate slope towards lowest neighbor
 
@@ -3452,7 +4195,7 @@ void ComputeChildD8(
                     Databox *dem,
                     Databox *child)
 {
-  int i, j, ii, jj;
+  int i, j;
   int imin, jmin;
   int nx, ny;
   double zmin;
@@ -3479,31 +4222,7 @@ void ComputeChildD8(
       // local minima from which to start our Flint's Law recursion...
       // Parent-child relationships are computed by ComputeTestParentD8...
 
-      imin = -9999;
-      jmin = -9999;
-      zmin = 100000000000.0;
-      for (jj = j - 1; jj <= j + 1; jj++)
-      {
-        for (ii = i - 1; ii <= i + 1; ii++)
-        {
-          // skip if off grid
-          if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
-          {
-            ;
-          }
-
-          // find lowest neighbor
-          else
-          {
-            if ((*DataboxCoeff(dem, ii, jj, 0) < zmin))
-            {
-              zmin = *DataboxCoeff(dem, ii, jj, 0);
-              imin = ii;
-              jmin = jj;
-            }
-          }
-        }
-      }
+      zmin = FlowLowestNeighborD8(i, j, dem, 0, &imin, &jmin, NULL);
 
       // Determine elevation lowest neighbor -- lowest neighbor is D8 child!!
       // ** If cell is a local minimum (edge or otherwise), set value to -9999.0 (local min)
@@ -3543,16 +4262,9 @@ int ComputeTestParentD8(
                         Databox *dem)
 {
   int test = -999;
-  int itest, jtest;
   int imin, jmin;
-  int nx, ny;
   double zmin;
 
-  nx = DataboxNx(dem);
-  ny = DataboxNy(dem);
-  itest = 0;
-  jtest = 0;
-
   // skip nodata cells
   // (nodata cell can't be child because it has no elevation, ignored by code)
   // (nodata cell can't be parent -- everything drains TO nodata/ocean cells, not vice versa)
@@ -3574,37 +4286,7 @@ int ComputeTestParentD8(
     // ** loop over neighbors of [ii,jj] (adjacent and diagonal)
     // ** find elevation and indices of lowest neighbor (including self)
     // ** exclude off-grid cells
-    imin = -9999;
-    jmin = -9999;
-    zmin = 100000000000.0;
-    for (jtest = jj - 1; jtest <= jj + 1; jtest++)
-    {
-      for (itest = ii - 1; itest <= ii + 1; itest++)
-      {
-        // skip if off grid...
-        if ((itest < 0) || (jtest < 0) || (itest > nx - 1) || (jtest > ny - 1))
-        {
-          ;
-        }
-
-        // skip self...
-        else if ((itest == ii) && (jtest == jj))
-        {
-          ;
-        }
-
-        // otherwise, find lowest neighbor
-        else
-        {
-          if ((*DataboxCoeff(dem, itest, jtest, 0) < zmin))
-          {
-            zmin = *DataboxCoeff(dem, itest, jtest, 0);
-            imin = itest;
-            jmin = jtest;
-          }
-        }
-      }    // end loop over itest
-    }   // end loop over jtest
+    zmin = FlowLowestNeighborD8(ii, jj, dem, 1, &imin, &jmin, NULL);
 
     // Determine if [ii,jj] is parent of [i,j]
     // ** if zmin==-9999.0, cell drains to a nodata cell (i.e., to ocean)...
@@ -3638,8 +4320,10 @@ int ComputeTestParentD8(
 /*-----------------------------------------------------------------------
  * ComputeFlintsLawRec:
  *
- * Recursively computes Flint's law up a given drainage network
+ * Computes Flint's law up the drainage network draining to [i,j]
  *
+ * Parents are visited with an explicit stack rather than by recursion so
+ * large networks cannot overflow the call stack.
  *
  *---------------------------------------------------------------------*/
 void ComputeFlintsLawRec(
@@ -3653,72 +4337,188 @@ void ComputeFlintsLawRec(
                          double   c,
                          double   p)
 {
-  int ii, jj;
+  int ii, jj, ic, jc;
   int nx, ny;
-  int test = -999;
+  int cell, top, size;
+  int            *stack;
+
+  (void)child;
 
   nx = DataboxNx(demflint);
   ny = DataboxNy(demflint);
 
+  // if i or j is off grid --> skip
+  if ((i < 0) || (i >= nx) || (j < 0) || (j >= ny))
+  {
+    return;
+  }
+
   // if [i,j] is nodata cell --> skip
   if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
   {
     *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-    test = 0;
+    return;
   }
 
-  // if i or j is off grid --> skip
-  else if ((i < 0) || (i >= nx) || (j < 0) || (j >= ny))
-  {
-    test = 0;
-  }
+  size = 64;
+  stack = talloc(int, size);
+  top = 0;
+  stack[top++] = j * nx + i;
 
-  // else --> loop over neighbors of [i,j]
-  else
+  while (top > 0)
   {
-    for (jj = j - 1; jj <= j + 1; jj++)
+    cell = stack[--top];
+    ic = cell % nx;
+    jc = cell / nx;
+
+    // loop over neighbors of [ic,jc]
+    for (jj = jc - 1; jj <= jc + 1; jj++)
     {
-      for (ii = i - 1; ii <= i + 1; ii++)
+      for (ii = ic - 1; ii <= ic + 1; ii++)
       {
-        // skip nodata neighbors...
-        if (*DataboxCoeff(dem, ii, jj, 0) == -9999.0)
+        // skip off-grid neighbors and self...
+        if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1) || ((ii == ic) && (jj == jc)))
         {
-          test = 0;
+          ;
         }
 
-        // skip off-grid neighbors...
-        else if ((ii < 0) || (jj < 0) || (ii > nx - 1) || (jj > ny - 1))
+        // if [ii,jj] is a D8 parent
+        // ...and Flint's Law DEM not already computed for [ii,jj] -- i.e., demflint(ii,jj)==-1111. (avoid infinite loop)
+        // ...then compute DEM and move upstream
+        else if ((FlowReceiverD8(ii, jj, dem) == cell) && (*DataboxCoeff(demflint, ii, jj, 0) == -1111.0))
         {
-          test = 0;
-        }
+          *DataboxCoeff(demflint, ii, jj, 0) = *DataboxCoeff(demflint, ic, jc, 0) +
+                                               c * pow(*DataboxCoeff(area, ii, jj, 0), p) * *DataboxCoeff(ds, ii, jj, 0);
 
-        // skip self...
-        else if ((ii == i) && (jj == j))
-        {
-          test = 0;
+          if (top == size)
+          {
+            size *= 2;
+            stack = (int*)realloc(stack, sizeof(int) * size);
+          }
+          stack[top++] = jj * nx + ii;
         }
+      }    // end loop over ii
+    }   // end loop over jj
+  }
 
-        // if on grid, not nodata, and not self, test if [ii,jj] is D8 parent of [i,j]
-        else
-        {
-          test = ComputeTestParentD8(i, j, ii, jj, dem);
-        }
+  tfree(stack);
+}
 
-        // if [ii,jj] is a parent
-        // ...and Flint's Law DEM not already computed for [ii,jj] -- i.e., demflint(ii,jj)==-1111. (avoid infinite loop)
-        // ...then compute DEM and move upstream (RECURSIVE!)
-        if ((test == 1) && (*DataboxCoeff(demflint, ii, jj, 0) == -1111.0))
+
+/*-----------------------------------------------------------------------
+ * ComputeFlintsLawUpstream:
+ *
+ * Computes Flint's law elevations over all drainage networks of the grid.
+ * Nodata cells are set to -9999.0. Local minima (child==-9999.0) are set
+ * to their DEM elevation and every cell upstream of them that is still
+ * -1111.0 gets the elevation of its D8 child plus c*(A**p)*ds.
+ *
+ * This gives the same result as calling ComputeFlintsLawRec from every
+ * local minimum, but the D8 parents of all cells are found in one pass
+ * over the grid, so the cost is linear in the number of cells.
+ *
+ *---------------------------------------------------------------------*/
+void ComputeFlintsLawUpstream(
+                              Databox *dem,
+                              Databox *demflint,
+                              Databox *child,
+                              Databox *area,
+                              Databox *ds,
+                              double   c,
+                              double   p)
+{
+  int i, j, k;
+  int nx, ny, ncells;
+  int cell, parent, top;
+  int            *receiver;
+  int            *first;
+  int            *next;
+  int            *parents;
+  int            *stack;
+
+  nx = DataboxNx(dem);
+  ny = DataboxNy(dem);
+  ncells = nx * ny;
+
+  // D8 parents of each cell, stored as parents[first[cell] .. first[cell+1]-1]
+  receiver = talloc(int, ncells);
+  first = ctalloc(int, ncells + 1);
+  for (cell = 0; cell < ncells; cell++)
+  {
+    receiver[cell] = FlowReceiverD8(cell % nx, cell / nx, dem);
+    if (receiver[cell] >= 0)
+    {
+      first[receiver[cell] + 1]++;
+    }
+  }
+  for (cell = 0; cell < ncells; cell++)
+  {
+    first[cell + 1] += first[cell];
+  }
+
+  next = talloc(int, ncells);
+  parents = talloc(int, first[ncells]);
+  for (cell = 0; cell < ncells; cell++)
+  {
+    next[cell] = first[cell];
+  }
+  for (cell = 0; cell < ncells; cell++)
+  {
+    if (receiver[cell] >= 0)
+    {
+      parents[next[receiver[cell]]++] = cell;
+    }
+  }
+
+  // every cell has a single D8 child, so it is pushed at most once
+  stack = talloc(int, ncells);
+
+
+  for (j = 0; j < ny; j++)
+  {
+    for (i = 0; i < nx; i++)
+    {
+      // If original DEM elevation is -9999.0
+      // -- nodata cell (assumed to be ocean/estuary cell)
+      // -- set demflint to -9999.0
+      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
+      {
+        *DataboxCoeff(demflint, i, j, 0) = -9999.0;
+      }
+
+      // If child elevation is set to -9999.0...
+      // -- cell is a local minimum (no child)
+      // -- set demflint elevation to original DEM value
+      // -- then walk upstream to calculate parent elevations
+      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
+      {
+        *DataboxCoeff(demflint, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
+
+        top = 0;
+        stack[top++] = j * nx + i;
+        while (top > 0)
         {
-          // compute DEM...
-          *DataboxCoeff(demflint, ii, jj, 0) = *DataboxCoeff(demflint, i, j, 0) +
-                                               c * pow(*DataboxCoeff(area, ii, jj, 0), p) * *DataboxCoeff(ds, ii, jj, 0);
+          cell = stack[--top];
+          for (k = first[cell]; k < first[cell + 1]; k++)
+          {
+            parent = parents[k];
+            if (DataboxCoeffs(demflint)[parent] == -1111.0)
+            {
+              DataboxCoeffs(demflint)[parent] = DataboxCoeffs(demflint)[cell] +
+                                                c * pow(DataboxCoeffs(area)[parent], p) * DataboxCoeffs(ds)[parent];
+              stack[top++] = parent;
+            }
+          }
+        }
+      }
+    }   // end loop over i
+  }  // end loop over j
 
-          // recursive loop...
-          ComputeFlintsLawRec(ii, jj, dem, demflint, child, area, ds, c, p);
-        }     // end recursive if statement
-      }    // end loop over ii
-    }   // end loop over jj
-  }  // end if re: off grid
+  tfree(receiver);
+  tfree(first);
+  tfree(next);
+  tfree(parents);
+  tfree(stack);
 }
 
 
@@ -3807,33 +4607,7 @@ void ComputeFlintsLaw(
   }
 
   // compute elevations using Flint's law
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      // If original DEM elevation is -9999.0
-      // -- nodata cell (assumed to be ocean/estuary cell)
-      // -- set demflint to -9999.0
-      // -- continue loop
-      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
-      {
-        *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-      }
-
-      // If child elevation is set to -9999.0...
-      // -- cell is a local minimum (no child)
-      // -- set demflint elevation to original DEM value
-      // -- then loop upstream (recursively) to calculate parent elevations
-      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-      {
-        // set value at [i,j]
-        *DataboxCoeff(demflint, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
-
-        // call recursive function
-        ComputeFlintsLawRec(i, j, dem, demflint, child, area, ds, c, p);
-      }
-    }   // end loop over i
-  }  // end loop over j
+  ComputeFlintsLawUpstream(dem, demflint, child, area, ds, c, p);
 
   FreeDatabox(sx);
   FreeDatabox(sy);
@@ -4059,33 +4833,7 @@ void ComputeFlintsLawFit(
     }
   }
   // -- then call recursive loop
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      // If original DEM elevation is -9999.0
-      // -- nodata cell (assumed to be ocean/estuary cell)
-      // -- set demflint to -9999.0
-      // -- continue loop
-      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
-      {
-        *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-      }
-
-      // If child elevation is set to -9999.0...
-      // -- cell is a local minimum (no child)
-      // -- set demflint elevation to original DEM value
-      // -- then loop upstream (recursively) to calculate parent elevations
-      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-      {
-        // set value at [i,j]
-        *DataboxCoeff(demflint, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
-
-        // call recursive function
-        ComputeFlintsLawRec(i, j, dem, demflint, child, area, ds, ctry, ptry);
-      }
-    }   // end loop over i
-  }  // end loop over j
+  ComputeFlintsLawUpstream(dem, demflint, child, area, ds, ctry, ptry);
 
   printf("-------------------------------------------------------------\n");
   printf("Flints Law Fit: \n");
@@ -4120,35 +4868,7 @@ void ComputeFlintLM(
   ny = DataboxNy(dem);
 
   // Calculate Flints Law DEM using current parameter estimates
-  for (j = 0; j < ny; j++)
-  {
-    for (i = 0; i < nx; i++)
-    {
-      // If original DEM elevation is -9999.0
-      // -- nodata cell (assumed to be ocean/estuary cell)
-      // -- set demflint to -9999.0
-      // -- continue loop
-      //    (THIS IS THE SAME AS IN ComputeFlintsLaw)
-      if (*DataboxCoeff(dem, i, j, 0) == -9999.0)
-      {
-        *DataboxCoeff(demflint, i, j, 0) = -9999.0;
-      }
-
-      // If child elevation is set to -9999.0...
-      // -- cell is a local minimum (no child)
-      // -- set demflint elevation to original DEM value
-      // -- then loop upstream (recursively) to calculate parent elevations
-      //    (THIS IS THE SAME AS IN ComputeFlintsLaw)
-      else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-      {
-        // set value at [i,j]
-        *DataboxCoeff(demflint, i, j, 0) = *DataboxCoeff(dem, i, j, 0);
-
-        // call recursive function
-        ComputeFlintsLawRec(i, j, dem, demflint, child, area, ds, c, p);
-      }
-    }   // end loop over i
-  }  // end loop over j
+  ComputeFlintsLawUpstream(dem, demflint, child, area, ds, c, p);
 
   // Loop again to calculate derivatives
   for (j = 0; j < ny; j++)
@@ -4653,33 +5373,7 @@ void ComputeFlintsLawByBasin(
         }
 
         // -- then call recursive loop
-        for (j = 0; j < ny; j++)
-        {
-          for (i = 0; i < nx; i++)
-          {
-            // If original DEM elevation is -9999.0
-            // -- nodata cell (assumed to be ocean/estuary cell)
-            // -- set demflint to -9999.0
-            // -- continue loop
-            if (*DataboxCoeff(basin_in, i, j, 0) == -9999.0)
-            {
-              *DataboxCoeff(basin_out, i, j, 0) = -9999.0;
-            }
-
-            // If child elevation is set to -9999.0...
-            // -- cell is a local minimum (no child)
-            // -- set demflint elevation to original DEM value
-            // -- then loop upstream (recursively) to calculate parent elevations
-            else if (*DataboxCoeff(child, i, j, 0) == -9999.0)
-            {
-              // set value at [i,j]
-              *DataboxCoeff(basin_out, i, j, 0) = *DataboxCoeff(basin_in, i, j, 0);
-
-              // call recursive function
-              ComputeFlintsLawRec(i, j, basin_in, basin_out, child, area, ds, ctry, ptry);
-            }
-          }      // end loop over i
-        }     // end loop over j
+        ComputeFlintsLawUpstream(basin_in, basin_out, child, area, ds, ctry, ptry);
 
         // copy fitted values from basin_out to demflint
         for (j = 0; j < ny; j++)
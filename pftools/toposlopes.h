@@ -71,6 +71,12 @@ void ComputeUpstreamArea(
                          Databox *sy,
                          Databox *area);
 
+void ComputeUpstreamAreaSplit(
+                              Databox *dem,
+                              Databox *sx,
+                              Databox *sy,
+                              Databox *area);
+
 void ComputeFillFlats(
                       Databox *dem,
                       Databox *newdem);
@@ -79,6 +85,10 @@ int ComputePitFill(
                    Databox *dem,
                    double   dpit);
 
+int ComputePriorityFloodFill(
+                             Databox *dem,
+                             double   epsilon);
+
 int ComputeMovingAvg(
                      Databox *dem,
                      double   wsize);
@@ -114,6 +124,15 @@ void ComputeFlintsLawRec(
                          double   c,
                          double   p);
 
+void ComputeFlintsLawUpstream(
+                              Databox *dem,
+                              Databox *demflint,
+                              Databox *child,
+                              Databox *area,
+                              Databox *ds,
+                              double   c,
+                              double   p);
+
 void ComputeFlintsLaw(
                       Databox *dem,
                       double   c,
@@ -0,0 +1,274 @@
+#  Infiltration into a dry column with the Adaptive time step.  The top
+#  boundary switches between rain and recession, so the controller has
+#  to shrink the step when the wetting front makes the Newton solve
+#  harder and must still land exactly on every boundary condition
+#  transition.  The time step log is checked for those properties.
+
+set tcl_precision 17
+
+set runname adaptive_timestep
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+pfset FileVersion 4
+
+pfset Process.Topology.P        [lindex $argv 0]
+pfset Process.Topology.Q        [lindex $argv 1]
+pfset Process.Topology.R        [lindex $argv 2]
+
+#---------------------------------------------------------
+# Computational Grid
+#---------------------------------------------------------
+pfset ComputationalGrid.Lower.X                0.0
+pfset ComputationalGrid.Lower.Y                0.0
+pfset ComputationalGrid.Lower.Z                0.0
+
+pfset ComputationalGrid.DX                     1.0
+pfset ComputationalGrid.DY                     1.0
+pfset ComputationalGrid.DZ                     0.1
+
+pfset ComputationalGrid.NX                     2
+pfset ComputationalGrid.NY                     2
+pfset ComputationalGrid.NZ                     40
+
+#---------------------------------------------------------
+# Domain Geometry
+#---------------------------------------------------------
+pfset GeomInput.Names                          "domain_input"
+
+pfset GeomInput.domain_input.InputType         Box
+pfset GeomInput.domain_input.GeomName          domain
+
+pfset Geom.domain.Lower.X                      0.0
+pfset Geom.domain.Lower.Y                      0.0
+pfset Geom.domain.Lower.Z                      0.0
+
+pfset Geom.domain.Upper.X                      2.0
+pfset Geom.domain.Upper.Y                      2.0
+pfset Geom.domain.Upper.Z                      4.0
+
+pfset Geom.domain.Patches "left right front back bottom top"
+
+#-----------------------------------------------------------------------------
+# Subsurface properties
+#-----------------------------------------------------------------------------
+pfset Geom.Perm.Names                          "domain"
+pfset Geom.domain.Perm.Type                    Constant
+pfset Geom.domain.Perm.Value                   0.5
+
+pfset Perm.TensorType                          TensorByGeom
+pfset Geom.Perm.TensorByGeom.Names             "domain"
+pfset Geom.domain.Perm.TensorValX              1.0
+pfset Geom.domain.Perm.TensorValY              1.0
+pfset Geom.domain.Perm.TensorValZ              1.0
+
+pfset SpecificStorage.Type                     Constant
+pfset SpecificStorage.GeomNames                "domain"
+pfset Geom.domain.SpecificStorage.Value        1.0e-4
+
+pfset Geom.Porosity.GeomNames                  "domain"
+pfset Geom.domain.Porosity.Type                Constant
+pfset Geom.domain.Porosity.Value               0.4
+
+pfset Phase.RelPerm.Type                       VanGenuchten
+pfset Phase.RelPerm.GeomNames                  "domain"
+pfset Geom.domain.RelPerm.Alpha                3.5
+pfset Geom.domain.RelPerm.N                    2.0
+
+pfset Phase.Saturation.Type                    VanGenuchten
+pfset Phase.Saturation.GeomNames               "domain"
+pfset Geom.domain.Saturation.Alpha             3.5
+pfset Geom.domain.Saturation.N                 2.0
+pfset Geom.domain.Saturation.SRes              0.1
+pfset Geom.domain.Saturation.SSat              1.0
+
+#-----------------------------------------------------------------------------
+# Phases, contaminants, gravity
+#-----------------------------------------------------------------------------
+pfset Phase.Names                              "water"
+pfset Phase.water.Density.Type                 Constant
+pfset Phase.water.Density.Value                1.0
+pfset Phase.water.Viscosity.Type               Constant
+pfset Phase.water.Viscosity.Value              1.0
+
+pfset Contaminants.Names                       ""
+pfset Geom.Retardation.GeomNames               ""
+pfset Gravity                                  1.0
+
+pfset Domain.GeomName                          domain
+
+pfset Wells.Names                              ""
+
+#-----------------------------------------------------------------------------
+# Timing: adaptive steps, rain for 3 and recession for 5 time units
+#-----------------------------------------------------------------------------
+pfset TimingInfo.BaseUnit                      1.0
+pfset TimingInfo.StartCount                    0
+pfset TimingInfo.StartTime                     0.0
+pfset TimingInfo.StopTime                      10.0
+pfset TimingInfo.DumpInterval                  -1
+
+pfset TimeStep.Type                            Adaptive
+pfset TimeStep.InitialStep                     0.01
+pfset TimeStep.MinStep                         0.0001
+pfset TimeStep.MaxStep                         1.0
+
+pfset Cycle.Names                              "constant rainrec"
+pfset Cycle.constant.Names                     "alltime"
+pfset Cycle.constant.alltime.Length            1
+pfset Cycle.constant.Repeat                    -1
+
+pfset Cycle.rainrec.Names                      "rain rec"
+pfset Cycle.rainrec.rain.Length                3
+pfset Cycle.rainrec.rec.Length                 5
+pfset Cycle.rainrec.Repeat                     -1
+
+#-----------------------------------------------------------------------------
+# Boundary Conditions: Pressure
+#-----------------------------------------------------------------------------
+pfset BCPressure.PatchNames                    "left right front back bottom top"
+
+foreach patch "left right front back bottom" {
+    pfset Patch.$patch.BCPressure.Type           FluxConst
+    pfset Patch.$patch.BCPressure.Cycle          "constant"
+    pfset Patch.$patch.BCPressure.alltime.Value  0.0
+}
+
+pfset Patch.top.BCPressure.Type                FluxConst
+pfset Patch.top.BCPressure.Cycle               "rainrec"
+pfset Patch.top.BCPressure.rain.Value          -0.1
+pfset Patch.top.BCPressure.rec.Value           0.0
+
+pfset TopoSlopesX.Type                         "Constant"
+pfset TopoSlopesX.GeomNames                    ""
+pfset TopoSlopesY.Type                         "Constant"
+pfset TopoSlopesY.GeomNames                    ""
+
+pfset Mannings.Type                            "Constant"
+pfset Mannings.GeomNames                       ""
+
+#---------------------------------------------------------
+# Initial conditions: dry column
+#---------------------------------------------------------
+pfset ICPressure.Type                          HydroStaticPatch
+pfset ICPressure.GeomNames                     domain
+pfset Geom.domain.ICPressure.Value             -4.0
+pfset Geom.domain.ICPressure.RefGeom           domain
+pfset Geom.domain.ICPressure.RefPatch          top
+
+pfset PhaseSources.water.Type                  Constant
+pfset PhaseSources.water.GeomNames             domain
+pfset PhaseSources.water.Geom.domain.Value     0.0
+
+pfset KnownSolution                            NoKnownSolution
+
+#-----------------------------------------------------------------------------
+# Set solver parameters
+#-----------------------------------------------------------------------------
+pfset Solver                                   Richards
+pfset Solver.MaxIter                           10000
+
+pfset Solver.Nonlinear.MaxIter                 15
+pfset Solver.Nonlinear.ResidualTol             1e-9
+pfset Solver.Nonlinear.EtaChoice               EtaConstant
+pfset Solver.Nonlinear.EtaValue                1e-5
+pfset Solver.Nonlinear.UseJacobian             True
+pfset Solver.Nonlinear.DerivativeEpsilon       1e-8
+
+pfset Solver.Linear.KrylovDimension            20
+pfset Solver.Linear.Preconditioner             MGSemi
+
+pfset Solver.PrintSubsurf                      False
+pfset Solver.PrintPressure                     False
+pfset Solver.PrintSaturation                   False
+
+#-----------------------------------------------------------------------------
+# Run and Unload the ParFlow output files
+#-----------------------------------------------------------------------------
+pfrun $runname
+pfundist $runname
+
+#
+# Tests
+#
+set passed 1
+
+set min_step    [pfget TimeStep.MinStep]
+set max_step    [pfget TimeStep.MaxStep]
+set stop_time   [pfget TimingInfo.StopTime]
+set transitions "3.0 8.0"
+set eps         1.0e-8
+
+# Read the time step table from the log file
+set times ""
+set steps ""
+set infos ""
+set file [open $runname.out.log r]
+set in_table 0
+while {[gets $file line] >= 0} {
+    if {[string match "----------   *" $line]} {
+        set in_table 1
+        continue
+    }
+    if {$in_table} {
+        if {[scan $line "%d %g %g %c" seq time dt info] != 4} {
+            break
+        }
+        if {$seq > 0} {
+            lappend times $time
+            lappend steps $dt
+            lappend infos [format %c $info]
+        }
+    }
+}
+close $file
+
+if {[llength $times] == 0} {
+    puts "No time steps found in $runname.out.log"
+    set passed 0
+} {
+    if {abs([lindex $times end] - $stop_time) > $eps} {
+        puts "Run stopped at [lindex $times end] instead of $stop_time"
+        set passed 0
+    }
+}
+
+set max_taken 0.0
+set prev_time 0.0
+foreach time $times dt $steps info $infos {
+    if {$dt > $max_step + $eps} {
+        puts "Step $dt at time $time is larger than TimeStep.MaxStep"
+        set passed 0
+    }
+    if {$dt < $min_step - $eps && $info == "p"} {
+        puts "Step $dt at time $time is smaller than TimeStep.MinStep"
+        set passed 0
+    }
+    foreach transition $transitions {
+        if {$prev_time < $transition - $eps && $time > $transition + $eps} {
+            puts "Step from $prev_time to $time crosses the BC transition at $transition"
+            set passed 0
+        }
+    }
+    if {$dt > $max_taken} {
+        set max_taken $dt
+    }
+    set prev_time $time
+}
+
+# The controller must have grown the step well past the initial one
+if {$max_taken < 10.0 * [pfget TimeStep.InitialStep]} {
+    puts "Largest step $max_taken did not grow from the initial step"
+    set passed 0
+}
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
@@ -0,0 +1,284 @@
+#  FluxFile boundary conditions on a repeating time cycle.  The top
+#  flux of a column follows a four interval cycle given by one PFB file
+#  per interval.  The files are distributed for a different process
+#  topology than the run and only their top layer holds the flux, so the
+#  patch cells must be picked out of the files by position.  The run is
+#  compared with the same cycle given by FluxConst values, once with the
+#  default cache and once with a cache holding only two intervals.
+
+set tcl_precision 17
+
+set runname bc_flux_file_cycle
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+pfset FileVersion 4
+
+pfset Process.Topology.P        [lindex $argv 0]
+pfset Process.Topology.Q        [lindex $argv 1]
+pfset Process.Topology.R        [lindex $argv 2]
+
+#---------------------------------------------------------
+# Computational Grid
+#---------------------------------------------------------
+pfset ComputationalGrid.Lower.X                0.0
+pfset ComputationalGrid.Lower.Y                0.0
+pfset ComputationalGrid.Lower.Z                0.0
+
+pfset ComputationalGrid.DX                     1.0
+pfset ComputationalGrid.DY                     1.0
+pfset ComputationalGrid.DZ                     0.2
+
+pfset ComputationalGrid.NX                     4
+pfset ComputationalGrid.NY                     4
+pfset ComputationalGrid.NZ                     10
+
+#---------------------------------------------------------
+# Domain Geometry
+#---------------------------------------------------------
+pfset GeomInput.Names                          "domain_input"
+
+pfset GeomInput.domain_input.InputType         Box
+pfset GeomInput.domain_input.GeomName          domain
+
+pfset Geom.domain.Lower.X                      0.0
+pfset Geom.domain.Lower.Y                      0.0
+pfset Geom.domain.Lower.Z                      0.0
+
+pfset Geom.domain.Upper.X                      4.0
+pfset Geom.domain.Upper.Y                      4.0
+pfset Geom.domain.Upper.Z                      2.0
+
+pfset Geom.domain.Patches "left right front back bottom top"
+
+#-----------------------------------------------------------------------------
+# Subsurface properties
+#-----------------------------------------------------------------------------
+pfset Geom.Perm.Names                          "domain"
+pfset Geom.domain.Perm.Type                    Constant
+pfset Geom.domain.Perm.Value                   0.5
+
+pfset Perm.TensorType                          TensorByGeom
+pfset Geom.Perm.TensorByGeom.Names             "domain"
+pfset Geom.domain.Perm.TensorValX              1.0
+pfset Geom.domain.Perm.TensorValY              1.0
+pfset Geom.domain.Perm.TensorValZ              1.0
+
+pfset SpecificStorage.Type                     Constant
+pfset SpecificStorage.GeomNames                "domain"
+pfset Geom.domain.SpecificStorage.Value        1.0e-4
+
+pfset Geom.Porosity.GeomNames                  "domain"
+pfset Geom.domain.Porosity.Type                Constant
+pfset Geom.domain.Porosity.Value               0.4
+
+pfset Phase.RelPerm.Type                       VanGenuchten
+pfset Phase.RelPerm.GeomNames                  "domain"
+pfset Geom.domain.RelPerm.Alpha                3.5
+pfset Geom.domain.RelPerm.N                    2.0
+
+pfset Phase.Saturation.Type                    VanGenuchten
+pfset Phase.Saturation.GeomNames               "domain"
+pfset Geom.domain.Saturation.Alpha             3.5
+pfset Geom.domain.Saturation.N                 2.0
+pfset Geom.domain.Saturation.SRes              0.1
+pfset Geom.domain.Saturation.SSat              1.0
+
+#-----------------------------------------------------------------------------
+# Phases, contaminants, gravity
+#-----------------------------------------------------------------------------
+pfset Phase.Names                              "water"
+pfset Phase.water.Density.Type                 Constant
+pfset Phase.water.Density.Value                1.0
+pfset Phase.water.Viscosity.Type               Constant
+pfset Phase.water.Viscosity.Value              1.0
+
+pfset Contaminants.Names                       ""
+pfset Geom.Retardation.GeomNames               ""
+pfset Gravity                                  1.0
+
+pfset Domain.GeomName                          domain
+
+pfset Wells.Names                              ""
+
+#-----------------------------------------------------------------------------
+# Timing: a cycle of four unit intervals repeated three times
+#-----------------------------------------------------------------------------
+pfset TimingInfo.BaseUnit                      1.0
+pfset TimingInfo.StartCount                    0
+pfset TimingInfo.StartTime                     0.0
+pfset TimingInfo.StopTime                      12.0
+pfset TimingInfo.DumpInterval                  1.0
+
+pfset TimeStep.Type                            Constant
+pfset TimeStep.Value                           0.25
+
+set intervals "wet1 dry1 wet2 dry2"
+set fluxes    "-0.05 0.0 -0.02 0.01"
+
+pfset Cycle.Names                              "constant rainrec"
+pfset Cycle.constant.Names                     "alltime"
+pfset Cycle.constant.alltime.Length            1
+pfset Cycle.constant.Repeat                    -1
+
+pfset Cycle.rainrec.Names                      $intervals
+foreach interval $intervals {
+    pfset Cycle.rainrec.$interval.Length       1
+}
+pfset Cycle.rainrec.Repeat                     -1
+
+#-----------------------------------------------------------------------------
+# Boundary Conditions: Pressure
+#-----------------------------------------------------------------------------
+pfset BCPressure.PatchNames                    "left right front back bottom top"
+
+foreach patch "left right front back bottom" {
+    pfset Patch.$patch.BCPressure.Type           FluxConst
+    pfset Patch.$patch.BCPressure.Cycle          "constant"
+    pfset Patch.$patch.BCPressure.alltime.Value  0.0
+}
+
+pfset Patch.top.BCPressure.Type                FluxConst
+pfset Patch.top.BCPressure.Cycle               "rainrec"
+foreach interval $intervals flux $fluxes {
+    pfset Patch.top.BCPressure.$interval.Value $flux
+}
+
+pfset TopoSlopesX.Type                         "Constant"
+pfset TopoSlopesX.GeomNames                    ""
+pfset TopoSlopesY.Type                         "Constant"
+pfset TopoSlopesY.GeomNames                    ""
+
+pfset Mannings.Type                            "Constant"
+pfset Mannings.GeomNames                       ""
+
+#---------------------------------------------------------
+# Initial conditions: dry column
+#---------------------------------------------------------
+pfset ICPressure.Type                          HydroStaticPatch
+pfset ICPressure.GeomNames                     domain
+pfset Geom.domain.ICPressure.Value             -2.0
+pfset Geom.domain.ICPressure.RefGeom           domain
+pfset Geom.domain.ICPressure.RefPatch          top
+
+pfset PhaseSources.water.Type                  Constant
+pfset PhaseSources.water.GeomNames             domain
+pfset PhaseSources.water.Geom.domain.Value     0.0
+
+pfset KnownSolution                            NoKnownSolution
+
+#-----------------------------------------------------------------------------
+# Set solver parameters
+#-----------------------------------------------------------------------------
+pfset Solver                                   Richards
+pfset Solver.MaxIter                           10000
+
+pfset Solver.Nonlinear.MaxIter                 15
+pfset Solver.Nonlinear.ResidualTol             1e-9
+pfset Solver.Nonlinear.EtaChoice               EtaConstant
+pfset Solver.Nonlinear.EtaValue                1e-5
+pfset Solver.Nonlinear.UseJacobian             True
+pfset Solver.Nonlinear.DerivativeEpsilon       1e-8
+
+pfset Solver.Linear.KrylovDimension            20
+pfset Solver.Linear.Preconditioner             MGSemi
+
+pfset Solver.PrintSubsurf                      False
+pfset Solver.PrintPressure                     True
+pfset Solver.PrintSaturation                   True
+
+#-----------------------------------------------------------------------------
+# Reference run with FluxConst values
+#-----------------------------------------------------------------------------
+pfrun $runname
+pfundist $runname
+
+source pftest.tcl
+set passed 1
+
+set reference_dir flux_file_cycle_reference
+file delete -force $reference_dir
+file mkdir $reference_dir
+
+set outputs [lsort [glob $runname.out.press.*.pfb $runname.out.satur.*.pfb]]
+foreach output $outputs {
+    file copy $output $reference_dir
+}
+
+#-----------------------------------------------------------------------------
+# Write one flux file per interval.  Cells below the top layer hold a flux
+# that would flood the column if it were applied.
+#-----------------------------------------------------------------------------
+proc write_flux_file {filename nx ny nz dx dy dz flux} {
+    set file [open $filename w]
+    fconfigure $file -translation binary
+    puts -nonewline $file [binary format QQQIIIQQQI 0.0 0.0 0.0 \
+                               $nx $ny $nz $dx $dy $dz 1]
+    puts -nonewline $file [binary format IIIIIIIII 0 0 0 $nx $ny $nz 1 1 1]
+    for {set k 0} {$k < $nz} {incr k} {
+        if {$k == $nz - 1} {
+            set value $flux
+        } {
+            set value -1000.0
+        }
+        for {set n 0} {$n < $nx * $ny} {incr n} {
+            puts -nonewline $file [binary format Q $value]
+        }
+    }
+    close $file
+}
+
+pfset Process.Topology.P        [lindex $argv 1]
+pfset Process.Topology.Q        [lindex $argv 0]
+
+foreach interval $intervals flux $fluxes {
+    set filename flux_cycle.$interval.pfb
+    write_flux_file $filename \
+        [pfget ComputationalGrid.NX] [pfget ComputationalGrid.NY] \
+        [pfget ComputationalGrid.NZ] [pfget ComputationalGrid.DX] \
+        [pfget ComputationalGrid.DY] [pfget ComputationalGrid.DZ] $flux
+    pfdist $filename
+
+    pfset Patch.top.BCPressure.Type                  FluxFile
+    pfset Patch.top.BCPressure.$interval.FileName    $filename
+}
+
+pfset Process.Topology.P        [lindex $argv 0]
+pfset Process.Topology.Q        [lindex $argv 1]
+
+#-----------------------------------------------------------------------------
+# Run with the flux files, with the default cache and with a cache that
+# has to drop intervals and read them again on every repeat
+#-----------------------------------------------------------------------------
+foreach cache_size "32 2" {
+    pfset BCPressure.FileCacheSize $cache_size
+
+    foreach output $outputs {
+        file delete $output
+    }
+
+    pfrun $runname
+    pfundist $runname
+
+    foreach output $outputs {
+        if ![pftestFile $output "Max difference in $output with cache size $cache_size" \
+                 $sig_digits $reference_dir] {
+            set passed 0
+        }
+    }
+}
+
+foreach interval $intervals {
+    file delete flux_cycle.$interval.pfb flux_cycle.$interval.pfb.dist
+}
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
@@ -0,0 +1,315 @@
+#
+# Shared CLM restart (Solver.CLM.SingleFileRST).  The CLM test case is
+# run for 5 hours, writing one restart PFB per step, and restarted from
+# the step 3 restart on the same process topology and on the transposed
+# one.  Both restarted runs must give the same pressure, saturation and
+# CLM output.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname clm_single_rst
+
+#-----------------------------------------------------------------------------
+# File input version number
+#-----------------------------------------------------------------------------
+pfset FileVersion 4
+
+#-----------------------------------------------------------------------------
+# Process Topology
+#-----------------------------------------------------------------------------
+
+pfset Process.Topology.P        [lindex $argv 0]
+pfset Process.Topology.Q        [lindex $argv 1]
+pfset Process.Topology.R        [lindex $argv 2]
+
+#-----------------------------------------------------------------------------
+# Computational Grid
+#-----------------------------------------------------------------------------
+pfset ComputationalGrid.Lower.X                0.0
+pfset ComputationalGrid.Lower.Y                0.0
+pfset ComputationalGrid.Lower.Z                0.0
+
+pfset ComputationalGrid.DX                     1000.
+pfset ComputationalGrid.DY                     1000.
+pfset ComputationalGrid.DZ                     0.5
+
+pfset ComputationalGrid.NX                     5
+pfset ComputationalGrid.NY                     5
+pfset ComputationalGrid.NZ                     10
+
+#-----------------------------------------------------------------------------
+# Domain
+#-----------------------------------------------------------------------------
+pfset GeomInput.Names                          "domain_input"
+pfset GeomInput.domain_input.InputType         Box
+pfset GeomInput.domain_input.GeomName          domain
+
+pfset Geom.domain.Lower.X                      0.0
+pfset Geom.domain.Lower.Y                      0.0
+pfset Geom.domain.Lower.Z                      0.0
+
+pfset Geom.domain.Upper.X                      5000.
+pfset Geom.domain.Upper.Y                      5000.
+pfset Geom.domain.Upper.Z                      5.
+
+pfset Geom.domain.Patches  "x-lower x-upper y-lower y-upper z-lower z-upper"
+
+pfset Domain.GeomName                          domain
+
+#-----------------------------------------------------------------------------
+# Subsurface properties
+#-----------------------------------------------------------------------------
+pfset Geom.Perm.Names                          "domain"
+pfset Geom.domain.Perm.Type                    Constant
+pfset Geom.domain.Perm.Value                   0.2
+
+pfset Perm.TensorType                          TensorByGeom
+pfset Geom.Perm.TensorByGeom.Names             "domain"
+pfset Geom.domain.Perm.TensorValX              1.0
+pfset Geom.domain.Perm.TensorValY              1.0
+pfset Geom.domain.Perm.TensorValZ              1.0
+
+pfset SpecificStorage.Type                     Constant
+pfset SpecificStorage.GeomNames                "domain"
+pfset Geom.domain.SpecificStorage.Value        1.0e-6
+
+pfset Geom.Porosity.GeomNames                  domain
+pfset Geom.domain.Porosity.Type                Constant
+pfset Geom.domain.Porosity.Value               0.390
+
+pfset Phase.Names                              "water"
+pfset Phase.water.Density.Type                 Constant
+pfset Phase.water.Density.Value                1.0
+pfset Phase.water.Viscosity.Type               Constant
+pfset Phase.water.Viscosity.Value               1.0
+pfset Phase.water.Mobility.Type                Constant
+pfset Phase.water.Mobility.Value               1.0
+
+pfset Contaminants.Names                       ""
+pfset Gravity                                  1.0
+
+pfset Phase.RelPerm.Type                       VanGenuchten
+pfset Phase.RelPerm.GeomNames                  "domain"
+pfset Geom.domain.RelPerm.Alpha                3.5
+pfset Geom.domain.RelPerm.N                    2.
+
+pfset Phase.Saturation.Type                    VanGenuchten
+pfset Phase.Saturation.GeomNames               "domain"
+pfset Geom.domain.Saturation.Alpha             3.5
+pfset Geom.domain.Saturation.N                 2.
+pfset Geom.domain.Saturation.SRes              0.01
+pfset Geom.domain.Saturation.SSat              1.0
+
+pfset Wells.Names                              ""
+
+pfset PhaseSources.water.Type                  Constant
+pfset PhaseSources.water.GeomNames             domain
+pfset PhaseSources.water.Geom.domain.Value     0.0
+
+pfset KnownSolution                            NoKnownSolution
+
+#-----------------------------------------------------------------------------
+# Timing: hourly steps, one CLM restart per step
+#-----------------------------------------------------------------------------
+pfset TimingInfo.BaseUnit                      1.0
+pfset TimingInfo.StartCount                    0
+pfset TimingInfo.StartTime                     0.0
+pfset TimingInfo.StopTime                      5
+pfset TimingInfo.DumpInterval                  -1
+pfset TimeStep.Type                            Constant
+pfset TimeStep.Value                           1.0
+
+pfset Cycle.Names                              constant
+pfset Cycle.constant.Names                     "alltime"
+pfset Cycle.constant.alltime.Length            1
+pfset Cycle.constant.Repeat                    -1
+
+#-----------------------------------------------------------------------------
+# Boundary conditions: no flow sides and bottom, overland flow on top
+#-----------------------------------------------------------------------------
+pfset BCPressure.PatchNames                    [pfget Geom.domain.Patches]
+
+foreach patch "x-lower x-upper y-lower y-upper z-lower" {
+    pfset Patch.$patch.BCPressure.Type             FluxConst
+    pfset Patch.$patch.BCPressure.Cycle            "constant"
+    pfset Patch.$patch.BCPressure.alltime.Value    0.0
+}
+
+pfset Patch.z-upper.BCPressure.Type            OverlandFlow
+pfset Patch.z-upper.BCPressure.Cycle           "constant"
+pfset Patch.z-upper.BCPressure.alltime.Value   0.0
+
+pfset TopoSlopesX.Type                         "Constant"
+pfset TopoSlopesX.GeomNames                    "domain"
+pfset TopoSlopesX.Geom.domain.Value            -0.001
+
+pfset TopoSlopesY.Type                         "Constant"
+pfset TopoSlopesY.GeomNames                    "domain"
+pfset TopoSlopesY.Geom.domain.Value            0.001
+
+pfset Mannings.Type                            "Constant"
+pfset Mannings.GeomNames                       "domain"
+pfset Mannings.Geom.domain.Value               5.52e-6
+
+#-----------------------------------------------------------------------------
+# Solver
+#-----------------------------------------------------------------------------
+pfset Solver                                   Richards
+pfset Solver.MaxIter                           500
+
+pfset Solver.Nonlinear.MaxIter                 15
+pfset Solver.Nonlinear.ResidualTol             1e-9
+pfset Solver.Nonlinear.EtaChoice               EtaConstant
+pfset Solver.Nonlinear.EtaValue                0.01
+pfset Solver.Nonlinear.UseJacobian             True
+pfset Solver.Nonlinear.StepTol                 1e-20
+pfset Solver.Nonlinear.Globalization           LineSearch
+pfset Solver.Linear.KrylovDimension            15
+pfset Solver.Linear.MaxRestart                 2
+
+pfset Solver.Linear.Preconditioner             MGSemi
+pfset Solver.PrintSubsurf                      False
+pfset Solver.Drop                              1E-20
+pfset Solver.AbsTol                            1E-9
+
+pfset Solver.LSM                               CLM
+pfset Solver.CLM.MetForcing                    1D
+pfset Solver.CLM.MetFileName                   narr_1hr.sc3.txt.0
+pfset Solver.CLM.MetFilePath                   ./
+pfset Solver.CLM.IstepStart                    1
+
+pfset Solver.CLM.DailyRST                      False
+pfset Solver.CLM.SingleFileRST                 True
+
+pfset Solver.PrintCLM                          True
+pfset Solver.CLM.SingleFile                    True
+pfset Solver.WriteCLMBinary                    False
+pfset Solver.CLM.WriteLogs                     False
+
+#-----------------------------------------------------------------------------
+# Initial conditions: water pressure
+#-----------------------------------------------------------------------------
+pfset ICPressure.Type                          HydroStaticPatch
+pfset ICPressure.GeomNames                     domain
+pfset Geom.domain.ICPressure.Value             -2.0
+pfset Geom.domain.ICPressure.RefGeom           domain
+pfset Geom.domain.ICPressure.RefPatch          z-upper
+
+#-----------------------------------------------------------------------------
+# CLM driver files for each process; restart selects the CLM restart as
+# start time and initial condition source
+#-----------------------------------------------------------------------------
+proc WriteCLMInput {restart} {
+    set num_processors [expr [pfget Process.Topology.P] * [pfget Process.Topology.Q] * [pfget Process.Topology.R]]
+
+    set file [open drv_clmin.dat r]
+    set clmin [read $file]
+    close $file
+
+    if $restart {
+	regsub -line {^startcode(\s+)2} $clmin {startcode\11} clmin
+	regsub -line {^clm_ic(\s+)2} $clmin {clm_ic\11} clmin
+    }
+
+    for {set i 0} {$i <= $num_processors} {incr i} {
+	file delete drv_vegm.dat.$i
+	file copy drv_vegm.dat drv_vegm.dat.$i
+	set file [open drv_clmin.dat.$i w]
+	puts -nonewline $file $clmin
+	close $file
+    }
+}
+
+#-----------------------------------------------------------------------------
+# Restart from the CLM restart of restart_step on a P x Q x R grid
+#-----------------------------------------------------------------------------
+proc RestartRun {runname restart_step P Q R} {
+    pfset Process.Topology.P                   $P
+    pfset Process.Topology.Q                   $Q
+    pfset Process.Topology.R                   $R
+
+    pfset TimingInfo.StartCount                $restart_step
+    pfset TimingInfo.StartTime                 $restart_step.0
+    pfset Solver.CLM.IstepStart                [expr $restart_step + 1]
+
+    pfset ICPressure.Type                      PFBFile
+    pfset Geom.domain.ICPressure.FileName      [format "%s.out.press.%05d.pfb" $runname $restart_step]
+    pfdist [pfget Geom.domain.ICPressure.FileName]
+
+    WriteCLMInput 1
+    pfrun $runname
+    pfundist $runname
+}
+
+#-----------------------------------------------------------------------------
+# Run to the end, writing the shared CLM restarts
+#-----------------------------------------------------------------------------
+file delete {*}[glob -nocomplain $runname.out.*]
+
+WriteCLMInput 0
+pfrun $runname
+pfundist $runname
+
+source ../pftest.tcl
+set passed 1
+
+set restart_step 3
+set last_step 5
+
+set restart [format "%s.out.clm_rst.%05d.pfb" $runname $restart_step]
+if ![file exists $restart] {
+    puts "FAILED : CLM restart <$restart> not created"
+    set passed 0
+}
+
+set outputs {}
+for {set i [expr $restart_step + 1]} {$i <= $last_step} {incr i} {
+    set i_string [format "%05d" $i]
+    lappend outputs $runname.out.press.$i_string.pfb
+    lappend outputs $runname.out.satur.$i_string.pfb
+    lappend outputs $runname.out.clm_output.$i_string.C.pfb
+}
+
+#-----------------------------------------------------------------------------
+# Restart on the process grid that wrote the restart; its outputs are the
+# reference.  A CLM restart does not hold every CLM state, so a restarted
+# run is compared with another restarted run rather than the first run.
+#-----------------------------------------------------------------------------
+RestartRun $runname $restart_step [lindex $argv 0] [lindex $argv 1] [lindex $argv 2]
+
+set reference_dir clm_single_rst_reference
+file delete -force $reference_dir
+file mkdir $reference_dir
+
+foreach output $outputs {
+    if [file exists $output] {
+	file copy $output $reference_dir
+	file delete $output
+    } {
+	puts "FAILED : output file <$output> not created"
+	set passed 0
+    }
+}
+
+#-----------------------------------------------------------------------------
+# Restart again with the process topology transposed
+#-----------------------------------------------------------------------------
+RestartRun $runname $restart_step [lindex $argv 1] [lindex $argv 0] [lindex $argv 2]
+
+foreach output $outputs {
+    if ![pftestFile $output "Max difference in $output" $sig_digits $reference_dir] {
+	set passed 0
+    }
+}
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
@@ -553,6 +553,31 @@ pfrun $runname
 pfundist $runname
 check_output $runname
 
+#-----------------------------------------------------------------------------
+# Walker2 with CGS2 orthogonalization, checked against the Walker2 results
+#-----------------------------------------------------------------------------
+
+puts "Running Walker2 with CGS2"
+
+pfset Solver.Linear.Orthogonalization                    CGS2
+
+pfrun $runname
+pfundist $runname
+check_output $runname
+
+#-----------------------------------------------------------------------------
+# Walker2 with few clustering boxes, checked against the Walker2 results;
+# loops over the crater geometry fall back to traversing the octree
+#-----------------------------------------------------------------------------
+
+puts "Running Walker2 with Clustering.MaxBoxes"
+
+pfset Clustering.MaxBoxes                                2
+
+pfrun $runname
+pfundist $runname
+check_output $runname
+
 if $passed {
     puts "creater2D : PASSED"
 } {
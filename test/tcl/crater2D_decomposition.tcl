@@ -0,0 +1,45 @@
+#  This runs the crater2D_vangtable_spline problem on a decomposition
+#  that balances the active cells of the crater, read from its domain
+#  mask; the results must match the crater2D_vangtable_spline correct
+#  output.
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set crater2D_setup_only 1
+source crater2D_vangtable_spline.tcl
+
+set runname  crater2D_decomposition
+
+pfset Process.Topology.P        [lindex $argv 0]
+pfset Process.Topology.Q        [lindex $argv 1]
+pfset Process.Topology.R        [lindex $argv 2]
+
+pfset Process.Decomposition.Method      Mask
+pfset Process.Decomposition.FileName    ../correct_output/crater2D_vangtable_spline.out.mask.pfb
+
+#-----------------------------------------------------------------------------
+# Run and Unload the ParFlow output files
+#-----------------------------------------------------------------------------
+pfrun $runname
+pfundist $runname
+
+#
+# Tests
+#
+source pftest.tcl
+set sig_digits 5
+
+set correct_output_dir [crater2DCorrectOutput $runname]
+set passed [crater2DTest $runname $sig_digits $correct_output_dir]
+file delete -force $correct_output_dir
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
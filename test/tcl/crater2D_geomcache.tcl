@@ -0,0 +1,58 @@
+#  This runs the crater2D_vangtable_spline problem twice with the
+#  geometry cache enabled; the first run writes the cache and the second
+#  reads the solid back from it.  Both runs must match the
+#  crater2D_vangtable_spline correct output.
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set crater2D_setup_only 1
+source crater2D_vangtable_spline.tcl
+
+set runname  crater2D_geomcache
+
+#-----------------------------------------------------------------------------
+# Cache the solid octrees between the two runs
+#-----------------------------------------------------------------------------
+set cache_dir                                            $runname.cache
+file delete -force $cache_dir
+
+pfset GeomCache.Directory                                $cache_dir
+
+#-----------------------------------------------------------------------------
+# Run and Unload the ParFlow output files, writing and then reading the cache
+#-----------------------------------------------------------------------------
+source pftest.tcl
+set sig_digits 5
+
+set passed 1
+
+set correct_output_dir [crater2DCorrectOutput $runname]
+
+foreach pass "write read" {
+    pfrun $runname
+    pfundist $runname
+
+    if ![crater2DTest $runname $sig_digits $correct_output_dir] {
+	puts "FAILED : geometry cache $pass run"
+	set passed 0
+    }
+}
+
+file delete -force $correct_output_dir
+
+if {[llength [glob -nocomplain $cache_dir/*.pfgc]] == 0} {
+    puts "FAILED : no geometry cache files were written to $cache_dir"
+    set passed 0
+}
+file delete -force $cache_dir
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
@@ -0,0 +1,46 @@
+#  This runs the crater2D_vangtable_spline problem with the solid read
+#  from the binary .pfsolb file format; the results must match the
+#  crater2D_vangtable_spline correct output.
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set crater2D_setup_only 1
+source crater2D_vangtable_spline.tcl
+
+set runname  crater2D_pfsolb
+
+#---------------------------------------------------------
+# Convert the ASCII solid file to the binary format
+#---------------------------------------------------------
+pfsolidfmtconvert ../input/crater2D.pfsol crater2D.pfsolb
+
+pfset GeomInput.solidinput.FileName   crater2D.pfsolb
+
+#-----------------------------------------------------------------------------
+# Run and Unload the ParFlow output files
+#-----------------------------------------------------------------------------
+pfrun $runname
+pfundist $runname
+
+file delete crater2D.pfsolb
+
+#
+# Tests
+#
+source pftest.tcl
+set sig_digits 5
+
+set correct_output_dir [crater2DCorrectOutput $runname]
+set passed [crater2DTest $runname $sig_digits $correct_output_dir]
+file delete -force $correct_output_dir
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
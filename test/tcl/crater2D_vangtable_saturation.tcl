@@ -0,0 +1,42 @@
+#  This runs the crater2D_vangtable_spline problem with the Van Genuchten
+#  saturation also read from lookup tables (spline interpolation, linear
+#  in zone4).
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set crater2D_setup_only 1
+source crater2D_vangtable_spline.tcl
+
+set runname  crater2D_vangtable_saturation
+
+#---------------------------------------------------------
+# Saturation lookup tables
+#---------------------------------------------------------
+foreach zone $Zones {
+    pfset Geom.$zone.Saturation.NumSamplePoints   $VG_points
+    pfset Geom.$zone.Saturation.MinPressureHead   -300
+}
+pfset Geom.zone4.Saturation.InterpolationMethod   Linear
+
+#-----------------------------------------------------------------------------
+# Run and Unload the ParFlow output files
+#-----------------------------------------------------------------------------
+pfrun $runname
+pfundist $runname
+
+#
+# Tests
+#
+source pftest.tcl
+set sig_digits 5
+
+if [crater2DTest $runname $sig_digits] {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
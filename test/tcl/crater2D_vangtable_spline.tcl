@@ -483,6 +483,64 @@ pfset Solver.Linear.Preconditioner                       MGSemi
 pfset Solver.Linear.Preconditioner.MGSemi.MaxIter        1
 pfset Solver.Linear.Preconditioner.MGSemi.MaxLevels      100
 
+#-----------------------------------------------------------------------------
+# Regression check of the outputs of run runname against the correct
+# output in correct_output_dir, which is named after this deck
+#-----------------------------------------------------------------------------
+proc crater2DTest {runname sig_digits {correct_output_dir "../correct_output"}} {
+    set passed 1
+
+    if ![pftestFile $runname.out.perm_x.pfb "Max difference in perm_x" $sig_digits $correct_output_dir] {
+	set passed 0
+    }
+    if ![pftestFile $runname.out.perm_y.pfb "Max difference in perm_y" $sig_digits $correct_output_dir] {
+	set passed 0
+    }
+    if ![pftestFile $runname.out.perm_z.pfb "Max difference in perm_z" $sig_digits $correct_output_dir] {
+	set passed 0
+    }
+    if ![pftestFile $runname.out.porosity.pfb "Max difference in porosity" $sig_digits $correct_output_dir] {
+	set passed 0
+    }
+
+    # Pressure was very close to zero and test was failing so ignore very small pressures even if
+    # the numbers differ in sig_digits
+    set abs_diff 1E-200
+    foreach i "00000 00001 00002" {
+	if ![pftestFileWithAbs $runname.out.press.$i.pfb "Max difference in Pressure for timestep $i" $sig_digits $abs_diff $correct_output_dir] {
+	    set passed 0
+	}
+	if ![pftestFile $runname.out.satur.$i.pfb "Max difference in Saturation for timestep $i" $sig_digits $correct_output_dir] {
+	    set passed 0
+	}
+    }
+
+    return $passed
+}
+
+#-----------------------------------------------------------------------------
+# The correct output of this deck linked under the name of run runname, for
+# the variants of this problem that are checked against it
+#-----------------------------------------------------------------------------
+proc crater2DCorrectOutput {runname} {
+    set correct_output_dir $runname.correct_output
+    file delete -force $correct_output_dir
+    file mkdir $correct_output_dir
+
+    set prefix crater2D_vangtable_spline.out.
+    foreach file [glob -directory ../correct_output -tails $prefix*] {
+	set postfix [string range $file [string length $prefix] end]
+	file link -symbolic $correct_output_dir/$runname.out.$postfix [file normalize ../correct_output/$file]
+    }
+
+    return $correct_output_dir
+}
+
+# Variants source this deck for the problem setup and run it themselves
+if [info exists crater2D_setup_only] {
+    return
+}
+
 #-----------------------------------------------------------------------------
 # Run and Unload the ParFlow output files
 #-----------------------------------------------------------------------------
@@ -495,35 +553,7 @@ pfundist $runname
 source pftest.tcl
 set sig_digits 5
 
-set passed 1
-
-if ![pftestFile $runname.out.perm_x.pfb "Max difference in perm_x" $sig_digits] {
-    set passed 0
-}
-if ![pftestFile $runname.out.perm_y.pfb "Max difference in perm_y" $sig_digits] {
-    set passed 0
-}
-if ![pftestFile $runname.out.perm_z.pfb "Max difference in perm_z" $sig_digits] {
-    set passed 0
-}
-if ![pftestFile $runname.out.porosity.pfb "Max difference in porosity" $sig_digits] {
-    set passed 0
-}
-
-# Pressure was very close to zero and test was failing so ignore very small pressures even if
-# the numbers differ in sig_digits
-set abs_diff 1E-200
-foreach i "00000 00001 00002" {
-    if ![pftestFileWithAbs $runname.out.press.$i.pfb "Max difference in Pressure for timestep $i" $sig_digits $abs_diff] {
-	set passed 0
-    }
-    if ![pftestFile $runname.out.satur.$i.pfb "Max difference in Saturation for timestep $i" $sig_digits] {
-	set passed 0
-    }
-}
-
-
-if $passed {
+if [crater2DTest $runname $sig_digits] {
     puts "crater2D : PASSED"
 } {
     puts "crater2D : FAILED"
@@ -383,6 +383,24 @@ foreach i "00000 00001 00002 00003 00004 00005" {
 }
 }
 
+#-----------------------------------------------------------------------------
+# Rerun with the pipelined BiCGStab linear solver, checked against the same
+# results
+#-----------------------------------------------------------------------------
+pfset Solver.Linear.KrylovMethod                         PipelinedBiCGStab
+
+pfrun $runname
+pfundist $runname
+
+foreach i "00000 00001 00002 00003 00004 00005" {
+    if ![pftestFile $runname.out.press.$i.pfb "PipelinedBiCGStab: Max difference in Pressure for timestep $i" $sig_digits] {
+    set passed 0
+}
+    if ![pftestFile $runname.out.satur.$i.pfb "PipelinedBiCGStab: Max difference in Saturation for timestep $i" $sig_digits] {
+    set passed 0
+}
+}
+
 if $passed {
     puts "$runname : PASSED"
 } {
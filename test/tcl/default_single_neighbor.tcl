@@ -0,0 +1,14 @@
+#  This runs the default_single problem with the package exchanges done
+#  by neighborhood collectives instead of persistent point to point
+#  requests; the results must match the default_single correct output.
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+pfset Process.Exchange.Method   Neighbor
+
+source default_single.tcl
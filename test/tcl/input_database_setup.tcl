@@ -0,0 +1,242 @@
+#  This times problem setup for an input file with a large number of
+#  geometries.  Every geometry carries its own set of keys so setup
+#  performs many thousands of input database lookups.  The run is a
+#  single time step; the elapsed time is reported and the usage file
+#  is checked to make sure every geometry key was read.
+#
+#  Usage: tclsh input_database_setup.tcl P Q R [num_geoms]
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname input_database_setup
+
+if {[llength $argv] > 3} {
+    set num_geoms [lindex $argv 3]
+} {
+    set num_geoms 100
+}
+
+pfset FileVersion 4
+
+pfset Process.Topology.P        [lindex $argv 0]
+pfset Process.Topology.Q        [lindex $argv 1]
+pfset Process.Topology.R        [lindex $argv 2]
+
+#---------------------------------------------------------
+# Computational Grid
+#---------------------------------------------------------
+pfset ComputationalGrid.Lower.X                0.0
+pfset ComputationalGrid.Lower.Y                0.0
+pfset ComputationalGrid.Lower.Z                0.0
+
+pfset ComputationalGrid.DX                     1.0
+pfset ComputationalGrid.DY                     1.0
+pfset ComputationalGrid.DZ                     1.0
+
+pfset ComputationalGrid.NX                     4
+pfset ComputationalGrid.NY                     4
+pfset ComputationalGrid.NZ                     $num_geoms
+
+#---------------------------------------------------------
+# Geometries: the domain and one box per layer
+#---------------------------------------------------------
+set layer_names ""
+set layer_inputs ""
+for {set k 0} {$k < $num_geoms} {incr k} {
+    lappend layer_names layer$k
+    lappend layer_inputs layer${k}_input
+}
+
+pfset GeomInput.Names "domain_input $layer_inputs"
+
+pfset GeomInput.domain_input.InputType            Box
+pfset GeomInput.domain_input.GeomName             domain
+
+pfset Geom.domain.Lower.X                         0.0
+pfset Geom.domain.Lower.Y                         0.0
+pfset Geom.domain.Lower.Z                         0.0
+
+pfset Geom.domain.Upper.X                         4.0
+pfset Geom.domain.Upper.Y                         4.0
+pfset Geom.domain.Upper.Z                         $num_geoms
+
+pfset Geom.domain.Patches "left right front back bottom top"
+
+for {set k 0} {$k < $num_geoms} {incr k} {
+    pfset GeomInput.layer${k}_input.InputType     Box
+    pfset GeomInput.layer${k}_input.GeomName      layer$k
+
+    pfset Geom.layer$k.Lower.X                    0.0
+    pfset Geom.layer$k.Lower.Y                    0.0
+    pfset Geom.layer$k.Lower.Z                    $k
+
+    pfset Geom.layer$k.Upper.X                    4.0
+    pfset Geom.layer$k.Upper.Y                    4.0
+    pfset Geom.layer$k.Upper.Z                    [expr $k + 1]
+}
+
+#-----------------------------------------------------------------------------
+# Per geometry properties
+#-----------------------------------------------------------------------------
+pfset Geom.Perm.Names                   $layer_names
+pfset Geom.Porosity.GeomNames           $layer_names
+pfset SpecificStorage.GeomNames         $layer_names
+pfset Phase.RelPerm.GeomNames           $layer_names
+pfset Phase.Saturation.GeomNames        $layer_names
+
+for {set k 0} {$k < $num_geoms} {incr k} {
+    pfset Geom.layer$k.Perm.Type                 Constant
+    pfset Geom.layer$k.Perm.Value                [expr 0.1 + 0.01 * ($k % 10)]
+
+    pfset Geom.layer$k.Porosity.Type             Constant
+    pfset Geom.layer$k.Porosity.Value            0.3
+
+    pfset Geom.layer$k.SpecificStorage.Value     1.0e-4
+
+    pfset Geom.layer$k.RelPerm.Alpha             2.0
+    pfset Geom.layer$k.RelPerm.N                 3.0
+
+    pfset Geom.layer$k.Saturation.Alpha          2.0
+    pfset Geom.layer$k.Saturation.N              3.0
+    pfset Geom.layer$k.Saturation.SRes           0.1
+    pfset Geom.layer$k.Saturation.SSat           1.0
+}
+
+pfset Perm.TensorType                   TensorByGeom
+pfset Geom.Perm.TensorByGeom.Names      "domain"
+pfset Geom.domain.Perm.TensorValX       1.0
+pfset Geom.domain.Perm.TensorValY       1.0
+pfset Geom.domain.Perm.TensorValZ       1.0
+
+pfset SpecificStorage.Type              Constant
+pfset Phase.RelPerm.Type                VanGenuchten
+pfset Phase.Saturation.Type             VanGenuchten
+
+#-----------------------------------------------------------------------------
+# Phases, contaminants, gravity
+#-----------------------------------------------------------------------------
+pfset Phase.Names                       "water"
+pfset Phase.water.Density.Type          Constant
+pfset Phase.water.Density.Value         1.0
+pfset Phase.water.Viscosity.Type        Constant
+pfset Phase.water.Viscosity.Value       1.0
+
+pfset Contaminants.Names                ""
+pfset Geom.Retardation.GeomNames        ""
+pfset Gravity                           1.0
+
+#-----------------------------------------------------------------------------
+# Timing: a single time step
+#-----------------------------------------------------------------------------
+pfset TimingInfo.BaseUnit               1.0
+pfset TimingInfo.StartCount             0
+pfset TimingInfo.StartTime              0.0
+pfset TimingInfo.StopTime               0.001
+pfset TimingInfo.DumpInterval           -1
+pfset TimeStep.Type                     Constant
+pfset TimeStep.Value                    0.001
+
+pfset Domain.GeomName                   domain
+
+pfset Wells.Names                       ""
+
+pfset Cycle.Names                       constant
+pfset Cycle.constant.Names              "alltime"
+pfset Cycle.constant.alltime.Length     1
+pfset Cycle.constant.Repeat             -1
+
+#-----------------------------------------------------------------------------
+# Boundary Conditions: Pressure
+#-----------------------------------------------------------------------------
+pfset BCPressure.PatchNames             "left right front back bottom top"
+
+foreach patch "left right front back bottom top" {
+    pfset Patch.$patch.BCPressure.Type           FluxConst
+    pfset Patch.$patch.BCPressure.Cycle          "constant"
+    pfset Patch.$patch.BCPressure.alltime.Value  0.0
+}
+
+pfset TopoSlopesX.Type                  "Constant"
+pfset TopoSlopesX.GeomNames             ""
+pfset TopoSlopesY.Type                  "Constant"
+pfset TopoSlopesY.GeomNames             ""
+
+pfset Mannings.Type                     "Constant"
+pfset Mannings.GeomNames                ""
+
+#---------------------------------------------------------
+# Initial conditions: water pressure
+#---------------------------------------------------------
+pfset ICPressure.Type                   HydroStaticPatch
+pfset ICPressure.GeomNames              domain
+pfset Geom.domain.ICPressure.Value      -1.0
+pfset Geom.domain.ICPressure.RefGeom    domain
+pfset Geom.domain.ICPressure.RefPatch   top
+
+pfset PhaseSources.water.Type                   Constant
+pfset PhaseSources.water.GeomNames              domain
+pfset PhaseSources.water.Geom.domain.Value      0.0
+
+pfset KnownSolution                     NoKnownSolution
+
+#-----------------------------------------------------------------------------
+# Set solver parameters
+#-----------------------------------------------------------------------------
+pfset Solver                            Richards
+pfset Solver.MaxIter                    1
+
+pfset Solver.Nonlinear.MaxIter          10
+pfset Solver.Nonlinear.ResidualTol      1e-9
+pfset Solver.Nonlinear.EtaChoice        EtaConstant
+pfset Solver.Nonlinear.EtaValue         1e-5
+pfset Solver.Nonlinear.UseJacobian      True
+pfset Solver.Nonlinear.DerivativeEpsilon 1e-2
+
+pfset Solver.Linear.KrylovDimension     10
+pfset Solver.Linear.Preconditioner      MGSemi
+
+pfset Solver.PrintSubsurf               False
+pfset Solver.PrintPressure              False
+pfset Solver.PrintSaturation            False
+
+#-----------------------------------------------------------------------------
+# Run and report the elapsed time
+#-----------------------------------------------------------------------------
+set start [clock milliseconds]
+pfrun $runname
+set elapsed [expr ([clock milliseconds] - $start) / 1000.0]
+pfundist $runname
+
+puts [format "%s : %d geometries, run time %.3f s" $runname $num_geoms $elapsed]
+
+#
+# Tests
+#
+set passed 1
+
+# Every per geometry key must have been flagged as used
+set file [open $runname.out.pftcl r]
+set not_used 0
+while {[gets $file line] >= 0} {
+    if {$line == "# Not used"} {
+        set not_used 1
+    } {
+        if {$not_used && [string match "pfset Geom.layer*" $line]} {
+            puts "Key not used : $line"
+            set passed 0
+        }
+        set not_used 0
+    }
+}
+close $file
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
@@ -0,0 +1,183 @@
+#
+# Priority-flood depression filling (pfpitfilldem -priorityflood) on a
+# synthetic DEM with nested pits and nodata regions.
+#
+# The DEM is a plane draining west with a closed rim around an inner
+# ring and pit. The rim spills at 105 on its west side, so with
+# epsilon 0 everything inside the rim must be filled flat to 105. With
+# epsilon > 0 every data cell that does not touch the domain edge or
+# nodata must have a strictly lower neighbor. Both filled DEMs are also
+# compared with the reference output.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname pitfill_priorityflood
+
+set nx 30
+set ny 20
+
+# center, rim and spill point of the nested depression
+set ci 15
+set cj 10
+set spill_i 9
+set spill_z 105.0
+
+proc ring {i j ci cj} {
+    return [expr max(abs($i - $ci), abs($j - $cj))]
+}
+
+#---------------------------------------------------------
+# Synthetic DEM
+#---------------------------------------------------------
+set file [open $runname.dem.sa w]
+puts $file "$nx $ny 1"
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	set r [ring $i $j $ci $cj]
+	if {(($i + $j) < 4) || (($i >= 24) && ($i <= 25) && ($j >= 3) && ($j <= 4))} {
+	    set z -9999.0
+	} elseif {($r == 6) && ($i == $spill_i) && ($j == $cj)} {
+	    set z $spill_z
+	} elseif {$r == 6} {
+	    set z 110.0
+	} elseif {$r == 3} {
+	    set z 100.0
+	} elseif {$r < 3} {
+	    set z [expr 90.0 + 0.1 * $r]
+	} elseif {$r < 6} {
+	    set z [expr 95.0 + 0.1 * $i]
+	} else {
+	    set z [expr 100.0 + 0.5 * $i + 0.2 * abs($j - $cj)]
+	}
+	puts $file [format "%.6f" $z]
+    }
+}
+close $file
+
+set dem [pfload -sa $runname.dem.sa]
+pfsetgrid [list $nx $ny 1] {0.0 0.0 0.0} {1.0 1.0 1.0} $dem
+
+file delete $runname.dem.sa
+
+#---------------------------------------------------------
+# Fill flat and with a minimum drop
+#---------------------------------------------------------
+set epsilon 0.01
+
+set flat [pfpitfilldem -priorityflood $dem]
+pfsave $flat -pfb $runname.flat.pfb
+
+set drop [pfpitfilldem -priorityflood $dem $epsilon]
+pfsave $drop -pfb $runname.epsilon.pfb
+
+#-----------------------------------------------------------------------------
+# Verify output
+#-----------------------------------------------------------------------------
+
+source pftest.tcl
+set passed 1
+
+# data cells that drain off the domain edge or into nodata directly
+proc isOutlet {dem i j nx ny} {
+    if {($i == 0) || ($j == 0) || ($i == $nx - 1) || ($j == $ny - 1)} {
+	return 1
+    }
+    foreach {ii jj} [list [expr $i - 1] $j [expr $i + 1] $j $i [expr $j - 1] $i [expr $j + 1]] {
+	if {[pfgetelt $dem $ii $jj 0] == -9999.0} {
+	    return 1
+	}
+    }
+    return 0
+}
+
+# lowest D4 neighbor of an interior cell
+proc lowestNeighbor {dem i j} {
+    set zmin 1e30
+    foreach {ii jj} [list [expr $i - 1] $j [expr $i + 1] $j $i [expr $j - 1] $i [expr $j + 1]] {
+	set zmin [expr min($zmin, [pfgetelt $dem $ii $jj 0])]
+    }
+    return $zmin
+}
+
+set flat_sinks 0
+set drop_sinks 0
+set flat_errors 0
+set unchanged_errors 0
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	set z [pfgetelt $dem $i $j 0]
+	set zflat [pfgetelt $flat $i $j 0]
+	set zdrop [pfgetelt $drop $i $j 0]
+
+	if {($z == -9999.0) || [isOutlet $dem $i $j $nx $ny]} {
+	    if {($zflat != $z) || ($zdrop != $z)} {
+		incr unchanged_errors
+	    }
+	    continue
+	}
+
+	# no cell may be a pit; with epsilon every cell must drain
+	if {[lowestNeighbor $flat $i $j] > $zflat} {
+	    incr flat_sinks
+	}
+	if {[lowestNeighbor $drop $i $j] >= $zdrop} {
+	    incr drop_sinks
+	}
+
+	# inside the rim the depression fills to the spill point
+	if {[ring $i $j $ci $cj] < 6} {
+	    if {$zflat != $spill_z} {
+		incr flat_errors
+	    }
+	} elseif {$zflat != $z} {
+	    incr flat_errors
+	}
+    }
+}
+
+if {$flat_sinks != 0} {
+    puts "FAILED : $flat_sinks sinks remain after filling with epsilon 0"
+    set passed 0
+}
+
+if {$drop_sinks != 0} {
+    puts "FAILED : $drop_sinks cells do not drain after filling with epsilon $epsilon"
+    set passed 0
+}
+
+if {$flat_errors != 0} {
+    puts "FAILED : $flat_errors cells are not filled to the spill elevation"
+    set passed 0
+}
+
+if {$unchanged_errors != 0} {
+    puts "FAILED : $unchanged_errors outlet or nodata cells were changed"
+    set passed 0
+}
+
+if ![pftestFile $runname.flat.pfb "Max difference in flat filled DEM" $sig_digits] {
+    set passed 0
+}
+
+if ![pftestFile $runname.epsilon.pfb "Max difference in epsilon filled DEM" $sig_digits] {
+    set passed 0
+}
+
+# a negative epsilon is rejected
+if {![catch {pfpitfilldem -priorityflood $dem -1.0} msg] ||
+    ([string first "greater than or equal to zero" $msg] < 0)} {
+    puts "FAILED : negative epsilon was not rejected"
+    set passed 0
+}
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
@@ -0,0 +1,312 @@
+#  Checkpoint/restart of the Richards solver.  A rain and recession
+#  column is run to the end while writing a checkpoint every 10 steps.
+#  The run is then restarted from the checkpoint at step 10 on a
+#  different process topology and must reproduce the remaining outputs
+#  of the first run, including the steps chosen by the Adaptive
+#  time step controller.
+#
+#  Ponded water is collected by a reservoir, which releases it until
+#  its storage drops below Min_Release_Storage after the checkpoint.
+#  The release cell is on rank 0 for every topology, so the reservoir
+#  output of rank 0 must be reproduced as well.
+
+set tcl_precision 17
+
+set runname richards_checkpoint
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+pfset FileVersion 4
+
+pfset Process.Topology.P        [lindex $argv 0]
+pfset Process.Topology.Q        [lindex $argv 1]
+pfset Process.Topology.R        [lindex $argv 2]
+
+#---------------------------------------------------------
+# Computational Grid
+#---------------------------------------------------------
+pfset ComputationalGrid.Lower.X                0.0
+pfset ComputationalGrid.Lower.Y                0.0
+pfset ComputationalGrid.Lower.Z                0.0
+
+pfset ComputationalGrid.DX                     1.0
+pfset ComputationalGrid.DY                     1.0
+pfset ComputationalGrid.DZ                     0.2
+
+pfset ComputationalGrid.NX                     4
+pfset ComputationalGrid.NY                     4
+pfset ComputationalGrid.NZ                     20
+
+#---------------------------------------------------------
+# Domain Geometry
+#---------------------------------------------------------
+pfset GeomInput.Names                          "domain_input"
+
+pfset GeomInput.domain_input.InputType         Box
+pfset GeomInput.domain_input.GeomName          domain
+
+pfset Geom.domain.Lower.X                      0.0
+pfset Geom.domain.Lower.Y                      0.0
+pfset Geom.domain.Lower.Z                      0.0
+
+pfset Geom.domain.Upper.X                      4.0
+pfset Geom.domain.Upper.Y                      4.0
+pfset Geom.domain.Upper.Z                      4.0
+
+pfset Geom.domain.Patches "left right front back bottom top"
+
+#-----------------------------------------------------------------------------
+# Subsurface properties
+#-----------------------------------------------------------------------------
+pfset Geom.Perm.Names                          "domain"
+pfset Geom.domain.Perm.Type                    Constant
+pfset Geom.domain.Perm.Value                   0.5
+
+pfset Perm.TensorType                          TensorByGeom
+pfset Geom.Perm.TensorByGeom.Names             "domain"
+pfset Geom.domain.Perm.TensorValX              1.0
+pfset Geom.domain.Perm.TensorValY              1.0
+pfset Geom.domain.Perm.TensorValZ              1.0
+
+pfset SpecificStorage.Type                     Constant
+pfset SpecificStorage.GeomNames                "domain"
+pfset Geom.domain.SpecificStorage.Value        1.0e-4
+
+pfset Geom.Porosity.GeomNames                  "domain"
+pfset Geom.domain.Porosity.Type                Constant
+pfset Geom.domain.Porosity.Value               0.4
+
+pfset Phase.RelPerm.Type                       VanGenuchten
+pfset Phase.RelPerm.GeomNames                  "domain"
+pfset Geom.domain.RelPerm.Alpha                3.5
+pfset Geom.domain.RelPerm.N                    2.0
+
+pfset Phase.Saturation.Type                    VanGenuchten
+pfset Phase.Saturation.GeomNames               "domain"
+pfset Geom.domain.Saturation.Alpha             3.5
+pfset Geom.domain.Saturation.N                 2.0
+pfset Geom.domain.Saturation.SRes              0.1
+pfset Geom.domain.Saturation.SSat              1.0
+
+#-----------------------------------------------------------------------------
+# Phases, contaminants, gravity
+#-----------------------------------------------------------------------------
+pfset Phase.Names                              "water"
+pfset Phase.water.Density.Type                 Constant
+pfset Phase.water.Density.Value                1.0
+pfset Phase.water.Viscosity.Type               Constant
+pfset Phase.water.Viscosity.Value              1.0
+
+pfset Contaminants.Names                       ""
+pfset Geom.Retardation.GeomNames               ""
+pfset Gravity                                  1.0
+
+pfset Domain.GeomName                          domain
+
+pfset Wells.Names                              ""
+
+#-----------------------------------------------------------------------------
+# Timing: adaptive steps, rain for 3 and recession for 5 time units
+#-----------------------------------------------------------------------------
+pfset TimingInfo.BaseUnit                      1.0
+pfset TimingInfo.StartCount                    0
+pfset TimingInfo.StartTime                     0.0
+pfset TimingInfo.StopTime                      10.0
+pfset TimingInfo.DumpInterval                  -1
+
+pfset TimeStep.Type                            Adaptive
+pfset TimeStep.InitialStep                     0.01
+pfset TimeStep.MinStep                         0.0001
+pfset TimeStep.MaxStep                         1.0
+
+pfset Cycle.Names                              "constant rainrec"
+pfset Cycle.constant.Names                     "alltime"
+pfset Cycle.constant.alltime.Length            1
+pfset Cycle.constant.Repeat                    -1
+
+pfset Cycle.rainrec.Names                      "rain rec"
+pfset Cycle.rainrec.rain.Length                3
+pfset Cycle.rainrec.rec.Length                 5
+pfset Cycle.rainrec.Repeat                     -1
+
+#-----------------------------------------------------------------------------
+# Boundary Conditions: Pressure
+#-----------------------------------------------------------------------------
+pfset BCPressure.PatchNames                    "left right front back bottom top"
+
+foreach patch "left right front back bottom" {
+    pfset Patch.$patch.BCPressure.Type           FluxConst
+    pfset Patch.$patch.BCPressure.Cycle          "constant"
+    pfset Patch.$patch.BCPressure.alltime.Value  0.0
+}
+
+pfset Patch.top.BCPressure.Type                OverlandFlow
+pfset Patch.top.BCPressure.Cycle               "rainrec"
+pfset Patch.top.BCPressure.rain.Value          -0.1
+pfset Patch.top.BCPressure.rec.Value           0.0
+
+pfset TopoSlopesX.Type                         "Constant"
+pfset TopoSlopesX.GeomNames                    "domain"
+pfset TopoSlopesX.Geom.domain.Value            0.01
+pfset TopoSlopesY.Type                         "Constant"
+pfset TopoSlopesY.GeomNames                    "domain"
+pfset TopoSlopesY.Geom.domain.Value            0.01
+
+pfset Mannings.Type                            "Constant"
+pfset Mannings.GeomNames                       "domain"
+pfset Mannings.Geom.domain.Value               1.0e-5
+
+#---------------------------------------------------------
+# Reservoir: intake in the far corner, release next to the origin
+#---------------------------------------------------------
+pfset Reservoirs.Names                         "reservoir"
+pfset Reservoirs.Overland_Flow_Solver          OverlandFlow
+pfset Reservoirs.reservoir.Intake_X            3.5
+pfset Reservoirs.reservoir.Intake_Y            3.5
+pfset Reservoirs.reservoir.Release_X           0.5
+pfset Reservoirs.reservoir.Release_Y           0.5
+pfset Reservoirs.reservoir.Has_Secondary_Intake_Cell 0
+pfset Reservoirs.reservoir.Max_Storage         100.0
+pfset Reservoirs.reservoir.Storage             0.55
+pfset Reservoirs.reservoir.Min_Release_Storage 0.5
+pfset Reservoirs.reservoir.Release_Rate        0.05
+
+#---------------------------------------------------------
+# Initial conditions: dry column
+#---------------------------------------------------------
+pfset ICPressure.Type                          HydroStaticPatch
+pfset ICPressure.GeomNames                     domain
+pfset Geom.domain.ICPressure.Value             -4.0
+pfset Geom.domain.ICPressure.RefGeom           domain
+pfset Geom.domain.ICPressure.RefPatch          top
+
+pfset PhaseSources.water.Type                  Constant
+pfset PhaseSources.water.GeomNames             domain
+pfset PhaseSources.water.Geom.domain.Value     0.0
+
+pfset KnownSolution                            NoKnownSolution
+
+#-----------------------------------------------------------------------------
+# Set solver parameters
+#-----------------------------------------------------------------------------
+pfset Solver                                   Richards
+pfset Solver.MaxIter                           10000
+
+pfset Solver.Nonlinear.MaxIter                 15
+pfset Solver.Nonlinear.ResidualTol             1e-9
+pfset Solver.Nonlinear.EtaChoice               EtaConstant
+pfset Solver.Nonlinear.EtaValue                1e-5
+pfset Solver.Nonlinear.UseJacobian             True
+pfset Solver.Nonlinear.DerivativeEpsilon       1e-8
+
+pfset Solver.Linear.KrylovDimension            20
+pfset Solver.Linear.Preconditioner             MGSemi
+
+pfset Solver.PrintSubsurf                      False
+pfset Solver.PrintPressure                     True
+pfset Solver.PrintSaturation                   True
+
+pfset Solver.Checkpoint.StepInterval           10
+
+#-----------------------------------------------------------------------------
+# Run to the end, then keep the outputs of the first run as the reference
+#-----------------------------------------------------------------------------
+pfrun $runname
+pfundist $runname
+
+source pftest.tcl
+set passed 1
+
+set reference_dir checkpoint_reference
+file delete -force $reference_dir
+file mkdir $reference_dir
+
+set restart_step 10
+set outputs [lsort [glob $runname.out.press.*.pfb $runname.out.satur.*.pfb]]
+foreach output $outputs {
+    file copy $output $reference_dir
+}
+
+set reservoir_output ReservoirsOutput.csv
+file rename $reservoir_output $reference_dir
+
+set checkpoint [format "%s.out.checkpoint.%05d" $runname $restart_step]
+if ![file exists $checkpoint] {
+    puts "FAILED : checkpoint file <$checkpoint> not created"
+    set passed 0
+}
+
+#-----------------------------------------------------------------------------
+# Restart from the checkpoint with the process topology transposed
+#-----------------------------------------------------------------------------
+pfset Process.Topology.P        [lindex $argv 1]
+pfset Process.Topology.Q        [lindex $argv 0]
+pfset Process.Topology.R        [lindex $argv 2]
+
+pfset Solver.Checkpoint.StepInterval           0
+pfset Solver.Checkpoint.RestartFile            $checkpoint
+
+foreach output $outputs {
+    file delete $output
+}
+
+pfrun $runname
+pfundist $runname
+
+#
+# Tests
+#
+set compared 0
+foreach output $outputs {
+    regexp {\.([0-9]+)\.pfb$} $output match number
+    if {[scan $number %d] <= $restart_step} {
+        if [file exists $output] {
+            puts "FAILED : restarted run rewrote <$output>"
+            set passed 0
+        }
+        continue
+    }
+    if ![pftestFile $output "Max difference in $output" $sig_digits $reference_dir] {
+        set passed 0
+    }
+    incr compared
+}
+
+# The restarted run appends the rows after the checkpoint, which must
+# match the last rows of the first run
+proc ReadRows {filename} {
+    set file [open $filename r]
+    set rows [split [string trim [read $file]] "\n"]
+    close $file
+    return $rows
+}
+
+if [file exists $reservoir_output] {
+    set restarted_rows [ReadRows $reservoir_output]
+    set reference_rows [ReadRows $reference_dir/$reservoir_output]
+    set num_rows [llength $restarted_rows]
+    if {$num_rows == 0 || $num_rows >= [llength $reference_rows] ||
+        [lrange $reference_rows end-[expr $num_rows - 1] end] != $restarted_rows} {
+        puts "FAILED : reservoir output of the restarted run differs"
+        set passed 0
+    }
+} {
+    puts "FAILED : reservoir output <$reservoir_output> not created"
+    set passed 0
+}
+
+if {$compared == 0} {
+    puts "FAILED : first run did not go past the checkpoint"
+    set passed 0
+}
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}
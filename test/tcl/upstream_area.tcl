@@ -0,0 +1,86 @@
+#
+# Upstream contributing area (pfupstreamarea) on a synthetic DEM with
+# pits, a divide and a nodata corner.
+#
+# The D4 slopes route every cell to a single receiver, the upwind slopes
+# route some cells both in x and y. The reference areas of both were
+# computed with the original recursive parent map walk and must be
+# reproduced exactly. With -split the upwind areas of the two receivers
+# of such cells are split in proportion to the slopes instead.
+#
+
+#
+# Import the ParFlow TCL package
+#
+lappend auto_path $env(PARFLOW_DIR)/bin
+package require parflow
+namespace import Parflow::*
+
+set runname upstream_area
+
+set nx 40
+set ny 30
+
+#---------------------------------------------------------
+# Synthetic DEM
+#---------------------------------------------------------
+set file [open $runname.dem.sa w]
+puts $file "$nx $ny 1"
+for {set j 0} {$j < $ny} {incr j} {
+    for {set i 0} {$i < $nx} {incr i} {
+	if {($i + $j) < 4} {
+	    puts $file "-9999.0"
+	} else {
+	    set z [expr 100.0 + 0.5 * $i + 0.3 * $j + 4.0 * sin($i / 3.0) * cos($j / 4.0) + 2.0 * abs($i - 20) / 20.0]
+	    puts $file [format "%.6f" $z]
+	}
+    }
+}
+close $file
+
+set dem [pfload -sa $runname.dem.sa]
+pfsetgrid [list $nx $ny 1] {0.0 0.0 0.0} {1.0 1.0 1.0} $dem
+
+#---------------------------------------------------------
+# Areas from single-direction (D4) and upwind slopes
+#---------------------------------------------------------
+set sx [pfslopexD4 $dem]
+set sy [pfslopeyD4 $dem]
+set area [pfupstreamarea $dem $sx $sy]
+pfsave $area -pfb $runname.d4.pfb
+
+set sx [pfslopex $dem]
+set sy [pfslopey $dem]
+set area [pfupstreamarea $dem $sx $sy]
+pfsave $area -pfb $runname.upwind.pfb
+
+set area [pfupstreamarea -split $dem $sx $sy]
+pfsave $area -pfb $runname.split.pfb
+
+file delete $runname.dem.sa
+
+#-----------------------------------------------------------------------------
+# Verify output
+#-----------------------------------------------------------------------------
+
+source pftest.tcl
+set passed 1
+
+# areas are exact cell counts unless split
+if ![pftestFile $runname.d4.pfb "Max difference in D4 upstream area" 15] {
+    set passed 0
+}
+
+if ![pftestFile $runname.upwind.pfb "Max difference in upwind upstream area" 15] {
+    set passed 0
+}
+
+if ![pftestFile $runname.split.pfb "Max difference in split upwind upstream area" $sig_digits] {
+    set passed 0
+}
+
+if $passed {
+    puts "$runname : PASSED"
+} {
+    puts "$runname : FAILED"
+}